@@ -12,6 +12,9 @@
 
 #include <algorithm>
 #include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
 
 namespace r = reinforcement_learning;
 namespace u = reinforcement_learning::utility;
@@ -98,3 +101,69 @@ BENCHMARK_CAPTURE(bench_cb, non_dedupable_payload_dedup, 20, 10, 50, 2000, 500,
     ->Unit(benchmark::kMillisecond);
 BENCHMARK_CAPTURE(bench_cb, non_dedupable_payload_compression_dedup, 20, 10, 50, 2000, 500, true, true)
     ->Unit(benchmark::kMillisecond);
+
+// Per decision latency of choose_rank_batch(). Every iteration makes the same 256 decisions, in batches of `range`
+// decisions: a batch of 1 costs the same as choose_rank().
+static void bench_cb_batch(benchmark::State& state)
+{
+  const auto batch_size = static_cast<size_t>(state.range(0));
+  constexpr size_t decisions = 256;
+
+  cb_decision_gen cb_gen(20, 10, 50, 2000, 0, false);
+
+  std::vector<std::string> examples;
+  std::vector<std::string> event_ids;
+  for (size_t i = 0; i < decisions; ++i)
+  {
+    examples.push_back(cb_gen.gen_example());
+    event_ids.push_back("event_id_" + std::to_string(i));
+  }
+
+  u::configuration config;
+  cfg::create_from_json(JSON_CFG, config);
+  config.set(r::name::PROTOCOL_VERSION, "2");
+  config.set(r::name::EH_TEST, "true");
+  config.set(r::name::MODEL_SRC, r::value::NO_MODEL_DATA);
+  config.set(r::name::OBSERVATION_SENDER_IMPLEMENTATION, r::value::OBSERVATION_FILE_SENDER);
+  config.set(r::name::INTERACTION_SENDER_IMPLEMENTATION, r::value::INTERACTION_FILE_SENDER);
+  config.set(r::name::INTERACTION_FILE_NAME, r::DEV_NULL);
+  config.set(r::name::OBSERVATION_FILE_NAME, r::DEV_NULL);
+  config.set(r::name::MODEL_BACKGROUND_REFRESH, "false");
+  config.set(r::name::VW_POOL_INIT_SIZE, "1");
+  config.set("queue.mode", "BLOCK");
+
+  r::api_status status;
+  r::cb_loop model(config);
+  model.init(&status);
+
+  std::vector<std::vector<std::pair<r::str_view, r::str_view>>> batches;
+  for (size_t i = 0; i < decisions; i += batch_size)
+  {
+    batches.emplace_back();
+    for (size_t j = i; j < i + batch_size && j < decisions; ++j)
+    {
+      batches.back().emplace_back(event_ids[j].c_str(), r::str_view(examples[j].c_str(), examples[j].size()));
+    }
+  }
+
+  std::vector<r::ranking_response> responses;
+  for (auto _ : state)
+  {
+    for (const auto& batch : batches)
+    {
+      if (model.choose_rank_batch(batch, r::action_flags::DEFAULT, responses, &status) != err::success)
+      {
+        std::cout << "there was an error so something went wrong during "
+                     "benchmarking: "
+                  << status.get_error_msg() << std::endl;
+      }
+    }
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * decisions);
+  state.counters["time_per_decision"] = benchmark::Counter(
+      static_cast<double>(state.iterations() * decisions), benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+}
+
+// range: decisions per batch
+BENCHMARK(bench_cb_batch)->Arg(1)->Arg(16)->Arg(256)->Unit(benchmark::kMicrosecond);
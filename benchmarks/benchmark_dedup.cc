@@ -0,0 +1,51 @@
+#include "api_status.h"
+#include "benchmark_common.h"
+#include "configuration.h"
+#include "dedup_internals.h"
+#include "err_constants.h"
+
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <vector>
+
+namespace r = reinforcement_learning;
+namespace u = reinforcement_learning::utility;
+
+// Time to extract the actions of a CB context into the dedup dictionary and rewrite the context with their ids,
+// which the dedup extension does for every logged event.
+static void bench_dedup_transform(benchmark::State& state)
+{
+  const auto actions_per_decision = static_cast<int>(state.range(0));
+
+  cb_decision_gen cb_gen(20, 10, actions_per_decision, 2000, 0, false);
+  std::vector<std::string> examples;
+  for (int i = 0; i < 16; ++i) { examples.push_back(cb_gen.gen_example()); }
+
+  u::configuration config;
+  r::dedup_state dedup(config, false, true, nullptr);
+
+  std::string edited_payload;
+  r::generic_event::object_list_t object_ids;
+  size_t bytes = 0;
+  size_t i = 0;
+  for (auto _ : state)
+  {
+    const auto& example = examples[i++ % examples.size()];
+    if (dedup.transform_payload_and_add_objects(example, edited_payload, object_ids, nullptr) !=
+        r::error_code::success)
+    {
+      state.SkipWithError("transform failed");
+      return;
+    }
+    // keep the dictionary at a steady size
+    for (auto aid : object_ids) { dedup.get_dict().remove_object(aid); }
+    bytes += example.size();
+    benchmark::DoNotOptimize(edited_payload.data());
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(bytes));
+  state.SetItemsProcessed(state.iterations());
+}
+
+// range: actions per context
+BENCHMARK(bench_dedup_transform)->Arg(50)->Arg(100)->Arg(250)->Arg(500);
@@ -0,0 +1,116 @@
+#include "err_constants.h"
+#include "logger/event_queue.h"
+#include "logger/lock_free_event_queue.h"
+#include "logger/sharded_event_queue.h"
+#include "ranking_event.h"
+
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace r = reinforcement_learning;
+
+namespace
+{
+class bench_event : public r::event
+{
+public:
+  bench_event() = default;
+  explicit bench_event(const char* id) : event(id, r::timestamp{}) {}
+  bool try_drop(float, int) override { return false; }
+};
+
+using queue_func_t = r::i_event_queue<bench_event>::TFunc;
+
+std::unique_ptr<r::i_event_queue<bench_event>> make_queue(r::queue_implementation_enum implementation)
+{
+  // capacity large enough for pruning to never kick in
+  const size_t max_capacity = static_cast<size_t>(1) << 40;
+  if (implementation == r::queue_implementation_enum::SHARDED)
+  {
+    return std::unique_ptr<r::i_event_queue<bench_event>>(new r::sharded_event_queue<bench_event>(
+        max_capacity, std::thread::hardware_concurrency(), r::events_counter_status::ENABLE));
+  }
+  if (implementation == r::queue_implementation_enum::LOCK_FREE)
+  {
+    return std::unique_ptr<r::i_event_queue<bench_event>>(new r::lock_free_event_queue<bench_event>(
+        max_capacity, 64 * 1024, r::queue_mode_enum::BLOCK, r::events_counter_status::ENABLE));
+  }
+  return std::unique_ptr<r::i_event_queue<bench_event>>(
+      new r::event_queue<bench_event>(max_capacity, r::events_counter_status::ENABLE));
+}
+}  // namespace
+
+// Measures the time it takes `producers` threads to push `events_per_producer` events each while a single consumer
+// thread (the async_batcher flush thread) drains the queue.
+template <class... ExtraArgs>
+static void bench_event_queue(benchmark::State& state, ExtraArgs&&... extra_args)
+{
+  int res[sizeof...(extra_args)] = {extra_args...};
+  auto implementation = static_cast<r::queue_implementation_enum>(res[0]);
+  const auto producers = static_cast<int>(state.range(0));
+  constexpr int events_per_producer = 10000;
+
+  for (auto _ : state)
+  {
+    auto queue = make_queue(implementation);
+    std::atomic<bool> done{false};
+
+    std::thread consumer(
+        [&queue, &done]
+        {
+          queue_func_t f;
+          bench_event evt;
+          while (!done.load() || queue->size() > 0)
+          {
+            if (queue->pop(&f)) { f(evt, nullptr); }
+          }
+        });
+
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; ++p)
+    {
+      threads.emplace_back(
+          [&queue]
+          {
+            for (int i = 0; i < events_per_producer; ++i)
+            {
+              auto evt_sp = std::make_shared<bench_event>("event_id");
+              auto evt_fn = [evt_sp](bench_event& out_evt, r::api_status*) -> int
+              {
+                out_evt = std::move(*evt_sp);
+                return r::error_code::success;
+              };
+              queue->push(std::move(evt_fn), 64, evt_sp.get());
+            }
+          });
+    }
+
+    for (auto& t : threads) { t.join(); }
+    done = true;
+    consumer.join();
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * producers * events_per_producer);
+}
+
+// x queue implementation
+// range: number of producer threads
+BENCHMARK_CAPTURE(bench_event_queue, locked, static_cast<int>(r::queue_implementation_enum::LOCKED))
+    ->RangeMultiplier(2)
+    ->Range(1, 64)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(bench_event_queue, lock_free, static_cast<int>(r::queue_implementation_enum::LOCK_FREE))
+    ->RangeMultiplier(2)
+    ->Range(1, 64)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(bench_event_queue, sharded, static_cast<int>(r::queue_implementation_enum::SHARDED))
+    ->RangeMultiplier(2)
+    ->Range(1, 64)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
@@ -4,14 +4,23 @@
 #include "constants.h"
 #include "err_constants.h"
 #include "model_mgmt.h"
+#include "utility/versioned_object_pool.h"
+#include "vw_model/safe_vw.h"
 
 #include <benchmark/benchmark.h>
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
 #include <iostream>
+#include <iterator>
+#include <thread>
+#include <vector>
 
 namespace r = reinforcement_learning;
 namespace u = reinforcement_learning::utility;
+namespace m = reinforcement_learning::model_management;
 namespace err = reinforcement_learning::error_code;
 namespace cfg = reinforcement_learning::utility::config;
 
@@ -93,3 +102,99 @@ BENCHMARK_CAPTURE(bench_init, no_model, false, 0)->Unit(benchmark::kMillisecond)
 BENCHMARK_CAPTURE(bench_init, small_model, true, 0)->Unit(benchmark::kMillisecond);
 BENCHMARK_CAPTURE(bench_init, half_model, true, 1)->Unit(benchmark::kMillisecond);
 BENCHMARK_CAPTURE(bench_init, large_model, true, 2)->Unit(benchmark::kMillisecond);
+
+// Latency of ranking calls made while the model is being refreshed. Request threads keep checking a safe_vw out of the
+// pool and ranking with it while update_factory() builds a new generation of `range` instances of the half model.
+// Reports the percentiles of the per call latency over the refresh.
+static void bench_rank_latency_during_refresh(benchmark::State& state)
+{
+  const auto pool_size = static_cast<int>(state.range(0));
+  constexpr int request_threads = 4;
+
+  std::ifstream model_file("benchmarks/models/cb_explore_adf_half.m", std::ios::binary);
+  const std::vector<char> model_bytes(
+      (std::istreambuf_iterator<char>(model_file)), std::istreambuf_iterator<char>());
+  m::model_data data;
+  if (data.set_data(model_bytes.data(), model_bytes.size()) != err::success)
+  {
+    state.SkipWithError("could not load benchmarks/models/cb_explore_adf_half.m");
+    return;
+  }
+
+  cb_decision_gen cb_gen(20, 10, 50, 2000, 0, false);
+  const auto context = cb_gen.gen_example();
+
+  u::versioned_object_pool<r::safe_vw> pool(r::safe_vw_factory(data, "--json --quiet"), pool_size);
+
+  std::vector<double> latencies_us;
+  for (auto _ : state)
+  {
+    std::atomic<bool> refreshing{true};
+    std::vector<std::vector<double>> thread_latencies(request_threads);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < request_threads; ++t)
+    {
+      threads.emplace_back(
+          [&, t]
+          {
+            std::vector<int> actions;
+            std::vector<float> scores;
+            while (refreshing)
+            {
+              const auto start = std::chrono::steady_clock::now();
+              {
+                auto vw = pool.get_or_create();
+                vw->rank(context, actions, scores);
+              }
+              thread_latencies[t].push_back(
+                  std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+            }
+          });
+    }
+
+    pool.update_factory(r::safe_vw_factory(data, "--json --quiet"));
+    refreshing = false;
+    for (auto& t : threads) { t.join(); }
+    for (const auto& l : thread_latencies) { latencies_us.insert(latencies_us.end(), l.begin(), l.end()); }
+  }
+
+  if (latencies_us.empty()) { return; }
+  std::sort(latencies_us.begin(), latencies_us.end());
+  const auto percentile = [&latencies_us](double p)
+  { return latencies_us[static_cast<size_t>(p * static_cast<double>(latencies_us.size() - 1))]; };
+  state.counters["p50_us"] = percentile(0.5);
+  state.counters["p99_us"] = percentile(0.99);
+  state.counters["max_us"] = latencies_us.back();
+  state.counters["calls"] = static_cast<double>(latencies_us.size());
+}
+
+// range: pool size (number of safe_vw instances rebuilt by the refresh)
+BENCHMARK(bench_rank_latency_during_refresh)->Arg(4)->Arg(16)->Arg(64)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+// Steady state cost of getting a safe_vw for a request, without ranking, with `threads` request threads sharing the
+// pool. The thread cache path keeps one instance per thread and does not take the pool lock.
+template <class... ExtraArgs>
+static void bench_vw_pool_checkout(benchmark::State& state, ExtraArgs&&... extra_args)
+{
+  bool res[sizeof...(extra_args)] = {extra_args...};
+  const bool thread_cache = res[0];
+
+  // shared by the benchmark threads, one pool per mode
+  static u::versioned_object_pool<r::safe_vw> locked_pool(
+      r::safe_vw_factory("--cb_explore_adf --json --quiet"), 1, nullptr, false);
+  static u::versioned_object_pool<r::safe_vw> cached_pool(
+      r::safe_vw_factory("--cb_explore_adf --json --quiet"), 1, nullptr, true);
+  auto& pool = thread_cache ? cached_pool : locked_pool;
+
+  for (auto _ : state)
+  {
+    auto vw = pool.checkout();
+    benchmark::DoNotOptimize(vw.get());
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+// x thread cache (on/off)
+// threads: request threads
+BENCHMARK_CAPTURE(bench_vw_pool_checkout, locked, false)->ThreadRange(1, 16)->UseRealTime();
+BENCHMARK_CAPTURE(bench_vw_pool_checkout, thread_cache, true)->ThreadRange(1, 16)->UseRealTime();
@@ -0,0 +1,200 @@
+#include "api_status.h"
+#include "benchmark_common.h"
+#include "config_utility.h"
+#include "constants.h"
+#include "err_constants.h"
+#include "generic_event.h"
+#include "logger/logger_extensions.h"
+#include "logger/logger_facade.h"
+#include "ranking_response.h"
+#include "serialization/fb_serializer.h"
+#include "serialization/payload_serializer.h"
+#include "utility/watchdog.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdlib>
+#include <iostream>
+#include <new>
+
+namespace r = reinforcement_learning;
+namespace u = reinforcement_learning::utility;
+namespace l = reinforcement_learning::logger;
+namespace m = reinforcement_learning::model_management;
+
+// Global allocation counter, only counts allocations made by the thread that enabled it so that the batcher
+// thread (transform/serialization) is not accounted for.
+namespace
+{
+thread_local bool count_allocations = false;
+thread_local size_t allocations = 0;
+thread_local size_t allocated_bytes = 0;
+}  // namespace
+
+void* operator new(size_t size)
+{
+  if (count_allocations)
+  {
+    ++allocations;
+    allocated_bytes += size;
+  }
+  if (void* ptr = std::malloc(size == 0 ? 1 : size)) { return ptr; }
+  throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+
+namespace
+{
+class null_message_sender : public l::i_message_sender
+{
+public:
+  int send(const uint16_t, const buffer&, r::api_status* = nullptr) override { return r::error_code::success; }
+  int init(r::api_status* = nullptr) override { return r::error_code::success; }
+};
+}  // namespace
+
+// Allocations made by the request thread per logged CB v2 interaction.
+// The record path is what interaction_logger_facade uses, the closure path is the generic std::function fallback.
+template <class... ExtraArgs>
+static void bench_log_allocations(benchmark::State& state, ExtraArgs&&... extra_args)
+{
+  int res[sizeof...(extra_args)] = {extra_args...};
+  bool use_records = res[0];
+  bool lock_free_queue = res[1];
+
+  cb_decision_gen cb_gen(20, 10, 50, 2000, 0, false);
+  const auto context = cb_gen.gen_example();
+
+  u::configuration config;
+  config.set(r::name::PROTOCOL_VERSION, "2");
+  config.set(r::name::INTERACTION_SEND_BATCH_INTERVAL_MS, "10");
+  config.set(r::name::QUEUE_MODE, r::value::QUEUE_MODE_BLOCK);
+  config.set(r::name::QUEUE_IMPLEMENTATION,
+      lock_free_queue ? r::value::QUEUE_IMPLEMENTATION_LOCK_FREE : r::value::QUEUE_IMPLEMENTATION_LOCKED);
+
+  u::watchdog watchdog(nullptr);
+  auto ext = l::i_logger_extensions::get_extensions(config, nullptr);
+  l::interaction_logger_facade facade(m::model_type_t::CB, config,
+      std::unique_ptr<l::i_message_sender>(new null_message_sender()), watchdog, nullptr, *ext);
+  l::generic_event_logger logger(nullptr,
+      ext->create_batcher(
+          std::unique_ptr<l::i_message_sender>(new null_message_sender()), watchdog, nullptr, r::INTERACTION_SECTION),
+      "");
+  r::api_status status;
+  facade.init(&status);
+  logger.init(&status);
+
+  r::ranking_response response("event_id");
+  response.set_model_id("model_id");
+  for (uint32_t i = 0; i < 50; ++i) { response.push_back(i, 1.f / 50); }
+  const l::cb_serializer serializer;
+
+  size_t total_allocations = 0;
+  for (auto _ : state)
+  {
+    allocations = 0;
+    count_allocations = true;
+    if (use_records) { facade.log(context, 0, response, &status); }
+    else
+    {
+      std::vector<uint64_t> action_ids;
+      std::vector<float> probabilities;
+      std::string model_id(response.get_model_id());
+      for (auto const& slot : response)
+      {
+        action_ids.push_back(slot.action_id + 1);
+        probabilities.push_back(slot.probability);
+      }
+      logger.log(response.get_event_id(), context, serializer.type, ext.get(), serializer, &status, 0u,
+          r::messages::flatbuff::v2::LearningModeType_Online, action_ids, probabilities, model_id);
+    }
+    count_allocations = false;
+    total_allocations += allocations;
+  }
+  state.counters["allocs_per_event"] =
+      benchmark::Counter(static_cast<double>(total_allocations), benchmark::Counter::kAvgIterations);
+}
+
+// x record path (on/off)
+// x lock free queue (on/off)
+BENCHMARK_CAPTURE(bench_log_allocations, closure_locked_queue, false, false);
+BENCHMARK_CAPTURE(bench_log_allocations, record_locked_queue, true, false);
+BENCHMARK_CAPTURE(bench_log_allocations, record_lock_free_queue, true, true);
+
+// Bytes copied per CB v2 event for a context of `range` bytes, from the copy taken by log() to the serialized payload.
+// Each copy of the context lands in a freshly allocated buffer (event string, temporary vectors, builder growth), so
+// the bytes allocated along the way are used as the measure of bytes copied. Builder buffers handed out by a warm
+// flatbuffer_arena are not heap allocations: the payload itself is written once and is not counted.
+static void bench_context_bytes_copied(benchmark::State& state)
+{
+  const auto context_size = static_cast<size_t>(state.range(0));
+  const std::string context = "{\"a\":\"" + std::string(context_size - 8, 'x') + "\"}";
+
+  u::configuration config;
+  config.set(r::name::PROTOCOL_VERSION, "2");
+  auto ext = l::i_logger_extensions::get_extensions(config, nullptr);
+  const l::cb_serializer serializer;
+  const std::vector<uint64_t> action_ids = {1, 2, 3, 4};
+  const std::vector<float> probabilities = {0.7f, 0.1f, 0.1f, 0.1f};
+  const std::string model_id("model_id");
+
+  size_t total_bytes = 0;
+  for (auto _ : state)
+  {
+    allocated_bytes = 0;
+    count_allocations = true;
+    r::generic_event evt("event_id", r::timestamp(), serializer.type, context, "");
+    evt.transform(ext.get(), serializer, nullptr, 0u, r::messages::flatbuff::v2::LearningModeType_Online, action_ids,
+        probabilities, model_id);
+    benchmark::DoNotOptimize(evt.get_payload().data());
+    count_allocations = false;
+    total_bytes += allocated_bytes;
+  }
+  state.counters["bytes_copied_per_event"] =
+      benchmark::Counter(static_cast<double>(total_bytes), benchmark::Counter::kAvgIterations);
+  state.counters["context_copies"] = benchmark::Counter(
+      static_cast<double>(total_bytes) / context_size, benchmark::Counter::kAvgIterations);
+}
+
+// range: context size in bytes
+BENCHMARK(bench_context_bytes_copied)->Arg(10 * 1024)->Arg(50 * 1024);
+
+// Heap allocations per CB v2 payload built and copied into a batch, which is what the batcher (or a transform worker)
+// does for every event. Builder buffers are recycled by the thread's flatbuffer_arena.
+static void bench_payload_serialization_allocations(benchmark::State& state)
+{
+  const std::string context(static_cast<size_t>(state.range(0)), 'x');
+  const l::cb_serializer serializer;
+  const std::vector<uint64_t> action_ids = {1, 2, 3, 4};
+  const std::vector<float> probabilities = {0.7f, 0.1f, 0.1f, 0.1f};
+  const std::string model_id("model_id");
+  u::data_buffer batch;
+  r::generic_event evt;
+
+  size_t total_allocations = 0;
+  for (auto _ : state)
+  {
+    l::fb_collection_serializer<r::generic_event> collection(batch, r::value::CONTENT_ENCODING_IDENTITY);
+    allocations = 0;
+    count_allocations = true;
+    for (int i = 0; i < 64; ++i)
+    {
+      evt = r::generic_event("event_id", r::timestamp(), serializer.type,
+          serializer.event(context, 0u, r::messages::flatbuff::v2::LearningModeType_Online, action_ids, probabilities,
+              model_id),
+          r::event_content_type::IDENTITY, "");
+      collection.add(evt);
+    }
+    count_allocations = false;
+    total_allocations += allocations;
+    collection.finalize(nullptr);
+    batch.reset();
+  }
+  state.counters["allocs_per_event"] =
+      benchmark::Counter(static_cast<double>(total_allocations) / 64, benchmark::Counter::kAvgIterations);
+  state.SetItemsProcessed(state.iterations() * 64);
+}
+
+// range: context size in bytes
+BENCHMARK(bench_payload_serialization_allocations)->Arg(1024)->Arg(10 * 1024)->Arg(50 * 1024);
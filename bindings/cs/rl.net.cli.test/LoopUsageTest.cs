@@ -155,6 +155,36 @@ namespace Rl.Net.Cli.Test
             }
         }
 
+        [TestMethod]
+        public void Test_CBLoopChooseRankBatch()
+        {
+            string configJsonCB = configJson.TrimEnd('}', '\r', '\n', ' ', '\t') +
+                                @", ""model.vw.initial_command_line"": ""--quiet --cb_explore_adf"" }";
+
+            CBLoop cb_loop = Helpers.CreateLoopOrExit<CBLoop>(configJsonCB, config => new CBLoop(config), true);
+            ApiStatus apiStatus = new ApiStatus();
+
+            string[] eventIds = new string[16];
+            string[] contextJsons = new string[eventIds.Length];
+            for (int i = 0; i < eventIds.Length; i++)
+            {
+                eventIds[i] = "event_id_" + i;
+                contextJsons[i] = contextJsonCB;
+            }
+
+            RankingResponse[] rankingResponses;
+            if (!cb_loop.TryChooseRankBatch(eventIds, contextJsons, ActionFlags.Default, out rankingResponses, apiStatus))
+            {
+                Helpers.WriteStatusAndExit(apiStatus);
+            }
+
+            Assert.AreEqual(eventIds.Length, rankingResponses.Length);
+            for (int i = 0; i < eventIds.Length; i++)
+            {
+                Assert.AreEqual(eventIds[i], rankingResponses[i].EventId);
+            }
+        }
+
         [TestMethod]
         public void Test_CCBLoop()
         {
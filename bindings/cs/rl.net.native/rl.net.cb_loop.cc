@@ -6,6 +6,8 @@
 #include "trace_logger.h"
 
 #include <iostream>
+#include <utility>
+#include <vector>
 
 static void pipe_background_error_callback(const reinforcement_learning::api_status& status, cb_loop_context_t* context)
 {
@@ -93,6 +95,26 @@ API int CBLoopChooseRankWithFlags(cb_loop_context_t* context, const char* event_
       event_id, {context_json, static_cast<size_t>(context_json_size)}, flags, *resp, status);
 }
 
+API int CBLoopChooseRankBatch(cb_loop_context_t* context, const char** event_ids, const char** context_jsons,
+    const int* context_json_sizes, int count, unsigned int flags, reinforcement_learning::ranking_response** resps,
+    reinforcement_learning::api_status* status)
+{
+  std::vector<std::pair<reinforcement_learning::str_view, reinforcement_learning::str_view>> requests;
+  requests.reserve(static_cast<size_t>(count));
+  for (int i = 0; i < count; ++i)
+  {
+    requests.emplace_back(
+        event_ids[i], reinforcement_learning::str_view(context_jsons[i], static_cast<size_t>(context_json_sizes[i])));
+  }
+
+  std::vector<reinforcement_learning::ranking_response> responses;
+  const int result = context->cb_loop->choose_rank_batch(requests, flags, responses, status);
+  if (result != reinforcement_learning::error_code::success) { return result; }
+
+  for (int i = 0; i < count; ++i) { *resps[i] = std::move(responses[i]); }
+  return reinforcement_learning::error_code::success;
+}
+
 API int CBLoopReportActionTaken(
     cb_loop_context_t* context, const char* event_id, reinforcement_learning::api_status* status)
 {
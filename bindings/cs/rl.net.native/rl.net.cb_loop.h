@@ -29,6 +29,10 @@ extern "C"
   API int CBLoopChooseRankWithFlags(cb_loop_context_t* cb_loop, const char* event_id, const char* context_json,
       int context_json_size, unsigned int flags, reinforcement_learning::ranking_response* resp,
       reinforcement_learning::api_status* status = nullptr);
+  // resps holds count ranking_response objects owned by the caller
+  API int CBLoopChooseRankBatch(cb_loop_context_t* cb_loop, const char** event_ids, const char** context_jsons,
+      const int* context_json_sizes, int count, unsigned int flags, reinforcement_learning::ranking_response** resps,
+      reinforcement_learning::api_status* status = nullptr);
   API int CBLoopReportActionTaken(
       cb_loop_context_t* cb_loop, const char* event_id, reinforcement_learning::api_status* status = nullptr);
   API int CBLoopReportActionMultiIdTaken(cb_loop_context_t* cb_loop, const char* primary_id, const char* secondary_id,
@@ -6,6 +6,8 @@
 #include "trace_logger.h"
 
 #include <iostream>
+#include <utility>
+#include <vector>
 
 static void pipe_background_error_callback(
     const reinforcement_learning::api_status& status, livemodel_context_t* context)
@@ -94,6 +96,26 @@ API int LiveModelChooseRankWithFlags(livemodel_context_t* context, const char* e
       event_id, {context_json, static_cast<size_t>(context_json_size)}, flags, *resp, status);
 }
 
+API int LiveModelChooseRankBatch(livemodel_context_t* context, const char** event_ids, const char** context_jsons,
+    const int* context_json_sizes, int count, unsigned int flags, reinforcement_learning::ranking_response** resps,
+    reinforcement_learning::api_status* status)
+{
+  std::vector<std::pair<const char*, reinforcement_learning::string_view>> requests;
+  requests.reserve(static_cast<size_t>(count));
+  for (int i = 0; i < count; ++i)
+  {
+    requests.emplace_back(event_ids[i],
+        reinforcement_learning::string_view(context_jsons[i], static_cast<size_t>(context_json_sizes[i])));
+  }
+
+  std::vector<reinforcement_learning::ranking_response> responses;
+  const int result = context->livemodel->choose_rank_batch(requests, flags, responses, status);
+  if (result != reinforcement_learning::error_code::success) { return result; }
+
+  for (int i = 0; i < count; ++i) { *resps[i] = std::move(responses[i]); }
+  return reinforcement_learning::error_code::success;
+}
+
 API int LiveModelRequestContinuousAction(livemodel_context_t* context, const char* event_id, const char* context_json,
     int context_json_size, reinforcement_learning::continuous_action_response* resp,
     reinforcement_learning::api_status* status)
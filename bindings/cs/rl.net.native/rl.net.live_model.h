@@ -29,6 +29,10 @@ extern "C"
   API int LiveModelChooseRankWithFlags(livemodel_context_t* livemodel, const char* event_id, const char* context_json,
       int context_json_size, unsigned int flags, reinforcement_learning::ranking_response* resp,
       reinforcement_learning::api_status* status = nullptr);
+  // resps holds count ranking_response objects owned by the caller
+  API int LiveModelChooseRankBatch(livemodel_context_t* livemodel, const char** event_ids, const char** context_jsons,
+      const int* context_json_sizes, int count, unsigned int flags, reinforcement_learning::ranking_response** resps,
+      reinforcement_learning::api_status* status = nullptr);
 
   API int LiveModelRequestContinuousAction(livemodel_context_t* livemodel, const char* event_id,
       const char* context_json, int context_json_size, reinforcement_learning::continuous_action_response* resp,
@@ -50,6 +50,21 @@ namespace Rl.Net
                 return LiveModelChooseRankWithFlagsNative(liveModel, eventId, contextJson, contextJsonSize, flags, rankingResponse, apiStatus);
             }
 
+            [DllImport(NativeImports.RLNETNATIVE, EntryPoint = "LiveModelChooseRankBatch")]
+            private static extern int LiveModelChooseRankBatchNative(IntPtr liveModel, IntPtr eventIds, IntPtr contextJsons, IntPtr contextJsonSizes, int count, uint flags, IntPtr rankingResponses, IntPtr apiStatus);
+
+            internal static Func<IntPtr, IntPtr, IntPtr, IntPtr, int, uint, IntPtr, IntPtr, int> LiveModelChooseRankBatchOverride { get; set; }
+
+            public static int LiveModelChooseRankBatch(IntPtr liveModel, IntPtr eventIds, IntPtr contextJsons, IntPtr contextJsonSizes, int count, uint flags, IntPtr rankingResponses, IntPtr apiStatus)
+            {
+                if (LiveModelChooseRankBatchOverride != null)
+                {
+                    return LiveModelChooseRankBatchOverride(liveModel, eventIds, contextJsons, contextJsonSizes, count, flags, rankingResponses, apiStatus);
+                }
+
+                return LiveModelChooseRankBatchNative(liveModel, eventIds, contextJsons, contextJsonSizes, count, flags, rankingResponses, apiStatus);
+            }
+
             [DllImport(NativeImports.RLNETNATIVE, EntryPoint = "LiveModelRequestContinuousAction")]
             private static extern int LiveModelRequestContinuousActionNative(IntPtr liveModel, IntPtr eventId, IntPtr contextJson, int contextJsonSize, IntPtr continuousActionResponse, IntPtr apiStatus);
 
@@ -438,6 +453,43 @@ namespace Rl.Net
             }
         }
 
+        unsafe private static int LiveModelChooseRankBatch(IntPtr liveModel, string[] eventIds, string[] contextJsons, uint flags, IntPtr[] rankingResponses, IntPtr apiStatus)
+        {
+            if (eventIds == null || contextJsons == null || eventIds.Length != contextJsons.Length)
+            {
+                throw new ArgumentException("eventIds and contextJsons must have the same length", "contextJsons");
+            }
+
+            foreach (string contextJson in contextJsons)
+            {
+                CheckJsonString(contextJson);
+            }
+
+            int[] eventIdOffsets, eventIdSizes, contextJsonOffsets, contextJsonSizes;
+            byte[] eventIdsUtf8 = eventIds.ToNullTerminatedUtf8Batch(out eventIdOffsets, out eventIdSizes);
+            byte[] contextJsonsUtf8 = contextJsons.ToNullTerminatedUtf8Batch(out contextJsonOffsets, out contextJsonSizes);
+
+            IntPtr[] eventIdPtrs = new IntPtr[eventIds.Length];
+            IntPtr[] contextJsonPtrs = new IntPtr[contextJsons.Length];
+            fixed (byte* eventIdsUtf8Bytes = eventIdsUtf8)
+            fixed (byte* contextJsonsUtf8Bytes = contextJsonsUtf8)
+            {
+                for (int i = 0; i < eventIds.Length; i++)
+                {
+                    eventIdPtrs[i] = new IntPtr(eventIdsUtf8Bytes + eventIdOffsets[i]);
+                    contextJsonPtrs[i] = new IntPtr(contextJsonsUtf8Bytes + contextJsonOffsets[i]);
+                }
+
+                fixed (IntPtr* eventIdPtrsPtr = eventIdPtrs)
+                fixed (IntPtr* contextJsonPtrsPtr = contextJsonPtrs)
+                fixed (int* contextJsonSizesPtr = contextJsonSizes)
+                fixed (IntPtr* rankingResponsesPtr = rankingResponses)
+                {
+                    return NativeMethods.LiveModelChooseRankBatch(liveModel, new IntPtr(eventIdPtrsPtr), new IntPtr(contextJsonPtrsPtr), new IntPtr(contextJsonSizesPtr), eventIds.Length, flags, new IntPtr(rankingResponsesPtr), apiStatus);
+                }
+            }
+        }
+
         unsafe private static int LiveModelRequestContinuousAction(IntPtr liveModel, string eventId, string contextJson, IntPtr continuousActionResponse, IntPtr apiStatus)
         {
             CheckJsonString(contextJson);
@@ -885,6 +937,51 @@ namespace Rl.Net
             return result;
         }
 
+        public bool TryChooseRankBatch(string[] eventIds, string[] contextJsons, ActionFlags flags, out RankingResponse[] responses, ApiStatus apiStatus = null)
+        {
+            if (eventIds == null)
+            {
+                throw new ArgumentNullException("eventIds");
+            }
+
+            if (contextJsons == null)
+            {
+                throw new ArgumentNullException("contextJsons");
+            }
+
+            if (eventIds.Length != contextJsons.Length)
+            {
+                throw new ArgumentException("eventIds and contextJsons must have the same length", "contextJsons");
+            }
+
+            responses = new RankingResponse[contextJsons.Length];
+            IntPtr[] rankingResponses = new IntPtr[responses.Length];
+            for (int i = 0; i < responses.Length; i++)
+            {
+                responses[i] = new RankingResponse();
+                rankingResponses[i] = responses[i].DangerousGetHandle();
+            }
+
+            int result = LiveModelChooseRankBatch(this.DangerousGetHandle(), eventIds, contextJsons, (uint)flags, rankingResponses, apiStatus.ToNativeHandleOrNullptrDangerous());
+
+            GC.KeepAlive(this);
+            GC.KeepAlive(responses);
+            return result == NativeMethods.SuccessStatus;
+        }
+
+        public RankingResponse[] ChooseRankBatch(string[] eventIds, string[] contextJsons, ActionFlags flags = ActionFlags.Default)
+        {
+            RankingResponse[] result;
+
+            using (ApiStatus apiStatus = new ApiStatus())
+                if (!this.TryChooseRankBatch(eventIds, contextJsons, flags, out result, apiStatus))
+                {
+                    throw new RLException(apiStatus);
+                }
+
+            return result;
+        }
+
         public bool TryRequestContinuousAction(string eventId, string contextJson, out ContinuousActionResponse response, ApiStatus apiStatus = null)
         {
             response = new ContinuousActionResponse();
@@ -65,6 +65,11 @@ namespace Rl.Net
             return InvokeDangerous(() => this.liveModel.ChooseRank(eventId, contextJson, flags));
         }
 
+        public RankingResponse[] ChooseRankBatch(string[] eventIds, string[] contextJsons, ActionFlags flags = ActionFlags.Default)
+        {
+            return InvokeDangerous(() => this.liveModel.ChooseRankBatch(eventIds, contextJsons, flags));
+        }
+
         public DecisionResponse RequestDecision(string contextJson)
         {
             return InvokeDangerous(() => this.liveModel.RequestDecision(contextJson));
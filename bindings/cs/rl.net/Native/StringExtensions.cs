@@ -26,6 +26,32 @@ namespace Rl.Net.Native
             return length;
         }
 
+        // Encodes all the strings into a single buffer, each one followed by a null terminator, so that the buffer can be
+        // pinned once for the whole batch. offsets[i] is where strings[i] starts, sizes[i] its size in bytes without the
+        // terminator.
+        internal static byte[] ToNullTerminatedUtf8Batch(this string[] strings, out int[] offsets, out int[] sizes)
+        {
+            Encoding utf8 = Encoding.UTF8;
+
+            offsets = new int[strings.Length];
+            sizes = new int[strings.Length];
+            int totalSize = 0;
+            for (int i = 0; i < strings.Length; i++)
+            {
+                offsets[i] = totalSize;
+                sizes[i] = utf8.GetByteCount(strings[i]);
+                totalSize = checked(totalSize + sizes[i] + 1);
+            }
+
+            byte[] result = new byte[totalSize];
+            for (int i = 0; i < strings.Length; i++)
+            {
+                utf8.GetBytes(strings[i], 0, strings[i].Length, result, offsets[i]);
+            }
+
+            return result;
+        }
+
         unsafe internal static string PtrToStringUtf8(this IntPtr intPtr)
         {
             if (intPtr == IntPtr.Zero)
@@ -9,6 +9,9 @@
 #include <cstring>
 #include <exception>
 #include <memory>
+#include <string>
+#include <utility>
+#include <vector>
 
 #define STRINGIFY(x) #x
 #define MACRO_STRINGIFY(x) STRINGIFY(x)
@@ -212,6 +215,38 @@ PYBIND11_MODULE(rl_client, m)
         Request prediction for given context and let an event id be generated
 
         :rtype: :class:`rl_client.RankingResponse`
+    )pbdoc")
+      .def(
+          "choose_rank_batch",
+          [](rl::live_model& lm, const py::iterable& requests, bool deferred)
+          {
+            // keep the strings alive for the duration of the call
+            std::vector<std::pair<std::string, std::string>> storage;
+            for (const auto& request : requests)
+            {
+              storage.push_back(request.cast<std::pair<std::string, std::string>>());
+            }
+            std::vector<std::pair<const char*, rl::string_view>> batch;
+            batch.reserve(storage.size());
+            for (const auto& request : storage)
+            {
+              batch.emplace_back(request.first.c_str(), rl::string_view(request.second.data(), request.second.size()));
+            }
+
+            std::vector<rl::ranking_response> responses;
+            rl::api_status status;
+            unsigned int flags = deferred ? rl::action_flags::DEFERRED : rl::action_flags::DEFAULT;
+            THROW_IF_FAIL(lm.choose_rank_batch(batch, flags, responses, &status));
+            py::list result;
+            for (auto& response : responses) { result.append(py::cast(std::move(response))); }
+            return result;
+          },
+          py::arg("requests"), py::arg("deferred") = false,
+          R"pbdoc(
+        Request predictions for a batch of (event_id, context) pairs. The whole batch is ranked with the same model
+        and logged together, which is cheaper per decision than calling choose_rank in a loop.
+
+        :rtype: list of :class:`rl_client.RankingResponse`
     )pbdoc")
       .def(
           "request_episodic_decision",
@@ -346,6 +381,8 @@ PYBIND11_MODULE(rl_client, m)
       .def_property_readonly_static("VW_CMDLINE", [](py::object /*self*/) { return rl::name::VW_CMDLINE; })
       .def_property_readonly_static(
           "VW_POOL_INIT_SIZE", [](py::object /*self*/) { return rl::name::VW_POOL_INIT_SIZE; })
+      .def_property_readonly_static(
+          "VW_POOL_THREAD_CACHE", [](py::object /*self*/) { return rl::name::VW_POOL_THREAD_CACHE; })
       .def_property_readonly_static("INITIAL_EPSILON", [](py::object /*self*/) { return rl::name::INITIAL_EPSILON; })
       .def_property_readonly_static("LEARNING_MODE", [](py::object /*self*/) { return rl::name::LEARNING_MODE; })
       .def_property_readonly_static("PROTOCOL_VERSION", [](py::object /*self*/) { return rl::name::PROTOCOL_VERSION; })
@@ -426,6 +463,10 @@ PYBIND11_MODULE(rl_client, m)
           "MODEL_FILE_MUST_EXIST", [](py::object /*self*/) { return rl::name::MODEL_FILE_MUST_EXIST; })
       .def_property_readonly_static(
           "ZSTD_COMPRESSION_LEVEL", [](py::object /*self*/) { return rl::name::ZSTD_COMPRESSION_LEVEL; })
+      .def_property_readonly_static(
+          "ZSTD_DICTIONARY_SIZE", [](py::object /*self*/) { return rl::name::ZSTD_DICTIONARY_SIZE; })
+      .def_property_readonly_static(
+          "ZSTD_DICTIONARY_SAMPLES", [](py::object /*self*/) { return rl::name::ZSTD_DICTIONARY_SAMPLES; })
       .def_property_readonly_static(
           "AZURE_STORAGE_BLOB", [](py::object /*self*/) { return rl::value::AZURE_STORAGE_BLOB; })
       .def_property_readonly_static("NO_MODEL_DATA", [](py::object /*self*/) { return rl::value::NO_MODEL_DATA; })
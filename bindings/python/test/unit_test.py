@@ -70,6 +70,16 @@ class LiveModelTests(unittest.TestCase):
             rl_client.RLException, model.choose_rank, invalid_event_id, context
         )
 
+    def test_choose_rank_batch(self):
+        model = rl_client.LiveModel(self.config)
+
+        context = '{"_multi":[{},{}]}'
+        requests = [("event_id_%d" % i, context) for i in range(16)]
+        responses = model.choose_rank_batch(requests)
+        self.assertEqual(len(responses), len(requests))
+        for (event_id, _), response in zip(requests, responses):
+            self.assertEqual(response.event_id, event_id)
+
     def test_exception_contains_code(self):
         try:
             # This function should fail with an empty config.
@@ -0,0 +1,82 @@
+#include "batch_event_groups.h"
+
+#include <cstring>
+
+namespace
+{
+constexpr size_t INITIAL_SLOTS = 64;
+}
+
+uint64_t batch_event_groups::hash(const char* data, size_t size)
+{
+  // FNV-1a, event ids are short
+  uint64_t h = 14695981039346656037ULL;
+  for (size_t i = 0; i < size; ++i)
+  {
+    h ^= static_cast<unsigned char>(data[i]);
+    h *= 1099511628211ULL;
+  }
+  return h;
+}
+
+void batch_event_groups::add(const flatbuffers::String& id, const v2::JoinedEvent* event)
+{
+  if ((_size + 1) * 2 > _slots.size()) { grow(); }
+
+  const uint64_t h = hash(id.c_str(), id.size());
+  const size_t mask = _slots.size() - 1;
+  size_t i = h & mask;
+  for (; _slots[i].group != 0; i = (i + 1) & mask)
+  {
+    if (_slots[i].hash != h) { continue; }
+    const auto* other = _groups[_slots[i].group - 1].id;
+    if (other->size() != id.size() || std::memcmp(other->c_str(), id.c_str(), id.size()) != 0) { continue; }
+
+    // the group of an id that was already consumed is started again
+    if (_slots[i].group - 1 >= _next)
+    {
+      _groups[_slots[i].group - 1].events.push_back(event);
+      return;
+    }
+    break;
+  }
+
+  if (_size == _groups.size()) { _groups.emplace_back(); }
+  auto& new_group = _groups[_size++];
+  new_group.id = &id;
+  new_group.events.push_back(event);
+  _slots[i].hash = h;
+  _slots[i].group = _size;
+}
+
+void batch_event_groups::pop_front()
+{
+  if (empty()) { return; }
+  if (++_next == _size) { clear(); }
+}
+
+void batch_event_groups::clear()
+{
+  for (size_t i = 0; i < _size; ++i)
+  {
+    _groups[i].id = nullptr;
+    _groups[i].events.clear();
+  }
+  _size = 0;
+  _next = 0;
+  for (auto& s : _slots) { s = slot(); }
+}
+
+void batch_event_groups::grow()
+{
+  std::vector<slot> slots(_slots.empty() ? INITIAL_SLOTS : _slots.size() * 2);
+  const size_t mask = slots.size() - 1;
+  for (const auto& s : _slots)
+  {
+    if (s.group == 0) { continue; }
+    size_t i = s.hash & mask;
+    while (slots[i].group != 0) { i = (i + 1) & mask; }
+    slots[i] = s;
+  }
+  _slots.swap(slots);
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "generated/v2/FileFormat_generated.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace v2 = reinforcement_learning::messages::flatbuff::v2;
+
+/*
+batch event groups
+The events of a JoinedPayload grouped by event id, in the order each id first
+appears. Ids are not copied: they point into the payload, which outlives the
+batch. Each id is hashed once, into an open addressing table (linear probing)
+mapping it to its group.
+
+Groups are consumed from the front. Once all of them are, the groups and the
+table are reset but keep their memory, so that the next batches of a similar
+size do not allocate.
+*/
+class batch_event_groups
+{
+public:
+  struct group
+  {
+    const flatbuffers::String* id = nullptr;
+    std::vector<const v2::JoinedEvent*> events;
+  };
+
+  batch_event_groups() = default;
+  batch_event_groups(const batch_event_groups&) = delete;
+  batch_event_groups& operator=(const batch_event_groups&) = delete;
+
+  // appends the event to the group of id, starting a new group for the first
+  // event of an id
+  void add(const flatbuffers::String& id, const v2::JoinedEvent* event);
+
+  bool empty() const { return _next == _size; }
+  // groups not consumed yet
+  size_t pending() const { return _size - _next; }
+  // i-th group not consumed yet, 0 is the front
+  group& pending_at(size_t i) { return _groups[_next + i]; }
+  group& front() { return _groups[_next]; }
+  void pop_front();
+  void clear();
+
+private:
+  struct slot
+  {
+    uint64_t hash = 0;
+    // index of the group + 1, 0 for an empty slot
+    size_t group = 0;
+  };
+
+  static uint64_t hash(const char* data, size_t size);
+  // doubles the table, which is kept at most half full
+  void grow();
+
+  std::vector<group> _groups;
+  size_t _size = 0;
+  size_t _next = 0;
+  std::vector<slot> _slots;
+};
@@ -0,0 +1,117 @@
+#include "parse_example_binary.h"
+#include "parse_example_external.h"
+#include "vw/config/options_cli.h"
+#include "vw/core/global_data.h"
+#include "vw/core/learner.h"
+#include "vw/core/parse_primitives.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace
+{
+const char* const SOURCE_LOG = RL_BINARY_PARSER_TEST_FILES "valid_joined_logs/average_reward_100_interactions.fb";
+const char* const SYNTHETIC_LOG = "rl_binary_parser_bench.fb";
+
+size_t synthetic_log_bytes()
+{
+  const char* mb = std::getenv("RL_BINARY_PARSER_BENCH_MB");
+  return static_cast<size_t>(mb != nullptr ? std::atoll(mb) : 2048) * 1024 * 1024;
+}
+
+// Writes a joined log of at least size bytes: the file magic and header of SOURCE_LOG, then its checkpoint and
+// regular messages repeated. Returns false if SOURCE_LOG can not be read.
+bool write_synthetic_log(const std::string& file_name, size_t size)
+{
+  std::ifstream in(SOURCE_LOG, std::ios::binary);
+  std::vector<char> log((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+  if (log.empty()) { return false; }
+
+  // messages are padded to 8 bytes: the first checkpoint starts the repeated part
+  size_t offset = 0;
+  size_t body_begin = 0;
+  uint32_t previous_size = 0;
+  while (offset + sizeof(uint32_t) <= log.size())
+  {
+    offset += previous_size % 8;
+    uint32_t type = 0;
+    std::memcpy(&type, log.data() + offset, sizeof(type));
+    if (type == MSG_TYPE_CHECKPOINT && body_begin == 0) { body_begin = offset; }
+    offset += sizeof(type);
+    if (type == MSG_TYPE_FILEMAGIC)
+    {
+      offset += 4;
+      previous_size = 0;
+      continue;
+    }
+    std::memcpy(&previous_size, log.data() + offset, sizeof(previous_size));
+    offset += sizeof(previous_size) + previous_size;
+  }
+  if (body_begin == 0) { return false; }
+  // pad the body so that its copies start aligned
+  log.resize(log.size() + (8 - log.size() % 8) % 8, 0);
+
+  std::ofstream out(file_name, std::ios::binary | std::ios::trunc);
+  out.write(log.data(), static_cast<std::streamsize>(body_begin));
+  size_t written = body_begin;
+  while (written < size)
+  {
+    out.write(log.data() + body_begin, static_cast<std::streamsize>(log.size() - body_begin));
+    written += log.size() - body_begin;
+  }
+  return out.good();
+}
+}  // namespace
+
+// Examples per second trained from a multi-GB joined log (RL_BINARY_PARSER_BENCH_MB, 2048 by default), with the
+// interactions parsed on the learning thread (0) or ahead on a pool of parser threads, and the log read through
+// io_buf or mapped in memory.
+static void bench_binary_parser_threads(benchmark::State& state)
+{
+  static const bool log_written = write_synthetic_log(SYNTHETIC_LOG, synthetic_log_bytes());
+  if (!log_written)
+  {
+    state.SkipWithError("could not write the synthetic joined log");
+    return;
+  }
+
+  const auto args = std::string("--cb_explore_adf --binary_parser --quiet --parser_threads ") +
+      std::to_string(state.range(0)) + (state.range(1) != 0 ? " --binary_parser_mmap" : "") + " -d " + SYNTHETIC_LOG;
+  uint64_t examples = 0;
+  for (auto _ : state)
+  {
+    auto options = VW::make_unique<VW::config::options_cli>(VW::split_command_line(args));
+    auto vw = VW::external::initialize_with_binary_parser(std::move(options));
+
+    VW::start_parser(*vw);
+    VW::LEARNER::generic_driver(*vw);
+    VW::end_parser(*vw);
+
+    examples += vw->sd->example_number;
+    VW::finish(*vw, false);
+  }
+  state.counters["examples_per_sec"] = benchmark::Counter(static_cast<double>(examples), benchmark::Counter::kIsRate);
+}
+
+// range: parser threads, mapped input
+BENCHMARK(bench_binary_parser_threads)
+    ->Args({0, 0})
+    ->Args({1, 0})
+    ->Args({2, 0})
+    ->Args({4, 0})
+    ->Args({8, 0})
+    ->Args({0, 1})
+    ->Args({4, 1})
+    ->Args({8, 1})
+    ->Iterations(1)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,51 @@
+#include "decompression_arena.h"
+
+#include <algorithm>
+#include <cstddef>
+
+namespace
+{
+constexpr size_t ALIGNMENT = alignof(std::max_align_t);
+}
+
+uint8_t* decompression_arena::allocate(size_t size)
+{
+  size = (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+  std::lock_guard<std::mutex> lock(_mutex);
+  if (_current < _blocks.size() && _blocks[_current].size - _used >= size)
+  {
+    auto* data = _blocks[_current].data.get() + _used;
+    _used += size;
+    return data;
+  }
+
+  // the next block large enough, blocks too small for this buffer are left for the next batch
+  const size_t target = _blocks.empty() ? 0 : _current + 1;
+  size_t next = target;
+  while (next < _blocks.size() && _blocks[next].size < size) { ++next; }
+  if (next == _blocks.size())
+  {
+    const size_t block_size = (std::max)(size, static_cast<size_t>(BLOCK_SIZE));
+    _blocks.push_back({std::unique_ptr<uint8_t[]>(new uint8_t[block_size]), block_size});
+  }
+  // keep the blocks in the order they are used
+  if (next != target) { std::swap(_blocks[target], _blocks[next]); }
+  _current = target;
+  _used = size;
+  return _blocks[_current].data.get();
+}
+
+void decompression_arena::reset()
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  _current = 0;
+  _used = 0;
+}
+
+size_t decompression_arena::capacity() const
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  size_t capacity = 0;
+  for (const auto& b : _blocks) { capacity += b.size; }
+  return capacity;
+}
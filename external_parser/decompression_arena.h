@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/*
+decompression arena
+Memory for the events decompressed from one JoinedPayload. Buffers are carved
+out of large blocks which are kept between batches: reset() makes all of them
+available again once the batch has been processed, so that decompressing a
+batch stops allocating once the arena has grown to the size of a batch.
+
+Buffers are aligned for flatbuffers and live until the next reset().
+allocate() can be called from several threads.
+*/
+class decompression_arena
+{
+public:
+  static const size_t BLOCK_SIZE = 1024 * 1024;
+
+  decompression_arena() = default;
+  decompression_arena(const decompression_arena&) = delete;
+  decompression_arena& operator=(const decompression_arena&) = delete;
+
+  uint8_t* allocate(size_t size);
+  void reset();
+  // bytes held by the blocks
+  size_t capacity() const;
+
+private:
+  struct block
+  {
+    std::unique_ptr<uint8_t[]> data;
+    size_t size;
+  };
+
+  mutable std::mutex _mutex;
+  std::vector<block> _blocks;
+  // block being carved and bytes used in it
+  size_t _current = 0;
+  size_t _used = 0;
+};
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "decompression_arena.h"
 #include "generated/v2/CaEvent_generated.h"
 #include "generated/v2/CbEvent_generated.h"
 #include "generated/v2/Metadata_generated.h"
@@ -7,6 +8,7 @@
 #include "joined_event.h"
 #include "loop.h"
 #include "zstd.h"
+#include "zstd_dictionary_cache.h"
 
 namespace v2 = reinforcement_learning::messages::flatbuff::v2;
 
@@ -185,50 +187,120 @@ struct event_processor<v2::CaEvent>
   }
 };
 
-template <typename T>
-bool process_compression(const uint8_t* data, size_t size, const v2::Metadata& metadata, const T*& payload,
-    flatbuffers::DetachedBuffer& detached_buffer, VW::io::logger& logger)
+// Size of a zstd frame once decompressed, 0 if the frame is invalid or does
+// not carry its size
+inline size_t zstd_content_size(const uint8_t* data, size_t size)
 {
-  if (metadata.encoding() == v2::EventEncoding_Zstd)
+  const auto content_size = ZSTD_getFrameContentSize(data, size);
+  return content_size == ZSTD_CONTENTSIZE_ERROR || content_size == ZSTD_CONTENTSIZE_UNKNOWN
+      ? 0
+      : static_cast<size_t>(content_size);
+}
+
+// Decompresses a zstd frame into buffer, which holds the frame's content size
+inline bool zstd_decompress(const uint8_t* data, size_t size, uint8_t* buffer, size_t buffer_size,
+    const v2::Metadata& metadata, VW::io::logger& logger, const zstd_dictionary_cache* dictionaries)
+{
+  // frames compressed with a dictionary carry its id
+  const ZSTD_DDict* ddict = nullptr;
+  const uint32_t dict_id = ZSTD_getDictID_fromFrame(data, size);
+  if (dict_id != 0)
   {
-    size_t buff_size = ZSTD_getFrameContentSize(data, size);
-    if (buff_size == ZSTD_CONTENTSIZE_ERROR)
+    ddict = dictionaries != nullptr ? dictionaries->get(dict_id) : nullptr;
+    if (ddict == nullptr)
     {
-      logger.out_warn(
-          "Received ZSTD_CONTENTSIZE_ERROR while "
-          "decompressing event with id: "
-          "[{}] of type: [{}]",
-          metadata.id()->c_str(), EnumNamePayloadType(metadata.payload_type()));
-      return false;
-    }
-    if (buff_size == ZSTD_CONTENTSIZE_UNKNOWN)
-    {
-      logger.out_warn(
-          "Received ZSTD_CONTENTSIZE_UNKNOWN while "
-          "decompressing event with id: "
-          "[{}] of type: [{}]",
-          metadata.id()->c_str(), EnumNamePayloadType(metadata.payload_type()));
+      logger.out_warn("Received event with id: [{}] of type: [{}] compressed with unknown zstd dictionary [{}]",
+          metadata.id()->c_str(), EnumNamePayloadType(metadata.payload_type()), dict_id);
       return false;
     }
+  }
 
-    std::unique_ptr<uint8_t[]> buff_data(flatbuffers::DefaultAllocator().allocate(buff_size));
-    size_t res = ZSTD_decompress(buff_data.get(), buff_size, data, size);
+  // one decompression context per thread instead of one per event
+  struct dctx_holder
+  {
+    ZSTD_DCtx* dctx = ZSTD_createDCtx();
+    ~dctx_holder() { ZSTD_freeDCtx(dctx); }
+  };
+  static thread_local dctx_holder holder;
 
-    if (ZSTD_isError(res))
-    {
-      logger.out_warn(
-          "Received [{}] error while decompressing event with id: "
-          "[{}] of type: [{}]",
-          ZSTD_getErrorName(res), metadata.id()->c_str(), EnumNamePayloadType(metadata.payload_type()));
-      return false;
-    }
+  size_t res = ddict != nullptr ? ZSTD_decompress_usingDDict(holder.dctx, buffer, buffer_size, data, size, ddict)
+                                : ZSTD_decompressDCtx(holder.dctx, buffer, buffer_size, data, size);
+
+  if (ZSTD_isError(res))
+  {
+    logger.out_warn(
+        "Received [{}] error while decompressing event with id: "
+        "[{}] of type: [{}]",
+        ZSTD_getErrorName(res), metadata.id()->c_str(), EnumNamePayloadType(metadata.payload_type()));
+    return false;
+  }
+  return true;
+}
+
+// zstd_content_size, logging why the frame can not be decompressed
+inline bool check_zstd_content_size(
+    const uint8_t* data, size_t size, const v2::Metadata& metadata, VW::io::logger& logger, size_t& content_size)
+{
+  const auto frame_content_size = ZSTD_getFrameContentSize(data, size);
+  if (frame_content_size == ZSTD_CONTENTSIZE_ERROR)
+  {
+    logger.out_warn(
+        "Received ZSTD_CONTENTSIZE_ERROR while "
+        "decompressing event with id: "
+        "[{}] of type: [{}]",
+        metadata.id()->c_str(), EnumNamePayloadType(metadata.payload_type()));
+    return false;
+  }
+  if (frame_content_size == ZSTD_CONTENTSIZE_UNKNOWN)
+  {
+    logger.out_warn(
+        "Received ZSTD_CONTENTSIZE_UNKNOWN while "
+        "decompressing event with id: "
+        "[{}] of type: [{}]",
+        metadata.id()->c_str(), EnumNamePayloadType(metadata.payload_type()));
+    return false;
+  }
+  content_size = static_cast<size_t>(frame_content_size);
+  return true;
+}
+
+template <typename T>
+bool process_compression(const uint8_t* data, size_t size, const v2::Metadata& metadata, const T*& payload,
+    flatbuffers::DetachedBuffer& detached_buffer, VW::io::logger& logger,
+    const zstd_dictionary_cache* dictionaries = nullptr)
+{
+  if (metadata.encoding() == v2::EventEncoding_Zstd)
+  {
+    size_t buff_size = 0;
+    if (!check_zstd_content_size(data, size, metadata, logger, buff_size)) { return false; }
+
+    std::unique_ptr<uint8_t[]> buff_data(flatbuffers::DefaultAllocator().allocate(buff_size));
+    if (!zstd_decompress(data, size, buff_data.get(), buff_size, metadata, logger, dictionaries)) { return false; }
 
     auto data_ptr = buff_data.release();
 
-    detached_buffer = flatbuffers::DetachedBuffer(nullptr, false, data_ptr, 0, data_ptr, res);
+    detached_buffer = flatbuffers::DetachedBuffer(nullptr, false, data_ptr, 0, data_ptr, buff_size);
     payload = flatbuffers::GetRoot<T>(detached_buffer.data());
   }
   else { payload = flatbuffers::GetRoot<T>(data); }
   return true;
 }
+
+// Same as above, decompressing into a buffer of the arena
+template <typename T>
+bool process_compression(const uint8_t* data, size_t size, const v2::Metadata& metadata, const T*& payload,
+    decompression_arena& arena, VW::io::logger& logger, const zstd_dictionary_cache* dictionaries = nullptr)
+{
+  if (metadata.encoding() == v2::EventEncoding_Zstd)
+  {
+    size_t buff_size = 0;
+    if (!check_zstd_content_size(data, size, metadata, logger, buff_size)) { return false; }
+
+    auto* buffer = arena.allocate(buff_size);
+    if (!zstd_decompress(data, size, buffer, buff_size, metadata, logger, dictionaries)) { return false; }
+    payload = flatbuffers::GetRoot<T>(buffer);
+  }
+  else { payload = flatbuffers::GetRoot<T>(data); }
+  return true;
+}
 }  // namespace typed_event
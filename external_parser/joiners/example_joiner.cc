@@ -24,28 +24,42 @@
 
 #include <algorithm>
 #include <cctype>
+#include <cfloat>
 
 // VW headers
+#include "vw/common/hash.h"
 #include "vw/core/parse_example_json.h"
 #include "vw/core/parser.h"
 #include "vw/core/scope_exit.h"
 
 example_joiner::example_joiner(VW::workspace* vw)
-    : i_joiner(vw->logger), _vw(vw), _reward_calculation(&reward::earliest), _binary_to_json(false)
+    : i_joiner(vw->logger)
+    , _vw(vw)
+    , _parse_options(get_parse_options(*vw->options))
+    , _reward_calculation(&reward::earliest)
+    , _binary_to_json(false)
 {
 }
 
 example_joiner::example_joiner(VW::workspace* vw, bool binary_to_json, const std::string& outfile_name)
-    : i_joiner(vw->logger), _vw(vw), _reward_calculation(&reward::earliest), _binary_to_json(binary_to_json)
+    : i_joiner(vw->logger)
+    , _vw(vw)
+    , _parse_options(get_parse_options(*vw->options))
+    , _reward_calculation(&reward::earliest)
+    , _binary_to_json(binary_to_json)
 {
   _outfile.open(outfile_name, std::ofstream::out);
 }
 
 example_joiner::~example_joiner()
 {
+  wait_for_parse_jobs();
+  _parse_pool.reset();
+
   // cleanup examples
   _dedup_cache.clear(return_example_f, this);
   for (auto* ex : _example_pool) { VW::dealloc_examples(ex, 1); }
+  for (auto* ex : _parse_example_pool) { VW::dealloc_examples(ex, 1); }
   if (_binary_to_json) { _outfile.close(); }
 }
 
@@ -79,6 +93,57 @@ VW::example& example_joiner::get_or_create_example_f(void* vw)
 
 void example_joiner::return_example_f(void* vw, VW::example* ex) { ((example_joiner*)vw)->return_example(ex); }
 
+void example_joiner::set_parse_threads(size_t threads)
+{
+  if (_vw->output_config.audit || _vw->output_config.hash_inv)
+  {
+    logger.out_warn("Interactions are parsed on the parser thread with --audit or --invert_hash");
+    return;
+  }
+  wait_for_parse_jobs();
+  _parse_pool = threads > 0 ? VW::make_unique<work_pool>(threads) : nullptr;
+}
+
+VW::example* example_joiner::take_parse_example()
+{
+  VW::example* ex = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(_parse_example_pool_mutex);
+    if (!_parse_example_pool.empty())
+    {
+      ex = _parse_example_pool.back();
+      _parse_example_pool.pop_back();
+    }
+  }
+  if (ex == nullptr) { ex = VW::alloc_examples(1); }
+  _vw->parser_runtime.example_parser->lbl_parser.default_label(ex->l);
+  return ex;
+}
+
+void example_joiner::hand_over_examples(VW::multi_ex& parsed, VW::multi_ex& examples)
+{
+  for (size_t i = 0; i < parsed.size(); ++i)
+  {
+    if (i == examples.size()) { examples.push_back(VW::new_unused_example(*_vw)); }
+    VW::copy_example_data_with_label(examples[i], parsed[i]);
+    VW::empty_example(*_vw, *parsed[i]);
+  }
+
+  std::lock_guard<std::mutex> lock(_parse_example_pool_mutex);
+  _parse_example_pool.insert(_parse_example_pool.end(), parsed.begin(), parsed.end());
+  parsed.clear();
+}
+
+void example_joiner::wait_for_parse_jobs()
+{
+  for (auto& job : _parse_jobs)
+  {
+    job->done.wait();
+    for (auto* ex : job->examples) { VW::dealloc_examples(ex, 1); }
+  }
+  _parse_jobs.clear();
+}
+
 bool example_joiner::process_event(const v2::JoinedEvent& joined_event)
 {
   if (joined_event.event() == nullptr || joined_event.timestamp() == nullptr)
@@ -95,9 +160,20 @@ bool example_joiner::process_event(const v2::JoinedEvent& joined_event)
     return false;
   }
 
-  std::string id = event->meta()->id()->str();
+  const auto& id = *event->meta()->id();
 
-  if (event->meta()->payload_type() == v2::PayloadType_DedupInfo)
+  if (event->meta()->payload_type() == v2::PayloadType_ZstdDictionary)
+  {
+    // dictionaries are sent uncompressed, in front of the events using them
+    const auto* dictionary = event->payload();
+    if (dictionary == nullptr || _zstd_dictionaries.add(dictionary->data(), dictionary->size()) == 0)
+    {
+      logger.out_warn("Received invalid zstd dictionary with id: [{}]", id.c_str());
+      return false;
+    }
+    return true;
+  }
+  else if (event->meta()->payload_type() == v2::PayloadType_DedupInfo)
   {
     if (!process_dedup(*event, *event->meta()))
     {
@@ -113,15 +189,7 @@ bool example_joiner::process_event(const v2::JoinedEvent& joined_event)
     logger.out_error("Episode type events require multistep");
     return false;
   }
-  if (_batch_grouped_events.find(id) != _batch_grouped_events.end())
-  {
-    _batch_grouped_events[id].push_back(&joined_event);
-  }
-  else
-  {
-    _batch_grouped_events.insert({id, {&joined_event}});
-    _batch_event_order.emplace(id);
-  }
+  _batch_groups.add(id, &joined_event);
   return true;
 }
 
@@ -184,9 +252,8 @@ void example_joiner::set_reward_function(const v2::RewardFunctionType type, bool
 
 void example_joiner::clear_batch_info()
 {
-  _batch_grouped_events.clear();
-  _batch_grouped_examples.clear();
-  while (!_batch_event_order.empty()) { _batch_event_order.pop(); }
+  wait_for_parse_jobs();
+  _batch_groups.clear();
 }
 
 void example_joiner::clear_vw_examples(VW::multi_ex& examples)
@@ -199,28 +266,64 @@ void example_joiner::clear_vw_examples(VW::multi_ex& examples)
   examples.push_back(VW::new_unused_example(*_vw));
 }
 
-void example_joiner::clear_event_id_batch_info(const std::string& id)
+// Case insensitive equality
+bool iequals(const std::string& a, const std::string& b)
 {
-  _batch_grouped_events.erase(id);
-  if (!_batch_event_order.empty() && _batch_event_order.front() == id) { _batch_event_order.pop(); }
-  _batch_grouped_examples.erase(id);
+  if (a.size() != b.size()) { return false; }
+
+  return std::equal(a.begin(), a.end(), b.begin(), [](char a, char b) { return std::tolower(a) == std::tolower(b); });
 }
 
-void example_joiner::invalidate_joined_event(const std::string& id)
+template <typename T>
+bool example_joiner::read_payload(const v2::Event& event, const v2::Metadata& metadata, const T*& payload)
 {
-  if (_batch_grouped_examples.find(id) != _batch_grouped_examples.end()) { _batch_grouped_examples[id].ok = false; }
+  return typed_event::process_compression<T>(event.payload()->data(), event.payload()->size(), metadata, payload,
+      _decompression_arena, logger, &_zstd_dictionaries);
 }
 
-// Case insensitive equality
-bool iequals(const std::string& a, const std::string& b)
+void example_joiner::parse_group(const batch_event_groups::group& events, joined_group& group,
+    VW::multi_ex& examples, const VW::example_factory_t& example_factory, bool defer_json)
 {
-  if (a.size() != b.size()) { return false; }
+  if (defer_json)
+  {
+    // the json contexts of several interactions are all parsed into the examples, in order with their outcomes
+    size_t interactions = 0;
+    for (const auto* joined_event : events.events)
+    {
+      const auto* event = flatbuffers::GetRoot<v2::Event>(joined_event->event()->data());
+      if (event->meta()->payload_type() != v2::PayloadType_Outcome) { ++interactions; }
+    }
+    if (interactions > 1)
+    {
+      group.parse_serially = true;
+      return;
+    }
+  }
 
-  return std::equal(a.begin(), a.end(), b.begin(), [](char a, char b) { return std::tolower(a) == std::tolower(b); });
+  for (size_t i = 0; i < events.events.size(); ++i)
+  {
+    const auto* joined_event = events.events[i];
+    const auto* event = flatbuffers::GetRoot<v2::Event>(joined_event->event()->data());
+    const auto* metadata = event->meta();
+    auto enqueued_time_utc =
+        get_enqueued_time(joined_event->timestamp(), metadata->client_time_utc(), _loop_info.use_client_time, logger);
+    const auto& payload_type = metadata->payload_type();
+
+    if (payload_type == v2::PayloadType_Outcome)
+    {
+      process_outcome(*event, *metadata, enqueued_time_utc, group);
+    }
+    else
+    {
+      group.multiline = (payload_type != v2::PayloadType_CA);
+      process_interaction(*event, *metadata, enqueued_time_utc, group, examples, example_factory, defer_json);
+    }
+  }
 }
 
-bool example_joiner::process_interaction(
-    const v2::Event& event, const v2::Metadata& metadata, const TimePoint& enqueued_time_utc, VW::multi_ex& examples)
+bool example_joiner::process_interaction(const v2::Event& event, const v2::Metadata& metadata,
+    const TimePoint& enqueued_time_utc, joined_group& group, VW::multi_ex& examples,
+    const VW::example_factory_t& example_factory, bool defer_json)
 {
   std::string payload_type(EnumNamePayloadType(metadata.payload_type()));
   std::string loop_type(EnumNameProblemType(_loop_info.problem_type_config));
@@ -237,13 +340,12 @@ bool example_joiner::process_interaction(
   }
 
   joined_event::joined_event je;
+  const v2::HashedFeatures* hashed_features = nullptr;
 
   if (metadata.payload_type() == v2::PayloadType_CB)
   {
     const v2::CbEvent* cb = nullptr;
-    if (!typed_event::process_compression<v2::CbEvent>(
-            event.payload()->data(), event.payload()->size(), metadata, cb, _detached_buffer, logger) ||
-        cb == nullptr)
+    if (!read_payload(event, metadata, cb) || cb == nullptr)
     {
       return false;
     }
@@ -259,13 +361,12 @@ bool example_joiner::process_interaction(
 
     je = typed_event::event_processor<v2::CbEvent>::fill_in_joined_event(
         *cb, metadata, enqueued_time_utc, typed_event::event_processor<v2::CbEvent>::get_context(*cb));
+    hashed_features = cb->hashed_features();
   }
   else if (metadata.payload_type() == v2::PayloadType_CCB || metadata.payload_type() == v2::PayloadType_Slates)
   {
     const v2::MultiSlotEvent* multislot = nullptr;
-    if (!typed_event::process_compression<v2::MultiSlotEvent>(
-            event.payload()->data(), event.payload()->size(), metadata, multislot, _detached_buffer, logger) ||
-        multislot == nullptr)
+    if (!read_payload(event, metadata, multislot) || multislot == nullptr)
     {
       return false;
     }
@@ -285,9 +386,7 @@ bool example_joiner::process_interaction(
   else if (metadata.payload_type() == v2::PayloadType_CA)
   {
     const v2::CaEvent* ca = nullptr;
-    if (!typed_event::process_compression<v2::CaEvent>(
-            event.payload()->data(), event.payload()->size(), metadata, ca, _detached_buffer, logger) ||
-        ca == nullptr)
+    if (!read_payload(event, metadata, ca) || ca == nullptr)
     {
       return false;
     }
@@ -315,40 +414,137 @@ bool example_joiner::process_interaction(
     return false;
   }
 
-  if (!_binary_to_json)
+  if (!_binary_to_json && hashed_features != nullptr && can_use_hashed_features(*hashed_features))
   {
-    std::string context(je.context);
-    try
-    {
-      VW::example_factory_t ex_fac = [this]() -> VW::example& { return *(VW::new_unused_example(*this->_vw)); };
-      if (_vw->output_config.audit || _vw->output_config.hash_inv)
-      {
-        VW::parsers::json::read_line_json<true>(
-            *_vw, examples, const_cast<char*>(context.c_str()), context.size(), ex_fac, &_dedup_cache.dedup_examples);
-      }
-      else
-      {
-        VW::parsers::json::read_line_json<false>(
-            *_vw, examples, const_cast<char*>(context.c_str()), context.size(), ex_fac, &_dedup_cache.dedup_examples);
-      }
-    }
-    catch (VW::vw_exception& e)
+    fill_in_hashed_features(*hashed_features, examples, example_factory);
+  }
+  else if (!_binary_to_json && defer_json)
+  {
+    // the group has a single interaction, see parse_group()
+    group.json_context = std::string(je.context);
+    group.parse_json_context = true;
+  }
+  else if (!_binary_to_json)
+  {
+    if (!parse_json_context(std::string(je.context), metadata.id()->c_str(), examples, example_factory))
     {
-      logger.out_warn(
-          "JSON parsing during interaction processing failed "
-          "with error: [{}] for event with id: [{}]",
-          e.what(), metadata.id()->c_str());
       return false;
     }
   }
 
-  _batch_grouped_examples.emplace(
-      std::make_pair<std::string, joined_event::joined_event>(metadata.id()->str(), std::move(je)));
+  // the first interaction of an event id is the one learnt from
+  if (!group.has_interaction)
+  {
+    group.je = std::move(je);
+    group.has_interaction = true;
+  }
+  return true;
+}
+
+bool example_joiner::parse_json_context(std::string context, const char* event_id, VW::multi_ex& examples,
+    const VW::example_factory_t& example_factory)
+{
+  try
+  {
+    if (_vw->output_config.audit || _vw->output_config.hash_inv)
+    {
+      VW::parsers::json::read_line_json<true>(*_vw, examples, const_cast<char*>(context.c_str()), context.size(),
+          example_factory, &_dedup_cache.dedup_examples);
+    }
+    else
+    {
+      VW::parsers::json::read_line_json<false>(*_vw, examples, const_cast<char*>(context.c_str()), context.size(),
+          example_factory, &_dedup_cache.dedup_examples);
+    }
+  }
+  catch (VW::vw_exception& e)
+  {
+    logger.out_warn(
+        "JSON parsing during interaction processing failed "
+        "with error: [{}] for event with id: [{}]",
+        e.what(), event_id);
+    return false;
+  }
   return true;
 }
 
-bool example_joiner::process_outcome(
-    const v2::Event& event, const v2::Metadata& metadata, const TimePoint& enqueued_time_utc)
+bool example_joiner::can_use_hashed_features(const v2::HashedFeatures& features) const
+{
+  if (features.examples() == nullptr || features.examples()->size() == 0) { return false; }
+  if (_vw->output_config.audit || _vw->output_config.hash_inv) { return false; }
+  // the shared example label set below is the CB one
+  if (_vw->parser_runtime.example_parser->lbl_parser.label_type != VW::label_type_t::CB) { return false; }
+  // the client must have parsed the context exactly as the json parser would here
+  const auto* parse_options = features.parse_options();
+  return features.hash_seed() == _vw->runtime_config.hash_seed &&
+      features.num_bits() == _vw->initial_weights_config.num_bits &&
+      features.parse_mask() == _vw->runtime_state.parse_mask && parse_options != nullptr &&
+      parse_options->str() == _parse_options;
+}
+
+std::string example_joiner::get_parse_options(VW::config::options_i& options)
+{
+  std::string res;
+  for (const char* name : {"hash", "affix"})
+  {
+    if (options.was_supplied(name))
+    {
+      res += std::string(" --") + name + " " + options.get_typed_option<std::string>(name).value();
+    }
+  }
+  for (const char* name : {"ignore", "keep", "redefine", "ngram", "skips", "spelling", "dictionary", "quadratic",
+           "cubic", "interactions", "experimental_full_name_interactions"})
+  {
+    if (!options.was_supplied(name)) { continue; }
+    for (const auto& value : options.get_typed_option<std::vector<std::string>>(name).value())
+    {
+      res += std::string(" --") + name + " " + value;
+    }
+  }
+  return res;
+}
+
+void example_joiner::fill_in_hashed_features(const v2::HashedFeatures& features, VW::multi_ex& examples,
+    const VW::example_factory_t& example_factory) const
+{
+  const uint64_t parse_mask = _vw->runtime_state.parse_mask;
+  const auto& hashed_examples = *features.examples();
+  for (flatbuffers::uoffset_t i = 0; i < hashed_examples.size(); ++i)
+  {
+    if (i >= examples.size()) { examples.push_back(&example_factory()); }
+    auto* ex = examples[i];
+    _vw->parser_runtime.example_parser->lbl_parser.default_label(ex->l);
+
+    const auto* namespaces = hashed_examples.Get(i)->namespaces();
+    if (namespaces == nullptr) { continue; }
+    for (const auto* ns : *namespaces)
+    {
+      const auto* hashes = ns->feature_hashes();
+      const auto* values = ns->values();
+      if (hashes == nullptr || values == nullptr || hashes->size() == 0) { continue; }
+
+      const auto index = ns->index();
+      auto& fs = ex->feature_space[index];
+      if (std::find(ex->indices.begin(), ex->indices.end(), index) == ex->indices.end())
+      {
+        ex->indices.push_back(index);
+      }
+      fs.start_ns_extent(ns->hash());
+      const auto count = (std::min)(hashes->size(), values->size());
+      for (flatbuffers::uoffset_t j = 0; j < count; ++j) { fs.push_back(values->Get(j), hashes->Get(j) & parse_mask); }
+      fs.end_ns_extent();
+    }
+  }
+
+  if (features.shared())
+  {
+    // same label as the json parser gives the shared example
+    examples[0]->l.cb.costs.push_back({FLT_MAX, static_cast<uint32_t>(VW::uniform_hash("shared", 6, 0)), -1.f});
+  }
+}
+
+bool example_joiner::process_outcome(const v2::Event& event, const v2::Metadata& metadata,
+    const TimePoint& enqueued_time_utc, joined_group& group)
 {
   reward::outcome_event o_event;
   o_event.metadata = {metadata.app_id() != nullptr ? metadata.app_id()->str() : "", metadata.payload_type(),
@@ -357,12 +553,10 @@ bool example_joiner::process_outcome(
   o_event.enqueued_time_utc = enqueued_time_utc;
 
   const v2::OutcomeEvent* outcome = nullptr;
-  if (!typed_event::process_compression<v2::OutcomeEvent>(
-          event.payload()->data(), event.payload()->size(), metadata, outcome, _detached_buffer, logger) ||
-      outcome == nullptr)
+  if (!read_payload(event, metadata, outcome) || outcome == nullptr)
   {
     // invalidate joined_event so that we don't learn from it
-    invalidate_joined_event(metadata.id()->str());
+    if (group.has_interaction) { group.je.ok = false; }
     return false;
   }
 
@@ -376,11 +570,7 @@ bool example_joiner::process_outcome(
 
   o_event.action_taken = outcome->action_taken();
 
-  if (_batch_grouped_examples.find(metadata.id()->str()) != _batch_grouped_examples.end())
-  {
-    auto& joined_event = _batch_grouped_examples[metadata.id()->str()];
-    joined_event.outcome_events.push_back(o_event);
-  }
+  if (group.has_interaction) { group.je.outcome_events.push_back(o_event); }
 
   return true;
 }
@@ -389,7 +579,8 @@ bool example_joiner::process_dedup(const v2::Event& event, const v2::Metadata& m
 {
   const v2::DedupInfo* dedup = nullptr;
   if (!typed_event::process_compression<v2::DedupInfo>(
-          event.payload()->data(), event.payload()->size(), metadata, dedup, _detached_buffer, logger) ||
+          event.payload()->data(), event.payload()->size(), metadata, dedup, _decompression_arena, logger,
+          &_zstd_dictionaries) ||
       dedup == nullptr)
   {
     return false;
@@ -452,26 +643,33 @@ bool example_joiner::process_joined(VW::multi_ex& examples)
 {
   _current_je_is_skip_learn = false;
 
-  if (_batch_event_order.empty()) { return true; }
+  if (_batch_groups.empty()) { return true; }
 
-  auto id = _batch_event_order.front();
-  bool multiline = false;
+  const char* id = _batch_groups.front().id->c_str();
+  joined_group group;
 
-  for (auto& joined_event : _batch_grouped_events[id])
+  VW::example_factory_t ex_fac = [this]() -> VW::example& { return *(VW::new_unused_example(*this->_vw)); };
+  if (!_parse_jobs.empty())
   {
-    const auto* event = flatbuffers::GetRoot<v2::Event>(joined_event->event()->data());
-    const auto* metadata = event->meta();
-    auto enqueued_time_utc =
-        get_enqueued_time(joined_event->timestamp(), metadata->client_time_utc(), _loop_info.use_client_time, logger);
-    const auto& payload_type = metadata->payload_type();
-
-    if (payload_type == v2::PayloadType_Outcome) { process_outcome(*event, *metadata, enqueued_time_utc); }
+    // parsed ahead, see on_batch_read()
+    auto job = std::move(_parse_jobs.front());
+    _parse_jobs.pop_front();
+    job->done.get();
+    hand_over_examples(job->examples, examples);
+    if (job->group.parse_serially) { parse_group(_batch_groups.front(), group, examples, ex_fac); }
     else
     {
-      multiline = (payload_type != v2::PayloadType_CA);
-      if (!process_interaction(*event, *metadata, enqueued_time_utc, examples)) { continue; }
+      group = std::move(job->group);
+      // the json parser only runs on this thread
+      if (group.parse_json_context && group.has_interaction &&
+          !parse_json_context(std::move(group.json_context), id, examples, ex_fac))
+      {
+        group.has_interaction = false;
+      }
     }
   }
+  else { parse_group(_batch_groups.front(), group, examples, ex_fac); }
+  const bool multiline = group.multiline;
 
   joined_event::joined_event* je = nullptr;
 
@@ -507,11 +705,11 @@ bool example_joiner::process_joined(VW::multi_ex& examples)
           if (_binary_to_json) { log_converter::build_json(_outfile, *je, logger); }
         }
 
-        clear_event_id_batch_info(id);
+        _batch_groups.pop_front();
         if (clear_examples) { clear_vw_examples(examples); }
       });
 
-  if (_batch_grouped_examples.find(id) == _batch_grouped_examples.end())
+  if (!group.has_interaction)
   {
     // can't learn from this interaction
     logger.out_warn(
@@ -522,7 +720,7 @@ bool example_joiner::process_joined(VW::multi_ex& examples)
     return false;
   }
 
-  je = &_batch_grouped_examples[id];
+  je = &group.je;
   if (!je->ok)
   {
     // don't learn from this interaction
@@ -592,10 +790,37 @@ void example_joiner::persist_metrics(VW::metric_sink& metrics)
   }
 }
 
-bool example_joiner::processing_batch() { return !_batch_event_order.empty(); }
+bool example_joiner::processing_batch() { return !_batch_groups.empty(); }
 bool example_joiner::current_event_is_skip_learn() { return _current_je_is_skip_learn; }
-void example_joiner::on_new_batch() {}
-void example_joiner::on_batch_read() {}
+void example_joiner::on_new_batch()
+{
+  // the previous batch has been processed
+  _decompression_arena.reset();
+}
+
+void example_joiner::on_batch_read()
+{
+  if (_parse_pool == nullptr) { return; }
+
+  // Every group of the batch is parsed ahead, but for the json contexts, which
+  // process_joined() parses. The configuration the jobs read only changes with
+  // the next batch, which is read once process_joined() consumed all of them.
+  for (size_t i = _parse_jobs.size(); i < _batch_groups.pending(); ++i)
+  {
+    auto job = VW::make_unique<parse_job>();
+    job->events = &_batch_groups.pending_at(i);
+
+    auto* raw_job = job.get();
+    job->done = _parse_pool->submit(
+        [this, raw_job]
+        {
+          VW::example_factory_t ex_fac = [this]() -> VW::example& { return *take_parse_example(); };
+          raw_job->examples.push_back(take_parse_example());
+          parse_group(*raw_job->events, raw_job->group, raw_job->examples, ex_fac, true);
+        });
+    _parse_jobs.push_back(std::move(job));
+  }
+}
 
 metrics::joiner_metrics example_joiner::get_metrics() { return _joiner_metrics; }
 
@@ -1,19 +1,26 @@
 #pragma once
 
+#include "batch_event_groups.h"
+#include "decompression_arena.h"
 #include "event_processors/joined_event.h"
 #include "event_processors/loop.h"
 #include "joiners/i_joiner.h"
 #include "lru_dedup_cache.h"
 #include "metrics/metrics.h"
 #include "parse_example_external.h"
+#include "vw/config/options.h"
 #include "vw/core/error_constants.h"
 #include "vw/core/example.h"
 #include "vw/core/v_array.h"
+#include "work_pool.h"
+#include "zstd_dictionary_cache.h"
 
+#include <deque>
 #include <fstream>
+#include <future>
 #include <list>
-#include <queue>
-#include <unordered_map>
+#include <memory>
+#include <mutex>
 
 class example_joiner : public i_joiner
 {
@@ -31,6 +38,16 @@ public:
   void apply_cli_overrides(VW::workspace* all, const VW::external::parser_options& parsed_options) override;
   bool joiner_ready() override;
 
+  // Decompresses and verifies the events of a batch on a pool of threads, from on_batch_read(), instead of one at a
+  // time in process_joined(). This is the only pool of the joiner: json contexts are still parsed in
+  // process_joined(), on the learning thread and in the order of the batch.
+  // Ignored with --audit or --invert_hash, which need the parse to update the workspace.
+  void set_parse_threads(size_t threads);
+
+  // The options changing the features a context is parsed into, as the
+  // client logs them with the hashed features (safe_vw::get_parse_options()).
+  static std::string get_parse_options(VW::config::options_i& options);
+
   float default_reward() const { return _loop_info.default_reward; }
   v2::LearningModeType learning_mode_config() const { return _loop_info.learning_mode_config; }
   v2::ProblemType problem_type_config() const { return _loop_info.problem_type_config; }
@@ -90,18 +107,72 @@ public:
   void persist_metrics(VW::metric_sink& sink) override;
 
 private:
+  // everything required to create a complete (multi)example from the events
+  // of one event id
+  struct joined_group
+  {
+    joined_event::joined_event je;
+    // je holds a valid interaction
+    bool has_interaction = false;
+    bool multiline = false;
+    // parse jobs leave the json context of the interaction to the learning
+    // thread: vw's json parser and the dedup cache are not thread safe
+    bool parse_json_context = false;
+    std::string json_context;
+    // the group has several interactions, it is parsed again on the learning
+    // thread, as without parse jobs
+    bool parse_serially = false;
+  };
+
+  // a group parsed ahead on the work pool, into examples of its own
+  struct parse_job
+  {
+    // the group's events in _batch_groups, which does not change until the
+    // job is consumed
+    const batch_event_groups::group* events = nullptr;
+    joined_group group;
+    VW::multi_ex examples;
+    std::future<void> done;
+  };
+
   bool process_dedup(const v2::Event& event, const v2::Metadata& metadata);
 
-  bool process_interaction(
-      const v2::Event& event, const v2::Metadata& metadata, const TimePoint& enqueued_time_utc, VW::multi_ex& examples);
+  // Decompresses the events of one event id and parses its interaction into
+  // examples. With defer_json, the json context is left in the group for
+  // parse_json_context(): the rest only reads the joiner configuration and the
+  // zstd dictionaries, so that groups can be parsed concurrently.
+  void parse_group(const batch_event_groups::group& events, joined_group& group, VW::multi_ex& examples,
+      const VW::example_factory_t& example_factory, bool defer_json = false);
+
+  bool process_interaction(const v2::Event& event, const v2::Metadata& metadata, const TimePoint& enqueued_time_utc,
+      joined_group& group, VW::multi_ex& examples, const VW::example_factory_t& example_factory, bool defer_json);
+
+  // parses the json context of an interaction (in place), on the learning thread
+  bool parse_json_context(std::string context, const char* event_id, VW::multi_ex& examples,
+      const VW::example_factory_t& example_factory);
 
-  bool process_outcome(const v2::Event& event, const v2::Metadata& metadata, const TimePoint& enqueued_time_utc);
+  // The features hashed by the client are only used when vw would have hashed
+  // the context into the same features, and is not asked for their names.
+  bool can_use_hashed_features(const v2::HashedFeatures& features) const;
+  // fills the examples from the features instead of parsing the json context
+  void fill_in_hashed_features(const v2::HashedFeatures& features, VW::multi_ex& examples,
+      const VW::example_factory_t& example_factory) const;
+
+  bool process_outcome(const v2::Event& event, const v2::Metadata& metadata, const TimePoint& enqueued_time_utc,
+      joined_group& group);
+
+  // decompresses the payload into the batch arena if needed
+  template <typename T>
+  bool read_payload(const v2::Event& event, const v2::Metadata& metadata, const T*& payload);
 
   void clear_batch_info();
-  void clear_event_id_batch_info(const std::string& id);
-  void invalidate_joined_event(const std::string& id);
   void clear_vw_examples(VW::multi_ex& examples);
 
+  VW::example* take_parse_example();
+  // copies the examples parsed by a job into the ones handed to vw
+  void hand_over_examples(VW::multi_ex& parsed, VW::multi_ex& examples);
+  void wait_for_parse_jobs();
+
   VW::example* get_or_create_example();
 
   static VW::example& get_or_create_example_f(void* vw);
@@ -111,17 +182,24 @@ private:
   static void return_example_f(void* vw, VW::example* ex);
 
   lru_dedup_cache _dedup_cache;
-  // from event id to all the information required to create a complete
-  // (multi)example
-  std::unordered_map<std::string, joined_event::joined_event> _batch_grouped_examples;
-  // from event id to all the events that have that event id
-  std::unordered_map<std::string, std::vector<const v2::JoinedEvent*>> _batch_grouped_events;
-  std::queue<std::string> _batch_event_order;
+  zstd_dictionary_cache _zstd_dictionaries;
+  // the events of the batch grouped by event id, in order
+  batch_event_groups _batch_groups;
 
   std::vector<VW::example*> _example_pool;
 
+  std::unique_ptr<work_pool> _parse_pool;
+  // one per group of _batch_groups, in the same order, while the batch is
+  // parsed ahead
+  std::deque<std::unique_ptr<parse_job>> _parse_jobs;
+  std::mutex _parse_example_pool_mutex;
+  std::vector<VW::example*> _parse_example_pool;
+
+  // buffers of the events decompressed from the current batch
+  decompression_arena _decompression_arena;
+
   VW::workspace* _vw;
-  flatbuffers::DetachedBuffer _detached_buffer;
+  std::string _parse_options;
 
   loop::sticky_value<reward::RewardFunctionType> _reward_calculation;
   loop::loop_info _loop_info;
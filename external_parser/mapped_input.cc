@@ -0,0 +1,132 @@
+#include "mapped_input.h"
+
+#include <cerrno>
+#include <cstring>
+
+#ifdef _WIN32
+#  ifndef NOMINMAX
+#    define NOMINMAX
+#  endif
+#  include <windows.h>
+#else
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+
+mapped_input::~mapped_input() { close(); }
+
+const char* mapped_input::read(size_t size)
+{
+  if (_size - _offset < size)
+  {
+    _offset = _size;
+    return nullptr;
+  }
+  const char* data = _data + _offset;
+  _offset += size;
+  return data;
+}
+
+#ifdef _WIN32
+bool mapped_input::open(const std::string& file_name, std::string& error)
+{
+  close();
+  HANDLE file = CreateFileA(file_name.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+      FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+  if (file == INVALID_HANDLE_VALUE)
+  {
+    error = "can not open " + file_name + ", error " + std::to_string(GetLastError());
+    return false;
+  }
+  LARGE_INTEGER file_size;
+  if (!GetFileSizeEx(file, &file_size))
+  {
+    error = "can not read the size of " + file_name + ", error " + std::to_string(GetLastError());
+    CloseHandle(file);
+    return false;
+  }
+  _is_open = true;
+  if (file_size.QuadPart == 0)
+  {
+    CloseHandle(file);
+    return true;
+  }
+
+  // the view keeps the mapping alive, the handles can be closed right away
+  HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  CloseHandle(file);
+  const void* view = mapping != nullptr ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+  const auto last_error = GetLastError();
+  if (mapping != nullptr) { CloseHandle(mapping); }
+  if (view == nullptr)
+  {
+    error = "can not map " + file_name + ", error " + std::to_string(last_error);
+    _is_open = false;
+    return false;
+  }
+  _data = static_cast<const char*>(view);
+  _size = static_cast<size_t>(file_size.QuadPart);
+  return true;
+}
+
+void mapped_input::close()
+{
+  if (_data != nullptr) { UnmapViewOfFile(_data); }
+  _data = nullptr;
+  _size = 0;
+  _offset = 0;
+  _is_open = false;
+}
+#else
+bool mapped_input::open(const std::string& file_name, std::string& error)
+{
+  close();
+  const int fd = ::open(file_name.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0)
+  {
+    error = "can not open " + file_name + ": " + std::strerror(errno);
+    return false;
+  }
+  struct stat stats
+  {
+  };
+  if (::fstat(fd, &stats) != 0)
+  {
+    error = "can not read the size of " + file_name + ": " + std::strerror(errno);
+    ::close(fd);
+    return false;
+  }
+  _is_open = true;
+  if (stats.st_size == 0)
+  {
+    ::close(fd);
+    return true;
+  }
+
+  const auto length = static_cast<size_t>(stats.st_size);
+  void* addr = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+  const int mmap_errno = errno;
+  ::close(fd);
+  if (addr == MAP_FAILED)
+  {
+    error = "can not map " + file_name + ": " + std::strerror(mmap_errno);
+    _is_open = false;
+    return false;
+  }
+  ::madvise(addr, length, MADV_SEQUENTIAL);
+  _data = static_cast<const char*>(addr);
+  _size = length;
+  return true;
+}
+
+void mapped_input::close()
+{
+  if (_data != nullptr) { ::munmap(const_cast<char*>(_data), _size); }
+  _data = nullptr;
+  _size = 0;
+  _offset = 0;
+  _is_open = false;
+}
+#endif
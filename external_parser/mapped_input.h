@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+/*
+mapped input
+A joined log mapped read-only in memory, for local replay of large files. The
+parser reads its messages as pointers into the mapping: payloads are verified
+and parsed where they are, without being copied through an io_buf first.
+
+The kernel is told the file is read front to back (MADV_SEQUENTIAL) so it
+reads ahead aggressively and drops pages once they were read.
+The file must not be truncated while it is mapped.
+*/
+class mapped_input
+{
+public:
+  mapped_input() = default;
+  ~mapped_input();
+  mapped_input(const mapped_input&) = delete;
+  mapped_input(mapped_input&&) = delete;
+  mapped_input& operator=(const mapped_input&) = delete;
+  mapped_input& operator=(mapped_input&&) = delete;
+
+  // false if the file can not be mapped, error describes why
+  bool open(const std::string& file_name, std::string& error);
+  bool is_open() const { return _is_open; }
+
+  // Points to the next size bytes and moves past them. nullptr if fewer bytes
+  // are left, then the input is at its end.
+  const char* read(size_t size);
+  // back to the start of the file, for the next pass
+  void rewind() { _offset = 0; }
+
+  size_t offset() const { return _offset; }
+  size_t size() const { return _size; }
+
+private:
+  void close();
+
+  const char* _data = nullptr;
+  size_t _size = 0;
+  size_t _offset = 0;
+  bool _is_open = false;
+};
@@ -16,6 +16,7 @@
 #include "vw/io/logger.h"
 
 #include <cfloat>
+#include <cstring>
 #include <fstream>
 #include <iostream>
 
@@ -83,12 +84,17 @@ namespace VW
 {
 namespace external
 {
-binary_parser::binary_parser(std::unique_ptr<i_joiner>&& joiner, VW::io::logger logger)
-    : parser(logger), _example_joiner(std::move(joiner)), _payload(nullptr), _payload_size(0), _total_size_read(0)
+binary_parser::binary_parser(std::unique_ptr<i_joiner>&& joiner, VW::io::logger logger, bool read_ahead)
+    : parser(logger)
+    , _example_joiner(std::move(joiner))
+    , _payload(nullptr)
+    , _payload_size(0)
+    , _total_size_read(0)
+    , _read_ahead(read_ahead)
 {
 }
 
-binary_parser::~binary_parser() {}
+binary_parser::~binary_parser() { stop_reader(); }
 
 bool binary_parser::read_version(io_buf& input)
 {
@@ -107,9 +113,14 @@ bool binary_parser::read_version(io_buf& input)
   _total_size_read += buffer_length;
   _payload_size = 0;  // this is used but the padding code, make it do the right thing.
 
-  if (*_payload != BINARY_PARSER_VERSION)
+  return check_version(_payload);
+}
+
+bool binary_parser::check_version(const char* payload)
+{
+  if (*payload != BINARY_PARSER_VERSION)
   {
-    logger.out_critical("File version [{}] does not match the parser version [{}]", static_cast<size_t>(*_payload),
+    logger.out_critical("File version [{}] does not match the parser version [{}]", static_cast<size_t>(*payload),
         BINARY_PARSER_VERSION);
     return false;
   }
@@ -203,16 +214,20 @@ bool binary_parser::read_checkpoint_msg(io_buf& input)
 
   _total_size_read += _payload_size;
 
+  apply_checkpoint(_payload);
+  return true;
+}
+
+void binary_parser::apply_checkpoint(const char* payload)
+{
   // TODO: fb verification: what if verification fails, crash or default to
   // something sensible?
-  auto checkpoint_info = flatbuffers::GetRoot<v2::CheckpointInfo>(_payload);
+  auto checkpoint_info = flatbuffers::GetRoot<v2::CheckpointInfo>(payload);
   _example_joiner->set_reward_function(checkpoint_info->reward_function_type());
   _example_joiner->set_default_reward(checkpoint_info->default_reward());
   _example_joiner->set_learning_mode_config(checkpoint_info->learning_mode_config());
   _example_joiner->set_problem_type_config(checkpoint_info->problem_type_config());
   _example_joiner->set_use_client_time(checkpoint_info->use_client_time());
-
-  return true;
 }
 
 bool binary_parser::read_regular_msg(io_buf& input, VW::multi_ex& examples, bool& ignore_msg)
@@ -243,6 +258,13 @@ bool binary_parser::read_regular_msg(io_buf& input, VW::multi_ex& examples, bool
 
   _total_size_read += _payload_size;
 
+  return process_joined_payload(_payload, _payload_size, false, examples, ignore_msg);
+}
+
+bool binary_parser::process_joined_payload(
+    const char* payload, uint32_t payload_size, bool verified, VW::multi_ex& examples, bool& ignore_msg)
+{
+  ignore_msg = false;
   if (!_example_joiner->joiner_ready())
   {
     logger.out_warn(
@@ -253,14 +275,18 @@ bool binary_parser::read_regular_msg(io_buf& input, VW::multi_ex& examples, bool
     return true;
   }
 
-  auto joined_payload = flatbuffers::GetRoot<v2::JoinedPayload>(_payload);
-  auto verifier = flatbuffers::Verifier(reinterpret_cast<const uint8_t*>(_payload), static_cast<size_t>(_payload_size));
-  if (!joined_payload->Verify(verifier))
+  auto joined_payload = flatbuffers::GetRoot<v2::JoinedPayload>(payload);
+  if (!verified)
+  {
+    auto verifier = flatbuffers::Verifier(reinterpret_cast<const uint8_t*>(payload), static_cast<size_t>(payload_size));
+    verified = joined_payload->Verify(verifier);
+  }
+  if (!verified)
   {
     logger.out_warn(
         "JoinedPayload of size [{}] verification failed after having read [{}] "
         "bytes from the file, skipping JoinedPayload",
-        _payload_size, _total_size_read);
+        payload_size, _total_size_read);
     return false;
   }
   _example_joiner->on_new_batch();
@@ -333,8 +359,223 @@ bool binary_parser::advance_to_next_payload_type(io_buf& input, unsigned int& pa
 
 void binary_parser::persist_metrics(metric_sink& sink) { _example_joiner->persist_metrics(sink); }
 
+bool binary_parser::map_input(const std::string& file_name)
+{
+  std::string error;
+  if (file_name.empty() || !_mapped_input.open(file_name, error))
+  {
+    logger.out_warn("Could not map the input file, reading it through io_buf instead. {}", error);
+    return false;
+  }
+  return true;
+}
+
+size_t binary_parser::read_bytes(io_buf* input, size_t size, const char*& data)
+{
+  if (_mapped_input.is_open())
+  {
+    const size_t left = _mapped_input.size() - _mapped_input.offset();
+    data = _mapped_input.read(size);
+    return data != nullptr ? size : left;
+  }
+  char* line = nullptr;
+  const size_t len = input->buf_read(line, size);
+  data = line;
+  return line != nullptr ? len : 0;
+}
+
+void binary_parser::read_message(io_buf* input, message& msg, uint32_t& previous_payload_size, uint64_t& offset)
+{
+  const char* data = nullptr;
+  const uint32_t padding = previous_payload_size % 8;
+  bool ok = padding == 0 || read_bytes(input, padding, data) == padding;
+  offset += padding;
+
+  unsigned int payload_type = MSG_TYPE_EOF;
+  if (ok)
+  {
+    const size_t len = read_bytes(input, sizeof(payload_type), data);
+    if (len == sizeof(payload_type)) { std::memcpy(&payload_type, data, sizeof(payload_type)); }
+    // the file doesn't have to end with an EOF message
+    else { ok = len == 0; }
+  }
+
+  if (ok && payload_type != MSG_TYPE_EOF)
+  {
+    offset += sizeof(payload_type);
+    // the version is the only message without a size
+    uint32_t payload_size = 4 * sizeof(char);
+    if (payload_type != MSG_TYPE_FILEMAGIC)
+    {
+      ok = read_bytes(input, sizeof(payload_size), data) == sizeof(payload_size);
+      if (ok) { std::memcpy(&payload_size, data, sizeof(payload_size)); }
+      offset += sizeof(payload_size);
+    }
+
+    ok = ok && read_bytes(input, payload_size, data) == payload_size;
+    if (ok)
+    {
+      // io_buf reuses its buffer for the next read, the mapping stays
+      if (_mapped_input.is_open()) { msg.payload = data; }
+      else
+      {
+        msg.storage.assign(data, data + payload_size);
+        msg.payload = msg.storage.data();
+      }
+      msg.payload_size = payload_size;
+      offset += payload_size;
+      previous_payload_size = payload_type == MSG_TYPE_FILEMAGIC ? 0 : payload_size;
+    }
+
+    if (ok && payload_type == MSG_TYPE_REGULAR)
+    {
+      const auto* bytes = reinterpret_cast<const uint8_t*>(msg.payload);
+      auto verifier = flatbuffers::Verifier(bytes, msg.payload_size);
+      msg.verified = flatbuffers::GetRoot<v2::JoinedPayload>(bytes)->Verify(verifier);
+    }
+  }
+
+  msg.type = ok ? payload_type : MSG_TYPE_EOF;
+  msg.read_error = !ok;
+  msg.end_offset = offset;
+}
+
+void binary_parser::read_ahead_loop(io_buf* input, uint64_t offset)
+{
+  uint32_t previous_payload_size = 0;
+  while (true)
+  {
+    message msg;
+    read_message(input, msg, previous_payload_size, offset);
+    const bool last = msg.type == MSG_TYPE_EOF;
+
+    {
+      std::unique_lock<std::mutex> lock(_messages_mutex);
+      _messages_cv.wait(lock, [this] { return _stop_reader || _messages.size() < READ_AHEAD_MESSAGES; });
+      if (_stop_reader) { return; }
+      _messages.push_back(std::move(msg));
+    }
+    _messages_cv.notify_all();
+    if (last) { return; }
+  }
+}
+
+void binary_parser::stop_reader()
+{
+  if (!_reader.joinable()) { return; }
+  {
+    std::lock_guard<std::mutex> lock(_messages_mutex);
+    _stop_reader = true;
+  }
+  _messages_cv.notify_all();
+  _reader.join();
+  _messages.clear();
+  _stop_reader = false;
+}
+
+void binary_parser::next_message(io_buf& input)
+{
+  // the batch of the previous message has been processed
+  if (!_read_ahead)
+  {
+    _current = message();
+    read_message(&input, _current, _payload_size, _total_size_read);
+    return;
+  }
+
+  // (re)started for every pass over the input
+  if (!_reader.joinable())
+  {
+    _reader = std::thread(&binary_parser::read_ahead_loop, this, &input, _total_size_read);
+  }
+  {
+    std::unique_lock<std::mutex> lock(_messages_mutex);
+    _messages_cv.wait(lock, [this] { return !_messages.empty(); });
+    _current = std::move(_messages.front());
+    _messages.pop_front();
+  }
+  _messages_cv.notify_all();
+  _total_size_read = _current.end_offset;
+}
+
+void binary_parser::end_of_input()
+{
+  if (_reader.joinable()) { _reader.join(); }
+  if (_mapped_input.is_open())
+  {
+    // the next pass reads the file from the start
+    _mapped_input.rewind();
+    _payload_size = 0;
+  }
+}
+
+bool binary_parser::parse_messages(io_buf& input, VW::multi_ex& examples)
+{
+  if (process_next_in_batch(examples)) { return true; }
+
+  while (true)
+  {
+    next_message(input);
+
+    switch (_current.type)
+    {
+      case MSG_TYPE_FILEMAGIC:
+      {
+        if (!check_version(_current.payload))
+        {
+          stop_reader();
+          return false;
+        }
+        break;
+      }
+      case MSG_TYPE_HEADER:
+      {
+        // TODO:: consume header
+        break;
+      }
+      case MSG_TYPE_CHECKPOINT:
+      {
+        apply_checkpoint(_current.payload);
+        break;
+      }
+      case MSG_TYPE_REGULAR:
+      {
+        bool ignore_msg = false;
+        if (process_joined_payload(_current.payload, _current.payload_size, _current.verified, examples, ignore_msg))
+        {
+          if (!ignore_msg) { return true; }
+        }
+        break;
+      }
+      case MSG_TYPE_EOF:
+      {
+        if (_current.read_error)
+        {
+          logger.out_critical(
+              "Failed to read the next message from file, after having read "
+              "[{}] bytes from the file",
+              _total_size_read);
+        }
+        end_of_input();
+        return false;
+      }
+
+      default:
+      {
+        logger.out_warn(
+            "Payload type not recognized [0x{:x}], after having read [{}] "
+            "bytes from the file, skipping payload",
+            _current.type, _total_size_read);
+        break;
+      }
+    }
+  }
+}
+
 bool binary_parser::parse_examples(VW::workspace*, io_buf& io_buf, VW::multi_ex& examples)
 {
+  if (_read_ahead || _mapped_input.is_open()) { return parse_messages(io_buf, examples); }
+
   if (process_next_in_batch(examples)) { return true; }
 
   unsigned int payload_type;
@@ -5,8 +5,16 @@
 #pragma once
 
 #include "joiners/i_joiner.h"
+#include "mapped_input.h"
 #include "parse_example_external.h"
 
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
 constexpr size_t BINARY_PARSER_VERSION = 1;
 
 constexpr unsigned int MSG_TYPE_FILEMAGIC = 0x42465756;  //'VWFB'
@@ -22,8 +30,14 @@ namespace external
 class binary_parser : public parser
 {
 public:
-  binary_parser(std::unique_ptr<i_joiner>&& joiner, VW::io::logger logger);  // taking ownership of joiner
+  // taking ownership of joiner
+  // read_ahead: messages are read and verified on a separate thread, READ_AHEAD_MESSAGES ahead of the joiner.
+  // io_buf is then only read by that thread, from the first call to parse_examples until the end of the input.
+  binary_parser(std::unique_ptr<i_joiner>&& joiner, VW::io::logger logger, bool read_ahead = false);
   ~binary_parser();
+  // Reads the messages from file_name mapped in memory instead of the io_buf handed to parse_examples, payloads are
+  // verified and parsed in the mapping. Falls back to the io_buf (and returns false) if the file can not be mapped.
+  bool map_input(const std::string& file_name);
   bool parse_examples(VW::workspace* all, io_buf& io_buf, VW::multi_ex& examples) override;
   bool read_version(io_buf& input);
   bool read_header(io_buf& input);
@@ -33,12 +47,54 @@ public:
   bool advance_to_next_payload_type(io_buf& input, unsigned int& payload_type);
   void persist_metrics(metric_sink& metrics) override;
 
+  static const size_t READ_AHEAD_MESSAGES = 8;
+
 private:
+  // a message read by read_message()
+  struct message
+  {
+    unsigned int type = MSG_TYPE_EOF;
+    // points into storage, or into the mapped input
+    const char* payload = nullptr;
+    uint32_t payload_size = 0;
+    std::vector<char> storage;
+    // JoinedPayload verified when it was read
+    bool verified = false;
+    bool read_error = false;
+    // bytes read from the file once the message was read
+    uint64_t end_offset = 0;
+  };
+
   bool process_next_in_batch(VW::multi_ex& examples);
+  bool check_version(const char* payload);
+  void apply_checkpoint(const char* payload);
+  bool process_joined_payload(
+      const char* payload, uint32_t payload_size, bool verified, VW::multi_ex& examples, bool& ignore_msg);
+
+  // reads from the mapped input if there is one, from input otherwise
+  size_t read_bytes(io_buf* input, size_t size, const char*& data);
+  void read_message(io_buf* input, message& msg, uint32_t& previous_payload_size, uint64_t& offset);
+  // message by message parsing, used when reading ahead or from the mapped input
+  bool parse_messages(io_buf& input, VW::multi_ex& examples);
+  void next_message(io_buf& input);
+  void end_of_input();
+  void read_ahead_loop(io_buf* input, uint64_t offset);
+  void stop_reader();
+
   std::unique_ptr<i_joiner> _example_joiner;
   char* _payload;
   uint32_t _payload_size;
   uint64_t _total_size_read;
+
+  const bool _read_ahead;
+  mapped_input _mapped_input;
+  // the joiner refers to the payload of the current message until its batch is processed
+  message _current;
+  std::mutex _messages_mutex;
+  std::condition_variable _messages_cv;
+  std::deque<message> _messages;
+  bool _stop_reader = false;
+  std::thread _reader;
 };
 }  // namespace external
 }  // namespace VW
@@ -111,8 +111,18 @@ std::unique_ptr<parser> parser::get_external_parser(VW::workspace* all, const pa
 
       return VW::make_unique<binary_json_converter>(std::move(joiner), all->logger);
     }
-    else if (parsed_options.multistep) { joiner = VW::make_unique<multistep_example_joiner>(all); }
-    else { joiner = VW::make_unique<example_joiner>(all); }
+    bool read_ahead = false;
+    if (parsed_options.multistep) { joiner = VW::make_unique<multistep_example_joiner>(all); }
+    else
+    {
+      auto ex_joiner = VW::make_unique<example_joiner>(all);
+      if (parsed_options.parser_threads > 0)
+      {
+        ex_joiner->set_parse_threads(static_cast<size_t>(parsed_options.parser_threads));
+        read_ahead = true;
+      }
+      joiner = std::move(ex_joiner);
+    }
 
     apply_cli_overrides(joiner, all, parsed_options);
 
@@ -121,7 +131,9 @@ std::unique_ptr<parser> parser::get_external_parser(VW::workspace* all, const pa
       all->parser_runtime.example_parser->metrics = VW::make_unique<VW::details::dsjson_metrics>();
     }
 
-    return VW::make_unique<binary_parser>(std::move(joiner), all->logger);
+    auto bp = VW::make_unique<binary_parser>(std::move(joiner), all->logger, read_ahead);
+    if (parsed_options.mmap_input) { bp->map_input(all->parser_runtime.data_filename); }
+    return std::unique_ptr<parser>(std::move(bp));
   }
   throw std::runtime_error("external parser type not recognised");
 }
@@ -149,7 +161,15 @@ void parser::set_parse_args(VW::config::option_group_definition& in_options, par
       .add(VW::config::make_option("reward_function", parsed_options.reward_function)
                .help("Override the reward function to be used, valid values: earliest, average, median, sum, min, max"))
       .add(VW::config::make_option("learning_mode", parsed_options.learning_mode)
-               .help("Override the learning mode from the file, valid values: Online, Apprentice, LoggingOnly"));
+               .help("Override the learning mode from the file, valid values: Online, Apprentice, LoggingOnly"))
+      .add(VW::config::make_option("parser_threads", parsed_options.parser_threads)
+               .default_value(0)
+               .help("Threads decompressing and verifying the events of a JoinedPayload ahead of learning, messages "
+                     "are also read ahead on a separate thread. Json contexts are always parsed on the learning "
+                     "thread, one at a time. 0 does everything on the learning thread. Ignored with --multistep"))
+      .add(VW::config::make_option("binary_parser_mmap", parsed_options.mmap_input)
+               .help("Map the data file in memory and parse the joined payloads where they are instead of copying "
+                     "them, for large local files"));
 }
 
 void parser::persist_metrics(metric_sink& metric_sink) { metric_sink.set_uint("external_parser", 1); }
@@ -0,0 +1,72 @@
+#include <boost/test/unit_test.hpp>
+
+#include "batch_event_groups.h"
+
+#include <string>
+#include <vector>
+
+namespace
+{
+// ids in a flatbuffer, as they are in a JoinedPayload
+std::vector<const flatbuffers::String*> build_ids(flatbuffers::FlatBufferBuilder& fbb, size_t count)
+{
+  std::vector<flatbuffers::Offset<flatbuffers::String>> offsets;
+  for (size_t i = 0; i < count; ++i) { offsets.push_back(fbb.CreateString("event-" + std::to_string(i))); }
+  // pointers are only valid once the builder is done
+  std::vector<const flatbuffers::String*> ids;
+  for (const auto& offset : offsets) { ids.push_back(flatbuffers::GetTemporaryPointer(fbb, offset)); }
+  return ids;
+}
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(batch_event_groups_in_first_seen_order)
+{
+  flatbuffers::FlatBufferBuilder fbb;
+  const auto ids = build_ids(fbb, 500);
+  std::vector<v2::JoinedEvent*> events(1000);
+  for (size_t i = 0; i < events.size(); ++i) { events[i] = reinterpret_cast<v2::JoinedEvent*>(i + 1); }
+
+  batch_event_groups groups;
+  // every batch reuses the groups of the previous one
+  for (int batch = 0; batch < 3; ++batch)
+  {
+    for (size_t i = 0; i < ids.size(); ++i) { groups.add(*ids[i], events[i]); }
+    for (size_t i = 0; i < ids.size(); ++i) { groups.add(*ids[ids.size() - 1 - i], events[ids.size() + i]); }
+    BOOST_CHECK_EQUAL(groups.pending(), ids.size());
+    BOOST_CHECK_EQUAL(groups.pending_at(1).id, ids[1]);
+
+    for (size_t i = 0; i < ids.size(); ++i)
+    {
+      const auto& group = groups.front();
+      BOOST_CHECK_EQUAL(group.id, ids[i]);
+      BOOST_REQUIRE_EQUAL(group.events.size(), 2);
+      BOOST_CHECK_EQUAL(group.events[0], events[i]);
+      BOOST_CHECK_EQUAL(group.events[1], events[events.size() - 1 - i]);
+      groups.pop_front();
+    }
+    BOOST_CHECK(groups.empty());
+  }
+}
+
+BOOST_AUTO_TEST_CASE(batch_event_groups_consumed_id_starts_a_new_group)
+{
+  flatbuffers::FlatBufferBuilder fbb;
+  const auto ids = build_ids(fbb, 2);
+  auto* first = reinterpret_cast<v2::JoinedEvent*>(1);
+  auto* second = reinterpret_cast<v2::JoinedEvent*>(2);
+
+  batch_event_groups groups;
+  groups.add(*ids[0], first);
+  groups.add(*ids[1], first);
+  groups.pop_front();
+  groups.add(*ids[0], second);
+
+  BOOST_CHECK_EQUAL(groups.pending(), 2);
+  groups.pop_front();
+  BOOST_CHECK_EQUAL(groups.front().id, ids[0]);
+  BOOST_REQUIRE_EQUAL(groups.front().events.size(), 1);
+  BOOST_CHECK_EQUAL(groups.front().events[0], second);
+
+  groups.clear();
+  BOOST_CHECK(groups.empty());
+}
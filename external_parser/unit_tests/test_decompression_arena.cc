@@ -0,0 +1,28 @@
+#include <boost/test/unit_test.hpp>
+
+#include "decompression_arena.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+BOOST_AUTO_TEST_CASE(decompression_arena_reuses_blocks_after_reset)
+{
+  decompression_arena arena;
+  auto* first = arena.allocate(10);
+  auto* second = arena.allocate(10);
+  BOOST_CHECK_EQUAL(reinterpret_cast<uintptr_t>(first) % alignof(std::max_align_t), 0);
+  BOOST_CHECK_EQUAL(reinterpret_cast<uintptr_t>(second) % alignof(std::max_align_t), 0);
+  BOOST_CHECK(second >= first + 10);
+
+  // larger than a block
+  auto* large = arena.allocate(3 * decompression_arena::BLOCK_SIZE);
+  std::memset(large, 1, 3 * decompression_arena::BLOCK_SIZE);
+  const auto capacity = arena.capacity();
+  BOOST_CHECK_EQUAL(capacity, 4 * decompression_arena::BLOCK_SIZE);
+
+  arena.reset();
+  BOOST_CHECK_EQUAL(arena.allocate(10), first);
+  arena.allocate(2 * decompression_arena::BLOCK_SIZE);
+  BOOST_CHECK_EQUAL(arena.capacity(), capacity);
+}
@@ -1,5 +1,7 @@
 #include <boost/test/unit_test.hpp>
 
+#include "generated/v2/CbEvent_generated.h"
+#include "generated/v2/Event_generated.h"
 #include "joiners/example_joiner.h"
 #include "test_common.h"
 #include "vw/config/options_cli.h"
@@ -246,3 +248,207 @@ BOOST_AUTO_TEST_CASE(example_joiner_test_stickyness)
 
   VW::finish(*vw, false);
 }
+
+namespace
+{
+flatbuffers::Offset<v2::HashedExample> create_hashed_example(flatbuffers::FlatBufferBuilder& fbb,
+    const std::vector<unsigned char>& indices, const std::vector<std::vector<uint64_t>>& hashes,
+    const std::vector<std::vector<float>>& values)
+{
+  std::vector<flatbuffers::Offset<v2::HashedNamespace>> namespaces;
+  for (size_t i = 0; i < indices.size(); ++i)
+  {
+    namespaces.push_back(v2::CreateHashedNamespace(
+        fbb, indices[i], indices[i] * 100, fbb.CreateVector(hashes[i]), fbb.CreateVector(values[i])));
+  }
+  return v2::CreateHashedExample(fbb, fbb.CreateVector(namespaces));
+}
+
+// the hashing configuration of a client, logged with the hashed features
+struct hashing_config
+{
+  uint32_t hash_seed;
+  uint64_t parse_mask;
+  uint32_t num_bits;
+  std::string parse_options;
+};
+
+// the configuration vw hashes contexts with
+hashing_config get_hashing_config(VW::workspace* vw)
+{
+  return {vw->runtime_config.hash_seed, vw->runtime_state.parse_mask, vw->initial_weights_config.num_bits,
+      example_joiner::get_parse_options(*vw->options)};
+}
+
+// the CB interaction of joined_event, logged again with hashed features
+const v2::JoinedEvent* add_hashed_features(const v2::JoinedEvent& joined_event, const hashing_config& config,
+    std::vector<flatbuffers::DetachedBuffer>& detached_buffers)
+{
+  const auto* event = flatbuffers::GetRoot<v2::Event>(joined_event.event()->data());
+  const auto* meta = event->meta();
+  const auto* cb = flatbuffers::GetRoot<v2::CbEvent>(event->payload()->data());
+
+  flatbuffers::FlatBufferBuilder payload_fbb;
+  std::vector<flatbuffers::Offset<v2::HashedExample>> examples{
+      create_hashed_example(payload_fbb, {'G'}, {{10, 11}}, {{1.f, 2.f}}),
+      create_hashed_example(payload_fbb, {'T'}, {{20}}, {{1.f}}),
+      create_hashed_example(payload_fbb, {'T', 'U'}, {{30}, {31, 32}}, {{0.5f}, {1.f, 1.f}})};
+  const auto examples_offset = payload_fbb.CreateVector(examples);
+  const auto parse_options_offset = payload_fbb.CreateString(config.parse_options);
+  const auto features = v2::CreateHashedFeatures(payload_fbb, config.hash_seed, config.parse_mask, true,
+      examples_offset, config.num_bits, parse_options_offset);
+  payload_fbb.Finish(v2::CreateCbEvent(payload_fbb, cb->deferred_action(),
+      payload_fbb.CreateVector(cb->action_ids()->data(), cb->action_ids()->size()),
+      payload_fbb.CreateVector(cb->context()->data(), cb->context()->size()),
+      payload_fbb.CreateVector(cb->probabilities()->data(), cb->probabilities()->size()),
+      payload_fbb.CreateString(cb->model_id() != nullptr ? cb->model_id()->c_str() : ""), cb->learning_mode(),
+      features));
+
+  flatbuffers::FlatBufferBuilder event_fbb;
+  const auto new_meta = v2::CreateMetadata(event_fbb, event_fbb.CreateString(meta->id()->c_str()),
+      meta->client_time_utc(), event_fbb.CreateString(meta->app_id() != nullptr ? meta->app_id()->c_str() : ""),
+      meta->payload_type(), meta->pass_probability(), v2::EventEncoding_Identity);
+  const auto payload = event_fbb.CreateVector(payload_fbb.GetBufferPointer(), payload_fbb.GetSize());
+  event_fbb.Finish(v2::CreateEvent(event_fbb, new_meta, payload));
+
+  flatbuffers::FlatBufferBuilder joined_fbb;
+  joined_fbb.Finish(v2::CreateJoinedEvent(joined_fbb,
+      joined_fbb.CreateVector(event_fbb.GetBufferPointer(), event_fbb.GetSize()), joined_event.timestamp()));
+  detached_buffers.push_back(joined_fbb.Release());
+  return flatbuffers::GetRoot<v2::JoinedEvent>(detached_buffers.back().data());
+}
+
+// the examples of cb_v2.fb, parsed from the json context rather than from the hashed features
+void check_json_context_parsed(const VW::multi_ex& examples)
+{
+  BOOST_REQUIRE_EQUAL(examples.size(), 4);
+  BOOST_CHECK_EQUAL(CB::ec_is_example_header(*examples[0]), true);
+  BOOST_CHECK_EQUAL(examples[0]->feature_space[(int)'G'].indices.size(), 3);
+  BOOST_CHECK_EQUAL(examples[2]->indices.size(), 1);
+  BOOST_CHECK_EQUAL(examples[2]->indices[0], 'T');
+}
+
+void join_cb_with_hashed_features(VW::workspace* vw, const hashing_config& config, VW::multi_ex& examples)
+{
+  example_joiner joiner(vw);
+  joiner.set_problem_type_config(v2::ProblemType_CB);
+
+  std::string input_files = get_test_files_location();
+  auto interaction_buffer = read_file(input_files + "/fb_events/cb_v2.fb");
+  std::vector<flatbuffers::DetachedBuffer> int_detached_buffers;
+  std::vector<flatbuffers::DetachedBuffer> hashed_detached_buffers;
+
+  for (auto* je : wrap_into_joined_events(interaction_buffer, int_detached_buffers))
+  {
+    joiner.process_event(*add_hashed_features(*je, config, hashed_detached_buffers));
+    examples.push_back(VW::new_unused_example(*vw));
+  }
+
+  auto observation_buffer = read_file(input_files + "/fb_events/f-reward_v2.fb");
+  std::vector<flatbuffers::DetachedBuffer> obs_detached_buffers;
+  for (auto* je : wrap_into_joined_events(observation_buffer, obs_detached_buffers)) { joiner.process_event(*je); }
+
+  BOOST_CHECK_EQUAL(joiner.processing_batch(), true);
+  joiner.process_joined(examples);
+  BOOST_CHECK_EQUAL(joiner.processing_batch(), false);
+}
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(example_joiner_test_cb_hashed_features)
+{
+  auto options = VW::make_unique<VW::config::options_cli>(
+      std::vector<std::string>{"--quiet", "--binary_parser", "--cb_explore_adf"});
+  auto vw = VW::external::initialize_with_binary_parser(std::move(options));
+
+  VW::multi_ex examples;
+  join_cb_with_hashed_features(vw.get(), get_hashing_config(vw.get()), examples);
+
+  BOOST_REQUIRE_EQUAL(examples.size(), 4);
+  BOOST_CHECK_EQUAL(CB::ec_is_example_header(*examples[0]), true);
+  BOOST_CHECK_EQUAL(examples[1]->l.cb.costs.size(), 1);
+  BOOST_CHECK_EQUAL(examples[1]->l.cb.costs[0].cost, -1.5f);
+  BOOST_CHECK_EQUAL(VW::example_is_newline(*examples[3]), true);
+
+  // the features are the hashed ones, not the ones of the json context
+  BOOST_CHECK_EQUAL(examples[0]->indices.size(), 1);
+  BOOST_CHECK_EQUAL(examples[0]->indices[0], 'G');
+  const auto& shared = examples[0]->feature_space[(int)'G'];
+  BOOST_CHECK_EQUAL(shared.indices.size(), 2);
+  BOOST_CHECK_EQUAL(shared.indices[0], 10);
+  BOOST_CHECK_EQUAL(shared.indices[1], 11);
+  BOOST_CHECK_EQUAL(shared.values[1], 2.f);
+  BOOST_CHECK_EQUAL(shared.sum_feat_sq, 5.f);
+  BOOST_CHECK_EQUAL(shared.namespace_extents.size(), 1);
+  BOOST_CHECK_EQUAL(shared.namespace_extents[0].hash, 'G' * 100);
+
+  BOOST_CHECK_EQUAL(examples[1]->indices.size(), 1);
+  BOOST_CHECK_EQUAL(examples[1]->feature_space[(int)'T'].indices[0], 20);
+  BOOST_CHECK_EQUAL(examples[2]->indices.size(), 2);
+  BOOST_CHECK_EQUAL(examples[2]->indices[1], 'U');
+  BOOST_CHECK_EQUAL(examples[2]->feature_space[(int)'U'].indices.size(), 2);
+  BOOST_CHECK_EQUAL(examples[2]->feature_space[(int)'T'].values[0], 0.5f);
+
+  clear_examples(examples, vw.get());
+  VW::finish(*vw, false);
+}
+
+BOOST_AUTO_TEST_CASE(example_joiner_test_cb_hashed_features_other_seed)
+{
+  auto options = VW::make_unique<VW::config::options_cli>(
+      std::vector<std::string>{"--quiet", "--binary_parser", "--cb_explore_adf"});
+  auto vw = VW::external::initialize_with_binary_parser(std::move(options));
+
+  auto config = get_hashing_config(vw.get());
+  config.hash_seed += 1;
+  VW::multi_ex examples;
+  join_cb_with_hashed_features(vw.get(), config, examples);
+
+  // hashed with another seed: the json context is parsed instead
+  check_json_context_parsed(examples);
+
+  clear_examples(examples, vw.get());
+  VW::finish(*vw, false);
+}
+
+BOOST_AUTO_TEST_CASE(example_joiner_test_cb_hashed_features_other_bits)
+{
+  auto options = VW::make_unique<VW::config::options_cli>(
+      std::vector<std::string>{"--quiet", "--binary_parser", "--cb_explore_adf", "-b", "20"});
+  auto vw = VW::external::initialize_with_binary_parser(std::move(options));
+
+  // hashed by a model with more bits, masked down to the bits of this one
+  auto config = get_hashing_config(vw.get());
+  config.num_bits = 24;
+  config.parse_mask = (uint64_t(1) << 24) - 1;
+  VW::multi_ex examples;
+  join_cb_with_hashed_features(vw.get(), config, examples);
+  check_json_context_parsed(examples);
+
+  clear_examples(examples, vw.get());
+  VW::finish(*vw, false);
+}
+
+BOOST_AUTO_TEST_CASE(example_joiner_test_cb_hashed_features_other_parse_options)
+{
+  auto options = VW::make_unique<VW::config::options_cli>(
+      std::vector<std::string>{"--quiet", "--binary_parser", "--cb_explore_adf", "-q", "GT"});
+  auto vw = VW::external::initialize_with_binary_parser(std::move(options));
+
+  auto config = get_hashing_config(vw.get());
+  BOOST_CHECK_EQUAL(config.parse_options, " --quadratic GT");
+
+  // the client had no interactions
+  config.parse_options.clear();
+  VW::multi_ex examples;
+  join_cb_with_hashed_features(vw.get(), config, examples);
+  check_json_context_parsed(examples);
+  clear_examples(examples, vw.get());
+
+  // nor does it ignore namespaces the trainer parses
+  config.parse_options = " --ignore U --quadratic GT";
+  join_cb_with_hashed_features(vw.get(), config, examples);
+  check_json_context_parsed(examples);
+
+  clear_examples(examples, vw.get());
+  VW::finish(*vw, false);
+}
@@ -7,6 +7,8 @@
 #include "vw/core/learner.h"
 #include "vw/core/parse_primitives.h"
 
+#include <sstream>
+
 BOOST_AUTO_TEST_CASE(cb_simple)
 {
   std::string input_files = get_test_files_location();
@@ -292,6 +294,162 @@ BOOST_AUTO_TEST_CASE(ccb_compare_dsjson_with_fb_models)
   compare_files_json_to_fb(model_name);
 }
 
+BOOST_AUTO_TEST_CASE(cb_compare_dsjson_with_fb_models_parser_threads)
+{
+  std::string input_files = get_test_files_location();
+
+  std::string model_name = input_files + "/test_outputs/m_average_parser_threads";
+
+  std::string file_name = input_files + "/valid_joined_logs/average_reward_100_interactions";
+
+  // examples parsed ahead are learnt in the same order
+  generate_dsjson_and_fb_models(model_name, "--cb_explore_adf --parser_threads 4 ", file_name);
+
+  // read the models and compare
+  compare_files_json_to_fb(model_name);
+}
+
+BOOST_AUTO_TEST_CASE(ccb_compare_dsjson_with_fb_models_parser_threads)
+{
+  std::string input_files = get_test_files_location();
+
+  std::string model_name = input_files + "/test_outputs/ccb_m_sum_parser_threads";
+
+  std::string file_name = input_files + "/valid_joined_logs/ccb_sum_reward_100_interactions";
+
+  generate_dsjson_and_fb_models(model_name, "--ccb_explore_adf --parser_threads 4 ", file_name);
+
+  // read the models and compare
+  compare_files_json_to_fb(model_name);
+}
+
+BOOST_AUTO_TEST_CASE(cb_compare_dsjson_with_fb_models_mmap)
+{
+  std::string input_files = get_test_files_location();
+
+  std::string model_name = input_files + "/test_outputs/m_average_mmap";
+
+  std::string file_name = input_files + "/valid_joined_logs/average_reward_100_interactions";
+
+  generate_dsjson_and_fb_models(model_name, "--cb_explore_adf --binary_parser_mmap ", file_name);
+
+  // read the models and compare
+  compare_files_json_to_fb(model_name);
+}
+
+BOOST_AUTO_TEST_CASE(ccb_compare_dsjson_with_fb_models_mmap_parser_threads)
+{
+  std::string input_files = get_test_files_location();
+
+  std::string model_name = input_files + "/test_outputs/ccb_m_sum_mmap_parser_threads";
+
+  std::string file_name = input_files + "/valid_joined_logs/ccb_sum_reward_100_interactions";
+
+  generate_dsjson_and_fb_models(model_name, "--ccb_explore_adf --binary_parser_mmap --parser_threads 2 ", file_name);
+
+  // read the models and compare
+  compare_files_json_to_fb(model_name);
+}
+
+BOOST_AUTO_TEST_CASE(cb_dedup_compressed_parser_threads)
+{
+  std::string input_files = get_test_files_location();
+
+  auto buffer = read_file(input_files + "/valid_joined_logs/cb_dedup_compressed.log");
+
+  auto options = VW::make_unique<VW::config::options_cli>(
+      std::vector<std::string>{"--quiet", "--binary_parser", "--cb_explore_adf", "--parser_threads", "2"});
+  auto vw = VW::external::initialize_with_binary_parser(std::move(options));
+
+  VW::multi_ex examples;
+  examples.push_back(VW::new_unused_example(*vw));
+  set_buffer_as_vw_input(buffer, vw.get());
+
+  size_t interactions = 0;
+  while (vw->parser_runtime.example_parser->reader(vw.get(), vw->parser_runtime.example_parser->input, examples) > 0)
+  {
+    ++interactions;
+    BOOST_CHECK_EQUAL(examples.size(), 4);
+    BOOST_CHECK_EQUAL(examples[0]->indices.size(), 1);
+    BOOST_CHECK_EQUAL(examples[0]->indices[0], 'G');
+    BOOST_CHECK_EQUAL(examples[1]->indices.size(), 1);
+    BOOST_CHECK_EQUAL(examples[1]->indices[0], 'T');
+    BOOST_CHECK_EQUAL(examples[2]->indices.size(), 1);
+    BOOST_CHECK_EQUAL(examples[2]->indices[0], 'T');
+    BOOST_CHECK_EQUAL(examples[3]->indices.size(), 0);  // newline example
+
+    clear_examples(examples, vw.get());
+    examples.push_back(VW::new_unused_example(*vw));
+  }
+
+  BOOST_CHECK_GT(interactions, 0);
+
+  clear_examples(examples, vw.get());
+  VW::finish(*vw, false);
+}
+
+namespace
+{
+// the features and labels of every multi example the binary parser reads from file_name, one string each
+std::vector<std::string> read_cb_examples(const std::string& file_name, const std::vector<std::string>& extra_args)
+{
+  auto buffer = read_file(file_name);
+
+  std::vector<std::string> args{"--quiet", "--binary_parser", "--cb_explore_adf"};
+  args.insert(args.end(), extra_args.begin(), extra_args.end());
+  auto options = VW::make_unique<VW::config::options_cli>(args);
+  auto vw = VW::external::initialize_with_binary_parser(std::move(options));
+
+  VW::multi_ex examples;
+  examples.push_back(VW::new_unused_example(*vw));
+  set_buffer_as_vw_input(buffer, vw.get());
+
+  std::vector<std::string> res;
+  while (vw->parser_runtime.example_parser->reader(vw.get(), vw->parser_runtime.example_parser->input, examples) > 0)
+  {
+    std::ostringstream out;
+    for (const auto* ex : examples)
+    {
+      for (const auto& cost : ex->l.cb.costs)
+      {
+        out << "cost " << cost.action << ':' << cost.cost << ':' << cost.probability << '\n';
+      }
+      for (const auto index : ex->indices)
+      {
+        const auto& fs = ex->feature_space[index];
+        out << static_cast<int>(index) << ':';
+        for (size_t i = 0; i < fs.size(); ++i) { out << ' ' << fs.indices[i] << '=' << fs.values[i]; }
+        out << '\n';
+      }
+      out << "--\n";
+    }
+    res.push_back(out.str());
+
+    clear_examples(examples, vw.get());
+    examples.push_back(VW::new_unused_example(*vw));
+  }
+
+  clear_examples(examples, vw.get());
+  VW::finish(*vw, false);
+  return res;
+}
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(cb_parser_threads_match_serial_parsing)
+{
+  std::string input_files = get_test_files_location();
+
+  for (const std::string log :
+      {"/valid_joined_logs/cb_dedup_compressed.log", "/valid_joined_logs/average_reward_100_interactions.fb"})
+  {
+    const auto serial = read_cb_examples(input_files + log, {});
+    const auto parallel = read_cb_examples(input_files + log, {"--parser_threads", "4"});
+
+    BOOST_CHECK_GT(serial.size(), 0);
+    BOOST_CHECK_EQUAL_COLLECTIONS(serial.begin(), serial.end(), parallel.begin(), parallel.end());
+  }
+}
+
 BOOST_AUTO_TEST_CASE(ca_compare_dsjson_with_fb_models_simple)
 {
   std::string input_files = get_test_files_location();
@@ -0,0 +1,43 @@
+#include <boost/test/unit_test.hpp>
+
+#include "work_pool.h"
+
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+BOOST_AUTO_TEST_CASE(work_pool_results_in_submission_order)
+{
+  work_pool pool(4);
+  BOOST_CHECK_EQUAL(pool.size(), 4);
+
+  std::vector<int> results(100, -1);
+  std::vector<std::future<void>> done;
+  for (int i = 0; i < 100; ++i) { done.push_back(pool.submit([&results, i] { results[i] = i * i; })); }
+
+  for (int i = 0; i < 100; ++i)
+  {
+    done[i].get();
+    BOOST_CHECK_EQUAL(results[i], i * i);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(work_pool_reports_exceptions)
+{
+  work_pool pool(2);
+  auto failed = pool.submit([] { throw std::runtime_error("failed"); });
+  auto succeeded = pool.submit([] {});
+
+  BOOST_CHECK_THROW(failed.get(), std::runtime_error);
+  BOOST_CHECK_NO_THROW(succeeded.get());
+}
+
+BOOST_AUTO_TEST_CASE(work_pool_runs_queued_tasks_on_destruction)
+{
+  std::atomic<int> count{0};
+  {
+    work_pool pool(1);
+    for (int i = 0; i < 50; ++i) { pool.submit([&count] { ++count; }); }
+  }
+  BOOST_CHECK_EQUAL(count.load(), 50);
+}
@@ -0,0 +1,46 @@
+#include "work_pool.h"
+
+work_pool::work_pool(size_t threads)
+{
+  _threads.reserve(threads);
+  for (size_t i = 0; i < threads; ++i) { _threads.emplace_back(&work_pool::worker, this); }
+}
+
+work_pool::~work_pool()
+{
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _stop = true;
+  }
+  _cv.notify_all();
+  for (auto& thread : _threads) { thread.join(); }
+}
+
+std::future<void> work_pool::submit(std::function<void()> task)
+{
+  std::packaged_task<void()> packaged(std::move(task));
+  auto result = packaged.get_future();
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _tasks.push_back(std::move(packaged));
+  }
+  _cv.notify_one();
+  return result;
+}
+
+void work_pool::worker()
+{
+  while (true)
+  {
+    std::packaged_task<void()> task;
+    {
+      std::unique_lock<std::mutex> lock(_mutex);
+      _cv.wait(lock, [this] { return _stop || !_tasks.empty(); });
+      if (_tasks.empty()) { return; }
+      task = std::move(_tasks.front());
+      _tasks.pop_front();
+    }
+    // exceptions are stored in the task's future
+    task();
+  }
+}
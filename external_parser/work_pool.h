@@ -0,0 +1,42 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+work pool
+A fixed set of threads running the submitted tasks in submission order. The
+completion of a task (or its exception) is reported through the future
+returned by submit(), which lets the caller consume results in the order it
+submitted them whatever order they complete in.
+
+Tasks still queued when the pool is destroyed are run before the threads exit.
+*/
+class work_pool
+{
+public:
+  explicit work_pool(size_t threads);
+  ~work_pool();
+  work_pool(const work_pool&) = delete;
+  work_pool(work_pool&&) = delete;
+  work_pool& operator=(const work_pool&) = delete;
+  work_pool& operator=(work_pool&&) = delete;
+
+  std::future<void> submit(std::function<void()> task);
+  size_t size() const { return _threads.size(); }
+
+private:
+  void worker();
+
+  std::mutex _mutex;
+  std::condition_variable _cv;
+  std::deque<std::packaged_task<void()>> _tasks;
+  bool _stop = false;
+  std::vector<std::thread> _threads;
+};
@@ -0,0 +1,43 @@
+#include "zstd_dictionary_cache.h"
+
+#include "zdict.h"
+#include "zstd.h"
+
+zstd_dictionary_cache::zstd_dictionary_cache(size_t max_size) : _max_size(max_size == 0 ? 1 : max_size) {}
+
+zstd_dictionary_cache::~zstd_dictionary_cache() { clear(); }
+
+uint32_t zstd_dictionary_cache::add(const uint8_t* data, size_t size)
+{
+  const uint32_t id = ZDICT_getDictID(data, size);
+  if (id == 0) { return 0; }
+  // clients send the dictionary with every batch using it
+  if (_dictionaries.find(id) != _dictionaries.end()) { return id; }
+
+  auto* ddict = ZSTD_createDDict(data, size);
+  if (ddict == nullptr) { return 0; }
+
+  if (_dictionaries.size() >= _max_size)
+  {
+    const auto oldest = _arrival_order.front();
+    _arrival_order.pop_front();
+    ZSTD_freeDDict(_dictionaries[oldest]);
+    _dictionaries.erase(oldest);
+  }
+  _dictionaries.emplace(id, ddict);
+  _arrival_order.push_back(id);
+  return id;
+}
+
+const ZSTD_DDict* zstd_dictionary_cache::get(uint32_t id) const
+{
+  auto it = _dictionaries.find(id);
+  return it == _dictionaries.end() ? nullptr : it->second;
+}
+
+void zstd_dictionary_cache::clear()
+{
+  for (auto& dictionary : _dictionaries) { ZSTD_freeDDict(dictionary.second); }
+  _dictionaries.clear();
+  _arrival_order.clear();
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <unordered_map>
+
+// zstd is a private dependency of the parser, same declaration as in zstd.h
+typedef struct ZSTD_DDict_s ZSTD_DDict;
+
+/*
+zstd dictionary cache
+Clients training zstd dictionaries ship them as ZstdDictionary events in front
+of the batches using them. Events compressed with a dictionary carry its id in
+their zstd frame header, which is used to look the dictionary up here.
+
+Dictionaries are kept in arrival order and the oldest one is evicted once
+max_size is reached: clients only refer to their few most recent dictionaries.
+*/
+class zstd_dictionary_cache
+{
+public:
+  static const size_t DEFAULT_MAX_SIZE = 16;
+
+  explicit zstd_dictionary_cache(size_t max_size = DEFAULT_MAX_SIZE);
+  ~zstd_dictionary_cache();
+  zstd_dictionary_cache(const zstd_dictionary_cache&) = delete;
+  zstd_dictionary_cache(zstd_dictionary_cache&&) = delete;
+  zstd_dictionary_cache& operator=(const zstd_dictionary_cache&) = delete;
+  zstd_dictionary_cache& operator=(zstd_dictionary_cache&&) = delete;
+
+  // returns the id of the dictionary, 0 if the content is not a zstd dictionary
+  uint32_t add(const uint8_t* data, size_t size);
+  // nullptr if the dictionary is unknown
+  const ZSTD_DDict* get(uint32_t id) const;
+  size_t size() const { return _dictionaries.size(); }
+  void clear();
+
+private:
+  size_t _max_size;
+  std::unordered_map<uint32_t, ZSTD_DDict*> _dictionaries;
+  std::list<uint32_t> _arrival_order;
+};
@@ -15,12 +15,14 @@ namespace name
 const char* const APP_ID = "appid";
 const char* const MODEL_SRC = "model.source";
 const char* const MODEL_BLOB_URI = "model.blob.uri";
+const char* const MODEL_DELTA_BLOB_URI = "model.delta.blob.uri";  // source of model deltas for the http transports
 const char* const MODEL_REFRESH_INTERVAL_MS = "model.refreshintervalms";
 const char* const MODEL_IMPLEMENTATION = "model.implementation";  // VW vs other ML
 const char* const MODEL_BACKGROUND_REFRESH = "model.backgroundrefresh";
 const char* const MODEL_VW_INITIAL_COMMAND_LINE = "model.vw.initial_command_line";
 const char* const VW_CMDLINE = "vw.commandline";
 const char* const VW_POOL_INIT_SIZE = "vw.pool.init.size";
+const char* const VW_POOL_THREAD_CACHE = "vw.pool.thread_cache";
 const char* const INITIAL_EPSILON = "initial_exploration.epsilon";
 const char* const LEARNING_MODE = "rank.learning.mode";
 const char* const PROTOCOL_VERSION = "protocol.version";
@@ -62,6 +64,7 @@ const char* const INTERACTION_SEND_BATCH_INTERVAL_MS = "interaction.send.batchin
 const char* const INTERACTION_SENDER_IMPLEMENTATION = "interaction.sender.implementation";
 const char* const INTERACTION_USE_COMPRESSION = "interaction.send.use_compression";
 const char* const INTERACTION_USE_DEDUP = "interaction.send.use_dedup";
+const char* const INTERACTION_HASHED_FEATURES = "interaction.send.hashed_features";
 const char* const INTERACTION_QUEUE_MODE = "interaction.queue.mode";
 const char* const INTERACTION_HTTP_API_HOST = "interaction.http.api.host";
 const char* const INTERACTION_APIM_TASKS_LIMIT = "interaction.apim.tasks_limit";
@@ -92,10 +95,21 @@ const char* const OBSERVATION_SUBSAMPLE_RATE = "observation.subsample.rate";
 // global sender properties
 const char* const SEND_HIGH_WATER_MARK = "send.highwatermark";
 const char* const SEND_QUEUE_MAX_CAPACITY_KB = "send.queue.maxcapacity.kb";
+const char* const SEND_QUEUE_MEMORY_CAP_KB = "send.queue.memory_cap.kb";  // 0 = no cap
 const char* const SEND_BATCH_INTERVAL_MS = "send.batchintervalms";
 const char* const USE_COMPRESSION = "send.use_compression";
 const char* const USE_DEDUP = "send.use_dedup";
+const char* const TRANSFORM_THREADS = "send.transform.threads";
+const char* const SEND_ADAPTIVE_BATCHING = "send.adaptive_batching";
+const char* const SEND_BATCH_INTERVAL_MIN_MS = "send.batchintervalms.min";
+const char* const SEND_BATCH_INTERVAL_MAX_MS = "send.batchintervalms.max";
+const char* const SEND_HIGH_WATER_MARK_MIN = "send.highwatermark.min";
+const char* const SEND_HIGH_WATER_MARK_MAX = "send.highwatermark.max";
+const char* const SEND_QUEUE_FLUSH_THRESHOLD = "send.queue.flush_threshold";  // fraction of the queue capacity
 const char* const QUEUE_MODE = "queue.mode";
+const char* const QUEUE_IMPLEMENTATION = "queue.implementation";
+const char* const QUEUE_RING_SIZE = "queue.ring.size";
+const char* const QUEUE_SHARDS = "queue.shards";
 const char* const SUBSAMPLE_RATE = "subsample.rate";
 const char* const SENDER_IMPLEMENTATION = "sender.implementation";
 
@@ -105,13 +119,29 @@ const char* const TRACE_LOG_LEVEL = "trace.logger.level";
 const char* const EPISODE_FILE_NAME = "episode.file.name";
 const char* const INTERACTION_FILE_NAME = "interaction.file.name";
 const char* const OBSERVATION_FILE_NAME = "observation.file.name";
+const char* const FILE_WRITE_BEHIND = "file.write_behind";  // buffered file sender, see buffered_file_logger
+const char* const FILE_WRITE_BEHIND_BUFFER_KB = "file.write_behind.buffer.kb";
+const char* const FILE_FLUSH_INTERVAL_MS = "file.write_behind.flush_interval_ms";
+const char* const FILE_FSYNC = "file.fsync";  // NONE, BATCH, INTERVAL or SIZE
+const char* const FILE_FSYNC_INTERVAL_MS = "file.fsync.interval_ms";
+const char* const FILE_FSYNC_KB = "file.fsync.kb";
+const char* const FILE_ROTATE_KB = "file.rotate.kb";                    // 0 = no size based rotation
+const char* const FILE_ROTATE_INTERVAL_MS = "file.rotate.interval_ms";  // 0 = no time based rotation
 const char* const TIME_PROVIDER_IMPLEMENTATION = "time_provider.implementation";
 const char* const HTTP_CLIENT_DISABLE_CERT_VALIDATION = "http.certvalidation.disable";
 const char* const HTTP_CLIENT_TIMEOUT = "http.timeout";  // Timeout is in seconds, default is 30.
+const char* const HTTP_CLIENT_POOL_SIZE = "http.client.pool_size";  // clients (connection pools) per endpoint
+const char* const HTTP_RETRY_BASE_DELAY_MS = "http.retry.base_delay_ms";
+const char* const HTTP_RETRY_MAX_DELAY_MS = "http.retry.max_delay_ms";
 const char* const MODEL_FILE_NAME = "model_file_loader.file_name";
 const char* const MODEL_FILE_MUST_EXIST = "model_file_loader.file_must_exist";
+const char* const MODEL_FILE_MMAP = "model_file_loader.mmap";  // map the model file instead of copying it
+const char* const MODEL_FILE_WATCH = "model_file_loader.watch";  // watch the model file instead of polling it
+const char* const MODEL_FILE_DELTA_NAME = "model_file_loader.delta_file_name";  // source of model deltas
 
 const char* const ZSTD_COMPRESSION_LEVEL = "zstd.compression_level";
+const char* const ZSTD_DICTIONARY_SIZE = "zstd.dictionary.size";        // in bytes, 0 disables dictionaries
+const char* const ZSTD_DICTIONARY_SAMPLES = "zstd.dictionary.samples";  // payloads per dictionary training
 }  // namespace name
 }  // namespace reinforcement_learning
 
@@ -151,6 +181,7 @@ const char* const LEARNING_MODE_APPRENTICE = "APPRENTICE";
 const char* const LEARNING_MODE_LOGGINGONLY = "LOGGINGONLY";
 const char* const CONTENT_ENCODING_IDENTITY = "IDENTITY";
 const char* const CONTENT_ENCODING_DEDUP = "DEDUP";
+const char* const CONTENT_ENCODING_ZSTD_DICT_SUFFIX = ";ZSTD_DICT=";
 const char* const HTTP_API_DEFAULT_HEADER_KEY_NAME = "Ocp-Apim-Subscription-Key";
 const char* const HTTP_API_DEFAULT_OAUTH_TOKEN_TYPE = "Bearer";
 const char* const TRACE_LOG_LEVEL_DEFAULT = "info";
@@ -161,9 +192,17 @@ const char* const AZURE_OAUTH_CREDENTIALS_CLIENTSECRET = "CLIENT_SECRET";
 
 const char* const QUEUE_MODE_DROP = "DROP";
 const char* const QUEUE_MODE_BLOCK = "BLOCK";
+const char* const QUEUE_IMPLEMENTATION_LOCKED = "LOCKED";
+const char* const QUEUE_IMPLEMENTATION_LOCK_FREE = "LOCK_FREE";
+const char* const QUEUE_IMPLEMENTATION_SHARDED = "SHARDED";
+const char* const FILE_FSYNC_NONE = "NONE";
+const char* const FILE_FSYNC_BATCH = "BATCH";
+const char* const FILE_FSYNC_INTERVAL = "INTERVAL";
+const char* const FILE_FSYNC_SIZE = "SIZE";
 
 const bool DEFAULT_MODEL_BACKGROUND_REFRESH = true;
 const int DEFAULT_VW_POOL_INIT_SIZE = 4;
+const bool DEFAULT_VW_POOL_THREAD_CACHE = false;
 const int DEFAULT_PROTOCOL_VERSION = 1;
 const char* const DEFAULT_AUDIT_OUTPUT_PATH = "audit";
 
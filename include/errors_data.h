@@ -58,4 +58,7 @@ ERROR_CODE_DEFINITION(52, static_model_load_error, "Static model passed in C# la
 ERROR_CODE_DEFINITION(53, http_oauth_authentication_error, "http request failed to authenticate")
 ERROR_CODE_DEFINITION(
     54, http_oauth_unexpected_error, "http request failed with an unexpected error while retrieving a token")
+ERROR_CODE_DEFINITION(55, file_write_error, "Unable to write to file.")
+ERROR_CODE_DEFINITION(56, model_delta_invalid, "Invalid model delta: ")
+ERROR_CODE_DEFINITION(57, model_delta_base_mismatch, "Model delta does not apply to the current model: ")
 //! [Error Definitions]
@@ -12,6 +12,7 @@
 #include "err_constants.h"
 #include "factory_resolver.h"
 #include "future_compat.h"
+#include "logger_metrics.h"
 #include "multi_slot_response.h"
 #include "multi_slot_response_detailed.h"
 #include "multistep.h"
@@ -20,6 +21,8 @@
 
 #include <functional>
 #include <memory>
+#include <utility>
+#include <vector>
 
 namespace reinforcement_learning
 {
@@ -167,6 +170,20 @@ public:
   int choose_rank(string_view context_json, unsigned int flags, ranking_response& resp,
       api_status* status = nullptr);  // event_id is auto-generated
 
+  /**
+   * @brief Choose an action for each decision of a batch. Equivalent to calling choose_rank() for every
+   * (event_id, context_json) pair, but the whole batch is ranked with the same model object and its interactions
+   * are queued for logging together, which lowers the per decision overhead.
+   * @param requests (event_id, context_json) pairs.  The same event_id should be used when reporting the outcome
+   *                 for the corresponding action.
+   * @param flags Action flags (see action_flags.h), applied to every decision
+   * @param resps Ranking responses, in the same order as the requests
+   * @param status  Optional field with detailed string description if there is an error
+   * @return int Return error code.  This will also be returned in the api_status object
+   */
+  int choose_rank_batch(const std::vector<std::pair<const char*, string_view>>& requests, unsigned int flags,
+      std::vector<ranking_response>& resps, api_status* status = nullptr);
+
   /**
    * @brief (DEPRECATED) Choose an action from a continuous range, given a list of context features
    * The inference library chooses an action by sampling the probability density function produced per continuous action
@@ -428,6 +445,15 @@ public:
    */
   int refresh_model(api_status* status = nullptr);
 
+  /**
+   * @brief Metrics of the loggers sending the interactions and the observations, for monitoring.
+   * @param interactions  Receives the metrics of the interaction logger
+   * @param observations  Receives the metrics of the observation logger
+   * @param status  Optional field with detailed string description if there is an error
+   * @return int Return error code.  This will also be returned in the api_status object
+   */
+  int get_logger_metrics(logger_metrics& interactions, logger_metrics& observations, api_status* status = nullptr);
+
   /**
    * @brief Error callback function.
    * When live_model is constructed, a background error callback and a
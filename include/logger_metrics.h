@@ -0,0 +1,71 @@
+/**
+ * @brief Metrics of the loggers sending the interactions and observations to the trainer, for monitoring.
+ *
+ * @file logger_metrics.h
+ */
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace reinforcement_learning
+{
+/**
+ * @brief Batching of a logger's events: the flush interval and batch size currently used (the configured ones unless
+ * send.adaptive_batching is set) and the inputs the adaptive batching picked them from.
+ */
+struct batching_metrics
+{
+  int interval_ms = 0;
+  size_t high_water_mark = 0;
+  // smoothed duration of i_message_sender::send
+  float send_latency_ms = 0.f;
+  // sends not completed by the sender after the last flush
+  size_t in_flight = 0;
+  // smoothed rate at which the queue fills up between flushes
+  float queue_growth_bytes_per_ms = 0.f;
+  uint64_t flushes = 0;
+  // flushes started by the queue fill threshold instead of the timer
+  uint64_t early_flushes = 0;
+  // gauge of the bytes held by the queue and the batch being built, read when the metrics are requested
+  size_t memory_bytes = 0;
+  // events dropped by the send.queue.memory_cap.kb limit
+  uint64_t memory_cap_drops = 0;
+  // fraction of time the transform workers were busy since the metrics were last requested, 0 if transforms run on
+  // the batcher thread (send.transform.threads == 0)
+  float transform_utilization = 0.f;
+};
+
+/**
+ * @brief Requests sent by the http sender of a logger: the requests in flight, the latency and retry histograms.
+ */
+struct http_sender_metrics
+{
+  // latency_ms[i] counts the requests completed in less than 2^i ms (and at least 2^(i-1) ms), the last bucket is
+  // unbounded
+  static const size_t LATENCY_BUCKETS = 18;
+  // retries[i] counts the requests completed after i retries, the last bucket counts RETRY_BUCKETS - 1 or more
+  static const size_t RETRY_BUCKETS = 8;
+
+  // requests sent and not completed yet, including retries
+  size_t in_flight = 0;
+  uint64_t completed = 0;
+  // completed without a 2xx status once the retries ran out
+  uint64_t failed = 0;
+  // time from the first attempt to the completion of the last one, retry delays included
+  std::array<uint64_t, LATENCY_BUCKETS> latency_ms{};
+  std::array<uint64_t, RETRY_BUCKETS> retries{};
+};
+
+/**
+ * @brief Metrics of one of the loggers of a live_model or loop.
+ */
+struct logger_metrics
+{
+  batching_metrics batching;
+  // false if the logger does not send over http (file, custom or stdout senders), sender is left empty then
+  bool has_sender_metrics = false;
+  http_sender_metrics sender;
+};
+}  // namespace reinforcement_learning
@@ -9,6 +9,7 @@
 #include "err_constants.h"
 #include "factory_resolver.h"
 #include "future_compat.h"
+#include "logger_metrics.h"
 #include "sender.h"
 
 #include <cstring>
@@ -145,6 +146,15 @@ public:
    */
   int refresh_model(api_status* status = nullptr);
 
+  /**
+   * @brief Metrics of the loggers sending the interactions and the observations, for monitoring.
+   * @param interactions  Receives the metrics of the interaction logger
+   * @param observations  Receives the metrics of the observation logger
+   * @param status  Optional field with detailed string description if there is an error
+   * @return int Return error code.  This will also be returned in the api_status object
+   */
+  int get_logger_metrics(logger_metrics& interactions, logger_metrics& observations, api_status* status = nullptr);
+
   /**
    * @brief Error callback function.
    * When base_loop is constructed, a background error callback and a
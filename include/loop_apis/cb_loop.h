@@ -16,6 +16,8 @@
 
 #include <functional>
 #include <memory>
+#include <utility>
+#include <vector>
 
 namespace reinforcement_learning
 {
@@ -84,6 +86,20 @@ public:
   int choose_rank(str_view context_json, unsigned int flags, ranking_response& resp,
       api_status* status = nullptr);  // event_id is auto-generated
 
+  /**
+   * @brief Choose an action for each decision of a batch. Equivalent to calling choose_rank() for every
+   * (event_id, context_json) pair, but the whole batch is ranked with the same model object and its interactions
+   * are queued for logging together, which lowers the per decision overhead.
+   * @param requests (event_id, context_json) pairs.  The same event_id should be used when reporting the outcome
+   *                 for the corresponding action.
+   * @param flags Action flags (see action_flags.h), applied to every decision
+   * @param resps Ranking responses, in the same order as the requests
+   * @param status  Optional field with detailed string description if there is an error
+   * @return int Return error code.  This will also be returned in the api_status object
+   */
+  int choose_rank_batch(const std::vector<std::pair<str_view, str_view>>& requests, unsigned int flags,
+      std::vector<ranking_response>& resps, api_status* status = nullptr);
+
   /**
    * @brief Report the outcome for the top action.
    *
@@ -5,6 +5,7 @@
 #include <cstddef>
 #include <cstdint>
 #include <cstring>
+#include <memory>
 #include <string>
 #include <utility>
 #include <vector>
@@ -14,6 +15,7 @@ namespace reinforcement_learning
 {
 class ranking_response;
 class api_status;
+struct hashed_features;
 }  // namespace reinforcement_learning
 
 namespace reinforcement_learning
@@ -39,6 +41,12 @@ public:
   // Set data
   int set_data(const char* vw_model, size_t len);
 
+  // Refer to read-only memory owned elsewhere (e.g. a memory mapped model file) instead of a copy of it.
+  // Copies of this model_data share the memory, which is released with the last of them. The non-const data() copies
+  // it into owned memory first, read it through a const model_data to avoid the copy. alloc() and free() switch back
+  // to owned memory.
+  void set_shared(std::shared_ptr<const char> data, size_t len);
+
   model_data() = default;
   ~model_data() = default;
 
@@ -49,6 +57,8 @@ public:
 
 private:
   std::vector<char> _data;
+  std::shared_ptr<const char> _shared;
+  size_t _shared_sz = 0;
   uint32_t _refresh_count = 0;
 };
 
@@ -57,6 +67,9 @@ class i_data_transport
 {
 public:
   virtual int get_data(model_data& data, api_status* status = nullptr) = 0;
+  // The model could not use the last data returned (a delta against another model version): the next get_data()
+  // returns a complete model. Transports which only return complete models have nothing to do.
+  virtual void request_full_model() {}
   virtual ~i_data_transport() = default;
 };
 
@@ -81,8 +94,19 @@ public:
   virtual int update(const model_data& data, bool& model_ready, api_status* status = nullptr) = 0;
   virtual int choose_rank(const char* event_id, uint64_t rnd_seed, string_view features, std::vector<int>& action_ids,
       std::vector<float>& action_pdf, std::string& model_version, api_status* status = nullptr) = 0;
+  // Same as choose_rank(), also returns the features the context was hashed into. The default implementation
+  // returns no features, for models which do not parse the context.
+  virtual int choose_rank_hashed(const char* event_id, uint64_t rnd_seed, string_view features,
+      std::vector<int>& action_ids, std::vector<float>& action_pdf, std::string& model_version,
+      hashed_features& hashed, api_status* status = nullptr);
   virtual int choose_continuous_action(string_view features, float& action, float& pdf_value,
       std::string& model_version, api_status* status = nullptr) = 0;
+  // Ranks each context of a batch. The default implementation calls choose_rank() once per context, models which
+  // can share work across the batch (e.g. a single inference object checkout) override it.
+  virtual int choose_rank_batch(const std::vector<const char*>& event_ids, const std::vector<uint64_t>& rnd_seeds,
+      const std::vector<string_view>& features, std::vector<std::vector<int>>& action_ids,
+      std::vector<std::vector<float>>& action_pdfs, std::vector<std::string>& model_versions,
+      api_status* status = nullptr);
   virtual int request_decision(const std::vector<const char*>& event_ids, string_view features,
       std::vector<std::vector<uint32_t>>& actions_ids, std::vector<std::vector<float>>& action_pdfs,
       std::string& model_version, api_status* status = nullptr) = 0;
@@ -1,6 +1,7 @@
 #pragma once
 #include "configuration.h"
 #include "data_buffer.h"
+#include "logger_metrics.h"
 
 #include <memory>
 namespace reinforcement_learning
@@ -22,6 +23,12 @@ public:
     return v_send(data, status);
   }
 
+  // Number of sends accepted but not completed yet, 0 for senders completing them synchronously
+  virtual size_t in_flight_count() const { return 0; }
+
+  // Fills metrics and returns true if the sender tracks its requests, the http senders do
+  virtual bool get_metrics(http_sender_metrics& /*metrics*/) const { return false; }
+
   virtual ~i_sender() = default;
 
 protected:
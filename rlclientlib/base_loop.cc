@@ -65,4 +65,10 @@ int base_loop::refresh_model(api_status* status)
   return _pimpl->refresh_model(status);
 }
 
+int base_loop::get_logger_metrics(logger_metrics& interactions, logger_metrics& observations, api_status* status)
+{
+  INIT_CHECK();
+  return _pimpl->get_logger_metrics(interactions, observations, status);
+}
+
 }  // namespace reinforcement_learning
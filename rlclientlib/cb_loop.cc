@@ -29,6 +29,19 @@ int cb_loop::choose_rank(str_view context_json, unsigned int flags, ranking_resp
   return _pimpl->choose_rank(string_view(context_json.str, context_json.size), flags, response, status);
 }
 
+int cb_loop::choose_rank_batch(const std::vector<std::pair<str_view, str_view>>& requests, unsigned int flags,
+    std::vector<ranking_response>& responses, api_status* status)
+{
+  INIT_CHECK();
+  std::vector<std::pair<const char*, string_view>> impl_requests;
+  impl_requests.reserve(requests.size());
+  for (const auto& request : requests)
+  {
+    impl_requests.emplace_back(request.first.str, string_view(request.second.str, request.second.size));
+  }
+  return _pimpl->choose_rank_batch(impl_requests, flags, responses, status);
+}
+
 int cb_loop::report_outcome(str_view event_id, str_view outcome, api_status* status)
 {
   INIT_CHECK();
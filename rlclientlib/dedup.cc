@@ -3,21 +3,78 @@
 #include "logger/logger_extensions.h"
 #include "serialization/payload_serializer.h"
 #include "utility/config_helper.h"
-#include "utility/context_helper.h"
 #include "vw/common/hash.h"
+#include "zdict.h"
 #include "zstd.h"
 
-#include <sstream>
+#include <rapidjson/error/en.h>
+#include <rapidjson/memorystream.h>
+#include <rapidjson/reader.h>
+
+#include <algorithm>
+#include <cstring>
 
 namespace reinforcement_learning
 {
 namespace u = utility;
 namespace fb = flatbuffers;
 namespace l = reinforcement_learning::logger;
+namespace rj = rapidjson;
+
+dedup_arena::~dedup_arena()
+{
+  for (auto* c : _chunks) { delete c; }
+}
+
+const char* dedup_arena::store(const char* data, size_t length, chunk*& owner)
+{
+  // large contents get a chunk of their own instead of wasting the end of a shared one
+  if (length > CHUNK_SIZE / 4) { owner = new_chunk(length); }
+  else
+  {
+    if (_current == nullptr || _current->capacity - _current->used < length)
+    {
+      if (!_free.empty())
+      {
+        _current = _free.back();
+        _free.pop_back();
+      }
+      else { _current = new_chunk(CHUNK_SIZE); }
+    }
+    owner = _current;
+  }
+
+  char* dest = owner->data.get() + owner->used;
+  if (length > 0) { std::memcpy(dest, data, length); }
+  owner->used += length;
+  ++owner->live;
+  return dest;
+}
+
+void dedup_arena::release(chunk* owner)
+{
+  if (--owner->live > 0) { return; }
+
+  // the chunk is empty, it can be written from the start again
+  owner->used = 0;
+  if (owner == _current) { return; }
+  if (owner->capacity == CHUNK_SIZE && _free.size() < MAX_FREE_CHUNKS) { _free.push_back(owner); }
+  else { delete_chunk(owner); }
+}
 
-dedup_dict::dict_entry::dict_entry(const char* data, size_t length)
-    : _count(1), _length(length), _content(data, data + length)
+dedup_arena::chunk* dedup_arena::new_chunk(size_t capacity)
 {
+  auto* c = new chunk{std::unique_ptr<char[]>(new char[capacity]), capacity, 0, 0, _chunks.size()};
+  _chunks.push_back(c);
+  return c;
+}
+
+void dedup_arena::delete_chunk(chunk* c)
+{
+  _chunks[c->index] = _chunks.back();
+  _chunks[c->index]->index = c->index;
+  _chunks.pop_back();
+  delete c;
 }
 
 static generic_event::object_id_t hash_content(const char* start, size_t size)
@@ -28,79 +85,276 @@ static generic_event::object_id_t hash_content(const char* start, size_t size)
 generic_event::object_id_t dedup_dict::add_object(const char* start, size_t length)
 {
   auto hash = hash_content(start, length);
-  auto it = _entries.find(hash);
-  if (it == _entries.end()) { _entries.insert({hash, dict_entry(start, length)}); }
-  else { ++it->second._count; }
+  auto& s = _shards[shard_index(hash)];
+  std::lock_guard<std::mutex> lock(s._mutex);
+  add_object(s, hash, start, length);
   return hash;
 }
 
+void dedup_dict::add_object(shard& s, generic_event::object_id_t aid, const char* start, size_t length)
+{
+  auto it = s._entries.find(aid);
+  if (it != s._entries.end())
+  {
+    ++it->second._count;
+    return;
+  }
+
+  dict_entry entry{1, length, nullptr, nullptr};
+  entry._content = s._arena.store(start, length, entry._chunk);
+  s._entries.insert({aid, entry});
+}
+
+void dedup_dict::add_objects(string_view payload, const std::vector<object_ref>& objects)
+{
+  static_assert(SHARDS_COUNT <= 32, "shards are tracked in a 32 bits mask");
+  uint32_t touched = 0;
+  for (const auto& obj : objects) { touched |= 1u << shard_index(obj.id); }
+
+  for (size_t i = 0; i < SHARDS_COUNT; ++i)
+  {
+    if ((touched & (1u << i)) == 0) { continue; }
+    auto& s = _shards[i];
+    std::lock_guard<std::mutex> lock(s._mutex);
+    for (const auto& obj : objects)
+    {
+      if (shard_index(obj.id) == i) { add_object(s, obj.id, payload.data() + obj.offset, obj.length); }
+    }
+  }
+}
+
 bool dedup_dict::remove_object(generic_event::object_id_t aid, size_t count)
 {
   if (count < 1) { return true; }
 
-  auto it = _entries.find(aid);
-  if (it == _entries.end()) { return false; }
+  auto& s = _shards[shard_index(aid)];
+  std::lock_guard<std::mutex> lock(s._mutex);
+  auto it = s._entries.find(aid);
+  if (it == s._entries.end()) { return false; }
 
   count = std::min(count, it->second._count);
   it->second._count -= count;
-  if (it->second._count == 0u) { _entries.erase(it); }
+  if (it->second._count == 0u)
+  {
+    s._arena.release(it->second._chunk);
+    s._entries.erase(it);
+  }
 
   return true;
 }
 
 string_view dedup_dict::get_object(generic_event::object_id_t aid) const
 {
-  auto it = _entries.find(aid);
-  if (it == _entries.end()) { return {}; }
-  return {it->second._content.data(), it->second._length};
+  const auto& s = _shards[shard_index(aid)];
+  std::lock_guard<std::mutex> lock(s._mutex);
+  auto it = s._entries.find(aid);
+  if (it == s._entries.end()) { return {}; }
+  return {it->second._content, it->second._length};
+}
+
+namespace
+{
+const char MULTI_KEY[] = "_multi";
+
+// Appends {"__aid":<aid>} to out
+void append_object_reference(std::string& out, generic_event::object_id_t aid)
+{
+  char digits[20];
+  size_t count = 0;
+  do
+  {
+    digits[count++] = static_cast<char>('0' + aid % 10);
+    aid /= 10;
+  } while (aid != 0);
+
+  out.append("{\"__aid\":", 9);
+  while (count > 0) { out.push_back(digits[--count]); }
+  out.push_back('}');
+}
+
+// SAX handler rewriting the objects of the top level _multi array as the reader goes over the payload. Everything
+// between two objects is copied to the output once, and each object is hashed once when it ends.
+struct object_extractor : public rj::BaseReaderHandler<rj::UTF8<>, object_extractor>
+{
+  const rj::MemoryStream& _is;
+  string_view _payload;
+  std::string& _out;
+  std::vector<dedup_dict::object_ref>& _objects;
+  int _level = 0;
+  int _array_level = 0;
+  bool _is_multi = false;
+  size_t _item_start = 0;
+  size_t _copied = 0;  // payload bytes already written to _out
+
+  object_extractor(const rj::MemoryStream& is, string_view payload, std::string& out,
+      std::vector<dedup_dict::object_ref>& objects)
+      : _is(is), _payload(payload), _out(out), _objects(objects)
+  {
+  }
+
+  bool Key(const char* str, rj::SizeType length, bool copy)
+  {
+    if (_level == 1 && _array_level == 0)
+    {
+      _is_multi = length == sizeof(MULTI_KEY) - 1 && std::memcmp(str, MULTI_KEY, length) == 0;
+    }
+    return true;
+  }
+
+  bool StartObject()
+  {
+    // the reader has consumed the '{'
+    if (_is_multi && _level == 1 && _array_level == 1) { _item_start = _is.Tell() - 1; }
+    ++_level;
+    return true;
+  }
+
+  bool EndObject(rj::SizeType member_count)
+  {
+    --_level;
+    if (_is_multi && _level == 1 && _array_level == 1)
+    {
+      const size_t length = _is.Tell() - _item_start;
+      const auto aid = hash_content(_payload.data() + _item_start, length);
+      _objects.push_back({aid, _item_start, length});
+
+      _out.append(_payload.data() + _copied, _item_start - _copied);
+      append_object_reference(_out, aid);
+      _copied = _item_start + length;
+    }
+    return true;
+  }
+
+  bool StartArray()
+  {
+    ++_array_level;
+    return true;
+  }
+
+  bool EndArray(rj::SizeType element_count)
+  {
+    --_array_level;
+    return true;
+  }
+
+  void finish() { _out.append(_payload.data() + _copied, _payload.size() - _copied); }
+};
+}  // namespace
+
+int dedup_dict::extract_objects(
+    string_view payload, std::string& edited_payload, std::vector<object_ref>& objects, api_status* status)
+{
+  objects.clear();
+  edited_payload.clear();
+  // references are usually shorter than the objects they replace
+  edited_payload.reserve(payload.size());
+
+  // The memory stream reads the payload in place, no copy is needed for parsing.
+  // The reader is reused by the thread so that its token stack is only allocated once.
+  static thread_local rj::Reader reader;
+  rj::MemoryStream is(payload.data(), payload.size());
+  object_extractor extractor(is, payload, edited_payload, objects);
+  const auto res = reader.Parse<rj::kParseDefaultFlags>(is, extractor);
+  if (res.IsError())
+  {
+    RETURN_ERROR_LS(nullptr, status, json_parse_error)
+        << "JSON parse error: " << rj::GetParseError_En(res.Code()) << " (" << res.Offset() << ")";
+  }
+  extractor.finish();
+  return error_code::success;
 }
 
 int dedup_dict::transform_payload_and_add_objects(
     string_view payload, std::string& edited_payload, generic_event::object_list_t& object_ids, api_status* status)
 {
-  u::ContextInfo context_info;
-  RETURN_IF_FAIL(u::get_context_info(payload, context_info, nullptr, status));
+  std::vector<object_ref> objects;
+  RETURN_IF_FAIL(extract_objects(payload, edited_payload, objects, status));
 
-  edited_payload = std::string(payload);
+  add_objects(payload, objects);
   object_ids.clear();
-  object_ids.reserve(context_info.actions.size());
+  object_ids.reserve(objects.size());
+  for (const auto& obj : objects) { object_ids.push_back(obj.id); }
 
-  size_t edit_offset = 0;
-  for (auto& p : context_info.actions)
+  return error_code::success;
+}
+
+size_t dedup_dict::size() const
+{
+  size_t res = 0;
+  for (const auto& s : _shards)
   {
-    auto hash = add_object(&payload[p.first], p.second);
-    object_ids.push_back(hash);
-    std::stringstream replacement;
-    replacement << "{\"__aid\":";
-    replacement << hash << "}";
-    edited_payload.replace(p.first - edit_offset, p.second, replacement.str());
+    std::lock_guard<std::mutex> lock(s._mutex);
+    res += s._entries.size();
+  }
+  return res;
+}
+
+namespace
+{
+// zstd contexts and output buffer of the calling thread, reused across payloads instead of being created by each
+// one-shot ZSTD_compress/ZSTD_decompress call
+struct zstd_contexts
+{
+  ZSTD_CCtx* cctx = ZSTD_createCCtx();
+  ZSTD_DCtx* dctx = ZSTD_createDCtx();
+  std::vector<uint8_t> scratch;
 
-    // adjust the edit position based on how many bytes were deleted.
-    edit_offset += p.second - replacement.tellp();
+  ~zstd_contexts()
+  {
+    ZSTD_freeCCtx(cctx);
+    ZSTD_freeDCtx(dctx);
   }
 
-  return error_code::success;
+  static zstd_contexts& local()
+  {
+    static thread_local zstd_contexts contexts;
+    return contexts;
+  }
+};
+}  // namespace
+
+zstd_dictionary::zstd_dictionary(std::vector<char> content, int level)
+    : _content(std::move(content))
+    , _cdict(ZSTD_createCDict(_content.data(), _content.size(), level))
+    , _id(ZDICT_getDictID(_content.data(), _content.size()))
+{
 }
 
-size_t dedup_dict::size() const { return _entries.size(); }
+zstd_dictionary::~zstd_dictionary() { ZSTD_freeCDict(_cdict); }
 
-zstd_compressor::zstd_compressor(int level) : _level(level) {}
+zstd_compressor::zstd_compressor(int level, size_t dictionary_size, size_t dictionary_samples)
+    : _level(level)
+    , _dictionary_size(dictionary_size)
+    , _dictionary_samples(dictionary_samples > 0 ? dictionary_samples : ZSTD_DEFAULT_DICTIONARY_SAMPLES)
+{
+}
 
-int zstd_compressor::compress(generic_event::payload_buffer_t& input, api_status* status) const
+int zstd_compressor::compress(generic_event::payload_buffer_t& input, api_status* status,
+    std::shared_ptr<const zstd_dictionary>* used_dictionary) const
 {
-  size_t buff_size = ZSTD_compressBound(input.size());
+  auto dictionary = std::atomic_load(&_current);
+  if (_dictionary_size > 0) { add_sample(input.data(), input.size()); }
 
-  std::unique_ptr<uint8_t[]> data(fb::DefaultAllocator().allocate(buff_size));
-  size_t res = ZSTD_compress(data.get(), buff_size, input.data(), input.size(), _level);
+  auto& contexts = zstd_contexts::local();
+  const size_t bound = ZSTD_compressBound(input.size());
+  if (contexts.scratch.size() < bound) { contexts.scratch.resize(bound); }
 
+  const size_t res = dictionary != nullptr
+      ? ZSTD_compress_usingCDict(
+            contexts.cctx, contexts.scratch.data(), bound, input.data(), input.size(), dictionary->cdict())
+      : ZSTD_compressCCtx(contexts.cctx, contexts.scratch.data(), bound, input.data(), input.size(), _level);
   if (ZSTD_isError(res) != 0u) { RETURN_ERROR_ARG(nullptr, status, compression_error, ZSTD_getErrorName(res)); }
 
-  auto* data_ptr = data.release();
+  // the payload only takes the compressed size, not the bound
+  auto* data_ptr = fb::DefaultAllocator().allocate(res);
+  std::memcpy(data_ptr, contexts.scratch.data(), res);
   input = fb::DetachedBuffer(nullptr, false, data_ptr, 0, data_ptr, res);
+  if (used_dictionary != nullptr) { *used_dictionary = std::move(dictionary); }
   return error_code::success;
 }
 
-int zstd_compressor::decompress(generic_event::payload_buffer_t& buf, api_status* status)
+int zstd_compressor::decompress(
+    generic_event::payload_buffer_t& buf, api_status* status, const zstd_dictionary* dictionary)
 {
   size_t buff_size = ZSTD_getFrameContentSize(buf.data(), buf.size());
   if (buff_size == ZSTD_CONTENTSIZE_ERROR)
@@ -112,8 +366,12 @@ int zstd_compressor::decompress(generic_event::payload_buffer_t& buf, api_status
     RETURN_ERROR_ARG(nullptr, status, compression_error, "Unknown compressed size.");
   }
 
+  auto& contexts = zstd_contexts::local();
   std::unique_ptr<uint8_t[]> data(fb::DefaultAllocator().allocate(buff_size));
-  size_t res = ZSTD_decompress(data.get(), buff_size, buf.data(), buf.size());
+  size_t res = dictionary != nullptr
+      ? ZSTD_decompress_usingDict(contexts.dctx, data.get(), buff_size, buf.data(), buf.size(),
+            dictionary->content().data(), dictionary->content().size())
+      : ZSTD_decompressDCtx(contexts.dctx, data.get(), buff_size, buf.data(), buf.size());
 
   if (ZSTD_isError(res) != 0u) { RETURN_ERROR_ARG(nullptr, status, compression_error, ZSTD_getErrorName(res)); }
 
@@ -122,36 +380,75 @@ int zstd_compressor::decompress(generic_event::payload_buffer_t& buf, api_status
   return error_code::success;
 }
 
+void zstd_compressor::add_sample(const uint8_t* data, size_t size) const
+{
+  std::lock_guard<std::mutex> lock(_samples_mutex);
+  // enough samples for the next training
+  if (_sample_sizes.size() >= _dictionary_samples) { return; }
+  _samples.insert(_samples.end(), data, data + size);
+  _sample_sizes.push_back(size);
+}
+
+void zstd_compressor::train_dictionary() const
+{
+  if (_dictionary_size == 0) { return; }
+  std::vector<char> samples;
+  std::vector<size_t> sample_sizes;
+  {
+    std::lock_guard<std::mutex> lock(_samples_mutex);
+    if (_sample_sizes.size() < _dictionary_samples) { return; }
+    samples.swap(_samples);
+    sample_sizes.swap(_sample_sizes);
+  }
+
+  // runs outside of the lock, compress() keeps using the current dictionary and collects the next samples
+  std::vector<char> content(_dictionary_size);
+  const size_t res =
+      ZDICT_trainFromBuffer(content.data(), content.size(), samples.data(), sample_sizes.data(), sample_sizes.size());
+  // too few or too similar samples, try again with the next ones
+  if (ZDICT_isError(res) != 0u) { return; }
+  content.resize(res);
+
+  // the batches still referring to the previous dictionary hold their own reference to it
+  std::shared_ptr<const zstd_dictionary> dictionary(new zstd_dictionary(std::move(content), _level));
+  std::atomic_store(&_current, dictionary);
+}
+
 dedup_state::dedup_state(const utility::configuration& c, bool use_compression, bool use_dedup,
     std::unique_ptr<i_time_provider> time_provider)
-    : _compressor(c.get_int(name::ZSTD_COMPRESSION_LEVEL, zstd_compressor::ZSTD_DEFAULT_COMPRESSION_LEVEL))
+    : _compressor(c.get_int(name::ZSTD_COMPRESSION_LEVEL, zstd_compressor::ZSTD_DEFAULT_COMPRESSION_LEVEL),
+          static_cast<size_t>(c.get_int(name::ZSTD_DICTIONARY_SIZE, 0)),
+          static_cast<size_t>(
+              c.get_int(name::ZSTD_DICTIONARY_SAMPLES, zstd_compressor::ZSTD_DEFAULT_DICTIONARY_SAMPLES)))
     , _time_provider(std::move(time_provider))
     , _use_compression(use_compression)
     , _use_dedup(use_dedup)
 {
 }
 
-string_view dedup_state::get_object(generic_event::object_id_t aid)
-{
-  std::unique_lock<std::mutex> mlock(_mutex);
-  return _dict.get_object(aid);
-}
+string_view dedup_state::get_object(generic_event::object_id_t aid) { return _dict.get_object(aid); }
 
 float dedup_state::get_ewma_value() const { return _ewma.value(); }
 
+void dedup_state::train_compression_dictionary() const
+{
+  if (_use_compression) { _compressor.train_dictionary(); }
+}
+
 void dedup_state::update_ewma(float value)
 {
   // This is racy, but update only reads and modifies a single value, so it won't lead to data corruption
   _ewma.update(value);
 }
 
-int dedup_state::compress(
-    generic_event::payload_buffer_t& input, event_content_type& content_type, api_status* status) const
+int dedup_state::compress(generic_event::payload_buffer_t& input, event_content_type& content_type,
+    std::shared_ptr<const zstd_dictionary>& dictionary, api_status* status) const
 {
+  dictionary = nullptr;
   if (_use_compression)
   {
     content_type = event_content_type::ZSTD;
-    return _compressor.compress(input, status);
+    return _compressor.compress(input, status, &dictionary);
   }
   content_type = event_content_type::IDENTITY;
   return error_code::success;
@@ -166,11 +463,20 @@ int dedup_state::transform_payload_and_add_objects(
     return error_code::success;
   }
 
-  std::unique_lock<std::mutex> mlock(_mutex);
-  return _dict.transform_payload_and_add_objects(payload, edited_payload, object_ids, status);
+  // Scan and rewrite the payload without any lock, then insert the objects shard by shard.
+  // Transforms run on the batcher thread or on the transform workers, each keeps its scratch list.
+  static thread_local std::vector<dedup_dict::object_ref> objects;
+  RETURN_IF_FAIL(dedup_dict::extract_objects(payload, edited_payload, objects, status));
+
+  object_ids.clear();
+  object_ids.reserve(objects.size());
+  for (const auto& obj : objects) { object_ids.push_back(obj.id); }
+
+  _dict.add_objects(payload, objects);
+  return error_code::success;
 }
 
-action_dict_builder::action_dict_builder(dedup_state& state) : _size_estimate(0), _state(state) {}
+action_dict_builder::action_dict_builder(dedup_state& state) : _state(state), _size_estimate(0) {}
 
 int action_dict_builder::add(const generic_event::object_list_t& object_ids, api_status* status)
 {
@@ -186,6 +492,8 @@ int action_dict_builder::add(const generic_event::object_list_t& object_ids, api
             << "Key not found while processing event into batch dictionary";
       }
       _used_objects.insert({aid, 1});
+      _action_ids.push_back(aid);
+      _action_values.push_back(content);
       _size_estimate += sizeof(size_t) + content.size();
     }
     else { ++it->second; }
@@ -193,25 +501,36 @@ int action_dict_builder::add(const generic_event::object_list_t& object_ids, api
   return error_code::success;
 }
 
+compression_dictionary_builder::compression_dictionary_builder(dedup_state& state) : _state(state) {}
+
+void compression_dictionary_builder::add(const generic_event& evt)
+{
+  const auto& dictionary = evt.get_payload_dictionary();
+  if (dictionary == nullptr || std::find(_dictionaries.begin(), _dictionaries.end(), dictionary) != _dictionaries.end())
+  {
+    return;
+  }
+  _dictionaries.push_back(dictionary);
+}
+
 size_t action_dict_builder::size() const { return (size_t)(_size_estimate * _state.get_ewma_value()); }
 
 int action_dict_builder::finalize(generic_event& evt, api_status* status)
 {
   l::dedup_info_serializer ser;
-  generic_event::object_list_t action_ids;
   const auto now = _state.get_time_provider() != nullptr ? _state.get_time_provider()->gmt_now() : timestamp();
-  std::vector<string_view> action_values;
 
-  RETURN_IF_FAIL(_state.get_all_values(_used_objects.begin(), _used_objects.end(), action_ids, action_values, status));
-  auto payload = l::dedup_info_serializer::event(action_ids, action_values);
+  // the contents were looked up by add(), the dictionary is not searched again
+  auto payload = l::dedup_info_serializer::event(_action_ids, _action_values);
 
   // remove used actions from the dictionary
   RETURN_IF_FAIL(_state.remove_all_values(_used_objects.begin(), _used_objects.end(), status));
 
   // compress the payload
   event_content_type content_type;
+  std::shared_ptr<const zstd_dictionary> dictionary;
   size_t old_size = payload.size();
-  RETURN_IF_FAIL(_state.compress(payload, content_type, status));
+  RETURN_IF_FAIL(_state.compress(payload, content_type, dictionary, status));
   size_t new_size = payload.size();
 
   // update compression ratio estimator
@@ -219,6 +538,7 @@ int action_dict_builder::finalize(generic_event& evt, api_status* status)
 
   evt = generic_event(DEDUP_DICT_EVENT_ID, now, generic_event::payload_type_t::PayloadType_DedupInfo,
       std::move(payload), content_type, evt.get_app_id());
+  evt.set_payload_dictionary(std::move(dictionary));
 
   return error_code::success;
 }
@@ -233,13 +553,18 @@ struct dedup_collection_serializer
   static int message_id() { return logger::message_type::fb_generic_event_collection; }
 
   dedup_collection_serializer(buffer_t& buffer, const char* content_encoding, shared_state_t& state)
-      : _ser(buffer, content_encoding, _dummy), _state(state), _builder(state)
+      : _state(state)
+      , _builder(state)
+      , _dictionaries(state)
+      , _base_encoding(content_encoding)
+      , _ser(buffer, content_encoding, _dummy)
   {
   }
 
   int add(event_t& evt, api_status* status = nullptr)
   {
     RETURN_IF_FAIL(_builder.add(evt.get_object_list(), status));
+    _dictionaries.add(evt);
     return _ser.add(evt, status);
   }
 
@@ -249,8 +574,13 @@ struct dedup_collection_serializer
   {
     generic_event evt;
     RETURN_IF_FAIL(_builder.finalize(evt, status));
+    _dictionaries.add(evt);
     RETURN_IF_FAIL(_ser.prepend(evt, status));
+    RETURN_IF_FAIL(_dictionaries.finalize(_ser, _base_encoding, _content_encoding, evt.get_app_id(), status));
+    _ser._content_encoding = _content_encoding.c_str();
     RETURN_IF_FAIL(_ser.finalize(status));
+    // on the batcher thread, off the path of the threads logging events
+    _state.train_compression_dictionary();
     return error_code::success;
   }
 
@@ -259,7 +589,56 @@ struct dedup_collection_serializer
   int _dummy{0};
   shared_state_t& _state;
   action_dict_builder _builder;
+  compression_dictionary_builder _dictionaries;
+  const char* _base_encoding;
+  std::string _content_encoding;
+  logger::fb_collection_serializer<event_t> _ser;
+};
+
+// Batches of zstd compressed events without dedup, shipping the dictionaries the events were compressed with
+template <typename event_t>
+struct zstd_dict_collection_serializer
+{
+  using serializer_t = logger::fb_event_serializer<event_t>;
+  using buffer_t = utility::data_buffer;
+  using shared_state_t = dedup_state;
+
+  static int message_id() { return logger::message_type::fb_generic_event_collection; }
+
+  zstd_dict_collection_serializer(buffer_t& buffer, const char* content_encoding, shared_state_t& state)
+      : _state(state), _ser(buffer, content_encoding), _dictionaries(state), _base_encoding(content_encoding)
+  {
+  }
+
+  int add(event_t& evt, api_status* status = nullptr)
+  {
+    _dictionaries.add(evt);
+    return _ser.add(evt, status);
+  }
+
+  uint64_t size() const { return _ser.size(); }
+
+  int finalize(api_status* status, uint64_t original_event_count)
+  {
+    _ser._original_event_count = original_event_count;
+    return finalize(status);
+  }
+
+  int finalize(api_status* status)
+  {
+    RETURN_IF_FAIL(_dictionaries.finalize(_ser, _base_encoding, _content_encoding, "", status));
+    _ser._content_encoding = _content_encoding.c_str();
+    RETURN_IF_FAIL(_ser.finalize(status));
+    // on the batcher thread, off the path of the threads logging events
+    _state.train_compression_dictionary();
+    return error_code::success;
+  }
+
+  shared_state_t& _state;
   logger::fb_collection_serializer<event_t> _ser;
+  compression_dictionary_builder _dictionaries;
+  const char* _base_encoding;
+  std::string _content_encoding;
 };
 
 class dedup_extensions : public logger::i_logger_extensions
@@ -287,6 +666,13 @@ public:
               std::move(sender), watchdog, _dedup_state, perror_cb, config));
     }
 
+    if (_dedup_state.uses_compression_dictionaries())
+    {
+      return std::unique_ptr<logger::i_async_batcher<generic_event>>(
+          new logger::async_batcher<generic_event, zstd_dict_collection_serializer>(
+              std::move(sender), watchdog, _dedup_state, perror_cb, config));
+    }
+
     return std::unique_ptr<logger::i_async_batcher<generic_event>>(
         new logger::async_batcher<generic_event, logger::fb_collection_serializer>(
             std::move(sender), watchdog, _dummy_state, perror_cb, config));
@@ -301,10 +687,10 @@ public:
     return _dedup_state.transform_payload_and_add_objects(context, edited_payload, objects, status);
   }
 
-  int transform_serialized_payload(
-      generic_event::payload_buffer_t& input, event_content_type& content_type, api_status* status) const override
+  int transform_serialized_payload(generic_event::payload_buffer_t& input, event_content_type& content_type,
+      std::shared_ptr<const zstd_dictionary>& dictionary, api_status* status) const override
   {
-    return _dedup_state.compress(input, content_type, status);
+    return _dedup_state.compress(input, content_type, dictionary, status);
   }
 
 private:
@@ -1,15 +1,63 @@
 #pragma once
 #include "api_status.h"
+#include "constants.h"
 #include "dedup.h"
 #include "rl_string_view.h"
 #include "zstd.h"
 
+#include <array>
+#include <cstring>
+#include <memory>
 #include <mutex>
+#include <string>
 #include <unordered_map>
 #include <vector>
 
 namespace reinforcement_learning
 {
+// Storage for the content of dictionary entries. Contents are copied into large chunks instead of getting one heap
+// block each, and a chunk is recycled once every entry it holds has been released. Not thread safe.
+class dedup_arena
+{
+public:
+  struct chunk
+  {
+    std::unique_ptr<char[]> data;
+    size_t capacity;
+    size_t used;
+    size_t live;   // entries stored in the chunk
+    size_t index;  // position in _chunks
+  };
+
+  static const size_t CHUNK_SIZE = 64 * 1024;
+
+  dedup_arena() = default;
+  dedup_arena(const dedup_arena&) = delete;
+  dedup_arena& operator=(const dedup_arena&) = delete;
+  ~dedup_arena();
+
+  //! Copies [data, data+length[ into the arena. owner is the chunk to pass to release() when the copy is not used
+  //! anymore.
+  const char* store(const char* data, size_t length, chunk*& owner);
+  void release(chunk* owner);
+
+  size_t chunks_count() const { return _chunks.size(); }
+
+private:
+  static const size_t MAX_FREE_CHUNKS = 2;
+
+  chunk* new_chunk(size_t capacity);
+  void delete_chunk(chunk* c);
+
+  std::vector<chunk*> _chunks;  // owned, in use or free
+  std::vector<chunk*> _free;
+  chunk* _current = nullptr;  // chunk new contents are appended to
+};
+
+// Refcounted objects shared by the events of a batch.
+// The dictionary is split in independently locked shards selected by object id, so request threads adding the objects
+// of their events and the batcher looking them up only contend when they touch the same shard. Lookups take the shard
+// lock too, the batcher does one per distinct object of a batch (see action_dict_builder).
 class dedup_dict
 {
 public:
@@ -17,32 +65,60 @@ public:
 
   dedup_dict(const dedup_dict&) = delete;
   dedup_dict& operator=(const dedup_dict&) = delete;
-
-  dedup_dict(dedup_dict&&) = default;
-  dedup_dict& operator=(dedup_dict&&) = default;
+  dedup_dict(dedup_dict&&) = delete;
+  dedup_dict& operator=(dedup_dict&&) = delete;
   ~dedup_dict() = default;
 
+  //! An object found in a payload: its id and the range [offset, offset+length[ it covers
+  struct object_ref
+  {
+    generic_event::object_id_t id;
+    size_t offset;
+    size_t length;
+  };
+
   //! Returns true if the object was found. This doesn't tell the ref count status of that object
   bool remove_object(generic_event::object_id_t aid, size_t count = 1);
   //! Returns the object id of the object described by [start, start+length[
   generic_event::object_id_t add_object(const char* start, size_t length);
+  //! Adds the objects found by extract_objects() in payload, locking each shard once
+  void add_objects(string_view payload, const std::vector<object_ref>& objects);
   //! Return a string_view of the object content, or an empty view if not found
+  //! The view is valid as long as the caller holds a reference to the object
   string_view get_object(generic_event::object_id_t aid) const;
 
   size_t size() const;
   int transform_payload_and_add_objects(
       string_view payload, std::string& edited_payload, generic_event::object_list_t& object_ids, api_status* status);
 
+  //! Writes payload to edited_payload with each object of its _multi array replaced by {"__aid":<id>}, in a single
+  //! pass that also validates the JSON. The dictionary is not touched, so this does not need the dictionary lock.
+  static int extract_objects(
+      string_view payload, std::string& edited_payload, std::vector<object_ref>& objects, api_status* status);
+
+  static const size_t SHARDS_COUNT = 16;
+
 private:
   struct dict_entry
   {
     size_t _count;
     size_t _length;
-    std::vector<char> _content;
+    const char* _content;
+    dedup_arena::chunk* _chunk;
+  };
 
-    dict_entry(const char* data, size_t length);
+  struct shard
+  {
+    mutable std::mutex _mutex;
+    std::unordered_map<generic_event::object_id_t, dict_entry> _entries;
+    dedup_arena _arena;
   };
-  std::unordered_map<generic_event::object_id_t, dict_entry> _entries;
+
+  static size_t shard_index(generic_event::object_id_t aid) { return static_cast<size_t>(aid % SHARDS_COUNT); }
+  // must be called with the shard locked
+  static void add_object(shard& s, generic_event::object_id_t aid, const char* start, size_t length);
+
+  std::array<shard, SHARDS_COUNT> _shards;
 };
 
 class ewma
@@ -59,17 +135,59 @@ private:
   const float _weight;
 };
 
+// zstd dictionary trained from recent payloads. Identified by the dictionary id zstd writes in the frames it
+// compresses, so that the receiving side can pick the right one.
+class zstd_dictionary
+{
+public:
+  zstd_dictionary(std::vector<char> content, int level);
+  ~zstd_dictionary();
+
+  zstd_dictionary(const zstd_dictionary&) = delete;
+  zstd_dictionary& operator=(const zstd_dictionary&) = delete;
+
+  uint32_t id() const { return _id; }
+  const std::vector<char>& content() const { return _content; }
+  const ZSTD_CDict* cdict() const { return _cdict; }
+
+private:
+  std::vector<char> _content;
+  ZSTD_CDict* _cdict;
+  uint32_t _id;
+};
+
 class zstd_compressor
 {
 public:
   const static int ZSTD_DEFAULT_COMPRESSION_LEVEL = 1;
+  const static int ZSTD_DEFAULT_DICTIONARY_SAMPLES = 1000;
+
+  //! With a dictionary_size, compress() collects dictionary_samples payloads, train_dictionary() then trains a
+  //! dictionary from them that compresses the following payloads.
+  explicit zstd_compressor(int level, size_t dictionary_size = 0, size_t dictionary_samples = 0);
+  //! dictionary, if not null, is set to the dictionary the payload was compressed with (nullptr if none)
+  int compress(generic_event::payload_buffer_t& input, api_status* status,
+      std::shared_ptr<const zstd_dictionary>* dictionary = nullptr) const;
+  static int decompress(
+      generic_event::payload_buffer_t& buf, api_status* status, const zstd_dictionary* dictionary = nullptr);
 
-  explicit zstd_compressor(int level);
-  int compress(generic_event::payload_buffer_t& input, api_status* status) const;
-  static int decompress(generic_event::payload_buffer_t& buf, api_status* status);
+  bool uses_dictionaries() const { return _dictionary_size > 0; }
+  //! Trains a new dictionary once enough samples were collected, does nothing otherwise.
+  //! Training takes a while: it is called by the batcher thread, not by the threads compressing payloads.
+  void train_dictionary() const;
 
 private:
+  void add_sample(const uint8_t* data, size_t size) const;
+
   const int _level;
+  const size_t _dictionary_size;
+  const size_t _dictionary_samples;
+
+  // Training state. compress() is const and called concurrently by the transform threads.
+  mutable std::mutex _samples_mutex;
+  mutable std::vector<char> _samples;
+  mutable std::vector<size_t> _sample_sizes;
+  mutable std::shared_ptr<const zstd_dictionary> _current;  // read with std::atomic_load
 };
 
 class dedup_state
@@ -78,6 +196,8 @@ public:
   dedup_state(const utility::configuration& c, bool use_compression, bool use_dedup,
       std::unique_ptr<i_time_provider> time_provider);
 
+  // The dictionary does its own locking, dedup_state needs no lock of its own.
+
   string_view get_object(generic_event::object_id_t aid);
   float get_ewma_value() const;
 
@@ -89,7 +209,11 @@ public:
   int remove_all_values(I start, I end, api_status* status);
 
   void update_ewma(float value);
-  int compress(generic_event::payload_buffer_t& input, event_content_type& content_type, api_status* status) const;
+  int compress(generic_event::payload_buffer_t& input, event_content_type& content_type,
+      std::shared_ptr<const zstd_dictionary>& dictionary, api_status* status) const;
+  bool uses_compression_dictionaries() const { return _use_compression && _compressor.uses_dictionaries(); }
+  //! see zstd_compressor::train_dictionary()
+  void train_compression_dictionary() const;
   int transform_payload_and_add_objects(
       string_view payload, std::string& edited_payload, generic_event::object_list_t& object_ids, api_status* status);
 
@@ -103,13 +227,32 @@ private:
   ewma _ewma;
   dedup_dict _dict;
   zstd_compressor _compressor;
-  std::mutex _mutex;
   std::unique_ptr<i_time_provider> _time_provider;
   bool _use_compression;
   bool _use_dedup;
 };
 
 static const char* DEDUP_DICT_EVENT_ID = "3defd95a-0122-4aac-9068-0b9ac30b66d8";
+static const char* ZSTD_DICTIONARY_EVENT_ID = "8c3a9a1e-5f0b-4f8e-9d0e-2f7b6c1d4a53";
+
+// Ships the zstd dictionaries the events of a batch were compressed with, as ZstdDictionary events put in front of
+// the batch, and lists their ids in the batch content encoding.
+class compression_dictionary_builder
+{
+public:
+  explicit compression_dictionary_builder(dedup_state& state);
+
+  //! Keeps the dictionary the event payload was compressed with
+  void add(const generic_event& evt);
+  //! Prepends the dictionary events with serializer.prepend() and returns the batch content encoding
+  template <typename TSerializer>
+  int finalize(TSerializer& serializer, const char* base_encoding, std::string& content_encoding, const char* app_id,
+      api_status* status);
+
+private:
+  dedup_state& _state;
+  std::vector<std::shared_ptr<const zstd_dictionary>> _dictionaries;
+};
 class action_dict_builder
 {
 public:
@@ -123,14 +266,16 @@ private:
   dedup_state& _state;
   size_t _size_estimate;
   std::unordered_map<generic_event::object_id_t, size_t> _used_objects;
+  // Contents of the objects of the batch, looked up once when first seen. The references the batch holds keep them
+  // valid until finalize() releases them.
+  generic_event::object_list_t _action_ids;
+  std::vector<string_view> _action_values;
 };
 
 template <typename I>
 int dedup_state::get_all_values(I start, I end, generic_event::object_list_t& action_ids,
     std::vector<string_view>& action_values, api_status* status)
 {
-  std::unique_lock<std::mutex> mlock(_mutex);
-
   for (; start != end; ++start)
   {
     auto content = _dict.get_object(start->first);
@@ -148,7 +293,6 @@ int dedup_state::get_all_values(I start, I end, generic_event::object_list_t& ac
 template <typename I>
 int dedup_state::remove_all_values(I start, I end, api_status* status)
 {
-  std::unique_lock<std::mutex> mlock(_mutex);
   for (; start != end; ++start)
   {
     if (!_dict.remove_object(start->first, start->second))
@@ -159,4 +303,29 @@ int dedup_state::remove_all_values(I start, I end, api_status* status)
 
   return error_code::success;
 }
+
+template <typename TSerializer>
+int compression_dictionary_builder::finalize(TSerializer& serializer, const char* base_encoding,
+    std::string& content_encoding, const char* app_id, api_status* status)
+{
+  content_encoding = base_encoding;
+  if (_dictionaries.empty()) { return error_code::success; }
+
+  const auto now = _state.get_time_provider() != nullptr ? _state.get_time_provider()->gmt_now() : timestamp();
+  content_encoding += value::CONTENT_ENCODING_ZSTD_DICT_SUFFIX;
+  for (size_t i = 0; i < _dictionaries.size(); ++i)
+  {
+    const auto& content = _dictionaries[i]->content();
+    auto* data = flatbuffers::DefaultAllocator().allocate(content.size());
+    std::memcpy(data, content.data(), content.size());
+    generic_event evt(ZSTD_DICTIONARY_EVENT_ID, now, generic_event::payload_type_t::PayloadType_ZstdDictionary,
+        generic_event::payload_buffer_t(nullptr, false, data, 0, data, content.size()), event_content_type::IDENTITY,
+        app_id);
+    RETURN_IF_FAIL(serializer.prepend(evt, status));
+
+    if (i > 0) { content_encoding += ','; }
+    content_encoding += std::to_string(_dictionaries[i]->id());
+  }
+  return error_code::success;
+}
 }  // namespace reinforcement_learning
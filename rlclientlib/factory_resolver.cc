@@ -15,6 +15,7 @@
 
 #include "console_tracer.h"
 #include "error_callback_fn.h"
+#include "logger/file/buffered_file_logger.h"
 #include "logger/file/file_logger.h"
 #include "model_mgmt/file_model_loader.h"
 
@@ -95,7 +96,11 @@ int console_tracer_create(
 int file_sender_create(std::unique_ptr<i_sender>& retval, const u::configuration& cfg, const char* file_name,
     error_callback_fn* error_cb, i_trace* trace_logger, api_status* status)
 {
-  retval.reset(new logger::file::file_logger(file_name, trace_logger));
+  if (cfg.get_bool(name::FILE_WRITE_BEHIND, false))
+  {
+    retval.reset(new logger::file::buffered_file_logger(file_name, trace_logger, error_cb));
+  }
+  else { retval.reset(new logger::file::file_logger(file_name, trace_logger)); }
   return error_code::success;
 }
 
@@ -113,7 +118,10 @@ int file_model_loader_create(std::unique_ptr<m::i_data_transport>& retval, const
   TRACE_INFO(trace_logger, "File model loader created.");
   const char* file_name = config.get(name::MODEL_FILE_NAME, "current");
   const bool file_must_exist = config.get_bool(name::MODEL_FILE_MUST_EXIST, false);
-  auto file_loader = VW::make_unique<model_management::file_model_loader>(file_name, file_must_exist, trace_logger);
+  const bool use_mmap = config.get_bool(name::MODEL_FILE_MMAP, false);
+  const bool use_watcher = config.get_bool(name::MODEL_FILE_WATCH, false);
+  auto file_loader = VW::make_unique<model_management::file_model_loader>(
+      file_name, file_must_exist, trace_logger, use_mmap, use_watcher);
 
   const auto success = file_loader->init(status);
   if (success != error_code::success) { return success; }
@@ -39,10 +39,35 @@ generic_event::generic_event(const char* id, const timestamp& ts, payload_type_t
     , _event_index(0)
 {
 }
+void generic_event::reset(
+    const char* id, const timestamp& ts, payload_type_t type, string_view context, const char* app_id)
+{
+  _id.assign(id);
+  _client_time_gmt = ts;
+  _payload_type = type;
+  _payload = payload_buffer_t();
+  _payload_dictionary = nullptr;
+  _objects.clear();
+  _pass_prob = 1.f;
+  _content_type = event_content_type::IDENTITY;
+  _app_id.assign(app_id);
+  _event_index = 0;
+  _context_string.assign(context.data(), context.size());
+  _captured_size = 0;
+}
+
+size_t generic_event::memory_size() const
+{
+  return sizeof(generic_event) + _id.capacity() + _app_id.capacity() + _context_string.capacity() + _payload.size() +
+      _objects.capacity() * sizeof(object_id_t) + _captured_size;
+}
+
 bool generic_event::try_drop(float pass_prob, int drop_pass)
 {
   _pass_prob *= pass_prob;
-  return prg(drop_pass) > pass_prob;
+  const bool dropped = prg(drop_pass) > pass_prob;
+  if (dropped && _pool_owner != nullptr) { _pool_owner->release(); }
+  return dropped;
 }
 
 const char* generic_event::get_id() const { return _id.c_str(); }
@@ -69,6 +94,12 @@ generic_event::payload_type_t generic_event::get_payload_type() const { return _
 
 const generic_event::payload_buffer_t& generic_event::get_payload() const { return _payload; }
 
+void generic_event::clear_payload()
+{
+  _payload = payload_buffer_t();
+  _payload_dictionary = nullptr;
+}
+
 generic_event::encoding_type_t generic_event::get_encoding() const
 {
   switch (_content_type)
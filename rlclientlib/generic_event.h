@@ -6,6 +6,7 @@
 
 #include <flatbuffers/flatbuffers.h>
 
+#include <memory>
 #include <string>
 
 namespace reinforcement_learning
@@ -14,12 +15,22 @@ namespace logger
 {
 class i_logger_extensions;
 }
+class zstd_dictionary;
 enum class event_content_type
 {
   IDENTITY,
   ZSTD
 };
 
+// Owner of a generic_event that comes from a pool (see logger/event_record.h).
+class i_pooled_event
+{
+public:
+  virtual ~i_pooled_event() = default;
+  // Hands the event back to its pool. Called exactly once, after the event is consumed or dropped.
+  virtual void release() = 0;
+};
+
 class generic_event
 {
 public:
@@ -45,8 +56,15 @@ public:
   generic_event& operator=(generic_event&&) = default;
   ~generic_event() = default;
 
+  // Reuse this event for a new context, keeping the capacity of its strings.
+  void reset(const char* id, const timestamp& ts, payload_type_t type, string_view context, const char* app_id);
+
+  // A pooled event is released as soon as it is dropped by try_drop().
+  void set_pool_owner(i_pooled_event* owner) { _pool_owner = owner; }
+
   float get_pass_prob() const;
   timestamp get_client_time_gmt() const;
+  // If the event is dropped and comes from a pool it is handed back to its pool, it must not be used afterwards.
   bool try_drop(float pass_prob, int drop_pass);
 
   const object_list_t& get_object_list() const;
@@ -62,31 +80,52 @@ public:
   payload_type_t get_payload_type() const;
 
   const payload_buffer_t& get_payload() const;
+  // Frees the payload buffer, once it has been copied into a batch.
+  void clear_payload();
+
+  // zstd dictionary the payload was compressed with, kept alive until the batch shipping it is built
+  const std::shared_ptr<const zstd_dictionary>& get_payload_dictionary() const { return _payload_dictionary; }
+  void set_payload_dictionary(std::shared_ptr<const zstd_dictionary> dictionary)
+  {
+    _payload_dictionary = std::move(dictionary);
+  }
 
   encoding_type_t get_encoding() const;
 
   // context_string is only valid before the event is transformed
   const std::string& get_context_string() const { return _context_string; }
 
+  // Heap and object memory held by the event: strings, payload, object list, plus the captured size.
+  size_t memory_size() const;
+  // Memory held on behalf of the event until it is transformed: the serializer arguments captured by the closure or
+  // stored in the record that transforms it.
+  void set_captured_size(size_t bytes) { _captured_size = bytes; }
+
   // generate a serializable event
   // This only works with a context string, other event types cannot be transformed
   template <typename TSerializer, typename... Args>
-  int transform(logger::i_logger_extensions* ext, TSerializer& serializer, api_status* status, Args... args)
+  int transform(
+      logger::i_logger_extensions* ext, const TSerializer& serializer, api_status* status, const Args&... args)
   {
     assert(_context_string.size() > 0);
     if (!ext->is_object_extraction_enabled()) { _payload = serializer.event(_context_string, args...); }
     else
     {
       std::string tmp;
-      RETURN_IF_FAIL(ext->transform_payload_and_extract_objects(_context_string.c_str(), tmp, _objects, status));
-      _payload = serializer.event(tmp.c_str(), args...);
+      RETURN_IF_FAIL(ext->transform_payload_and_extract_objects(_context_string, tmp, _objects, status));
+      _payload = serializer.event(tmp, args...);
     }
     if (ext->is_serialization_transform_enabled())
     {
-      RETURN_IF_FAIL(ext->transform_serialized_payload(_payload, _content_type, status));
+      RETURN_IF_FAIL(ext->transform_serialized_payload(_payload, _content_type, _payload_dictionary, status));
+    }
+    else
+    {
+      _content_type = event_content_type::IDENTITY;
+      _payload_dictionary = nullptr;
     }
-    else { _content_type = event_content_type::IDENTITY; }
     _context_string.clear();
+    _captured_size = 0;
     return 0;
   }
 
@@ -98,11 +137,14 @@ protected:
   timestamp _client_time_gmt;
   payload_type_t _payload_type;
   payload_buffer_t _payload;
+  std::shared_ptr<const zstd_dictionary> _payload_dictionary;
   object_list_t _objects;
   float _pass_prob = 1.0;
   event_content_type _content_type;
   std::string _app_id;
   uint64_t _event_index;
   std::string _context_string;
+  i_pooled_event* _pool_owner = nullptr;
+  size_t _captured_size = 0;
 };
 }  // namespace reinforcement_learning
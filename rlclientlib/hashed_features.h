@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace reinforcement_learning
+{
+// Features of one namespace of an example, as the model hashed them
+struct hashed_namespace
+{
+  unsigned char index = 0;  // feature group
+  uint64_t hash = 0;        // namespace hash
+  std::vector<uint64_t> feature_hashes;
+  std::vector<float> values;
+};
+
+struct hashed_example
+{
+  std::vector<hashed_namespace> namespaces;
+};
+
+// Features a context was parsed into by the model, logged with the CB v2 interaction (interaction.hashed_features)
+// so that the trainer can fill its examples from them instead of parsing the json context again.
+struct hashed_features
+{
+  // the hashes are only valid for a parser hashing contexts the same way: same seed, bits, mask and parse options
+  uint32_t hash_seed = 0;
+  uint64_t parse_mask = 0;
+  uint32_t num_bits = 0;
+  // "--name value" for each option set that changes the features of a context (e.g. --ignore, --redefine, -q)
+  std::string parse_options;
+  // examples[0] is the shared example of a multiline context
+  bool shared = false;
+  std::vector<hashed_example> examples;
+
+  bool empty() const { return examples.empty(); }
+
+  void clear()
+  {
+    hash_seed = 0;
+    parse_mask = 0;
+    num_bits = 0;
+    parse_options.clear();
+    shared = false;
+    examples.clear();
+  }
+
+  // heap and object memory, see event_record
+  size_t memory_size() const
+  {
+    size_t res = sizeof(*this) + parse_options.capacity() + examples.capacity() * sizeof(hashed_example);
+    for (const auto& ex : examples)
+    {
+      res += ex.namespaces.capacity() * sizeof(hashed_namespace);
+      for (const auto& ns : ex.namespaces)
+      {
+        res += ns.feature_hashes.capacity() * sizeof(uint64_t) + ns.values.capacity() * sizeof(float);
+      }
+    }
+    return res;
+  }
+};
+}  // namespace reinforcement_learning
@@ -90,6 +90,13 @@ int live_model::choose_rank(
   return _pimpl->choose_rank(context_json, flags, response, status);
 }
 
+int live_model::choose_rank_batch(const std::vector<std::pair<const char*, string_view>>& requests, unsigned int flags,
+    std::vector<ranking_response>& responses, api_status* status)
+{
+  INIT_CHECK();
+  return _pimpl->choose_rank_batch(requests, flags, responses, status);
+}
+
 int live_model::request_continuous_action(const char* event_id, string_view context_json, unsigned int flags,
     continuous_action_response& response, api_status* status)
 {
@@ -258,6 +265,12 @@ int live_model::refresh_model(api_status* status)
   return _pimpl->refresh_model(status);
 }
 
+int live_model::get_logger_metrics(logger_metrics& interactions, logger_metrics& observations, api_status* status)
+{
+  INIT_CHECK();
+  return _pimpl->get_logger_metrics(interactions, observations, status);
+}
+
 int live_model::request_episodic_decision(const char* event_id, const char* previous_id, string_view context_json,
     ranking_response& resp, episode_state& episode, api_status* status)
 {
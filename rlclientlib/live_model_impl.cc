@@ -6,8 +6,10 @@
 #include "err_constants.h"
 #include "error_callback_fn.h"
 #include "factory_resolver.h"
+#include "hashed_features.h"
 #include "internal_constants.h"
 #include "logger/preamble_sender.h"
+#include "model_mgmt/delta_data_transport.h"
 #include "ranking_response.h"
 #include "sampling.h"
 #include "sender.h"
@@ -68,6 +70,7 @@ int live_model_impl::init(api_status* status)
   }
 
   _initial_epsilon = _configuration.get_float(name::INITIAL_EPSILON, 0.2f);
+  _log_hashed_features = _protocol_version == 2 && _configuration.get_bool(name::INTERACTION_HASHED_FEATURES, false);
   const char* app_id = _configuration.get(name::APP_ID, "");
   _seed_shift = VW::uniform_hash(app_id, strlen(app_id), 0);
 
@@ -90,8 +93,13 @@ int live_model_impl::choose_rank(
   std::vector<int> action_ids;
   std::vector<float> action_pdf;
   std::string model_version;
+  hashed_features features;
 
-  _model->choose_rank(event_id, seed, context, action_ids, action_pdf, model_version, status);
+  if (_log_hashed_features)
+  {
+    _model->choose_rank_hashed(event_id, seed, context, action_ids, action_pdf, model_version, features, status);
+  }
+  else { _model->choose_rank(event_id, seed, context, action_ids, action_pdf, model_version, status); }
 
   RETURN_IF_FAIL(sample_and_populate_response(
       seed, action_ids, action_pdf, std::move(model_version), response, _trace_logger.get(), status));
@@ -104,7 +112,11 @@ int live_model_impl::choose_rank(
     RETURN_IF_FAIL(reset_action_order(response));
   }
 
-  RETURN_IF_FAIL(_interaction_logger->log(context, flags, response, status, _learning_mode));
+  if (_log_hashed_features)
+  {
+    RETURN_IF_FAIL(_interaction_logger->log(context, flags, response, features, status, _learning_mode));
+  }
+  else { RETURN_IF_FAIL(_interaction_logger->log(context, flags, response, status, _learning_mode)); }
 
   if (_learning_mode == APPRENTICE)
   {
@@ -121,6 +133,69 @@ int live_model_impl::choose_rank(
   return error_code::success;
 }
 
+// Same steps as choose_rank(), each one run for the whole batch: a single model call ranks every context and the
+// interactions are logged together.
+int live_model_impl::choose_rank_batch(const std::vector<std::pair<const char*, string_view>>& requests,
+    unsigned int flags, std::vector<ranking_response>& responses, api_status* status)
+{
+  // clear previous errors if any
+  api_status::try_clear(status);
+
+  std::vector<const char*> event_ids;
+  std::vector<string_view> contexts;
+  std::vector<uint64_t> seeds;
+  event_ids.reserve(requests.size());
+  contexts.reserve(requests.size());
+  seeds.reserve(requests.size());
+  for (const auto& request : requests)
+  {
+    // check arguments
+    RETURN_IF_FAIL(check_null_or_empty(request.first, request.second, _trace_logger.get(), status));
+    event_ids.push_back(request.first);
+    contexts.push_back(request.second);
+    // The seed used is composed of uniform_hash(app_id) + uniform_hash(event_id)
+    seeds.push_back(VW::uniform_hash(request.first, strlen(request.first), 0) + _seed_shift);
+  }
+
+  std::vector<std::vector<int>> action_ids;
+  std::vector<std::vector<float>> action_pdfs;
+  std::vector<std::string> model_versions;
+  RETURN_IF_FAIL(
+      _model->choose_rank_batch(event_ids, seeds, contexts, action_ids, action_pdfs, model_versions, status));
+
+  responses.resize(requests.size());
+  for (size_t i = 0; i < requests.size(); ++i)
+  {
+    auto& response = responses[i];
+    response.clear();
+    RETURN_IF_FAIL(sample_and_populate_response(
+        seeds[i], action_ids[i], action_pdfs[i], std::move(model_versions[i]), response, _trace_logger.get(), status));
+    response.set_event_id(event_ids[i]);
+
+    if (_learning_mode == LOGGINGONLY)
+    {
+      // Reset the ranked action order before logging
+      RETURN_IF_FAIL(reset_action_order(response));
+    }
+  }
+
+  RETURN_IF_FAIL(_interaction_logger->log_batch(contexts, flags, responses, status, _learning_mode));
+
+  if (_learning_mode == APPRENTICE)
+  {
+    // Reset the ranked action order after logging
+    for (auto& response : responses) { RETURN_IF_FAIL(reset_action_order(response)); }
+  }
+
+  // Check watchdog for any background errors. Do this at the end of function so that the work is still done.
+  if (_watchdog.has_background_error_been_reported())
+  {
+    RETURN_ERROR_LS(_trace_logger.get(), status, unhandled_background_error_occurred);
+  }
+
+  return error_code::success;
+}
+
 // here the event_id is auto-generated
 int live_model_impl::choose_rank(
     string_view context, unsigned int flags, ranking_response& response, api_status* status)
@@ -414,13 +489,29 @@ int live_model_impl::refresh_model(api_status* status)
   RETURN_IF_FAIL(_transport->get_data(md, status));
 
   bool model_ready = false;
-  RETURN_IF_FAIL(_model->update(md, model_ready, status));
+  auto scode = _model->update(md, model_ready, status);
+  if (scode == error_code::model_delta_base_mismatch)
+  {
+    // the delta does not apply to the loaded model, fall back to the complete model right away
+    api_status::try_clear(status);
+    _transport->request_full_model();
+    md = model_management::model_data();
+    RETURN_IF_FAIL(_transport->get_data(md, status));
+    scode = _model->update(md, model_ready, status);
+  }
+  RETURN_IF_FAIL(scode);
 
   _model_ready = model_ready;
 
   return error_code::success;
 }
 
+int live_model_impl::get_logger_metrics(logger_metrics& interactions, logger_metrics& observations, api_status* status)
+{
+  RETURN_IF_FAIL(_interaction_logger->get_metrics(interactions, status));
+  return _outcome_logger->get_metrics(observations, status);
+}
+
 live_model_impl::live_model_impl(const utility::configuration& config, const error_fn fn, void* err_context,
     trace_logger_factory_t* trace_factory, data_transport_factory_t* t_factory, model_factory_t* m_factory,
     sender_factory_t* sender_factory, time_provider_factory_t* time_provider_factory)
@@ -611,7 +702,15 @@ void live_model_impl::handle_model_update(const model_management::model_data& da
 
   bool model_ready = false;
 
-  if (_model->update(data, model_ready, &status) != error_code::success)
+  const auto scode = _model->update(data, model_ready, &status);
+  if (scode == error_code::model_delta_base_mismatch)
+  {
+    // not an error: the next download is a complete model
+    TRACE_INFO(_trace_logger, status.get_error_msg());
+    _transport->request_full_model();
+    return;
+  }
+  if (scode != error_code::success)
   {
     _error_cb.report_error(status);
     return;
@@ -625,6 +724,16 @@ int live_model_impl::init_model_mgmt(api_status* status)
   const auto* const tranport_impl = _configuration.get(name::MODEL_SRC, value::get_default_data_transport());
   RETURN_IF_FAIL(_t_factory->create(_transport, tranport_impl, _configuration, status));
 
+  utility::configuration delta_config;
+  if (m::get_delta_config(_configuration, delta_config))
+  {
+    // same kind of transport, reading from the delta location
+    std::unique_ptr<m::i_data_transport> delta_transport;
+    RETURN_IF_FAIL(_t_factory->create(delta_transport, tranport_impl, delta_config, status));
+    _transport.reset(
+        new m::delta_data_transport(std::move(_transport), std::move(delta_transport), _trace_logger.get()));
+  }
+
   if (_bg_model_proc)
   {
     // Initialize background process and start downloading models
@@ -13,6 +13,8 @@
 #include <atomic>
 #include <functional>
 #include <memory>
+#include <utility>
+#include <vector>
 
 namespace reinforcement_learning
 {
@@ -32,6 +34,9 @@ public:
       const char* event_id, string_view context, unsigned int flags, ranking_response& response, api_status* status);
   // here the event_id is auto-generated
   int choose_rank(string_view context, unsigned int flags, ranking_response& response, api_status* status);
+  // one (event_id, context) pair per decision, responses are in the same order
+  int choose_rank_batch(const std::vector<std::pair<const char*, string_view>>& requests, unsigned int flags,
+      std::vector<ranking_response>& responses, api_status* status);
   int request_continuous_action(const char* event_id, string_view context, unsigned int flags,
       continuous_action_response& response, api_status* status);
   // here the event_id is auto-generated
@@ -63,6 +68,8 @@ public:
 
   int refresh_model(api_status* status);
 
+  int get_logger_metrics(logger_metrics& interactions, logger_metrics& observations, api_status* status);
+
   explicit live_model_impl(const utility::configuration& config, error_fn fn, void* err_context,
       trace_logger_factory_t* trace_factory, data_transport_factory_t* t_factory, model_factory_t* m_factory,
       sender_factory_t* sender_factory, time_provider_factory_t* time_provider_factory);
@@ -104,6 +111,8 @@ private:
   utility::watchdog _watchdog;
   learning_mode _learning_mode;
   const int _protocol_version;
+  // CB v2 interactions carry the features the model hashed the context into
+  bool _log_hashed_features = false;
 
   trace_logger_factory_t* _trace_factory;
   data_transport_factory_t* _t_factory;
@@ -0,0 +1,100 @@
+#pragma once
+
+#include "logger_metrics.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+namespace reinforcement_learning
+{
+namespace logger
+{
+// Bounds of the adaptive batching mode (send.adaptive_batching)
+struct adaptive_batching_config
+{
+  int min_interval_ms = 10;
+  int max_interval_ms = 1000;
+  size_t min_high_water_mark = 16 * 1024;
+  size_t max_high_water_mark = 1024 * 1024;
+};
+
+// Picks the async_batcher flush interval and batch size after every flush.
+// Batches are sized to hold what arrives in one interval, and the interval is the time it takes the queue to
+// accumulate a full batch:
+// - light traffic converges to long intervals and small batches instead of many tiny posts,
+// - heavy traffic converges to short intervals and large batches, flushed before the queue fills up.
+// When the sender falls behind (slow sends or a growing number of sends in flight), the interval is stretched so
+// that the same traffic goes out in fewer, larger batches.
+// Not thread safe: only the batcher thread updates it.
+class adaptive_batch_controller
+{
+public:
+  adaptive_batch_controller(
+      const adaptive_batching_config& config, int initial_interval_ms, size_t initial_high_water_mark)
+      : _config(config)
+  {
+    if (_config.min_interval_ms <= 0) { _config.min_interval_ms = 1; }
+    if (_config.max_interval_ms < _config.min_interval_ms) { _config.max_interval_ms = _config.min_interval_ms; }
+    if (_config.max_high_water_mark < _config.min_high_water_mark)
+    {
+      _config.max_high_water_mark = _config.min_high_water_mark;
+    }
+    _interval_ms = clamp(static_cast<float>(initial_interval_ms), static_cast<float>(_config.min_interval_ms),
+        static_cast<float>(_config.max_interval_ms));
+    _metrics.interval_ms = static_cast<int>(_interval_ms);
+    _metrics.high_water_mark = clamp(initial_high_water_mark, _config.min_high_water_mark, _config.max_high_water_mark);
+  }
+
+  // queued_bytes: bytes in the queue when the flush started
+  // elapsed_ms: time since the previous flush started
+  // send_ms: total time spent in send() during the flush, over batches_sent calls
+  // in_flight: sends still pending in the sender after the flush
+  void update(size_t queued_bytes, float elapsed_ms, float send_ms, size_t batches_sent, size_t in_flight, bool early)
+  {
+    ++_metrics.flushes;
+    if (early) { ++_metrics.early_flushes; }
+    if (elapsed_ms < 1.f) { elapsed_ms = 1.f; }
+
+    // the previous flush drained the queue: what is in it now arrived since then
+    _metrics.queue_growth_bytes_per_ms = smooth(_metrics.queue_growth_bytes_per_ms, queued_bytes / elapsed_ms);
+    if (batches_sent > 0) { _metrics.send_latency_ms = smooth(_metrics.send_latency_ms, send_ms / batches_sent); }
+
+    const float rate = _metrics.queue_growth_bytes_per_ms;
+    float target_ms = rate > 0.f ? static_cast<float>(_config.max_high_water_mark) / rate
+                                 : static_cast<float>(_config.max_interval_ms);
+
+    // flushing faster than the sender accepts batches only makes them smaller
+    if (target_ms < _metrics.send_latency_ms) { target_ms = _metrics.send_latency_ms; }
+    if (in_flight > _metrics.in_flight && in_flight > 0) { target_ms = (std::max)(target_ms, _interval_ms * 1.5f); }
+    _metrics.in_flight = in_flight;
+
+    _interval_ms = clamp(smooth(_interval_ms, target_ms), static_cast<float>(_config.min_interval_ms),
+        static_cast<float>(_config.max_interval_ms));
+    _metrics.interval_ms = static_cast<int>(_interval_ms);
+
+    // a batch holds what arrives during one interval, with some headroom for bursts
+    const auto batch_bytes = static_cast<size_t>(rate * _interval_ms * 2.f);
+    _metrics.high_water_mark = clamp(batch_bytes, _config.min_high_water_mark, _config.max_high_water_mark);
+  }
+
+  int interval_ms() const { return _metrics.interval_ms; }
+  size_t high_water_mark() const { return _metrics.high_water_mark; }
+  const batching_metrics& metrics() const { return _metrics; }
+
+private:
+  template <typename T>
+  static T clamp(T value, T low, T high)
+  {
+    return value < low ? low : (value > high ? high : value);
+  }
+
+  // moves halfway to the new observation, so that a single burst does not swing the parameters
+  static float smooth(float current, float observed) { return current + (observed - current) * 0.5f; }
+
+  adaptive_batching_config _config;
+  float _interval_ms;
+  batching_metrics _metrics;
+};
+}  // namespace logger
+}  // namespace reinforcement_learning
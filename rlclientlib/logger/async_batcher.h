@@ -1,12 +1,16 @@
 #pragma once
 
+#include "adaptive_batching.h"
 #include "api_status.h"
 #include "constants.h"
 #include "data_buffer.h"
 #include "err_constants.h"
 #include "error_callback_fn.h"
 #include "event_queue.h"
+#include "lock_free_event_queue.h"
+#include "sharded_event_queue.h"
 #include "message_sender.h"
+#include "transform_worker_pool.h"
 #include "rl_string_view.h"
 #include "serialization/fb_serializer.h"
 #include "serialization/json_serializer.h"
@@ -19,10 +23,14 @@
 // float comparisons
 #include "vw/core/vw_math.h"
 
+#include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <functional>
 #include <memory>
 #include <mutex>
+#include <thread>
+#include <vector>
 
 namespace reinforcement_learning
 {
@@ -44,8 +52,16 @@ public:
 
   virtual int append(TFunc&& func, TEvent* event, api_status* status = nullptr) = 0;
   virtual int append(TFunc& func, TEvent* event, api_status* status = nullptr) = 0;
+  // Queue count events with a single queue push.
+  virtual int append_batch(TFunc* funcs, TEvent* const* events, size_t count, api_status* status = nullptr) = 0;
 
   virtual int run_iteration(api_status* status) = 0;
+
+  // Flush interval and batch size currently used, the configured ones unless send.adaptive_batching is set, the
+  // memory currently held by the batcher and the utilization of its transform workers.
+  virtual batching_metrics get_batching_metrics() const = 0;
+  // Metrics of the requests of the sender the batches are shipped with, false if it does not track them.
+  virtual bool get_sender_metrics(http_sender_metrics& metrics) const = 0;
 };
 
 // This class takes uses a queue and a background thread to accumulate events, and send them by batch asynchronously.
@@ -65,13 +81,34 @@ public:
 
   int append(TFunc&& func, TEvent* event, api_status* status = nullptr) override;
   int append(TFunc& func, TEvent* event, api_status* status = nullptr) override;
+  int append_batch(TFunc* funcs, TEvent* const* events, size_t count, api_status* status = nullptr) override;
 
   int run_iteration(api_status* status) override;
 
+  batching_metrics get_batching_metrics() const override;
+  bool get_sender_metrics(http_sender_metrics& metrics) const override { return _sender->get_sender_metrics(metrics); }
+
 private:
+  // Bytes held by the queued events and by the batch being built, what send.queue.memory_cap.kb limits.
+  // Reported as batching_metrics::memory_bytes.
+  size_t memory_usage() const { return _queue->capacity() + _batcher_bytes.load(); }
+
   int fill_buffer(std::shared_ptr<utility::data_buffer>& retbuffer, size_t& remaining, api_status* status);
+  struct event_chunk;
+  // pop up to max_count events into chunk and start their transforms on the worker pool
+  void start_chunk(event_chunk& chunk, size_t max_count);
+  // wait for the transforms of the chunk started last, it can then be added to the batches
+  void finish_chunk(event_chunk& chunk);
 
   void flush();  // flush all batches
+  void wait_or_prune_if_full();
+  // adaptive batching: start flushing before the next tick once the queue reaches the fill threshold
+  void flush_early_if_needed();
+  // Enforces send.queue.memory_cap.kb before queuing an event of item_size bytes: waits in BLOCK mode, prunes the
+  // queue and then drops the event in DROP mode. Returns false if the event was dropped.
+  bool wait_or_drop_if_over_memory_cap(size_t item_size, TEvent* event);
+
+  static std::unique_ptr<i_event_queue<TEvent>> create_queue(const utility::async_batcher_config& config);
 
 public:
   async_batcher(std::unique_ptr<i_message_sender> sender, utility::watchdog& watchdog, shared_state_t& shared_state,
@@ -81,7 +118,7 @@ public:
 private:
   std::unique_ptr<i_message_sender> _sender;
 
-  event_queue<TEvent> _queue;  // A queue to accumulate batch of events.
+  std::unique_ptr<i_event_queue<TEvent>> _queue;  // A queue to accumulate batch of events.
   size_t _send_high_water_mark;
   error_callback_fn* _perror_cb;
   shared_state_t& _shared_state;
@@ -96,6 +133,39 @@ private:
   float _subsample_rate;
   events_counter_status _events_counter_status;
   uint64_t _buffer_end_event_index = 0;
+
+  // transform workers, only used if send.transform.threads > 0
+  std::unique_ptr<transform_worker_pool<TEvent>> _transform_pool;
+  struct event_chunk
+  {
+    std::vector<TFunc> funcs;
+    std::vector<TEvent> events;
+    std::vector<int> results;
+    std::vector<api_status> statuses;
+    size_t size = 0;  // number of events in the chunk
+    size_t next = 0;  // next transformed event to add to a batch
+  };
+  // the batcher thread adds the transformed events of _chunks[_current_chunk] to the batches while the workers
+  // transform the next events in the other chunk
+  event_chunk _chunks[2];
+  size_t _current_chunk = 0;
+
+  // adaptive batching, only used if send.adaptive_batching is set
+  std::unique_ptr<adaptive_batch_controller> _batch_controller;
+  size_t _flush_threshold_bytes = 0;
+  std::atomic<bool> _early_flush{false};
+  std::chrono::steady_clock::time_point _last_flush;
+  mutable std::mutex _metrics_mutex;
+  batching_metrics _metrics;
+
+  // memory accounting, _memory_cap == 0 disables the cap
+  size_t _memory_cap;
+  std::atomic<size_t> _batcher_bytes{0};  // popped events and batch being built, not sent yet
+  size_t _batch_bytes = 0;                 // part of _batcher_bytes taken by the batch being built
+  size_t _chunk_bytes = 0;                 // part of _batcher_bytes taken by the transformed chunks
+  std::atomic<uint64_t> _memory_cap_drops{0};
+  std::condition_variable _memory_cv;        // notified by flush() once a sent batch released its memory
+  std::atomic<bool> _over_memory_cap{false};  // set when the cap is crossed in DROP mode, the queue is pruned once
 };
 
 template <typename TEvent, template <typename> class TSerializer>
@@ -115,30 +185,97 @@ int async_batcher<TEvent, TSerializer>::init(api_status* status)
 template <typename TEvent, template <typename> class TSerializer>
 int async_batcher<TEvent, TSerializer>::append(TFunc&& func, TEvent* event, api_status* status)
 {
-  // If subsampling rate is < 1, then run subsampling logic
-  if (_subsample_rate < 1.f)
+  // subsampling is done by the queue, after the event index is assigned
+  const auto item_size = TSerializer<TEvent>::serializer_t::size_estimate(*event);
+  if (!wait_or_drop_if_over_memory_cap(item_size, event)) { return error_code::success; }
+  // the queue released the event if it dropped it, a full queue in DROP mode still needs to be pruned
+  if (!_queue->push(std::move(func), item_size, event))
   {
-    if (event->try_drop(_subsample_rate, constants::SUBSAMPLE_RATE_DROP_PASS))
-    {
-      // If the event is dropped, just get out of here
-      return error_code::success;
-    }
+    wait_or_prune_if_full();
+    return error_code::success;
+  }
+
+  flush_early_if_needed();
+  wait_or_prune_if_full();
+  return error_code::success;
+}
+
+template <typename TEvent, template <typename> class TSerializer>
+int async_batcher<TEvent, TSerializer>::append_batch(
+    TFunc* funcs, TEvent* const* events, size_t count, api_status* status)
+{
+  // the memory cap drops events one by one, go through append()
+  if (_memory_cap > 0)
+  {
+    for (size_t i = 0; i < count; ++i) { RETURN_IF_FAIL(append(std::move(funcs[i]), events[i], status)); }
+    return error_code::success;
   }
 
-  _queue.push(std::move(func), TSerializer<TEvent>::serializer_t::size_estimate(*event), event);
+  std::vector<size_t> sizes(count);
+  for (size_t i = 0; i < count; ++i) { sizes[i] = TSerializer<TEvent>::serializer_t::size_estimate(*events[i]); }
+  _queue->push_batch(funcs, sizes.data(), events, count);
 
+  flush_early_if_needed();
+  wait_or_prune_if_full();
+  return error_code::success;
+}
+
+template <typename TEvent, template <typename> class TSerializer>
+void async_batcher<TEvent, TSerializer>::wait_or_prune_if_full()
+{
   // block or drop events if the queue if full
-  if (_queue.is_full())
+  if (_queue->is_full())
   {
     if (queue_mode_enum::BLOCK == _queue_mode)
     {
       std::unique_lock<std::mutex> lk(_m);
-      _cv.wait(lk, [this] { return !_queue.is_full(); });
+      _cv.wait(lk, [this] { return !_queue->is_full(); });
     }
-    else if (queue_mode_enum::DROP == _queue_mode) { _queue.prune(_pass_prob); }
+    else if (queue_mode_enum::DROP == _queue_mode) { _queue->prune(_pass_prob); }
   }
+}
 
-  return error_code::success;
+template <typename TEvent, template <typename> class TSerializer>
+bool async_batcher<TEvent, TSerializer>::wait_or_drop_if_over_memory_cap(size_t item_size, TEvent* event)
+{
+  // an event larger than the cap still goes through an empty batcher
+  const auto fits = [this, item_size]
+  {
+    const auto usage = memory_usage();
+    return usage + item_size <= _memory_cap || usage == 0;
+  };
+  if (_memory_cap == 0) { return true; }
+  if (fits())
+  {
+    if (_over_memory_cap.load(std::memory_order_relaxed)) { _over_memory_cap.store(false); }
+    return true;
+  }
+
+  if (queue_mode_enum::BLOCK == _queue_mode)
+  {
+    std::unique_lock<std::mutex> lk(_m);
+    _memory_cv.wait(lk, fits);
+    return true;
+  }
+
+  // lowest priority events go first, once per crossing of the cap rather than for every event over it
+  if (!_over_memory_cap.exchange(true))
+  {
+    _queue->prune(_pass_prob);
+    if (fits()) { return true; }
+  }
+  // dropped by the queue so that it is indexed as a pruned event would be
+  _queue->drop(event);
+  ++_memory_cap_drops;
+  return false;
+}
+
+template <typename TEvent, template <typename> class TSerializer>
+void async_batcher<TEvent, TSerializer>::flush_early_if_needed()
+{
+  if (_batch_controller == nullptr || _queue->capacity() < _flush_threshold_bytes) { return; }
+  // wake the batcher thread once, flush() clears the flag
+  if (!_early_flush.exchange(true)) { _periodic_background_proc.wake(); }
 }
 
 template <typename TEvent, template <typename> class TSerializer>
@@ -160,23 +297,71 @@ int async_batcher<TEvent, TSerializer>::fill_buffer(
 {
   TFunc f_evt;
   TEvent evt;
+  // Queues fed by concurrent producers do not pop events strictly in index order, track the highest index seen
+  // instead of the last one.
+  uint64_t buffer_end_event_index = _buffer_end_event_index;
   TSerializer<TEvent> collection_serializer(*buffer.get(), _batch_content_encoding, _shared_state);
+  // the batch memory is accounted as it grows and released by flush() once the batch is sent
+  const auto account_batch = [this, &collection_serializer]
+  {
+    const auto batch_bytes = static_cast<size_t>(collection_serializer.size());
+    if (batch_bytes > _batch_bytes)
+    {
+      _batcher_bytes += batch_bytes - _batch_bytes;
+      _batch_bytes = batch_bytes;
+    }
+  };
 
   while (remaining > 0 && collection_serializer.size() < _send_high_water_mark)
   {
-    if (_queue.pop(&f_evt))
+    if (_transform_pool != nullptr)
+    {
+      // Events left over when the previous batch reached the high water mark are added first.
+      // The chunks never hold more than remaining events between them, so they are empty once the flush is done.
+      auto* chunk = &_chunks[_current_chunk];
+      if (chunk->next == chunk->size)
+      {
+        chunk->size = chunk->next = 0;
+        _current_chunk = 1 - _current_chunk;
+        chunk = &_chunks[_current_chunk];
+        // the next chunk is normally started while the previous one is batched, except for the first one
+        if (chunk->size == 0) { start_chunk(*chunk, remaining); }
+        finish_chunk(*chunk);
+        if (chunk->size == 0) { continue; }
+        // transform the following events while this chunk is batched
+        start_chunk(_chunks[1 - _current_chunk], remaining - chunk->size);
+      }
+
+      const size_t i = chunk->next++;
+      --remaining;
+      if (chunk->results[i] != error_code::success)
+      {
+        api_status::try_update(status, chunk->results[i], chunk->statuses[i].get_error_msg());
+        return chunk->results[i];
+      }
+      auto& transformed = chunk->events[i];
+      const auto event_bytes = TSerializer<TEvent>::serializer_t::size_estimate(transformed);
+      buffer_end_event_index = (std::max)(buffer_end_event_index, transformed.get_event_index());
+      RETURN_IF_FAIL(collection_serializer.add(transformed, status));
+      _chunk_bytes -= event_bytes;
+      _batcher_bytes -= event_bytes;
+      account_batch();
+    }
+    else if (_queue->pop(&f_evt))
     {
       if (queue_mode_enum::BLOCK == _queue_mode) { _cv.notify_one(); }
       RETURN_IF_FAIL(f_evt(evt, status));
+      buffer_end_event_index = (std::max)(buffer_end_event_index, evt.get_event_index());
       RETURN_IF_FAIL(collection_serializer.add(evt, status));
       --remaining;
+      account_batch();
     }
   }
 
   if (_events_counter_status == events_counter_status::ENABLE)
   {
     uint64_t buffer_start_event_index = _buffer_end_event_index;
-    _buffer_end_event_index = evt.get_event_index();
+    _buffer_end_event_index = buffer_end_event_index;
     uint64_t original_event_count = (_buffer_end_event_index - buffer_start_event_index);
     RETURN_IF_FAIL(collection_serializer.finalize(status, original_event_count));
   }
@@ -185,14 +370,63 @@ int async_batcher<TEvent, TSerializer>::fill_buffer(
 }
 
 template <typename TEvent, template <typename> class TSerializer>
-void async_batcher<TEvent, TSerializer>::flush()
+void async_batcher<TEvent, TSerializer>::start_chunk(event_chunk& chunk, size_t max_count)
 {
-  const auto queue_size = _queue.size();
+  size_t count = 0;
+  const size_t chunk_capacity = chunk.funcs.size();
+  while (count < max_count && count < chunk_capacity && _queue->pop(&chunk.funcs[count]))
+  {
+    if (queue_mode_enum::BLOCK == _queue_mode) { _cv.notify_one(); }
+    ++count;
+  }
+  chunk.size = count;
+  chunk.next = 0;
+  _transform_pool->start(chunk.funcs.data(), chunk.events.data(), chunk.results.data(), chunk.statuses.data(), count);
+}
 
-  // Early exit if queue is empty.
-  if (queue_size == 0) { return; }
+template <typename TEvent, template <typename> class TSerializer>
+void async_batcher<TEvent, TSerializer>::finish_chunk(event_chunk& chunk)
+{
+  _transform_pool->wait();
+  // release the closures (and whatever they captured) now rather than when the slot is reused
+  for (size_t i = 0; i < chunk.size; ++i) { chunk.funcs[i] = nullptr; }
+  // The transformed events left the queue accounting when popped, they are accounted to the batcher until batched.
+  // Events being transformed are in neither, at most one chunk of them.
+  size_t chunk_bytes = 0;
+  for (size_t i = 0; i < chunk.size; ++i)
+  {
+    chunk_bytes += TSerializer<TEvent>::serializer_t::size_estimate(chunk.events[i]);
+  }
+  _chunk_bytes += chunk_bytes;
+  _batcher_bytes += chunk_bytes;
+}
+
+template <typename TEvent, template <typename> class TSerializer>
+batching_metrics async_batcher<TEvent, TSerializer>::get_batching_metrics() const
+{
+  batching_metrics res;
+  {
+    std::lock_guard<std::mutex> lock(_metrics_mutex);
+    res = _metrics;
+  }
+  res.memory_bytes = memory_usage();
+  res.memory_cap_drops = _memory_cap_drops.load();
+  res.transform_utilization = _transform_pool != nullptr ? _transform_pool->utilization() : 0.f;
+  return res;
+}
+
+template <typename TEvent, template <typename> class TSerializer>
+void async_batcher<TEvent, TSerializer>::flush()
+{
+  using clock_type = std::chrono::steady_clock;
+  const bool early = _early_flush.exchange(false);
+  const auto flush_start = clock_type::now();
+  const auto queued_bytes = _queue->capacity();
+  const auto queue_size = _queue->size();
 
   auto remaining = queue_size;
+  size_t batches_sent = 0;
+  clock_type::duration send_time{0};
   // Handle batching
   while (remaining > 0)
   {
@@ -200,11 +434,55 @@ void async_batcher<TEvent, TSerializer>::flush()
 
     auto buffer = _buffer_pool->acquire();
     if (fill_buffer(buffer, remaining, &status) != error_code::success) { ERROR_CALLBACK(_perror_cb, status); }
+    const auto send_start = clock_type::now();
     if (_sender->send(TSerializer<TEvent>::message_id(), buffer, &status) != error_code::success)
     {
       ERROR_CALLBACK(_perror_cb, status);
     }
+    send_time += clock_type::now() - send_start;
+    ++batches_sent;
+
+    // the buffer now belongs to the sender
+    _batcher_bytes -= _batch_bytes;
+    _batch_bytes = 0;
+    if (queue_mode_enum::BLOCK == _queue_mode && _memory_cap > 0)
+    {
+      // a producer checks the usage under _m before waiting, taking it here makes sure the release is not missed
+      { std::lock_guard<std::mutex> lk(_m); }
+      _memory_cv.notify_all();
+    }
   }
+
+  if (_batch_controller == nullptr) { return; }
+
+  // empty queues are reported too, the controller needs them to notice the traffic going down
+  using ms = std::chrono::duration<float, std::milli>;
+  _batch_controller->update(queued_bytes, std::chrono::duration_cast<ms>(flush_start - _last_flush).count(),
+      std::chrono::duration_cast<ms>(send_time).count(), batches_sent, _sender->in_flight_count(), early);
+  _last_flush = flush_start;
+  _send_high_water_mark = _batch_controller->high_water_mark();
+  _periodic_background_proc.set_interval_ms(_batch_controller->interval_ms());
+  std::lock_guard<std::mutex> lock(_metrics_mutex);
+  _metrics = _batch_controller->metrics();
+}
+
+template <typename TEvent, template <typename> class TSerializer>
+std::unique_ptr<i_event_queue<TEvent>> async_batcher<TEvent, TSerializer>::create_queue(
+    const utility::async_batcher_config& config)
+{
+  if (config.queue_implementation == queue_implementation_enum::LOCK_FREE)
+  {
+    return std::unique_ptr<i_event_queue<TEvent>>(new lock_free_event_queue<TEvent>(config.send_queue_max_capacity,
+        config.queue_ring_size, config.queue_mode, config.event_counter_status, config.subsample_rate));
+  }
+  if (config.queue_implementation == queue_implementation_enum::SHARDED)
+  {
+    size_t shards = config.queue_shards > 0 ? config.queue_shards : std::thread::hardware_concurrency();
+    return std::unique_ptr<i_event_queue<TEvent>>(new sharded_event_queue<TEvent>(
+        config.send_queue_max_capacity, shards, config.event_counter_status, config.subsample_rate));
+  }
+  return std::unique_ptr<i_event_queue<TEvent>>(
+      new event_queue<TEvent>(config.send_queue_max_capacity, config.event_counter_status, config.subsample_rate));
 }
 
 template <typename TEvent, template <typename> class TSerializer>
@@ -212,19 +490,57 @@ async_batcher<TEvent, TSerializer>::async_batcher(std::unique_ptr<i_message_send
     typename TSerializer<TEvent>::shared_state_t& shared_state, error_callback_fn* perror_cb,
     const utility::async_batcher_config& config)
     : _sender(std::move(sender))
-    , _queue(config.send_queue_max_capacity, config.event_counter_status, config.subsample_rate)
+    , _queue(create_queue(config))
     , _send_high_water_mark(config.send_high_water_mark)
     , _perror_cb(perror_cb)
     , _shared_state(shared_state)
-    , _periodic_background_proc(
-          static_cast<int>(config.send_batch_interval_ms), watchdog, "Async batcher thread", perror_cb)
+    , _periodic_background_proc(config.adaptive_batching
+              ? (std::max)(config.send_batch_interval_ms, config.batch_interval_max_ms)
+              : static_cast<int>(config.send_batch_interval_ms),
+          watchdog, "Async batcher thread", perror_cb)
     , _pass_prob(0.5)
     , _queue_mode(config.queue_mode)
     , _batch_content_encoding(config.batch_content_encoding)
     , _subsample_rate(config.subsample_rate)
     , _events_counter_status(config.event_counter_status)
+    , _memory_cap(config.send_queue_memory_cap)
 {
   _buffer_pool = utility::object_pool<utility::data_buffer>::create();
+  if (config.transform_threads > 0)
+  {
+    const auto threads = static_cast<size_t>(config.transform_threads);
+    _transform_pool.reset(new transform_worker_pool<TEvent>(threads));
+    // enough events per chunk for every worker to amortize its wake up
+    const size_t chunk_capacity = threads * 64;
+    for (auto& chunk : _chunks)
+    {
+      chunk.funcs.resize(chunk_capacity);
+      chunk.events.resize(chunk_capacity);
+      chunk.results.resize(chunk_capacity);
+      chunk.statuses.resize(chunk_capacity);
+    }
+  }
+
+  if (config.adaptive_batching)
+  {
+    adaptive_batching_config bounds;
+    bounds.min_interval_ms = config.batch_interval_min_ms;
+    bounds.max_interval_ms = config.batch_interval_max_ms;
+    bounds.min_high_water_mark = static_cast<size_t>(config.send_high_water_mark_min);
+    bounds.max_high_water_mark = static_cast<size_t>(config.send_high_water_mark_max);
+    _batch_controller.reset(
+        new adaptive_batch_controller(bounds, config.send_batch_interval_ms, config.send_high_water_mark));
+    _send_high_water_mark = _batch_controller->high_water_mark();
+    _periodic_background_proc.set_interval_ms(_batch_controller->interval_ms());
+    _flush_threshold_bytes = static_cast<size_t>(config.send_queue_max_capacity * config.send_queue_flush_threshold);
+    _last_flush = std::chrono::steady_clock::now();
+    _metrics = _batch_controller->metrics();
+  }
+  else
+  {
+    _metrics.interval_ms = config.send_batch_interval_ms;
+    _metrics.high_water_mark = _send_high_water_mark;
+  }
 }
 
 template <typename TEvent, template <typename> class TSerializer>
@@ -232,7 +548,9 @@ async_batcher<TEvent, TSerializer>::~async_batcher()
 {
   // Stop the background procedure the queue before exiting
   _periodic_background_proc.stop();
-  if (_queue.size() > 0) { flush(); }
+  if (_queue->size() > 0) { flush(); }
+  // the workers may still be transforming a chunk if a flush stopped on an error
+  if (_transform_pool != nullptr) { _transform_pool->wait(); }
 }
 }  // namespace logger
 }  // namespace reinforcement_learning
@@ -5,7 +5,9 @@
 #include "configuration.h"
 #include "constants.h"
 #include "error_callback_fn.h"
+#include "event_record.h"
 #include "learning_mode.h"
+#include "logger_metrics.h"
 #include "message_sender.h"
 #include "ranking_event.h"
 #include "ranking_response.h"
@@ -20,6 +22,8 @@
 
 #include <functional>
 #include <memory>
+#include <mutex>
+#include <vector>
 
 namespace reinforcement_learning
 {
@@ -42,9 +46,12 @@ public:
 
   int init(api_status* status);
 
+  void get_metrics(logger_metrics& metrics) const;
+
 protected:
   int append(TFunc&& func, TEvent* event, api_status* status);
   int append(TFunc& func, TEvent* event, api_status* status);
+  int append_batch(TFunc* funcs, TEvent* const* events, size_t count, api_status* status);
 
 protected:
   bool _initialized = false;
@@ -78,6 +85,13 @@ int event_logger<TEvent>::init(api_status* status)
   return error_code::success;
 }
 
+template <typename TEvent>
+void event_logger<TEvent>::get_metrics(logger_metrics& metrics) const
+{
+  metrics.batching = _batcher->get_batching_metrics();
+  metrics.has_sender_metrics = _batcher->get_sender_metrics(metrics.sender);
+}
+
 template <typename TEvent>
 int event_logger<TEvent>::append(TFunc&& func, TEvent* event, api_status* status)
 {
@@ -97,6 +111,18 @@ int event_logger<TEvent>::append(TFunc& func, TEvent* event, api_status* status)
   return append(std::move(func), status);
 }
 
+template <typename TEvent>
+int event_logger<TEvent>::append_batch(TFunc* funcs, TEvent* const* events, size_t count, api_status* status)
+{
+  if (!_initialized)
+  {
+    api_status::try_update(status, error_code::not_initialized, "Logger not initialized. Call init() first.");
+    return error_code::not_initialized;
+  }
+
+  return _batcher->append_batch(funcs, events, count, status);
+}
+
 class interaction_logger : public event_logger<ranking_event>
 {
 public:
@@ -193,9 +219,61 @@ public:
       out_evt = std::move(*evt_sp);
       return error_code::success;
     };
+    evt_sp->set_captured_size(details::captured_size_all(args...));
     return append(std::move(evt_fn), evt_sp.get(), status);
   }
 
+  // Allocation-free alternative to the log() above: the serializer arguments were written into a pooled record
+  // (see generic_event_record) and the queue only holds a pointer to it.
+  template <typename TSerializer, typename... Args>
+  int log(generic_event_record<TSerializer, Args...>* record, const char* event_id, string_view context,
+      generic_event::payload_type_t type, i_logger_extensions* ext, api_status* status)
+  {
+    const auto now = _time_provider != nullptr ? _time_provider->gmt_now() : timestamp();
+    record->prepare(event_id, now, type, context, _app_id, ext);
+    record->get_event().set_captured_size(record->args_size());
+    // capturing a single pointer lets std::function store the closure without allocating
+    auto evt_fn = [record](generic_event& out_evt, api_status* status) -> int
+    { return record->transform(out_evt, status); };
+    const int res = append(std::move(evt_fn), &record->get_event(), status);
+    // the record was not queued
+    if (res == error_code::not_initialized) { record->release(); }
+    return res;
+  }
+
+  // Batched version of the record log() above: all the records are queued with a single push.
+  template <typename TSerializer, typename... Args>
+  int log_batch(generic_event_record<TSerializer, Args...>* const* records, const char* const* event_ids,
+      const string_view* contexts, size_t count, generic_event::payload_type_t type, i_logger_extensions* ext,
+      api_status* status)
+  {
+    const auto now = _time_provider != nullptr ? _time_provider->gmt_now() : timestamp();
+    // reuse the member buffers unless another thread is logging a batch, which then allocates its own
+    std::unique_lock<std::mutex> lock(_batch_mutex, std::try_to_lock);
+    std::vector<TFunc> local_funcs;
+    std::vector<generic_event*> local_events;
+    auto& funcs = lock.owns_lock() ? _batch_funcs : local_funcs;
+    auto& events = lock.owns_lock() ? _batch_events : local_events;
+    funcs.resize(count);
+    events.resize(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+      auto* record = records[i];
+      record->prepare(event_ids[i], now, type, contexts[i], _app_id, ext);
+      record->get_event().set_captured_size(record->args_size());
+      funcs[i] = [record](generic_event& out_evt, api_status* status) -> int
+      { return record->transform(out_evt, status); };
+      events[i] = &record->get_event();
+    }
+    const int res = append_batch(funcs.data(), events.data(), count, status);
+    // the records were not queued
+    if (res == error_code::not_initialized)
+    {
+      for (size_t i = 0; i < count; ++i) { records[i]->release(); }
+    }
+    return res;
+  }
+
   // TODO: used for observations for now.. may want to change that later
   // These functions will take in fully transformed generic_event objects, and should only be used
   // when the creation of those types are very cheap
@@ -203,6 +281,12 @@ public:
       event_content_type content_type, api_status* status);
   int log(const char* event_id, generic_event::payload_buffer_t&& payload, generic_event::payload_type_t type,
       event_content_type content_type, generic_event::object_list_t&& objects, api_status* status);
+
+private:
+  // scratch buffers of log_batch()
+  std::mutex _batch_mutex;
+  std::vector<TFunc> _batch_funcs;
+  std::vector<generic_event*> _batch_events;
 };
 }  // namespace logger
 }  // namespace reinforcement_learning
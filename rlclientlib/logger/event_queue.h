@@ -4,6 +4,7 @@
 #include "ranking_event.h"
 #include "utility/config_helper.h"
 
+#include <functional>
 #include <list>
 #include <mutex>
 #include <queue>
@@ -11,13 +12,44 @@
 
 namespace reinforcement_learning
 {
-// a moving concurrent queue with locks and mutex
+// Interface shared by the queues an async_batcher can accumulate events in.
+// Producers call push() concurrently, a single consumer calls pop().
 template <class T>
-class event_queue
+class i_event_queue
 {
 public:
   using TFunc = std::function<int(T&, api_status*)>;
 
+  virtual ~i_event_queue() = default;
+
+  virtual bool pop(TFunc* item) = 0;
+  virtual bool push(TFunc&& item, size_t item_size, T* event) = 0;
+  // Pushes count items at once, in order. Returns the number of items queued (the others were subsampled out).
+  virtual size_t push_batch(TFunc* items, const size_t* item_sizes, T* const* events, size_t count)
+  {
+    size_t queued = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+      if (push(std::move(items[i]), item_sizes[i], events[i])) { ++queued; }
+    }
+    return queued;
+  }
+  virtual void prune(float pass_prob) = 0;
+  // Drops an event instead of queuing it. The event still takes an event index, as a subsampled or pruned event
+  // does, so that the batches still count it.
+  virtual void drop(T* event) = 0;
+  virtual size_t size() = 0;
+  virtual bool is_full() const = 0;
+  virtual size_t capacity() const = 0;
+};
+
+// a moving concurrent queue with locks and mutex
+template <class T>
+class event_queue : public i_event_queue<T>
+{
+public:
+  using TFunc = typename i_event_queue<T>::TFunc;
+
 private:
   // T's lifetime is tied to TFunc
   using queue_t = std::list<std::tuple<TFunc, size_t, T*>>;
@@ -39,13 +71,23 @@ public:
   {
   }
 
-  bool pop(TFunc* item)
+  bool pop(TFunc* item) override
+  {
+    size_t item_size;
+    T* event;
+    return pop(item, &item_size, &event);
+  }
+
+  // Also returns the size the item was pushed with and its event, which lives as long as the item.
+  bool pop(TFunc* item, size_t* item_size, T** event)
   {
     std::unique_lock<std::mutex> mlock(_mutex);
     if (!_queue.empty())
     {
       auto entry(std::move(_queue.front()));
       *item = std::move(std::get<0>(entry));
+      *item_size = std::get<1>(entry);
+      *event = std::get<2>(entry);
       _capacity = (std::max)(0, static_cast<int>(_capacity) - static_cast<int>(std::get<1>(entry)));
       _queue.pop_front();
       return true;
@@ -55,7 +97,7 @@ public:
 
   bool push(TFunc& item, size_t item_size, T* event) { return push(std::move(item), item_size, event); }
 
-  bool push(TFunc&& item, size_t item_size, T* event)
+  bool push(TFunc&& item, size_t item_size, T* event) override
   {
     std::unique_lock<std::mutex> mlock(_mutex);
     if (_event_counter_status == events_counter_status::ENABLE)
@@ -77,7 +119,41 @@ public:
     return true;
   }
 
-  void prune(float pass_prob)
+  // same as push() for every item, under a single lock acquisition
+  size_t push_batch(TFunc* items, const size_t* item_sizes, T* const* events, size_t count) override
+  {
+    std::unique_lock<std::mutex> mlock(_mutex);
+    size_t queued = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+      if (_event_counter_status == events_counter_status::ENABLE)
+      {
+        ++_event_index;
+        events[i]->set_event_index(_event_index);
+      }
+      if (_subsample_rate < 1 && events[i]->try_drop(_subsample_rate, constants::SUBSAMPLE_RATE_DROP_PASS))
+      {
+        continue;
+      }
+      _capacity += item_sizes[i];
+      _queue.emplace_back(std::move(items[i]), item_sizes[i], events[i]);
+      ++queued;
+    }
+    return queued;
+  }
+
+  void drop(T* event) override
+  {
+    std::unique_lock<std::mutex> mlock(_mutex);
+    if (_event_counter_status == events_counter_status::ENABLE)
+    {
+      ++_event_index;
+      event->set_event_index(_event_index);
+    }
+    event->try_drop(0.f, _drop_pass);
+  }
+
+  void prune(float pass_prob) override
   {
     std::unique_lock<std::mutex> mlock(_mutex);
     if (!is_full()) return;
@@ -89,15 +165,15 @@ public:
   }
 
   // approximate size
-  size_t size()
+  size_t size() override
   {
     std::unique_lock<std::mutex> mlock(_mutex);
     return _queue.size();
   }
 
-  bool is_full() const { return capacity() >= _max_capacity; }
+  bool is_full() const override { return capacity() >= _max_capacity; }
 
-  size_t capacity() const { return _capacity; }
+  size_t capacity() const override { return _capacity; }
 
 private:
   // thread-unsafe
@@ -0,0 +1,188 @@
+#pragma once
+
+#include "api_status.h"
+#include "err_constants.h"
+#include "generic_event.h"
+#include "hashed_features.h"
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace reinforcement_learning
+{
+namespace logger
+{
+namespace details
+{
+// C++11 replacement for std::index_sequence
+template <size_t... I>
+struct index_sequence
+{
+};
+
+template <size_t N, size_t... I>
+struct make_index_sequence : make_index_sequence<N - 1, N - 1, I...>
+{
+};
+
+template <size_t... I>
+struct make_index_sequence<0, I...> : index_sequence<I...>
+{
+};
+
+// Memory held by a copy of a serializer argument, heap allocations included.
+template <typename T>
+size_t captured_size(const T&)
+{
+  return sizeof(T);
+}
+inline size_t captured_size(const std::string& value) { return sizeof(value) + value.capacity(); }
+inline size_t captured_size(const hashed_features& value) { return value.memory_size(); }
+template <typename T>
+size_t captured_size(const std::vector<T>& value)
+{
+  // elements may own memory themselves (vectors of vectors for slates and multi slot events)
+  size_t res = sizeof(value) + (value.capacity() - value.size()) * sizeof(T);
+  for (const auto& item : value) { res += captured_size(item); }
+  return res;
+}
+
+inline size_t captured_size_all() { return 0; }
+template <typename T, typename... Rest>
+size_t captured_size_all(const T& first, const Rest&... rest)
+{
+  return captured_size(first) + captured_size_all(rest...);
+}
+}  // namespace details
+
+// Pool of event records. Once the pool has grown to the number of events in flight, acquire() and release() do not
+// allocate. A released record is freed instead of kept when max_free records are already waiting, or when its
+// arguments grew over MAX_RECORD_BYTES, so that a burst or a very large event does not pin memory for the life of
+// the pool.
+// The pool must outlive the batcher the records are queued in.
+template <typename TRecord>
+class event_record_pool
+{
+public:
+  static const size_t DEFAULT_MAX_FREE = 1024;
+  static const size_t MAX_RECORD_BYTES = 64 * 1024;
+
+  explicit event_record_pool(size_t max_free = DEFAULT_MAX_FREE) : _max_free(max_free) {}
+  event_record_pool(const event_record_pool&) = delete;
+  event_record_pool& operator=(const event_record_pool&) = delete;
+
+  TRecord* acquire()
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_free.empty())
+    {
+      ++_size;
+      // keep room for every record that can come back so that release() never reallocates
+      _free.reserve(std::min(_size, _max_free));
+      return new TRecord(*this);
+    }
+    auto* record = _free.back().release();
+    _free.pop_back();
+    return record;
+  }
+
+  void release(TRecord* record)
+  {
+    // declared before the lock: a record that is not kept is deleted once the lock is released
+    std::unique_ptr<TRecord> owned(record);
+    const bool oversized = record->args_size() > MAX_RECORD_BYTES;
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (oversized || _free.size() >= _max_free)
+    {
+      --_size;
+      return;
+    }
+    _free.push_back(std::move(owned));
+  }
+
+  // records alive, in use or free
+  size_t size() const
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _size;
+  }
+
+private:
+  const size_t _max_free;
+  size_t _size = 0;
+  std::vector<std::unique_ptr<TRecord>> _free;
+  mutable std::mutex _mutex;
+};
+
+// A pre-transform generic_event together with the arguments of TSerializer::event, stored by value.
+// Recycling a record reuses the capacity of its strings and vectors, and the transform step is called directly
+// instead of through a closure capturing copies of the arguments.
+// Lifecycle: acquire() from the pool, fill get_args(), then generic_event_logger::log(record, ...). The record
+// returns to its pool after transform() runs on the batcher thread, or when the queue drops its event.
+template <typename TSerializer, typename... Args>
+class generic_event_record : public i_pooled_event
+{
+public:
+  using args_t = std::tuple<Args...>;
+  using pool_t = event_record_pool<generic_event_record>;
+
+  explicit generic_event_record(pool_t& pool) : _pool(pool) {}
+  generic_event_record(const generic_event_record&) = delete;
+  generic_event_record& operator=(const generic_event_record&) = delete;
+
+  args_t& get_args() { return _args; }
+  generic_event& get_event() { return _event; }
+
+  void prepare(const char* event_id, const timestamp& ts, generic_event::payload_type_t type, string_view context,
+      const char* app_id, i_logger_extensions* ext)
+  {
+    _event.reset(event_id, ts, type, context, app_id);
+    _event.set_pool_owner(this);
+    _ext = ext;
+  }
+
+  // Transform the event and swap it into out_evt. The previous content of out_evt is kept so that its buffers are
+  // reused by the next event recorded here. Releases the record.
+  int transform(generic_event& out_evt, api_status* status)
+  {
+    const int res = transform_impl(status, details::make_index_sequence<sizeof...(Args)>());
+    if (res == error_code::success)
+    {
+      std::swap(out_evt, _event);
+      out_evt.set_pool_owner(nullptr);
+    }
+    release();
+    return res;
+  }
+
+  void release() override { _pool.release(this); }
+
+  // memory held by the arguments, accounted to the queued event
+  size_t args_size() const { return args_size_impl(details::make_index_sequence<sizeof...(Args)>()); }
+
+private:
+  template <size_t... I>
+  size_t args_size_impl(details::index_sequence<I...>) const
+  {
+    return details::captured_size_all(std::get<I>(_args)...);
+  }
+
+  template <size_t... I>
+  int transform_impl(api_status* status, details::index_sequence<I...>)
+  {
+    return _event.transform(_ext, _serializer, status, std::get<I>(_args)...);
+  }
+
+  pool_t& _pool;
+  generic_event _event;
+  args_t _args;
+  i_logger_extensions* _ext = nullptr;
+  const TSerializer _serializer{};  // serializers are stateless
+};
+}  // namespace logger
+}  // namespace reinforcement_learning
@@ -0,0 +1,435 @@
+#include "buffered_file_logger.h"
+
+#include "api_status.h"
+#include "constants.h"
+#include "err_constants.h"
+#include "trace_logger.h"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <utility>
+
+#ifdef _WIN32
+#  include <io.h>
+#else
+#  include <strings.h>
+#  include <sys/uio.h>
+#  include <unistd.h>
+#  define _stricmp strcasecmp
+#endif
+
+namespace reinforcement_learning
+{
+namespace logger
+{
+namespace file
+{
+namespace
+{
+// batches handed to a single writev call
+const size_t MAX_IOV = 64;
+
+fsync_policy to_fsync_policy(const char* policy)
+{
+  if (_stricmp(policy, value::FILE_FSYNC_BATCH) == 0) { return fsync_policy::BATCH; }
+  if (_stricmp(policy, value::FILE_FSYNC_INTERVAL) == 0) { return fsync_policy::INTERVAL; }
+  if (_stricmp(policy, value::FILE_FSYNC_SIZE) == 0) { return fsync_policy::SIZE; }
+  return fsync_policy::NONE;
+}
+
+bool file_exists(const std::string& file_name)
+{
+  struct stat result
+  {
+  };
+  return stat(file_name.c_str(), &result) == 0;
+}
+
+size_t file_size(const std::string& file_name)
+{
+  struct stat result
+  {
+  };
+  return stat(file_name.c_str(), &result) == 0 ? static_cast<size_t>(result.st_size) : 0;
+}
+
+#ifdef _WIN32
+int open_for_write(const char* file_name, bool append)
+{
+  return _open(file_name, _O_WRONLY | _O_CREAT | (append ? _O_APPEND : _O_TRUNC) | _O_BINARY, _S_IREAD | _S_IWRITE);
+}
+int close_fd(int fd) { return _close(fd); }
+int sync_fd(int fd) { return _commit(fd); }
+
+// no writev: one write per batch
+bool write_all(int fd, const unsigned char* const* data, const size_t* sizes, size_t count)
+{
+  for (size_t i = 0; i < count; ++i)
+  {
+    size_t done = 0;
+    while (done < sizes[i])
+    {
+      const int res = _write(fd, data[i] + done, static_cast<unsigned int>(sizes[i] - done));
+      if (res < 0) { return false; }
+      done += static_cast<size_t>(res);
+    }
+  }
+  return true;
+}
+#else
+int open_for_write(const char* file_name, bool append)
+{
+  return ::open(file_name, O_WRONLY | O_CREAT | (append ? O_APPEND : O_TRUNC) | O_CLOEXEC, 0644);
+}
+int close_fd(int fd) { return ::close(fd); }
+int sync_fd(int fd)
+{
+#  ifdef __APPLE__
+  return ::fsync(fd);
+#  else
+  // the file size is the only metadata that matters to read the data back
+  return ::fdatasync(fd);
+#  endif
+}
+
+// writev until every byte is written, resuming after partial writes and signals
+bool write_all(int fd, const unsigned char* const* data, const size_t* sizes, size_t count)
+{
+  iovec iov[MAX_IOV];
+  size_t first = 0;
+  size_t offset = 0;  // bytes of data[first] already written
+  while (first < count)
+  {
+    int iov_count = 0;
+    for (size_t i = first; i < count && iov_count < static_cast<int>(MAX_IOV); ++i, ++iov_count)
+    {
+      const size_t skip = i == first ? offset : 0;
+      iov[iov_count].iov_base = const_cast<unsigned char*>(data[i] + skip);
+      iov[iov_count].iov_len = sizes[i] - skip;
+    }
+    const ssize_t res = ::writev(fd, iov, iov_count);
+    if (res < 0)
+    {
+      if (errno == EINTR) { continue; }
+      return false;
+    }
+    auto written = static_cast<size_t>(res);
+    while (first < count && written >= sizes[first] - offset)
+    {
+      written -= sizes[first] - offset;
+      offset = 0;
+      ++first;
+    }
+    offset += written;
+  }
+  return true;
+}
+#endif
+}  // namespace
+
+buffered_file_config get_buffered_file_config(const utility::configuration& config)
+{
+  buffered_file_config res;
+  const auto kb = [&config](const char* name, size_t defval)
+  {
+    const int value = config.get_int(name, static_cast<int>(defval / 1024));
+    return value > 0 ? static_cast<size_t>(value) * 1024 : size_t(0);
+  };
+  res.buffer_bytes = kb(name::FILE_WRITE_BEHIND_BUFFER_KB, res.buffer_bytes);
+  res.flush_interval_ms = config.get_int(name::FILE_FLUSH_INTERVAL_MS, res.flush_interval_ms);
+  res.fsync = to_fsync_policy(config.get(name::FILE_FSYNC, value::FILE_FSYNC_NONE));
+  res.fsync_interval_ms = config.get_int(name::FILE_FSYNC_INTERVAL_MS, res.fsync_interval_ms);
+  res.fsync_bytes = kb(name::FILE_FSYNC_KB, res.fsync_bytes);
+  res.rotate_bytes = kb(name::FILE_ROTATE_KB, res.rotate_bytes);
+  res.rotate_ms = config.get_int(name::FILE_ROTATE_INTERVAL_MS, res.rotate_ms);
+  return res;
+}
+
+buffered_file_logger::buffered_file_logger(std::string file_name, i_trace* trace, error_callback_fn* error_cb)
+    : _file_name(std::move(file_name)), _trace(trace), _error_cb(error_cb)
+{
+}
+
+buffered_file_logger::~buffered_file_logger()
+{
+  if (!_writer.joinable()) { return; }
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _stop = true;
+    _sync_seq = _sent_seq;
+  }
+  _writer_cv.notify_one();
+  _writer.join();
+
+  api_status status;
+  if (close_file(&status) != error_code::success) { ERROR_CALLBACK(_error_cb, status); }
+}
+
+int buffered_file_logger::init(const utility::configuration& config, api_status* status)
+{
+  _config = get_buffered_file_config(config);
+  if (_config.flush_interval_ms <= 0) { _config.flush_interval_ms = 1; }
+  if (_config.buffer_bytes == 0) { _config.buffer_bytes = 1; }
+
+  if (_config.rotate_bytes > 0 || _config.rotate_ms > 0)
+  {
+    while (file_exists(rotated_name(_next_rotation_index))) { ++_next_rotation_index; }
+    // keep what a previous run captured instead of truncating it
+    if (file_size(_file_name) > 0 && std::rename(_file_name.c_str(), rotated_name(_next_rotation_index++).c_str()) != 0)
+    {
+      RETURN_ERROR_LS(_trace, status, file_open_error)
+          << " File:" << _file_name << " Error: unable to rotate, " << std::strerror(errno);
+    }
+  }
+  RETURN_IF_FAIL(open_file(status));
+  _last_sync = clock_type::now();
+  _writer = std::thread(&buffered_file_logger::writer_loop, this);
+  return error_code::success;
+}
+
+int buffered_file_logger::v_send(const buffer& data, api_status* status)
+{
+  if (!_writer.joinable())
+  {
+    RETURN_ERROR_LS(_trace, status, file_open_error) << " File:" << _file_name << " Error: sender not initialized";
+  }
+  const size_t size = data->buffer_filled_size();
+  std::unique_lock<std::mutex> lock(_mutex);
+  // backpressure: wait for the writer to catch up, a batch larger than the buffer goes through on its own
+  _written_cv.wait(lock, [&] { return _buffered_bytes == 0 || _buffered_bytes + size <= _config.buffer_bytes; });
+
+  _pending.push_back(data);
+  _buffered_bytes += size;
+  const uint64_t seq = ++_sent_seq;
+  const bool wait_for_sync = _config.fsync == fsync_policy::BATCH;
+  if (wait_for_sync) { _sync_seq = seq; }
+
+  // the writer wakes up on its own every flush_interval_ms, only hurry it when it has enough to write
+  if (wait_for_sync || _buffered_bytes >= _config.buffer_bytes / 2) { _writer_cv.notify_one(); }
+  if (wait_for_sync)
+  {
+    _written_cv.wait(lock, [&] { return _written_seq >= seq; });
+    if (_failed_seq >= seq) { return write_failure(status); }
+  }
+  return error_code::success;
+}
+
+int buffered_file_logger::flush(api_status* status)
+{
+  std::unique_lock<std::mutex> lock(_mutex);
+  if (!_writer.joinable()) { return error_code::success; }
+  const uint64_t seq = _sent_seq;
+  const uint64_t written_seq = _written_seq;
+  _sync_seq = seq;
+  _writer_cv.notify_one();
+  _written_cv.wait(lock, [&] { return _written_seq >= seq; });
+  if (_failed_seq > written_seq) { return write_failure(status); }
+  return error_code::success;
+}
+
+int buffered_file_logger::write_failure(api_status* status) const
+{
+  api_status::try_update(status, _failed_error, _failed_message.c_str());
+  return _failed_error;
+}
+
+size_t buffered_file_logger::in_flight_count() const
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  return static_cast<size_t>(_sent_seq - _written_seq);
+}
+
+void buffered_file_logger::writer_loop()
+{
+  std::vector<buffer> batches;
+  std::unique_lock<std::mutex> lock(_mutex);
+  while (true)
+  {
+    _writer_cv.wait_for(lock, std::chrono::milliseconds(_config.flush_interval_ms),
+        [this] { return _stop || _sync_seq > _written_seq || _buffered_bytes >= _config.buffer_bytes / 2; });
+
+    // batches and _pending swap their storage back and forth, so neither reallocates once warm
+    batches.swap(_pending);
+    const uint64_t seq = _sent_seq;
+    const bool sync = _sync_seq > _written_seq;
+    const bool stop = _stop;
+    lock.unlock();
+
+    size_t bytes = 0;
+    for (const auto& batch : batches) { bytes += batch->buffer_filled_size(); }
+    api_status status;
+    const bool failed = write_batches(batches, sync, &status) != error_code::success;
+    if (failed) { ERROR_CALLBACK(_error_cb, status); }
+    // release the buffers to their pool before waking up the sender
+    batches.clear();
+
+    lock.lock();
+    _buffered_bytes -= bytes;
+    if (failed)
+    {
+      _failed_seq = seq;
+      _failed_error = status.get_error_code();
+      _failed_message = status.get_error_msg();
+    }
+    _written_seq = seq;
+    _written_cv.notify_all();
+    if (stop) { return; }
+  }
+}
+
+int buffered_file_logger::write_batches(const std::vector<buffer>& batches, bool sync, api_status* status)
+{
+  const auto now = clock_type::now();
+  // the batches go to the current file if it cannot be rotated
+  bool rotation_failed = false;
+  const auto try_rotate = [this, &rotation_failed]
+  {
+    api_status rotate_status;
+    if (rotate(&rotate_status) != error_code::success)
+    {
+      ERROR_CALLBACK(_error_cb, rotate_status);
+      rotation_failed = true;
+    }
+  };
+  if (_config.rotate_ms > 0 && _file_bytes > 0 &&
+      now - _file_opened >= std::chrono::milliseconds(_config.rotate_ms))
+  {
+    try_rotate();
+  }
+
+  size_t begin = 0;
+  while (begin < batches.size())
+  {
+    // batches are not split across files
+    size_t end = begin;
+    size_t file_bytes = _file_bytes;
+    while (end < batches.size())
+    {
+      const size_t size = batches[end]->buffer_filled_size();
+      if (!rotation_failed && _config.rotate_bytes > 0 && file_bytes > 0 && file_bytes + size > _config.rotate_bytes)
+      {
+        break;
+      }
+      file_bytes += size;
+      ++end;
+    }
+    if (end == begin)
+    {
+      try_rotate();
+      continue;
+    }
+    RETURN_IF_FAIL(write_range(batches, begin, end, status));
+    begin = end;
+  }
+
+  switch (_config.fsync)
+  {
+    case fsync_policy::BATCH:
+      sync = sync || !batches.empty();
+      break;
+    case fsync_policy::INTERVAL:
+      sync = sync || (_unsynced_bytes > 0 && now - _last_sync >= std::chrono::milliseconds(_config.fsync_interval_ms));
+      break;
+    case fsync_policy::SIZE:
+      sync = sync || _unsynced_bytes >= _config.fsync_bytes;
+      break;
+    case fsync_policy::NONE:
+      break;
+  }
+  if (sync && _unsynced_bytes > 0) { RETURN_IF_FAIL(this->sync(status)); }
+  return error_code::success;
+}
+
+int buffered_file_logger::write_range(
+    const std::vector<buffer>& batches, size_t begin, size_t end, api_status* status)
+{
+  const unsigned char* data[MAX_IOV];
+  size_t sizes[MAX_IOV];
+  while (begin < end)
+  {
+    size_t count = 0;
+    size_t bytes = 0;
+    for (; begin < end && count < MAX_IOV; ++begin, ++count)
+    {
+      data[count] = batches[begin]->preamble_begin();
+      sizes[count] = batches[begin]->buffer_filled_size();
+      bytes += sizes[count];
+    }
+    if (!write_all(_fd, data, sizes, count))
+    {
+      RETURN_ERROR_LS(_trace, status, file_write_error) << " File:" << _file_name << " Error:" << std::strerror(errno);
+    }
+    _file_bytes += bytes;
+    _unsynced_bytes += bytes;
+    _bytes_written += bytes;
+  }
+  return error_code::success;
+}
+
+int buffered_file_logger::open_file(api_status* status, bool append)
+{
+  _fd = open_for_write(_file_name.c_str(), append);
+  if (_fd < 0)
+  {
+    RETURN_ERROR_LS(_trace, status, file_open_error) << " File:" << _file_name << " Error:" << std::strerror(errno);
+  }
+  if (!append) { _file_bytes = 0; }
+  _file_opened = clock_type::now();
+  return error_code::success;
+}
+
+int buffered_file_logger::close_file(api_status* status)
+{
+  if (_fd < 0) { return error_code::success; }
+  // unconditionally synced: a clean shutdown leaves nothing behind in the page cache
+  const int res = _unsynced_bytes > 0 ? sync(status) : error_code::success;
+  close_fd(_fd);
+  _fd = -1;
+  return res;
+}
+
+int buffered_file_logger::rotate(api_status* status)
+{
+  // synced first: close_file() closes the file even if the sync fails
+  if (_unsynced_bytes > 0) { RETURN_IF_FAIL(sync(status)); }
+  RETURN_IF_FAIL(close_file(status));
+  const auto rotated = rotated_name(_next_rotation_index);
+  if (std::rename(_file_name.c_str(), rotated.c_str()) != 0)
+  {
+    const int rename_error = errno;
+    // an open file cannot be renamed on Windows, reopen it to keep writing after the batches already in it.
+    // Reopening also restarts the rotate_ms clock, the rotation is not retried on every write.
+    RETURN_IF_FAIL(open_file(status, true));
+    RETURN_ERROR_LS(_trace, status, file_open_error)
+        << " File:" << _file_name << " Error: unable to rename to " << rotated << ", " << std::strerror(rename_error);
+  }
+  ++_next_rotation_index;
+  ++_rotations;
+  TRACE_INFO(_trace, "File sender rotated " + _file_name + " to " + rotated);
+  return open_file(status);
+}
+
+int buffered_file_logger::sync(api_status* status)
+{
+  if (sync_fd(_fd) != 0)
+  {
+    RETURN_ERROR_LS(_trace, status, file_write_error)
+        << " File:" << _file_name << " Error: sync failed, " << std::strerror(errno);
+  }
+  _unsynced_bytes = 0;
+  _last_sync = clock_type::now();
+  return error_code::success;
+}
+
+std::string buffered_file_logger::rotated_name(size_t index) const
+{
+  return _file_name + "." + std::to_string(index);
+}
+}  // namespace file
+}  // namespace logger
+}  // namespace reinforcement_learning
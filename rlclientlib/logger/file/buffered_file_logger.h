@@ -0,0 +1,137 @@
+#pragma once
+#include "err_constants.h"
+#include "error_callback_fn.h"
+#include "sender.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace reinforcement_learning
+{
+class i_trace;
+}
+
+namespace reinforcement_learning
+{
+namespace logger
+{
+namespace file
+{
+enum class fsync_policy
+{
+  NONE,      // leave it to the OS, the file is still synced when the sender shuts down
+  BATCH,     // send() returns once its batch is on disk
+  INTERVAL,  // at most every fsync_interval_ms
+  SIZE       // every fsync_bytes written
+};
+
+struct buffered_file_config
+{
+  // batches held in memory before send() waits for the writer
+  size_t buffer_bytes = 4 * 1024 * 1024;
+  // longest time a batch stays in memory before it is written
+  int flush_interval_ms = 100;
+  fsync_policy fsync = fsync_policy::NONE;
+  int fsync_interval_ms = 1000;
+  size_t fsync_bytes = 64 * 1024 * 1024;
+  // the file is renamed to <file_name>.<index> and a new one started once it reaches rotate_bytes, or rotate_ms
+  // after it was opened. 0 disables the rotation.
+  size_t rotate_bytes = 0;
+  int rotate_ms = 0;
+};
+
+// Reads the file.* settings (file.write_behind.buffer.kb, file.fsync, ...)
+buffered_file_config get_buffered_file_config(const utility::configuration& config);
+
+// File sender for high volume capture (file.write_behind).
+// send() only queues the batch: the buffer is shared, not copied. A writer thread hands the queued batches to the
+// file in a single writev call, syncs them according to the fsync policy and rotates the file.
+// send() blocks only when buffer_bytes are waiting to be written, or until the batch is synced with
+// fsync_policy::BATCH. Everything sent is written and synced when the sender is destroyed.
+// Write errors go to the error callback. send() with fsync_policy::BATCH and flush() also return the error of the
+// last failed write if it covered their batches, or batches sent after them.
+// A failed rotation is reported and the batches keep going to the current file, the rotation is tried again later.
+class buffered_file_logger : public i_sender
+{
+public:
+  buffered_file_logger(std::string file_name, i_trace* trace, error_callback_fn* error_cb = nullptr);
+  ~buffered_file_logger() override;
+
+  int init(const utility::configuration& config, api_status* status) override;
+
+  // Writes and syncs everything sent so far
+  int flush(api_status* status = nullptr);
+
+  // batches sent and not written yet
+  size_t in_flight_count() const override;
+
+  uint64_t bytes_written() const { return _bytes_written.load(); }
+  size_t rotations() const { return _rotations.load(); }
+  const std::string& get_file_name() const { return _file_name; }
+
+  buffered_file_logger(const buffered_file_logger&) = delete;
+  buffered_file_logger(buffered_file_logger&&) = delete;
+  buffered_file_logger& operator=(const buffered_file_logger&) = delete;
+  buffered_file_logger& operator=(buffered_file_logger&&) = delete;
+
+protected:
+  int v_send(const buffer& data, api_status* status) override;
+
+private:
+  using clock_type = std::chrono::steady_clock;
+
+  void writer_loop();
+  // error of the last failed write, _mutex must be held
+  int write_failure(api_status* status) const;
+  // The methods below are only called by the writer thread (and init() before it starts)
+  int write_batches(const std::vector<buffer>& batches, bool sync, api_status* status);
+  int write_range(const std::vector<buffer>& batches, size_t begin, size_t end, api_status* status);
+  // the file is truncated, unless append is set
+  int open_file(api_status* status, bool append = false);
+  int close_file(api_status* status);
+  int rotate(api_status* status);
+  int sync(api_status* status);
+  std::string rotated_name(size_t index) const;
+
+  const std::string _file_name;
+  i_trace* _trace;
+  error_callback_fn* _error_cb;
+  buffered_file_config _config;
+
+  mutable std::mutex _mutex;
+  std::condition_variable _writer_cv;
+  std::condition_variable _written_cv;
+  std::vector<buffer> _pending;
+  // bytes of the batches pending or being written
+  size_t _buffered_bytes = 0;
+  uint64_t _sent_seq = 0;
+  uint64_t _written_seq = 0;
+  // the writer writes (and syncs) immediately up to this batch
+  uint64_t _sync_seq = 0;
+  // last batch of the last write that failed, and its error
+  uint64_t _failed_seq = 0;
+  int _failed_error = error_code::success;
+  std::string _failed_message;
+  bool _stop = false;
+
+  // writer state
+  int _fd = -1;
+  size_t _file_bytes = 0;
+  size_t _unsynced_bytes = 0;
+  clock_type::time_point _file_opened;
+  clock_type::time_point _last_sync;
+  size_t _next_rotation_index = 1;
+
+  std::atomic<uint64_t> _bytes_written{0};
+  std::atomic<size_t> _rotations{0};
+  std::thread _writer;
+};
+}  // namespace file
+}  // namespace logger
+}  // namespace reinforcement_learning
@@ -26,4 +26,99 @@ uint8_t* flatbuffer_allocator::reallocate_downward(
   memmove(_buffer.body_begin() + new_size - in_use_back, _buffer.body_begin() + old_size - in_use_back, in_use_back);
   return _buffer.body_begin();
 }
+
+namespace
+{
+constexpr size_t MIN_BLOCK_SIZE_LOG2 = 10;  // 1 KB, the default builder size
+
+// Arenas of exited threads, waiting for a new thread. Never destroyed so that buffers released during static
+// destruction still find their arena.
+std::mutex& orphan_arenas_mutex()
+{
+  static auto* mutex = new std::mutex();
+  return *mutex;
+}
+
+std::vector<flatbuffer_arena*>& orphan_arenas()
+{
+  static auto* arenas = new std::vector<flatbuffer_arena*>();
+  return *arenas;
+}
+}  // namespace
+
+struct flatbuffer_arena_owner
+{
+  flatbuffer_arena* arena;
+
+  flatbuffer_arena_owner()
+  {
+    std::lock_guard<std::mutex> lock(orphan_arenas_mutex());
+    auto& orphans = orphan_arenas();
+    if (orphans.empty()) { arena = new flatbuffer_arena(); }
+    else
+    {
+      arena = orphans.back();
+      orphans.pop_back();
+    }
+  }
+
+  ~flatbuffer_arena_owner()
+  {
+    std::lock_guard<std::mutex> lock(orphan_arenas_mutex());
+    orphan_arenas().push_back(arena);
+  }
+};
+
+flatbuffer_arena& flatbuffer_arena::local()
+{
+  static thread_local flatbuffer_arena_owner owner;
+  return *owner.arena;
+}
+
+size_t flatbuffer_arena::size_class(size_t size)
+{
+  size_t res = MIN_BLOCK_SIZE_LOG2;
+  while ((static_cast<size_t>(1) << res) < size) { ++res; }
+  return res;
+}
+
+uint8_t* flatbuffer_arena::allocate(size_t size)
+{
+  const size_t cls = size_class(size);
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (cls < _free_blocks.size() && !_free_blocks[cls].empty())
+    {
+      auto* block = _free_blocks[cls].back();
+      _free_blocks[cls].pop_back();
+      _cached_bytes -= static_cast<size_t>(1) << cls;
+      return block;
+    }
+  }
+  return new uint8_t[static_cast<size_t>(1) << cls];
+}
+
+void flatbuffer_arena::deallocate(uint8_t* p, size_t size)
+{
+  // size is the one requested from allocate(), so it maps to the same class
+  const size_t cls = size_class(size);
+  const size_t block_size = static_cast<size_t>(1) << cls;
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_cached_bytes + block_size <= MAX_CACHED_BYTES)
+    {
+      if (_free_blocks.size() <= cls) { _free_blocks.resize(cls + 1); }
+      _free_blocks[cls].push_back(p);
+      _cached_bytes += block_size;
+      return;
+    }
+  }
+  delete[] p;
+}
+
+size_t flatbuffer_arena::cached_bytes() const
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _cached_bytes;
+}
 }  // namespace reinforcement_learning
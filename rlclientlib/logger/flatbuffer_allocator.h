@@ -2,6 +2,9 @@
 #include "data_buffer.h"
 #include "flatbuffers/flatbuffers.h"
 
+#include <mutex>
+#include <vector>
+
 namespace reinforcement_learning
 {
 class flatbuffer_allocator : public flatbuffers::Allocator
@@ -17,4 +20,38 @@ public:
 private:
   utility::data_buffer& _buffer;
 };
+
+// Per-thread pool of builder buffers, used by the payload serializers.
+// Blocks are handed out in power of two sizes and come back to the arena that allocated them when the builder or
+// the DetachedBuffer released from it is destroyed, from whichever thread that happens on.
+// Arenas are never freed: when a thread exits its arena is handed over to the next new thread, so detached buffers
+// can outlive the thread that built them.
+class flatbuffer_arena : public flatbuffers::Allocator
+{
+public:
+  // arena of the calling thread
+  static flatbuffer_arena& local();
+
+  uint8_t* allocate(size_t size) override;
+  void deallocate(uint8_t* p, size_t size) override;
+
+  // bytes held in free blocks
+  size_t cached_bytes() const;
+
+  flatbuffer_arena(const flatbuffer_arena&) = delete;
+  flatbuffer_arena& operator=(const flatbuffer_arena&) = delete;
+
+  // free blocks above this size are returned to the heap
+  static constexpr size_t MAX_CACHED_BYTES = 16 * 1024 * 1024;
+
+private:
+  flatbuffer_arena() = default;
+  static size_t size_class(size_t size);
+
+  mutable std::mutex _mutex;
+  std::vector<std::vector<uint8_t*>> _free_blocks;  // indexed by size class
+  size_t _cached_bytes = 0;
+
+  friend struct flatbuffer_arena_owner;
+};
 }  // namespace reinforcement_learning
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+#include "logger_metrics.h"
+
+namespace reinforcement_learning
+{
+// The window of requests in flight of an http_transport_client.
+// Requests report their completion here in whatever order they complete, so the sender can free the slot of the
+// first request that completes instead of waiting for the oldest one, which may be retrying.
+class http_completion_window
+{
+public:
+  http_completion_window() = default;
+  http_completion_window(const http_completion_window&) = delete;
+  http_completion_window& operator=(const http_completion_window&) = delete;
+
+  void started() { ++_in_flight; }
+
+  // Called by the request itself, from a pplx thread.
+  // done is the flag the sender polls to find completed requests: it is set under the same lock as the count of
+  // completions, so that reaped() never accounts for a request that is not counted yet.
+  void completed(std::chrono::milliseconds latency, size_t retries, bool success, std::atomic<bool>& done)
+  {
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      done = true;
+      --_in_flight;
+      ++_unreaped;
+      ++_metrics.completed;
+      if (!success) { ++_metrics.failed; }
+      ++_metrics.latency_ms[latency_bucket(latency)];
+      ++_metrics.retries[retries < http_sender_metrics::RETRY_BUCKETS ? retries
+                                                                      : http_sender_metrics::RETRY_BUCKETS - 1];
+    }
+    _cv.notify_one();
+  }
+
+  // Blocks until a request completes, unless some already did and were not reaped yet.
+  void wait_for_completion()
+  {
+    std::unique_lock<std::mutex> lock(_mutex);
+    _cv.wait(lock, [this] { return _unreaped > 0; });
+  }
+
+  // count completed requests were removed by the sender
+  void reaped(size_t count)
+  {
+    if (count == 0) { return; }
+    std::lock_guard<std::mutex> lock(_mutex);
+    _unreaped -= count;
+  }
+
+  size_t in_flight() const { return _in_flight.load(); }
+
+  http_sender_metrics metrics() const
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto res = _metrics;
+    res.in_flight = _in_flight.load();
+    return res;
+  }
+
+  static size_t latency_bucket(std::chrono::milliseconds latency)
+  {
+    const auto ms = latency.count() > 0 ? static_cast<uint64_t>(latency.count()) : uint64_t(0);
+    size_t bucket = 0;
+    while (bucket + 1 < http_sender_metrics::LATENCY_BUCKETS && (uint64_t(1) << bucket) <= ms) { ++bucket; }
+    return bucket;
+  }
+
+private:
+  std::atomic<size_t> _in_flight{0};
+  mutable std::mutex _mutex;
+  std::condition_variable _cv;
+  size_t _unreaped = 0;
+  http_sender_metrics _metrics;
+};
+}  // namespace reinforcement_learning
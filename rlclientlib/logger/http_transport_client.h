@@ -1,22 +1,26 @@
 #pragma once
 
 #include "api_status.h"
+#include "constants.h"
 #include "data_buffer.h"
 #include "err_constants.h"
 #include "error_callback_fn.h"
-#include "moving_queue.h"
+#include "logger/http_sender_metrics.h"
 #include "sender.h"
 #include "str_util.h"
 #include "trace_logger.h"
 #include "utility/eventhub_http_authorization.h"
 #include "utility/header_authorization.h"
 #include "utility/http_client.h"
+#include "utility/retry_timer.h"
 #include "utility/stl_container_adapter.h"
 
 #include <cpprest/http_headers.h>
 #include <pplx/pplxtasks.h>
 
+#include <atomic>
 #include <chrono>
+#include <list>
 #include <memory>
 #include <sstream>
 #include <thread>
@@ -38,6 +42,18 @@ class http_transport_client : public i_sender
 {
 public:
   virtual int init(const utility::configuration& config, api_status* status) override;
+  size_t in_flight_count() const override { return _window.in_flight(); }
+
+  // in-flight count, completion latency and retry histograms
+  bool get_metrics(http_sender_metrics& metrics) const override
+  {
+    metrics = _window.metrics();
+    return true;
+  }
+
+  // Delays between retries, also read from http.retry.base_delay_ms and http.retry.max_delay_ms by init().
+  // Applies to the requests sent afterwards.
+  void set_retry_backoff(const utility::retry_backoff& backoff) { _retry_backoff = backoff; }
 
   // Takes the ownership of the i_http_client and delete it at the end of lifetime
   template <typename... Args>
@@ -59,7 +75,10 @@ private:
         std::chrono::milliseconds max_retry_duration = std::chrono::milliseconds(
             360000),  // retries will halt before max_retries attempts if this time elapses
                       // first
-        error_callback_fn* error_callback = nullptr, i_trace* trace = nullptr);
+        error_callback_fn* error_callback = nullptr, i_trace* trace = nullptr,
+        http_completion_window* window = nullptr,  // notified when the request completes
+        utility::retry_timer* timer = nullptr,     // schedules the retries, must outlive the task
+        const utility::retry_backoff& backoff = utility::retry_backoff());
 
     // The constructor kicks off an async request which captures the this variable. If this object is moved then the
     // this pointer is invalidated and causes tricky bugs.
@@ -71,6 +90,9 @@ private:
     // Return error_code
     int join();
 
+    // The request completed and join() no longer blocks
+    bool is_done() const { return _done.load(); }
+
   private:
     // repeat request until success or _max_retries attempted
     // returns the http::status_code of the final attempt.
@@ -92,10 +114,21 @@ private:
 
     error_callback_fn* _error_callback;
     i_trace* _trace;
+    http_completion_window* _window;
+    utility::retry_timer* _timer;
+    utility::retry_backoff _backoff;
+    // retries attempted by the final attempt
+    size_t _retries = 0;
+    std::atomic<bool> _done{false};
   };
 
 private:
-  int pop_task(api_status* status);
+  // Both must be called under _mutex
+  // Waits until there is room in the window for one more request, freeing the slots of completed requests.
+  int wait_for_slot(api_status* status);
+  // Removes the completed requests from _tasks, returns how many were removed
+  size_t reap_completed();
+  void join_task(http_request_task& task);
 
   // cannot be copied or assigned
   http_transport_client(const http_transport_client&) = delete;
@@ -108,18 +141,24 @@ private:
   TAuthorization _authorization;
 
   std::mutex _mutex;
-  moving_queue<std::unique_ptr<http_request_task>> _tasks;
+  // requests in flight in sending order, completed ones are removed as soon as a slot is needed
+  std::list<std::unique_ptr<http_request_task>> _tasks;
   const size_t _max_tasks_count;
   const size_t _max_retry_count;
   const std::chrono::milliseconds _max_retry_duration;
   i_trace* _trace;
   error_callback_fn* _error_callback;
+  http_completion_window _window;
+  utility::retry_backoff _retry_backoff;
+  // retries wait on the timer thread instead of a pplx thread. The destructor joins every task before it goes away.
+  utility::retry_timer _retry_timer;
 };
 
 template <typename TAuthorization>
 http_transport_client<TAuthorization>::http_request_task::http_request_task(i_http_client* client, http_headers headers,
     const buffer& post_data, size_t max_retries, std::chrono::milliseconds max_retry_duration,
-    error_callback_fn* error_callback, i_trace* trace)
+    error_callback_fn* error_callback, i_trace* trace, http_completion_window* window, utility::retry_timer* timer,
+    const utility::retry_backoff& backoff)
     : _client(client)
     , _headers(headers)
     , _post_data(post_data)
@@ -128,7 +167,11 @@ http_transport_client<TAuthorization>::http_request_task::http_request_task(i_ht
     , _max_retry_duration(max_retry_duration)
     , _error_callback(error_callback)
     , _trace(trace)
+    , _window(window)
+    , _timer(timer)
+    , _backoff(backoff)
 {
+  if (_window != nullptr) { _window->started(); }
   _task = send_request();
 }
 
@@ -150,6 +193,11 @@ pplx::task<web::http::status_code> http_transport_client<TAuthorization>::http_r
               TRACE_ERROR(_trace, e.what());
             }
 
+            const bool success = (code >= status_codes::OK) && (code < status_codes::MultipleChoices);
+            const auto latency = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::system_clock::now() - _start_time);
+            if (_window != nullptr) { _window->completed(latency, _retries, success, _done); }
+            else { _done = true; }
             return code;
           });
 }
@@ -183,6 +231,7 @@ pplx::task<http_response> http_transport_client<TAuthorization>::http_request_ta
       TRACE_ERROR(_trace, e.what());
     }
 
+    _retries = try_count;
     bool success = (response_code >= status_codes::OK) && (response_code < status_codes::MultipleChoices);
     if (success) { return response_task; }
 
@@ -202,15 +251,17 @@ pplx::task<http_response> http_transport_client<TAuthorization>::http_request_ta
       return response_task;
     }
 
-    static const std::chrono::milliseconds RETRY_DELAY = std::chrono::milliseconds(1000);
+    const auto retry_delay = _backoff.delay(try_count);
     TRACE_ERROR(
-        _trace, u::concat("HTTP request failed with ", response_code, ", retrying in ", RETRY_DELAY.count(), "ms..."));
-
-    // using sleep_for is regrettable because it blocks this thread, but pplx doesn't implement better yield options.
-    std::this_thread::sleep_for(RETRY_DELAY);
+        _trace, u::concat("HTTP request failed with ", response_code, ", retrying in ", retry_delay.count(), "ms..."));
 
-    // return a new task which will resubmit the original request
-    return send_request_with_retries(try_count + 1);
+    // return a new task which will resubmit the original request once the delay has elapsed
+    if (_timer == nullptr)
+    {
+      std::this_thread::sleep_for(retry_delay);
+      return send_request_with_retries(try_count + 1);
+    }
+    return _timer->delay(retry_delay).then([this, try_count]() { return send_request_with_retries(try_count + 1); });
   };
 
   return _client->request(request).then(retry_request_on_failure_lambda);
@@ -229,31 +280,60 @@ int http_transport_client<TAuthorization>::http_request_task::join()
 template <typename TAuthorization>
 int http_transport_client<TAuthorization>::init(const utility::configuration& config, api_status* status)
 {
+  _retry_backoff.base_delay = std::chrono::milliseconds(
+      config.get_int(name::HTTP_RETRY_BASE_DELAY_MS, static_cast<int>(_retry_backoff.base_delay.count())));
+  _retry_backoff.max_delay = std::chrono::milliseconds(
+      config.get_int(name::HTTP_RETRY_MAX_DELAY_MS, static_cast<int>(_retry_backoff.max_delay.count())));
   RETURN_IF_FAIL(_authorization.init(config, status, _trace));
   return error_code::success;
 }
 
 template <typename TAuthorization>
-int http_transport_client<TAuthorization>::pop_task(api_status* status)
+void http_transport_client<TAuthorization>::join_task(http_request_task& task)
 {
-  // This function must be under a lock as there is a delay between popping from the queue and joining the task, but it
-  // should essentially be atomic.
-  std::lock_guard<std::mutex> lock(_mutex);
-
-  std::unique_ptr<http_request_task> oldest;
-  _tasks.pop(&oldest);
-
   try
   {
     // This will block if the task is not complete yet.
-    RETURN_IF_FAIL(oldest->join());
+    task.join();
   }
   catch (...)
   {
     // Ignore if there is an exception surfaced as this should have been handled in the continuation.
-    TRACE_WARN(_trace, "There should not be an exception raised in pop_task function.");
+    TRACE_WARN(_trace, "There should not be an exception raised while joining an http request.");
   }
+}
 
+template <typename TAuthorization>
+size_t http_transport_client<TAuthorization>::reap_completed()
+{
+  size_t reaped = 0;
+  for (auto it = _tasks.begin(); it != _tasks.end();)
+  {
+    if (!(*it)->is_done())
+    {
+      ++it;
+      continue;
+    }
+    // completed: only returns from the tail of the continuation
+    join_task(**it);
+    it = _tasks.erase(it);
+    ++reaped;
+  }
+  _window.reaped(reaped);
+  return reaped;
+}
+
+template <typename TAuthorization>
+int http_transport_client<TAuthorization>::wait_for_slot(api_status* status)
+{
+  reap_completed();
+  // A slow request (retrying or stuck on a slow connection) only holds its own slot: wait for whichever request
+  // completes first.
+  while (!_tasks.empty() && _tasks.size() >= _max_tasks_count)
+  {
+    _window.wait_for_completion();
+    reap_completed();
+  }
   return error_code::success;
 }
 
@@ -265,12 +345,12 @@ int http_transport_client<TAuthorization>::v_send(const buffer& post_data, api_s
 
   try
   {
+    std::lock_guard<std::mutex> lock(_mutex);
     // Before creating the task, ensure that it is allowed to be created.
-    if (_tasks.size() >= _max_tasks_count) { RETURN_IF_FAIL(pop_task(status)); }
+    RETURN_IF_FAIL(wait_for_slot(status));
 
-    std::unique_ptr<http_request_task> request_task(new http_request_task(
-        _client.get(), headers, post_data, _max_retry_count, _max_retry_duration, _error_callback, _trace));
-    _tasks.push(std::move(request_task));
+    _tasks.emplace_back(new http_request_task(_client.get(), headers, post_data, _max_retry_count,
+        _max_retry_duration, _error_callback, _trace, &_window, &_retry_timer, _retry_backoff));
   }
   catch (const std::exception& e)
   {
@@ -297,15 +377,8 @@ http_transport_client<TAuthorization>::http_transport_client(i_http_client* clie
 template <typename TAuthorization>
 http_transport_client<TAuthorization>::~http_transport_client()
 {
-  while (_tasks.size() != 0)
-  {
-    auto result = pop_task(nullptr);
-    if (result != error_code::success)
-    {
-      auto message =
-          utility::concat("Failure in pop_task while running ~http_transport_client. Status: '", result, "'");
-      TRACE_ERROR(_trace, message);
-    }
-  }
+  std::lock_guard<std::mutex> lock(_mutex);
+  for (auto& task : _tasks) { join_task(*task); }
+  _tasks.clear();
 }
 }  // namespace reinforcement_learning
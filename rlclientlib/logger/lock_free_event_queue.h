@@ -0,0 +1,211 @@
+#pragma once
+
+#include "event_queue.h"
+#include "utility/config_helper.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace reinforcement_learning
+{
+// A bounded multi-producer/single-consumer ring buffer (based on D. Vyukov's bounded queue).
+// push() never takes a lock: producers claim a slot with a single CAS on the enqueue position, fill it and
+// publish it through the slot's sequence number.
+// pop() and prune() share a consumer-side mutex so that pruning never races with the batcher draining the
+// queue. prune() only try-locks it, producers never wait on it.
+// Entries dropped by subsampling or pruning stay in the ring as empty slots and are skipped by pop().
+// Event indices come from a single counter, taken when an event enters push() or drop(), so every event gets a
+// unique index (subsampled ones and events dropped without a slot included). Producers racing for the ring may
+// claim their slots in a different order than their indices: indices are only nearly increasing in pop order.
+template <class T>
+class lock_free_event_queue : public i_event_queue<T>
+{
+public:
+  using TFunc = typename i_event_queue<T>::TFunc;
+
+private:
+  static constexpr size_t cache_line_size = 64;
+
+  struct slot
+  {
+    std::atomic<size_t> sequence{0};
+    TFunc func;
+    size_t item_size{0};
+    T* event{nullptr};  // nullptr marks an empty slot (dropped event)
+  };
+
+  std::unique_ptr<slot[]> _slots;
+  size_t _mask;
+  size_t _max_capacity;
+  events_counter_status _event_counter_status;
+  float _subsample_rate;
+  queue_mode_enum _queue_mode;
+
+  char _pad0[cache_line_size];
+  std::atomic<size_t> _enqueue_pos{0};
+  std::atomic<uint64_t> _event_index{0};
+  char _pad1[cache_line_size];
+  std::atomic<size_t> _capacity{0};
+  std::atomic<size_t> _size{0};
+  char _pad2[cache_line_size];
+
+  // consumer side state, guarded by _consumer_mutex
+  std::mutex _consumer_mutex;
+  size_t _dequeue_pos{0};
+  int _drop_pass{0};
+
+public:
+  // ring_size is rounded up to the next power of two.
+  // When every slot is taken, push() drops the incoming event in DROP mode and waits for a free slot in BLOCK mode.
+  lock_free_event_queue(size_t max_capacity, size_t ring_size, queue_mode_enum queue_mode = queue_mode_enum::DROP,
+      events_counter_status event_counter_status = events_counter_status::DISABLE, float subsample_rate = 1.0f)
+      : _mask(round_up_pow2(ring_size) - 1)
+      , _max_capacity(max_capacity)
+      , _event_counter_status(event_counter_status)
+      , _subsample_rate(subsample_rate)
+      , _queue_mode(queue_mode)
+  {
+    _slots.reset(new slot[_mask + 1]);
+    for (size_t i = 0; i <= _mask; ++i) { _slots[i].sequence.store(i, std::memory_order_relaxed); }
+  }
+
+  lock_free_event_queue(const lock_free_event_queue&) = delete;
+  lock_free_event_queue& operator=(const lock_free_event_queue&) = delete;
+
+  bool pop(TFunc* item) override
+  {
+    std::lock_guard<std::mutex> lock(_consumer_mutex);
+    while (true)
+    {
+      slot& s = _slots[_dequeue_pos & _mask];
+      // empty, or the producer owning the next slot has not published it yet
+      if (s.sequence.load(std::memory_order_acquire) != _dequeue_pos + 1) { return false; }
+
+      const bool live = s.event != nullptr;
+      if (live)
+      {
+        *item = std::move(s.func);
+        _capacity.fetch_sub(s.item_size, std::memory_order_relaxed);
+        _size.fetch_sub(1, std::memory_order_relaxed);
+      }
+      clear(s);
+      s.sequence.store(_dequeue_pos + _mask + 1, std::memory_order_release);
+      ++_dequeue_pos;
+      if (live) { return true; }
+    }
+  }
+
+  bool push(TFunc& item, size_t item_size, T* event) { return push(std::move(item), item_size, event); }
+
+  bool push(TFunc&& item, size_t item_size, T* event) override
+  {
+    assign_event_index(event);
+    size_t pos = _enqueue_pos.load(std::memory_order_relaxed);
+    slot* s;
+    while (true)
+    {
+      s = &_slots[pos & _mask];
+      const size_t seq = s->sequence.load(std::memory_order_acquire);
+      const auto diff = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos);
+      if (diff == 0)
+      {
+        if (_enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) { break; }
+      }
+      else if (diff < 0)
+      {
+        // every slot is in use
+        if (queue_mode_enum::DROP == _queue_mode)
+        {
+          release(event);
+          return false;
+        }
+        std::this_thread::yield();
+        pos = _enqueue_pos.load(std::memory_order_relaxed);
+      }
+      else { pos = _enqueue_pos.load(std::memory_order_relaxed); }
+    }
+
+    // If subsampling rate is < 1, then run subsampling logic
+    // A dropped event still consumes its slot so that the consumer sees a contiguous sequence.
+    const bool dropped = _subsample_rate < 1 && event->try_drop(_subsample_rate, constants::SUBSAMPLE_RATE_DROP_PASS);
+    if (!dropped)
+    {
+      s->func = std::move(item);
+      s->item_size = item_size;
+      s->event = event;
+      // account before publishing so that pop() never decrements below zero
+      _capacity.fetch_add(item_size, std::memory_order_relaxed);
+      _size.fetch_add(1, std::memory_order_relaxed);
+    }
+    s->sequence.store(pos + 1, std::memory_order_release);
+    return !dropped;
+  }
+
+  // the event is dropped the way prune() drops one, a pooled event goes back to its pool
+  void drop(T* event) override
+  {
+    assign_event_index(event);
+    release(event);
+  }
+
+  void prune(float pass_prob) override
+  {
+    std::unique_lock<std::mutex> lock(_consumer_mutex, std::try_to_lock);
+    // the consumer is draining the queue, no need to prune
+    if (!lock.owns_lock()) { return; }
+    if (!is_full()) { return; }
+    const size_t end = _enqueue_pos.load(std::memory_order_acquire);
+    for (size_t pos = _dequeue_pos; pos != end; ++pos)
+    {
+      slot& s = _slots[pos & _mask];
+      // skip slots still being written and events that were already dropped
+      if (s.sequence.load(std::memory_order_acquire) != pos + 1 || s.event == nullptr) { continue; }
+      if (s.event->try_drop(pass_prob, _drop_pass))
+      {
+        _capacity.fetch_sub(s.item_size, std::memory_order_relaxed);
+        _size.fetch_sub(1, std::memory_order_relaxed);
+        clear(s);
+      }
+    }
+    ++_drop_pass;
+  }
+
+  // approximate size
+  size_t size() override { return _size.load(std::memory_order_relaxed); }
+
+  bool is_full() const override
+  {
+    return capacity() >= _max_capacity || _size.load(std::memory_order_relaxed) > _mask;
+  }
+
+  size_t capacity() const override { return _capacity.load(std::memory_order_relaxed); }
+
+private:
+  void assign_event_index(T* event)
+  {
+    if (_event_counter_status == events_counter_status::ENABLE)
+    {
+      event->set_event_index(_event_index.fetch_add(1, std::memory_order_relaxed) + 1);
+    }
+  }
+
+  static void release(T* event) { event->try_drop(0.f, constants::SUBSAMPLE_RATE_DROP_PASS); }
+
+  static void clear(slot& s)
+  {
+    s.func = nullptr;
+    s.item_size = 0;
+    s.event = nullptr;
+  }
+
+  static size_t round_up_pow2(size_t n)
+  {
+    size_t res = 2;
+    while (res < n) { res <<= 1; }
+    return res;
+  }
+};
+}  // namespace reinforcement_learning
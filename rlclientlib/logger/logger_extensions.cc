@@ -33,10 +33,11 @@ public:
     return error_code::success;
   }
 
-  int transform_serialized_payload(
-      generic_event::payload_buffer_t& input, event_content_type& content_type, api_status* status) const override
+  int transform_serialized_payload(generic_event::payload_buffer_t& input, event_content_type& content_type,
+      std::shared_ptr<const zstd_dictionary>& dictionary, api_status* status) const override
   {
     content_type = event_content_type::IDENTITY;
+    dictionary = nullptr;
     return error_code::success;
   }
 
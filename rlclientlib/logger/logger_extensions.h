@@ -21,6 +21,7 @@ class watchdog;
 class generic_event;
 class api_status;
 class i_time_provider;
+class zstd_dictionary;
 namespace logger
 {
 template <typename TEvent>
@@ -31,13 +32,13 @@ class i_message_sender;
 namespace logger
 {
 // WARNING: This interface is a bit complex in its usage. It currently lives in the live_model_impl, but is passed
-// into the interaction logger and is eventually called in the logger thread. However, it (currently) does not
-// need any form of locking because the object is ONLY called in the SINGLE logger thead.
+// into the interaction logger and is eventually called in the logger thread. When send.transform.threads > 0, the
+// transform_* methods are called concurrently from the transform worker threads, so implementations must be
+// thread-safe (dedup_state locks its dictionary, compression only locks to collect dictionary training samples).
 // The workflow looks like:
 //   live_model_impl (owner) CONTAINS interaction_logger_facade CONTAINS generic_event_logger CONTAINS
 //     async_batcher CONTROLS logger thread AND CONTAINS a queue of generic_event. generic_event will hold a pointer to
 //     this object
-// If this condition changes, then the relevant calls must be locked!
 class i_logger_extensions
 {
 public:
@@ -61,8 +62,9 @@ public:
       utility::watchdog& watchdog, error_callback_fn* perror_cb, const char* section) = 0;
   virtual int transform_payload_and_extract_objects(
       string_view context, std::string& edited_payload, object_list_t& objects, api_status* status) = 0;
-  virtual int transform_serialized_payload(
-      payload_buffer_t& input, event_content_type& content_type, api_status* status) const = 0;
+  // dictionary is set to the zstd dictionary the payload was compressed with, nullptr if none was used
+  virtual int transform_serialized_payload(payload_buffer_t& input, event_content_type& content_type,
+      std::shared_ptr<const zstd_dictionary>& dictionary, api_status* status) const = 0;
 
   static std::unique_ptr<i_logger_extensions> get_extensions(
       const utility::configuration& config, std::unique_ptr<i_time_provider> time_provider);
@@ -2,6 +2,8 @@
 
 #include "err_constants.h"
 
+#include <utility>
+
 namespace err = reinforcement_learning::error_code;
 
 namespace reinforcement_learning
@@ -79,6 +81,33 @@ int interaction_logger_facade::init(api_status* status)
   }
 }
 
+int interaction_logger_facade::get_metrics(logger_metrics& metrics, api_status* status) const
+{
+  switch (_version)
+  {
+    case 1:
+      switch (_model_type)
+      {
+        case model_type_t::CB:
+          _v1_cb->get_metrics(metrics);
+          return error_code::success;
+        case model_type_t::CCB:
+          _v1_ccb->get_metrics(metrics);
+          return error_code::success;
+        case model_type_t::SLATES:
+          _v1_multislot->get_metrics(metrics);
+          return error_code::success;
+        default:
+          return protocol_not_supported(status);
+      }
+    case 2:
+      _v2->get_metrics(metrics);
+      return error_code::success;
+    default:
+      return protocol_not_supported(status);
+  }
+}
+
 int interaction_logger_facade::log(string_view context, unsigned int flags, const ranking_response& response,
     api_status* status, learning_mode learning_mode)
 {
@@ -91,24 +120,82 @@ int interaction_logger_facade::log(string_view context, unsigned int flags, cons
       v2::LearningModeType lmt;
       RETURN_IF_FAIL(get_learning_mode(learning_mode, lmt, status));
 
-      // needed for the serializer
-      std::vector<uint64_t> action_ids;
-      std::vector<float> probabilities;
-      std::string model_id(response.get_model_id());
-      for (auto const& r : response)
+      auto* record = acquire_cb_record(flags, lmt, response);
+      return _v2->log(record, response.get_event_id(), context, _serializer_cb.type, &_logger_extensions, status);
+    }
+    default:
+      return protocol_not_supported(status);
+  }
+}
+
+int interaction_logger_facade::log(string_view context, unsigned int flags, const ranking_response& response,
+    hashed_features& features, api_status* status, learning_mode learning_mode)
+{
+  if (_version != 2) { return log(context, flags, response, status, learning_mode); }
+
+  v2::LearningModeType lmt;
+  RETURN_IF_FAIL(get_learning_mode(learning_mode, lmt, status));
+
+  auto* record = acquire_cb_record(flags, lmt, response);
+  std::get<5>(record->get_args()) = std::move(features);
+  features.clear();
+  return _v2->log(record, response.get_event_id(), context, _serializer_cb.type, &_logger_extensions, status);
+}
+
+int interaction_logger_facade::log_batch(const std::vector<string_view>& contexts, unsigned int flags,
+    const std::vector<ranking_response>& responses, api_status* status, learning_mode learning_mode)
+{
+  switch (_version)
+  {
+    case 1:
+      for (size_t i = 0; i < responses.size(); ++i)
       {
-        action_ids.push_back(r.action_id + 1);
-        probabilities.push_back(r.probability);
+        RETURN_IF_FAIL(
+            _v1_cb->log(responses[i].get_event_id(), contexts[i], flags, responses[i], status, learning_mode));
       }
+      return error_code::success;
+    case 2:
+    {
+      v2::LearningModeType lmt;
+      RETURN_IF_FAIL(get_learning_mode(learning_mode, lmt, status));
 
-      return _v2->log(response.get_event_id(), context, _serializer_cb.type, &_logger_extensions, _serializer_cb,
-          status, flags, lmt, action_ids, probabilities, model_id);
+      std::vector<cb_record_t*> records(responses.size());
+      std::vector<const char*> event_ids(responses.size());
+      for (size_t i = 0; i < responses.size(); ++i)
+      {
+        records[i] = acquire_cb_record(flags, lmt, responses[i]);
+        event_ids[i] = responses[i].get_event_id();
+      }
+      return _v2->log_batch(records.data(), event_ids.data(), contexts.data(), records.size(), _serializer_cb.type,
+          &_logger_extensions, status);
     }
     default:
       return protocol_not_supported(status);
   }
 }
 
+interaction_logger_facade::cb_record_t* interaction_logger_facade::acquire_cb_record(
+    unsigned int flags, v2::LearningModeType lmt, const ranking_response& response)
+{
+  // needed for the serializer, written in place so that a recycled record reuses its buffers
+  auto* record = _cb_records.acquire();
+  auto& args = record->get_args();
+  std::get<0>(args) = flags;
+  std::get<1>(args) = lmt;
+  auto& action_ids = std::get<2>(args);
+  auto& probabilities = std::get<3>(args);
+  action_ids.clear();
+  probabilities.clear();
+  std::get<4>(args).assign(response.get_model_id());
+  std::get<5>(args).clear();
+  for (auto const& r : response)
+  {
+    action_ids.push_back(r.action_id + 1);
+    probabilities.push_back(r.probability);
+  }
+  return record;
+}
+
 int interaction_logger_facade::log(const char* episode_id, const char* previous_id, string_view context,
     unsigned int flags, const ranking_response& response, api_status* status)
 {
@@ -252,6 +339,21 @@ int observation_logger_facade::init(api_status* status)
   }
 }
 
+int observation_logger_facade::get_metrics(logger_metrics& metrics, api_status* status) const
+{
+  switch (_version)
+  {
+    case 1:
+      _v1->get_metrics(metrics);
+      return error_code::success;
+    case 2:
+      _v2->get_metrics(metrics);
+      return error_code::success;
+    default:
+      return protocol_not_supported(status);
+  }
+}
+
 int observation_logger_facade::log(const char* event_id, float outcome, api_status* status)
 {
   switch (_version)
@@ -5,7 +5,9 @@
 #include "constants.h"
 #include "error_callback_fn.h"
 #include "event_logger.h"
+#include "hashed_features.h"
 #include "learning_mode.h"
+#include "logger_metrics.h"
 #include "logger/logger_extensions.h"
 #include "message_sender.h"
 #include "model_mgmt.h"
@@ -38,9 +40,18 @@ public:
 
   int init(api_status* status);
 
+  int get_metrics(logger_metrics& metrics, api_status* status) const;
+
   // CB v1/v2
   int log(string_view context, unsigned int flags, const ranking_response& response, api_status* status,
       learning_mode learning_mode = ONLINE);
+  // CB v2 only, the features are moved into the event (and are left empty)
+  int log(string_view context, unsigned int flags, const ranking_response& response, hashed_features& features,
+      api_status* status, learning_mode learning_mode = ONLINE);
+
+  // CB v1/v2, one log() per response. The v2 events are queued with a single push.
+  int log_batch(const std::vector<string_view>& contexts, unsigned int flags,
+      const std::vector<ranking_response>& responses, api_status* status, learning_mode learning_mode = ONLINE);
 
   int log_decisions(std::vector<const char*>& event_ids, string_view context, unsigned int flags,
       const std::vector<std::vector<uint32_t>>& action_ids, const std::vector<std::vector<float>>& pdfs,
@@ -71,6 +82,12 @@ private:
   const std::unique_ptr<ccb_logger> _v1_ccb;
   const std::unique_ptr<multi_slot_logger> _v1_multislot;
 
+  // Records of the CB v2 path. Declared before _v2 so that it outlives the batcher flushing them on shutdown.
+  using cb_record_t = generic_event_record<cb_serializer, unsigned int, v2::LearningModeType, std::vector<uint64_t>,
+      std::vector<float>, std::string, hashed_features>;
+  event_record_pool<cb_record_t> _cb_records;
+  cb_record_t* acquire_cb_record(unsigned int flags, v2::LearningModeType lmt, const ranking_response& response);
+
   const std::unique_ptr<generic_event_logger> _v2;
 
   const cb_serializer _serializer_cb;
@@ -95,6 +112,8 @@ public:
 
   int init(api_status* status);
 
+  int get_metrics(logger_metrics& metrics, api_status* status) const;
+
   int log(const char* event_id, float outcome, api_status* status);
   int log(const char* event_id, const char* outcome, api_status* status);
 
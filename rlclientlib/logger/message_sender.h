@@ -1,5 +1,8 @@
 #pragma once
 
+#include "logger_metrics.h"
+
+#include <cstddef>
 #include <cstdint>
 #include <memory>
 namespace reinforcement_learning
@@ -20,6 +23,10 @@ public:
   virtual ~i_message_sender() = default;
   virtual int send(const uint16_t msg_type, const buffer& db, api_status* status = nullptr) = 0;
   virtual int init(api_status* status = nullptr) = 0;
+  // Number of sends accepted but not completed yet, 0 for senders completing them synchronously
+  virtual size_t in_flight_count() const { return 0; }
+  // Metrics of the underlying i_sender, false if it does not track its requests
+  virtual bool get_sender_metrics(http_sender_metrics& /*metrics*/) const { return false; }
 };
 }  // namespace logger
 }  // namespace reinforcement_learning
@@ -12,6 +12,8 @@ public:
   explicit preamble_message_sender(std::unique_ptr<i_sender>);
   int send(const uint16_t msg_type, const buffer& db, api_status* status) override;
   int init(api_status* status) override;
+  size_t in_flight_count() const override { return _sender->in_flight_count(); }
+  bool get_sender_metrics(http_sender_metrics& metrics) const override { return _sender->get_metrics(metrics); }
 
 private:
   std::unique_ptr<i_sender> _sender;
@@ -0,0 +1,168 @@
+#pragma once
+
+#include "event_queue.h"
+#include "utility/config_helper.h"
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace reinforcement_learning
+{
+// A queue split in several independently locked sub-queues. Each producer thread is hashed to one shard, so
+// request threads running on different cores do not write to the same lock or list.
+// Event indices come from a single counter shared by all shards, so they count every event pushed (including
+// subsampled ones). When they are enabled pop() merges the shards by index: the consumer holds the front event of
+// each shard and returns the one with the lowest index, so that a batch covers a range of indices rather than
+// interleaved indices from several shards. Otherwise pop() drains the shards round-robin.
+template <class T>
+class sharded_event_queue : public i_event_queue<T>
+{
+public:
+  using TFunc = typename i_event_queue<T>::TFunc;
+
+private:
+  std::vector<std::unique_ptr<event_queue<T>>> _shards;
+  size_t _max_capacity;
+  events_counter_status _event_counter_status;
+  float _subsample_rate;
+  std::atomic<uint64_t> _event_index{0};
+  size_t _next_pop_shard{0};  // only used by the consumer
+
+  // front event of each shard, taken out of it by the consumer to merge the shards by index
+  struct shard_head
+  {
+    TFunc func;
+    size_t item_size{0};
+    T* event{nullptr};  // nullptr when the head is empty
+  };
+  std::vector<shard_head> _heads;  // only used by the consumer
+  std::atomic<size_t> _heads_size{0};
+  std::atomic<size_t> _heads_capacity{0};
+
+public:
+  sharded_event_queue(size_t max_capacity, size_t shards_count,
+      events_counter_status event_counter_status = events_counter_status::DISABLE, float subsample_rate = 1.0f)
+      : _max_capacity(max_capacity), _event_counter_status(event_counter_status), _subsample_rate(subsample_rate)
+  {
+    if (shards_count == 0) { shards_count = 1; }
+    // Each shard gets an even share of the capacity: prune() drops events from the shards over their share.
+    // Indexing and subsampling are handled here, not by the shards.
+    for (size_t i = 0; i < shards_count; ++i)
+    {
+      _shards.emplace_back(new event_queue<T>(max_capacity / shards_count));
+    }
+    _heads.resize(shards_count);
+  }
+
+  bool pop(TFunc* item) override
+  {
+    if (_event_counter_status == events_counter_status::ENABLE) { return pop_lowest_index(item); }
+    for (size_t i = 0; i < _shards.size(); ++i)
+    {
+      auto& shard = _shards[_next_pop_shard];
+      _next_pop_shard = (_next_pop_shard + 1) % _shards.size();
+      if (shard->pop(item)) { return true; }
+    }
+    return false;
+  }
+
+  bool push(TFunc& item, size_t item_size, T* event) { return push(std::move(item), item_size, event); }
+
+  bool push(TFunc&& item, size_t item_size, T* event) override
+  {
+    if (_event_counter_status == events_counter_status::ENABLE)
+    {
+      event->set_event_index(_event_index.fetch_add(1, std::memory_order_relaxed) + 1);
+    }
+    // If subsampling rate is < 1, then run subsampling logic
+    if (_subsample_rate < 1)
+    {
+      if (event->try_drop(_subsample_rate, constants::SUBSAMPLE_RATE_DROP_PASS))
+      {
+        // If the event is dropped, just get out of here
+        return false;
+      }
+    }
+    return _shards[shard_index()]->push(std::move(item), item_size, event);
+  }
+
+  // The whole batch goes to the producer's shard: one index reservation and one lock acquisition.
+  size_t push_batch(TFunc* items, const size_t* item_sizes, T* const* events, size_t count) override
+  {
+    // subsampled batches are not contiguous, push them one by one
+    if (_subsample_rate < 1) { return i_event_queue<T>::push_batch(items, item_sizes, events, count); }
+    if (_event_counter_status == events_counter_status::ENABLE)
+    {
+      const uint64_t first_index = _event_index.fetch_add(count, std::memory_order_relaxed) + 1;
+      for (size_t i = 0; i < count; ++i) { events[i]->set_event_index(first_index + i); }
+    }
+    return _shards[shard_index()]->push_batch(items, item_sizes, events, count);
+  }
+
+  void drop(T* event) override
+  {
+    if (_event_counter_status == events_counter_status::ENABLE)
+    {
+      event->set_event_index(_event_index.fetch_add(1, std::memory_order_relaxed) + 1);
+    }
+    event->try_drop(0.f, constants::SUBSAMPLE_RATE_DROP_PASS);
+  }
+
+  void prune(float pass_prob) override
+  {
+    if (!is_full()) { return; }
+    for (auto& shard : _shards) { shard->prune(pass_prob); }
+  }
+
+  // approximate size
+  size_t size() override
+  {
+    size_t res = _heads_size.load(std::memory_order_relaxed);
+    for (auto& shard : _shards) { res += shard->size(); }
+    return res;
+  }
+
+  bool is_full() const override { return capacity() >= _max_capacity; }
+
+  size_t capacity() const override
+  {
+    size_t res = _heads_capacity.load(std::memory_order_relaxed);
+    for (const auto& shard : _shards) { res += shard->capacity(); }
+    return res;
+  }
+
+  size_t shards_count() const { return _shards.size(); }
+
+private:
+  bool pop_lowest_index(TFunc* item)
+  {
+    const size_t none = _heads.size();
+    size_t lowest = none;
+    for (size_t i = 0; i < _heads.size(); ++i)
+    {
+      auto& head = _heads[i];
+      if (head.event == nullptr && _shards[i]->pop(&head.func, &head.item_size, &head.event))
+      {
+        _heads_size.fetch_add(1, std::memory_order_relaxed);
+        _heads_capacity.fetch_add(head.item_size, std::memory_order_relaxed);
+      }
+      if (head.event == nullptr) { continue; }
+      if (lowest == none || head.event->get_event_index() < _heads[lowest].event->get_event_index()) { lowest = i; }
+    }
+    if (lowest == none) { return false; }
+
+    auto& head = _heads[lowest];
+    *item = std::move(head.func);
+    head.func = nullptr;
+    head.event = nullptr;
+    _heads_capacity.fetch_sub(head.item_size, std::memory_order_relaxed);
+    _heads_size.fetch_sub(1, std::memory_order_relaxed);
+    return true;
+  }
+
+  size_t shard_index() const { return std::hash<std::thread::id>()(std::this_thread::get_id()) % _shards.size(); }
+};
+}  // namespace reinforcement_learning
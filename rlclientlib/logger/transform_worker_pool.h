@@ -0,0 +1,143 @@
+#pragma once
+
+#include "api_status.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace reinforcement_learning
+{
+namespace logger
+{
+// A fixed set of threads running queued event transforms (context extraction, serialization, compression) on
+// behalf of the async_batcher thread.
+// start() hands a chunk of transforms to the workers and returns, wait() blocks until all of them are done, so that
+// the caller can serialize the previous chunk in the meantime. Each transform writes to its own output slot, so the
+// caller reads the results back in queue order and event indices are left untouched.
+template <typename TEvent>
+class transform_worker_pool
+{
+public:
+  using TFunc = std::function<int(TEvent&, api_status*)>;
+
+  explicit transform_worker_pool(size_t threads_count) : _last_report(clock_type::now())
+  {
+    if (threads_count == 0) { threads_count = 1; }
+    for (size_t i = 0; i < threads_count; ++i) { _threads.emplace_back(&transform_worker_pool::worker_loop, this); }
+  }
+
+  transform_worker_pool(const transform_worker_pool&) = delete;
+  transform_worker_pool& operator=(const transform_worker_pool&) = delete;
+
+  ~transform_worker_pool()
+  {
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _stop = true;
+    }
+    _work_cv.notify_all();
+    for (auto& t : _threads) { t.join(); }
+  }
+
+  // Starts results[i] = funcs[i](events[i], &statuses[i]) for every i in [0, count[ on the worker threads. The
+  // arrays must not be touched until wait() returns.
+  // Not reentrant: only the batcher thread calls it, and one chunk runs at a time.
+  void start(TFunc* funcs, TEvent* events, int* results, api_status* statuses, size_t count)
+  {
+    if (count == 0) { return; }
+    std::unique_lock<std::mutex> lock(_mutex);
+    // the previous chunk is done, but a worker woken late for it may still be looking at it
+    _done_cv.wait(lock, [this] { return _active == 0 && _next.load() >= _job.count; });
+    _job = {funcs, events, results, statuses, count};
+    _next.store(0);
+    ++_generation;
+    lock.unlock();
+    _work_cv.notify_all();
+  }
+
+  // Blocks until the chunk passed to the last start() is transformed.
+  void wait()
+  {
+    std::unique_lock<std::mutex> lock(_mutex);
+    // every item is claimed once _next reaches count, and claimed items are done once no worker is active
+    _done_cv.wait(lock, [this] { return _active == 0 && _next.load() >= _job.count; });
+  }
+
+  // Fraction of the workers' time spent running transforms since the previous call, in [0, 1].
+  // Close to 1 means the pool is the bottleneck of the batcher and more threads may help.
+  float utilization()
+  {
+    const auto now = clock_type::now();
+    const auto busy = _busy_ns.exchange(0);
+    std::lock_guard<std::mutex> lock(_mutex);
+    const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(now - _last_report).count();
+    _last_report = now;
+    if (elapsed <= 0) { return 0.f; }
+    const float res = static_cast<float>(busy) / (static_cast<float>(elapsed) * _threads.size());
+    return res > 1.f ? 1.f : res;
+  }
+
+  size_t threads_count() const { return _threads.size(); }
+
+private:
+  using clock_type = std::chrono::steady_clock;
+
+  struct job
+  {
+    TFunc* funcs;
+    TEvent* events;
+    int* results;
+    api_status* statuses;
+    size_t count;
+  };
+
+  void worker_loop()
+  {
+    uint64_t seen_generation = 0;
+    while (true)
+    {
+      {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _work_cv.wait(lock, [&] { return _stop || _generation != seen_generation; });
+        if (_stop) { return; }
+        seen_generation = _generation;
+        // _job is not modified while a worker is active
+        ++_active;
+      }
+
+      const auto start = clock_type::now();
+      for (size_t i = _next.fetch_add(1); i < _job.count; i = _next.fetch_add(1))
+      {
+        _job.results[i] = _job.funcs[i](_job.events[i], &_job.statuses[i]);
+      }
+      _busy_ns += static_cast<uint64_t>(
+          std::chrono::duration_cast<std::chrono::nanoseconds>(clock_type::now() - start).count());
+
+      {
+        std::lock_guard<std::mutex> lock(_mutex);
+        --_active;
+      }
+      _done_cv.notify_one();
+    }
+  }
+
+  std::vector<std::thread> _threads;
+  std::mutex _mutex;
+  std::condition_variable _work_cv;
+  std::condition_variable _done_cv;
+  bool _stop = false;
+  uint64_t _generation = 0;
+  size_t _active = 0;
+  job _job{};
+  std::atomic<size_t> _next{0};
+  std::atomic<uint64_t> _busy_ns{0};
+  clock_type::time_point _last_report;
+};
+}  // namespace logger
+}  // namespace reinforcement_learning
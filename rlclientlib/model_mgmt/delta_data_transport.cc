@@ -0,0 +1,50 @@
+#include "delta_data_transport.h"
+
+#include "api_status.h"
+#include "configuration.h"
+#include "constants.h"
+#include "trace_logger.h"
+
+namespace reinforcement_learning
+{
+namespace model_management
+{
+delta_data_transport::delta_data_transport(
+    std::unique_ptr<i_data_transport> full, std::unique_ptr<i_data_transport> delta, i_trace* trace)
+    : _full(std::move(full)), _delta(std::move(delta)), _trace(trace)
+{
+}
+
+int delta_data_transport::get_data(model_data& data, api_status* status)
+{
+  if (_need_full)
+  {
+    RETURN_IF_FAIL(_full->get_data(data, status));
+    if (data.refresh_count() > 0)
+    {
+      _need_full = false;
+      return error_code::success;
+    }
+  }
+  return _delta->get_data(data, status);
+}
+
+void delta_data_transport::request_full_model()
+{
+  TRACE_INFO(_trace, "Model delta rejected, waiting for a complete model.");
+  _need_full = true;
+}
+
+bool get_delta_config(const utility::configuration& config, utility::configuration& delta_config)
+{
+  const auto* const blob_uri = config.get(name::MODEL_DELTA_BLOB_URI, nullptr);
+  const auto* const file_name = config.get(name::MODEL_FILE_DELTA_NAME, nullptr);
+  if (blob_uri == nullptr && file_name == nullptr) { return false; }
+
+  delta_config = config;
+  if (blob_uri != nullptr) { delta_config.set(name::MODEL_BLOB_URI, blob_uri); }
+  if (file_name != nullptr) { delta_config.set(name::MODEL_FILE_NAME, file_name); }
+  return true;
+}
+}  // namespace model_management
+}  // namespace reinforcement_learning
@@ -0,0 +1,40 @@
+#pragma once
+#include "model_mgmt.h"
+
+#include <memory>
+
+namespace reinforcement_learning
+{
+class i_trace;
+namespace utility
+{
+class configuration;
+}
+namespace model_management
+{
+// Downloads model updates as deltas (see model_delta.h) instead of complete models.
+// The delta source carries every model update, either as a delta against the previous model or as a complete model.
+// The complete model source is read for the first model, and again when the loaded model cannot take a delta
+// (request_full_model()) until it holds a new model. Deltas keep being read meanwhile: the first one which applies
+// to the loaded model brings it up to date as well.
+class delta_data_transport : public i_data_transport
+{
+public:
+  delta_data_transport(
+      std::unique_ptr<i_data_transport> full, std::unique_ptr<i_data_transport> delta, i_trace* trace);
+
+  int get_data(model_data& data, api_status* status = nullptr) override;
+  void request_full_model() override;
+
+private:
+  std::unique_ptr<i_data_transport> _full;
+  std::unique_ptr<i_data_transport> _delta;
+  i_trace* _trace;
+  bool _need_full = true;
+};
+
+// Configuration of the delta source: config with the model location replaced by the delta location
+// (model.delta.blob.uri, model_file_loader.delta_file_name). Returns false if no delta location is configured.
+bool get_delta_config(const utility::configuration& config, utility::configuration& delta_config);
+}  // namespace model_management
+}  // namespace reinforcement_learning
@@ -2,6 +2,8 @@
 
 #include "api_status.h"
 #include "err_constants.h"
+#include "trace_logger.h"
+#include "utility/mapped_file.h"
 
 #include <sys/stat.h>
 #include <sys/types.h>
@@ -33,8 +35,13 @@ int file_model_loader::get_file_modified_time(time_t& file_time, api_status* sta
   RETURN_ERROR_LS(_trace, status, file_stats_error) << " file_name = " << _file_name;
 }
 
-file_model_loader::file_model_loader(std::string file_name, bool file_must_exist, i_trace* trace_logger)
-    : _file_name{std::move(file_name)}, _file_must_exist{file_must_exist}, _trace{trace_logger}
+file_model_loader::file_model_loader(
+    std::string file_name, bool file_must_exist, i_trace* trace_logger, bool use_mmap, bool use_watcher)
+    : _file_name{std::move(file_name)}
+    , _file_must_exist{file_must_exist}
+    , _trace{trace_logger}
+    , _use_mmap{use_mmap}
+    , _use_watcher{use_watcher}
 {
 }
 
@@ -45,11 +52,18 @@ int file_model_loader::init(api_status* status)
     std::ifstream in_strm(_file_name.c_str(), std::ios::in | std::ios::binary | std::ios::ate);
     if (!in_strm.good()) { RETURN_ERROR_LS(_trace, status, file_open_error) << " file_name = " << _file_name; }
   }
+  if (_use_watcher && !_watcher.watch(_file_name))
+  {
+    TRACE_INFO(_trace, "Model file cannot be watched, its changes are detected by polling.");
+  }
   return error_code::success;
 }
 
 int file_model_loader::get_data(model_data& data, api_status* status)
 {
+  // nothing happened to the file since it was loaded (always polled when not watched)
+  if (_loaded && !_watcher.changed()) { return error_code::success; }
+
   std::ifstream in_strm(_file_name.c_str(), std::ios::in | std::ios::binary | std::ios::ate);
 
   if (in_strm.good())
@@ -63,17 +77,30 @@ int file_model_loader::get_data(model_data& data, api_status* status)
     // If file has the same size and same timestamp, no need to reload
     if (curr_last_modified == _last_modified && (size_t)curr_file_size == _datasz) { return error_code::success; }
 
-    in_strm.seekg(0, std::ios::beg);
-    auto* const buff = data.alloc(curr_file_size);
-    if (!in_strm.read(buff, curr_file_size))
+    size_t loaded_size = 0;
+    if (_use_mmap)
+    {
+      in_strm.close();
+      std::shared_ptr<const char> mapped;
+      RETURN_IF_FAIL(utility::map_file(_file_name.c_str(), mapped, loaded_size, _trace, status));
+      data.set_shared(std::move(mapped), loaded_size);
+    }
+    else
     {
-      RETURN_ERROR_LS(_trace, status, file_read_error) << " file_name = " << _file_name;
+      in_strm.seekg(0, std::ios::beg);
+      auto* const buff = data.alloc(curr_file_size);
+      if (!in_strm.read(buff, curr_file_size))
+      {
+        RETURN_ERROR_LS(_trace, status, file_read_error) << " file_name = " << _file_name;
+      }
+      data.data_sz(curr_file_size);
+      in_strm.close();
+      loaded_size = (size_t)curr_file_size;
     }
-    data.data_sz(curr_file_size);
     data.increment_refresh_count();
-    in_strm.close();
     _last_modified = curr_last_modified;
-    _datasz = (size_t)curr_file_size;
+    _datasz = loaded_size;
+    _loaded = true;
   }
   else
   {
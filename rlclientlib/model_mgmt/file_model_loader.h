@@ -1,5 +1,6 @@
 #pragma once
 #include "model_mgmt.h"
+#include "utility/file_watcher.h"
 namespace reinforcement_learning
 {
 class i_trace;
@@ -9,10 +10,15 @@ namespace reinforcement_learning
 {
 namespace model_management
 {
+// Loads the model from a local file, and reloads it when the file changes.
+// With use_mmap, the model_data handed out is a read-only mapping of the file (shared, never copied by the models):
+// publish new models by renaming a new file over the old one rather than rewriting it in place.
+// With use_watcher, the file is only polled after the watcher reported a change (see utility::file_watcher).
 class file_model_loader : public i_data_transport
 {
 public:
-  file_model_loader(std::string file_name, bool file_must_exist, i_trace* trace_logger);
+  file_model_loader(std::string file_name, bool file_must_exist, i_trace* trace_logger, bool use_mmap = false,
+      bool use_watcher = false);
   int init(api_status* status = nullptr);
   int get_data(model_data& data, api_status* status = nullptr) override;
 
@@ -25,6 +31,11 @@ private:
   i_trace* _trace;
   time_t _last_modified = 0;
   size_t _datasz{};
+  bool _use_mmap;
+  bool _use_watcher;
+  bool _loaded = false;
+  // skips the stat calls while the file is untouched
+  utility::file_watcher _watcher;
 };
 
 }  // namespace model_management
@@ -0,0 +1,108 @@
+#include "model_delta.h"
+
+#include "api_status.h"
+#include "err_constants.h"
+#include "trace_logger.h"
+
+#include <cstring>
+
+namespace reinforcement_learning
+{
+namespace model_management
+{
+namespace
+{
+const char MAGIC[] = {'R', 'L', 'D', 'E', 'L', 'T', 'A', '1'};
+const size_t WEIGHT_SIZE = sizeof(uint64_t) + sizeof(float);
+
+class reader
+{
+public:
+  reader(const char* data, size_t size) : _pos(data), _end(data + size) {}
+
+  template <typename T>
+  bool read(T& value)
+  {
+    if (remaining() < sizeof(T)) { return false; }
+    std::memcpy(&value, _pos, sizeof(T));
+    _pos += sizeof(T);
+    return true;
+  }
+
+  bool read(std::string& value)
+  {
+    uint32_t length = 0;
+    if (!read(length) || remaining() < length) { return false; }
+    value.assign(_pos, length);
+    _pos += length;
+    return true;
+  }
+
+  size_t remaining() const { return static_cast<size_t>(_end - _pos); }
+
+private:
+  const char* _pos;
+  const char* _end;
+};
+
+template <typename T>
+void append(std::vector<char>& out, const T& value)
+{
+  const auto* bytes = reinterpret_cast<const char*>(&value);
+  out.insert(out.end(), bytes, bytes + sizeof(T));
+}
+
+void append(std::vector<char>& out, const std::string& value)
+{
+  append(out, static_cast<uint32_t>(value.size()));
+  out.insert(out.end(), value.begin(), value.end());
+}
+}  // namespace
+
+bool is_model_delta(const char* data, size_t size)
+{
+  return data != nullptr && size >= sizeof(MAGIC) && std::memcmp(data, MAGIC, sizeof(MAGIC)) == 0;
+}
+
+int parse_model_delta(const char* data, size_t size, model_delta& delta, i_trace* trace, api_status* status)
+{
+  if (!is_model_delta(data, size)) { RETURN_ERROR_LS(trace, status, model_delta_invalid) << "missing header"; }
+
+  reader in(data + sizeof(MAGIC), size - sizeof(MAGIC));
+  uint64_t count = 0;
+  if (!in.read(delta.base_id) || !in.read(delta.model_id) || !in.read(count))
+  {
+    RETURN_ERROR_LS(trace, status, model_delta_invalid) << "truncated header";
+  }
+  if (in.remaining() / WEIGHT_SIZE < count || in.remaining() != count * WEIGHT_SIZE)
+  {
+    RETURN_ERROR_LS(trace, status, model_delta_invalid)
+        << count << " weights announced, " << in.remaining() << " bytes left";
+  }
+
+  delta.weights.resize(static_cast<size_t>(count));
+  for (auto& w : delta.weights)
+  {
+    in.read(w.index);
+    in.read(w.value);
+  }
+  return error_code::success;
+}
+
+void write_model_delta(const model_delta& delta, std::vector<char>& out)
+{
+  out.clear();
+  out.reserve(sizeof(MAGIC) + 2 * sizeof(uint32_t) + delta.base_id.size() + delta.model_id.size() +
+      sizeof(uint64_t) + delta.weights.size() * WEIGHT_SIZE);
+  out.insert(out.end(), MAGIC, MAGIC + sizeof(MAGIC));
+  append(out, delta.base_id);
+  append(out, delta.model_id);
+  append(out, static_cast<uint64_t>(delta.weights.size()));
+  for (const auto& w : delta.weights)
+  {
+    append(out, w.index);
+    append(out, w.value);
+  }
+}
+}  // namespace model_management
+}  // namespace reinforcement_learning
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace reinforcement_learning
+{
+class api_status;
+class i_trace;
+namespace model_management
+{
+// A model update sent as the weights that changed since the model it was computed from.
+//
+// Layout (little endian):
+//   "RLDELTA1"                          8 bytes magic
+//   base_id length (uint32), bytes      id of the model the patch applies to, as reported by the model (safe_vw::id())
+//   model_id length (uint32), bytes     id of the patched model
+//   count (uint64)
+//   count x { index (uint64), value (float) }
+// index is a position in the model's weight array, as VW addresses it (feature index << stride_shift, plus the
+// offset within the stride).
+struct model_delta
+{
+  struct weight
+  {
+    uint64_t index;
+    float value;
+  };
+
+  std::string base_id;
+  std::string model_id;
+  std::vector<weight> weights;
+};
+
+// True if the data starts like a model delta. A complete model never does.
+bool is_model_delta(const char* data, size_t size);
+int parse_model_delta(const char* data, size_t size, model_delta& delta, i_trace* trace, api_status* status = nullptr);
+void write_model_delta(const model_delta& delta, std::vector<char>& out);
+}  // namespace model_management
+}  // namespace reinforcement_learning
@@ -1,29 +1,64 @@
 #include "model_mgmt.h"
 
+#include "api_status.h"
+#include "hashed_features.h"
+
+#include <algorithm>
+
 namespace reinforcement_learning
 {
 namespace model_management
 {
 
-char* model_data::data() { return _data.data(); }
-const char* model_data::data() const { return _data.data(); }
+char* model_data::data()
+{
+  // the shared memory may be a read-only mapping, a caller able to write gets its own copy
+  if (_shared)
+  {
+    _data.assign(_shared.get(), _shared.get() + _shared_sz);
+    _shared.reset();
+    _shared_sz = 0;
+  }
+  return _data.data();
+}
+const char* model_data::data() const { return _shared ? _shared.get() : _data.data(); }
 
 void model_data::increment_refresh_count() { ++_refresh_count; }
 
-size_t model_data::data_sz() const { return _data.size(); }
+size_t model_data::data_sz() const { return _shared ? _shared_sz : _data.size(); }
 
 uint32_t model_data::refresh_count() const { return _refresh_count; }
 
-void model_data::data_sz(const size_t fillsz) { _data.resize(fillsz); }
+void model_data::data_sz(const size_t fillsz)
+{
+  // shared memory can only be shrunk
+  if (_shared) { _shared_sz = (std::min)(fillsz, _shared_sz); }
+  else { _data.resize(fillsz); }
+}
 
 char* model_data::alloc(const size_t desired)
 {
+  _shared.reset();
+  _shared_sz = 0;
   _data.clear();
   _data.resize(desired);
   return _data.data();
 }
 
-void model_data::free() { _data.clear(); }
+void model_data::free()
+{
+  _shared.reset();
+  _shared_sz = 0;
+  _data.clear();
+}
+
+void model_data::set_shared(std::shared_ptr<const char> data, size_t len)
+{
+  _data.clear();
+  _data.shrink_to_fit();
+  _shared = std::move(data);
+  _shared_sz = _shared ? len : 0;
+}
 
 int model_data::set_data(const char* vw_model, size_t len)
 {
@@ -38,5 +73,28 @@ int model_data::set_data(const char* vw_model, size_t len)
   return reinforcement_learning::error_code::success;
 }
 
+int i_model::choose_rank_hashed(const char* event_id, uint64_t rnd_seed, string_view features,
+    std::vector<int>& action_ids, std::vector<float>& action_pdf, std::string& model_version, hashed_features& hashed,
+    api_status* status)
+{
+  hashed.clear();
+  return choose_rank(event_id, rnd_seed, features, action_ids, action_pdf, model_version, status);
+}
+
+int i_model::choose_rank_batch(const std::vector<const char*>& event_ids, const std::vector<uint64_t>& rnd_seeds,
+    const std::vector<string_view>& features, std::vector<std::vector<int>>& action_ids,
+    std::vector<std::vector<float>>& action_pdfs, std::vector<std::string>& model_versions, api_status* status)
+{
+  action_ids.resize(features.size());
+  action_pdfs.resize(features.size());
+  model_versions.resize(features.size());
+  for (size_t i = 0; i < features.size(); ++i)
+  {
+    RETURN_IF_FAIL(choose_rank(
+        event_ids[i], rnd_seeds[i], features[i], action_ids[i], action_pdfs[i], model_versions[i], status));
+  }
+  return error_code::success;
+}
+
 }  // namespace model_management
 }  // namespace reinforcement_learning
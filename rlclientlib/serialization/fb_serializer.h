@@ -323,22 +323,21 @@ struct fb_event_serializer<generic_event>
   using offset_vector_t = typename std::vector<flatbuffers::Offset<fb_event_t>>;
   using batch_builder_t = v2::EventBatchBuilder;
 
-  static size_t size_estimate(const generic_event& evt)
-  {
-    return evt.get_payload().size() + evt.get_context_string().size();
-  }
+  // Actual memory held by the queued event, so that the queue limits bound the process memory.
+  static size_t size_estimate(const generic_event& evt) { return evt.memory_size(); }
 
   static int serialize(generic_event& evt, flatbuffers::FlatBufferBuilder& outter_builder,
       flatbuffers::Offset<fb_event_t>& ret_val, api_status* status)
   {
-    flatbuffers::FlatBufferBuilder builder;
+    const auto& buffer = evt.get_payload();
+    // room for the payload and the metadata, so that the builder does not grow
+    flatbuffers::FlatBufferBuilder builder(buffer.size() + 1024, &flatbuffer_arena::local());
 
     const auto& ts = evt.get_client_time_gmt();
     v2::TimeStamp client_ts(ts.year, ts.month, ts.day, ts.hour, ts.minute, ts.second, ts.sub_second);
     const auto meta_offset = v2::CreateMetadataDirect(builder, evt.get_id(), &client_ts, evt.get_app_id(),
         evt.get_payload_type(), evt.get_pass_prob(), evt.get_encoding());
 
-    const auto& buffer = evt.get_payload();
     const auto payload_offset = builder.CreateVector(buffer.data(), buffer.size());
     builder.Finish(v2::CreateEvent(builder, meta_offset, payload_offset));
 
@@ -346,6 +345,9 @@ struct fb_event_serializer<generic_event>
     const auto evt_offset = outter_builder.CreateVector(event_buff.data(), event_buff.size());
     ret_val = v2::CreateSerializedEvent(outter_builder, evt_offset);
 
+    // the payload is now part of the batch, hand its buffer back to the arena
+    evt.clear_payload();
+
     return error_code::success;
   }
 };
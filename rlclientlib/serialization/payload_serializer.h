@@ -1,7 +1,5 @@
 #pragma once
 
-#pragma once
-
 #include "action_flags.h"
 #include "api_status.h"
 #include "continuous_action_response.h"
@@ -13,7 +11,9 @@
 #include "generated/v2/MultiStepEvent_generated.h"
 #include "generated/v2/OutcomeEvent_generated.h"
 #include "generic_event.h"
+#include "hashed_features.h"
 #include "learning_mode.h"
+#include "logger/flatbuffer_allocator.h"
 #include "logger/message_type.h"
 #include "ranking_event.h"
 #include "rl_string_view.h"
@@ -21,6 +21,8 @@
 
 #include <flatbuffers/flatbuffers.h>
 
+#include <algorithm>
+#include <cstring>
 #include <vector>
 
 namespace reinforcement_learning
@@ -31,68 +33,150 @@ using namespace messages::flatbuff;
 
 int get_learning_mode(learning_mode mode_in, v2::LearningModeType& mode_out, api_status* status);
 
+// Writes the context bytes straight into the builder with a single memcpy.
+inline flatbuffers::Offset<flatbuffers::Vector<uint8_t>> create_context_vector(
+    flatbuffers::FlatBufferBuilder& fbb, string_view context)
+{
+  uint8_t* dest = nullptr;
+  const auto offset = fbb.CreateUninitializedVector(context.size(), &dest);
+  if (!context.empty()) { std::memcpy(dest, context.data(), context.size()); }
+  return offset;
+}
+
 template <generic_event::payload_type_t pt>
 struct payload_serializer
 {
   const generic_event::payload_type_t type = pt;
+
+protected:
+  // Builder backed by the calling thread's flatbuffer_arena, with room for known_size bytes (the context) plus what
+  // the rest of the recent payloads of this type took, so that it does not grow (each growth copies the payload).
+  static flatbuffers::FlatBufferBuilder create_builder(size_t known_size = 0)
+  {
+    return flatbuffers::FlatBufferBuilder(known_size + extra_size(), &flatbuffer_arena::local());
+  }
+
+  // Detaches the payload. Its buffer goes back to the arena once the event has been copied into a batch.
+  static generic_event::payload_buffer_t finish(flatbuffers::FlatBufferBuilder& fbb, size_t known_size = 0)
+  {
+    // decaying maximum, so that one unusually large payload only inflates the next few hundred builders
+    const size_t observed = fbb.GetSize() > known_size ? fbb.GetSize() - known_size : 0;
+    auto& extra = extra_size();
+    extra = (std::max)(observed + BUILDER_SLACK, extra - extra / 64);
+    return fbb.Release();
+  }
+
+private:
+  static constexpr size_t BUILDER_SLACK = 256;  // vtables and alignment
+
+  static size_t& extra_size()
+  {
+    static thread_local size_t value = 1024;
+    return value;
+  }
 };
 
 struct cb_serializer : payload_serializer<generic_event::payload_type_t::PayloadType_CB>
 {
-  static generic_event::payload_buffer_t event(const std::string& context_str, unsigned int flags,
+  static generic_event::payload_buffer_t event(string_view context, unsigned int flags,
       v2::LearningModeType learning_mode, const std::vector<uint64_t>& action_ids,
       const std::vector<float>& probabilities, const std::string& model_id)
   {
-    flatbuffers::FlatBufferBuilder fbb;
+    auto fbb = create_builder(context.size());
 
-    std::vector<unsigned char> _context;
-    copy(context_str.begin(), context_str.end(), std::back_inserter(_context));
+    const auto action_ids_offset = fbb.CreateVector(action_ids);
+    const auto context_offset = create_context_vector(fbb, context);
+    const auto probabilities_offset = fbb.CreateVector(probabilities);
+    const auto model_id_offset = fbb.CreateString(model_id);
+    auto fb = v2::CreateCbEvent(fbb, flags & action_flags::DEFERRED, action_ids_offset, context_offset,
+        probabilities_offset, model_id_offset, learning_mode);
+    fbb.Finish(fb);
+    return finish(fbb, context.size());
+  }
 
-    auto fb = v2::CreateCbEventDirect(
-        fbb, flags & action_flags::DEFERRED, &action_ids, &_context, &probabilities, model_id.c_str(), learning_mode);
+  // The hashed features, if any, are logged along with the context
+  static generic_event::payload_buffer_t event(string_view context, unsigned int flags,
+      v2::LearningModeType learning_mode, const std::vector<uint64_t>& action_ids,
+      const std::vector<float>& probabilities, const std::string& model_id, const hashed_features& features)
+  {
+    if (features.empty()) { return event(context, flags, learning_mode, action_ids, probabilities, model_id); }
+
+    auto fbb = create_builder(context.size());
+
+    const auto action_ids_offset = fbb.CreateVector(action_ids);
+    const auto context_offset = create_context_vector(fbb, context);
+    const auto probabilities_offset = fbb.CreateVector(probabilities);
+    const auto model_id_offset = fbb.CreateString(model_id);
+    const auto features_offset = create_hashed_features(fbb, features);
+    auto fb = v2::CreateCbEvent(fbb, flags & action_flags::DEFERRED, action_ids_offset, context_offset,
+        probabilities_offset, model_id_offset, learning_mode, features_offset);
     fbb.Finish(fb);
-    return fbb.Release();
+    return finish(fbb, context.size());
+  }
+
+private:
+  static flatbuffers::Offset<v2::HashedFeatures> create_hashed_features(
+      flatbuffers::FlatBufferBuilder& fbb, const hashed_features& features)
+  {
+    std::vector<flatbuffers::Offset<v2::HashedExample>> examples;
+    examples.reserve(features.examples.size());
+    std::vector<flatbuffers::Offset<v2::HashedNamespace>> namespaces;
+    for (const auto& ex : features.examples)
+    {
+      namespaces.clear();
+      for (const auto& ns : ex.namespaces)
+      {
+        const auto hashes_offset = fbb.CreateVector(ns.feature_hashes);
+        const auto values_offset = fbb.CreateVector(ns.values);
+        namespaces.push_back(v2::CreateHashedNamespace(fbb, ns.index, ns.hash, hashes_offset, values_offset));
+      }
+      examples.push_back(v2::CreateHashedExample(fbb, fbb.CreateVector(namespaces)));
+    }
+    const auto examples_offset = fbb.CreateVector(examples);
+    const auto parse_options_offset = fbb.CreateString(features.parse_options);
+    return v2::CreateHashedFeatures(fbb, features.hash_seed, features.parse_mask, features.shared, examples_offset,
+        features.num_bits, parse_options_offset);
   }
 };
 
 struct ca_serializer : payload_serializer<generic_event::payload_type_t::PayloadType_CA>
 {
-  static generic_event::payload_buffer_t event(const std::string& context_str, unsigned int flags, float chosen_action,
+  static generic_event::payload_buffer_t event(string_view context, unsigned int flags, float chosen_action,
       float chosen_action_pdf_value, const std::string& model_id)
   {
-    flatbuffers::FlatBufferBuilder fbb;
-
-    std::vector<unsigned char> _context;
-    copy(context_str.begin(), context_str.end(), std::back_inserter(_context));
+    auto fbb = create_builder(context.size());
 
-    auto fb = v2::CreateCaEventDirect(
-        fbb, flags & action_flags::DEFERRED, chosen_action, &_context, chosen_action_pdf_value, model_id.c_str());
+    const auto context_offset = create_context_vector(fbb, context);
+    const auto model_id_offset = fbb.CreateString(model_id);
+    auto fb = v2::CreateCaEvent(
+        fbb, flags & action_flags::DEFERRED, chosen_action, context_offset, chosen_action_pdf_value, model_id_offset);
     fbb.Finish(fb);
-    return fbb.Release();
+    return finish(fbb, context.size());
   }
 };
 
 struct multi_slot_serializer : payload_serializer<generic_event::payload_type_t::PayloadType_Slates>
 {
-  static generic_event::payload_buffer_t event(const std::string& context_str, unsigned int flags,
+  static generic_event::payload_buffer_t event(string_view context, unsigned int flags,
       const std::vector<std::vector<uint32_t>>& action_ids, const std::vector<std::vector<float>>& pdfs,
       const std::string& model_version, const std::vector<std::string>& slot_ids,
       const std::vector<int>& baseline_actions, v2::LearningModeType learning_mode)
   {
-    flatbuffers::FlatBufferBuilder fbb;
+    auto fbb = create_builder(context.size());
     std::vector<flatbuffers::Offset<v2::SlotEvent>> slots;
 
-    std::vector<unsigned char> _context;
-    copy(context_str.begin(), context_str.end(), std::back_inserter(_context));
-
     for (size_t i = 0; i < action_ids.size(); i++)
     {
       slots.push_back(v2::CreateSlotEventDirect(fbb, &action_ids[i], &pdfs[i], slot_ids[i].c_str()));
     }
-    auto fb = v2::CreateMultiSlotEventDirect(fbb, &_context, &slots, model_version.c_str(),
-        flags & action_flags::DEFERRED, &baseline_actions, learning_mode);
+    const auto context_offset = create_context_vector(fbb, context);
+    const auto slots_offset = fbb.CreateVector(slots);
+    const auto model_version_offset = fbb.CreateString(model_version);
+    const auto baseline_actions_offset = fbb.CreateVector(baseline_actions);
+    auto fb = v2::CreateMultiSlotEvent(fbb, context_offset, slots_offset, model_version_offset,
+        flags & action_flags::DEFERRED, baseline_actions_offset, learning_mode);
     fbb.Finish(fb);
-    return fbb.Release();
+    return finish(fbb, context.size());
   }
 };
 
@@ -101,7 +185,9 @@ struct dedup_info_serializer : payload_serializer<generic_event::payload_type_t:
   static generic_event::payload_buffer_t event(
       const std::vector<generic_event::object_id_t>& object_ids, const std::vector<string_view>& object_values)
   {
-    flatbuffers::FlatBufferBuilder fbb;
+    size_t values_size = 0;
+    for (auto sv : object_values) { values_size += sv.size(); }
+    auto fbb = create_builder(values_size);
     std::vector<flatbuffers::Offset<flatbuffers::String>> vals;
     vals.reserve(object_values.size());
 
@@ -109,7 +195,7 @@ struct dedup_info_serializer : payload_serializer<generic_event::payload_type_t:
 
     auto fb = v2::CreateDedupInfoDirect(fbb, &object_ids, &vals);
     fbb.Finish(fb);
-    return fbb.Release();
+    return finish(fbb, values_size);
   }
 };
 
@@ -117,97 +203,101 @@ struct outcome_serializer : payload_serializer<generic_event::payload_type_t::Pa
 {
   static generic_event::payload_buffer_t numeric_event(float outcome)
   {
-    flatbuffers::FlatBufferBuilder fbb;
+    auto fbb = create_builder();
     const auto evt = v2::CreateNumericOutcome(fbb, outcome).Union();
     auto fb = v2::CreateOutcomeEvent(fbb, v2::OutcomeValue_numeric, evt);
     fbb.Finish(fb);
-    return fbb.Release();
+    return finish(fbb);
   }
 
   static generic_event::payload_buffer_t string_event(const char* outcome)
   {
-    flatbuffers::FlatBufferBuilder fbb;
+    auto fbb = create_builder();
     const auto evt = fbb.CreateString(outcome).Union();
     auto fb = v2::CreateOutcomeEvent(fbb, v2::OutcomeValue_literal, evt);
     fbb.Finish(fb);
-    return fbb.Release();
+    return finish(fbb);
   }
 
   static generic_event::payload_buffer_t numeric_event(int index, float outcome)
   {
-    flatbuffers::FlatBufferBuilder fbb;
+    auto fbb = create_builder();
     const auto evt = v2::CreateNumericOutcome(fbb, outcome).Union();
     const auto idx = v2::CreateNumericIndex(fbb, index).Union();
     auto fb = v2::CreateOutcomeEvent(fbb, v2::OutcomeValue_numeric, evt, v2::IndexValue_numeric, idx);
     fbb.Finish(fb);
-    return fbb.Release();
+    return finish(fbb);
   }
 
   static generic_event::payload_buffer_t numeric_event(const char* index, float outcome)
   {
-    flatbuffers::FlatBufferBuilder fbb;
+    auto fbb = create_builder();
     const auto evt = v2::CreateNumericOutcome(fbb, outcome).Union();
     const auto idx = fbb.CreateString(index).Union();
     auto fb = v2::CreateOutcomeEvent(fbb, v2::OutcomeValue_numeric, evt, v2::IndexValue_literal, idx);
     fbb.Finish(fb);
-    return fbb.Release();
+    return finish(fbb);
   }
 
   static generic_event::payload_buffer_t string_event(int index, const char* outcome)
   {
-    flatbuffers::FlatBufferBuilder fbb;
+    auto fbb = create_builder();
     const auto evt = fbb.CreateString(outcome).Union();
     const auto idx = v2::CreateNumericIndex(fbb, index).Union();
     auto fb = v2::CreateOutcomeEvent(fbb, v2::OutcomeValue_literal, evt, v2::IndexValue_numeric, idx);
     fbb.Finish(fb);
-    return fbb.Release();
+    return finish(fbb);
   }
 
   static generic_event::payload_buffer_t string_event(const char* index, const char* outcome)
   {
-    flatbuffers::FlatBufferBuilder fbb;
+    auto fbb = create_builder();
     const auto evt = fbb.CreateString(outcome).Union();
     const auto idx = fbb.CreateString(index).Union();
     auto fb = v2::CreateOutcomeEvent(fbb, v2::OutcomeValue_literal, evt, v2::IndexValue_literal, idx);
     fbb.Finish(fb);
-    return fbb.Release();
+    return finish(fbb);
   }
 
   static generic_event::payload_buffer_t report_action_taken()
   {
-    flatbuffers::FlatBufferBuilder fbb;
+    auto fbb = create_builder();
     auto fb = v2::CreateOutcomeEvent(fbb, v2::OutcomeValue_NONE, 0, v2::IndexValue_NONE, 0, true);
     fbb.Finish(fb);
-    return fbb.Release();
+    return finish(fbb);
   }
 
   static generic_event::payload_buffer_t report_action_taken(const char* index)
   {
-    flatbuffers::FlatBufferBuilder fbb;
+    auto fbb = create_builder();
     const auto idx = fbb.CreateString(index).Union();
     auto fb = v2::CreateOutcomeEvent(fbb, v2::OutcomeValue_NONE, 0, v2::IndexValue_literal, idx, true);
     fbb.Finish(fb);
-    return fbb.Release();
+    return finish(fbb);
   }
 };
 
 struct multistep_serializer : payload_serializer<generic_event::payload_type_t::PayloadType_MultiStep>
 {
-  static generic_event::payload_buffer_t event(const std::string& context_str, const std::string& previous_id,
+  static generic_event::payload_buffer_t event(string_view context, const std::string& previous_id,
       unsigned int flags, const std::vector<uint64_t>& action_ids, const std::vector<float>& probabilities,
       const std::string& event_id, const std::string& model_id)
   {
-    flatbuffers::FlatBufferBuilder fbb;
-
-    std::vector<unsigned char> _context;
-    copy(context_str.begin(), context_str.end(), std::back_inserter(_context));
+    auto fbb = create_builder(context.size());
 
+    const auto event_id_offset = fbb.CreateString(event_id);
     // TODO: we really shouldn't be checking previous_id.empty(). But to preserve behavior
     //       for compatibility with older builds of VW, keep it in for now.
-    auto fb = v2::CreateMultiStepEventDirect(fbb, event_id.c_str(), previous_id.empty() ? nullptr : previous_id.c_str(),
-        &action_ids, &_context, &probabilities, model_id.c_str(), flags & action_flags::DEFERRED);
+    const auto previous_id_offset =
+        previous_id.empty() ? flatbuffers::Offset<flatbuffers::String>() : fbb.CreateString(previous_id);
+    const auto action_ids_offset = fbb.CreateVector(action_ids);
+    const auto context_offset = create_context_vector(fbb, context);
+    const auto probabilities_offset = fbb.CreateVector(probabilities);
+    const auto model_id_offset = fbb.CreateString(model_id);
+    auto fb = v2::CreateMultiStepEvent(fbb, event_id_offset, previous_id_offset, action_ids_offset, context_offset,
+        probabilities_offset, model_id_offset, flags & action_flags::DEFERRED);
     fbb.Finish(fb);
-    return fbb.Release();
+    return finish(fbb, context.size());
   }
 };
 
@@ -215,10 +305,10 @@ struct episode_serializer : payload_serializer<generic_event::payload_type_t::Pa
 {
   static generic_event::payload_buffer_t episode_event(const char* event_id)
   {
-    flatbuffers::FlatBufferBuilder fbb;
+    auto fbb = create_builder();
     auto fb = v2::CreateEpisodeEventDirect(fbb, event_id);
     fbb.Finish(fb);
-    return fbb.Release();
+    return finish(fbb);
   }
 };
 }  // namespace logger
@@ -17,6 +17,19 @@ queue_mode_enum to_queue_mode_enum(const char* queue_mode)
   return queue_mode_enum::DROP;
 }
 
+queue_implementation_enum to_queue_implementation_enum(const char* queue_implementation)
+{
+  if (_stricmp(queue_implementation, value::QUEUE_IMPLEMENTATION_LOCK_FREE) == 0)
+  {
+    return queue_implementation_enum::LOCK_FREE;
+  }
+  if (_stricmp(queue_implementation, value::QUEUE_IMPLEMENTATION_SHARDED) == 0)
+  {
+    return queue_implementation_enum::SHARDED;
+  }
+  return queue_implementation_enum::LOCKED;
+}
+
 namespace utility
 {
 static int get_int(const configuration& config, const char* section, const char* property, int defval)
@@ -75,7 +88,20 @@ async_batcher_config get_batcher_config(const configuration& config, const char*
   res.send_high_water_mark = get_int(config, section, name::SEND_HIGH_WATER_MARK, 198 * 1024);
   res.send_batch_interval_ms = get_int(config, section, name::SEND_BATCH_INTERVAL_MS, 1000);
   res.send_queue_max_capacity = get_int(config, section, name::SEND_QUEUE_MAX_CAPACITY_KB, 16 * 1024) * 1024;
+  res.send_queue_memory_cap = static_cast<size_t>(get_int(config, section, name::SEND_QUEUE_MEMORY_CAP_KB, 0)) * 1024;
   res.queue_mode = to_queue_mode_enum(get_str(config, section, name::QUEUE_MODE, value::QUEUE_MODE_DROP));
+  res.queue_implementation = to_queue_implementation_enum(
+      get_str(config, section, name::QUEUE_IMPLEMENTATION, value::QUEUE_IMPLEMENTATION_LOCKED));
+  res.queue_ring_size = get_int(config, section, name::QUEUE_RING_SIZE, 64 * 1024);
+  res.queue_shards = get_int(config, section, name::QUEUE_SHARDS, 0);
+  res.transform_threads = get_int(config, section, name::TRANSFORM_THREADS, 0);
+  res.adaptive_batching = config.get_bool(section, name::SEND_ADAPTIVE_BATCHING, false);
+  // by default the configured interval and high water mark are the upper bounds
+  res.batch_interval_min_ms = get_int(config, section, name::SEND_BATCH_INTERVAL_MIN_MS, 10);
+  res.batch_interval_max_ms = get_int(config, section, name::SEND_BATCH_INTERVAL_MAX_MS, res.send_batch_interval_ms);
+  res.send_high_water_mark_min = get_int(config, section, name::SEND_HIGH_WATER_MARK_MIN, 16 * 1024);
+  res.send_high_water_mark_max = get_int(config, section, name::SEND_HIGH_WATER_MARK_MAX, res.send_high_water_mark);
+  res.send_queue_flush_threshold = get_float(config, section, name::SEND_QUEUE_FLUSH_THRESHOLD, 0.5f);
   res.batch_content_encoding = config.get_bool(section, name::USE_DEDUP, false) ? value::CONTENT_ENCODING_DEDUP
                                                                                 : value::CONTENT_ENCODING_IDENTITY;
   res.subsample_rate = get_float(config, section, name::SUBSAMPLE_RATE, 1.f);
@@ -87,7 +113,18 @@ async_batcher_config::async_batcher_config()
     : send_high_water_mark(198 * 1024)
     , send_batch_interval_ms(1000)
     , send_queue_max_capacity(16 * 1024 * 1024)
+    , send_queue_memory_cap(0)
     , queue_mode(queue_mode_enum::DROP)
+    , queue_implementation(queue_implementation_enum::LOCKED)
+    , queue_ring_size(64 * 1024)
+    , queue_shards(0)
+    , transform_threads(0)
+    , adaptive_batching(false)
+    , batch_interval_min_ms(10)
+    , batch_interval_max_ms(1000)
+    , send_high_water_mark_min(16 * 1024)
+    , send_high_water_mark_max(198 * 1024)
+    , send_queue_flush_threshold(0.5f)
     , event_counter_status(events_counter_status::DISABLE)
 {
 }
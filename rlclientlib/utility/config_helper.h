@@ -10,6 +10,14 @@ enum class queue_mode_enum
   BLOCK  // queue block if it is full
 };
 
+// this enum selects the queue used by the async_batcher to accumulate events
+enum class queue_implementation_enum
+{
+  LOCKED,     // std::list guarded by a mutex (default)
+  LOCK_FREE,  // bounded lock-free ring buffer, see lock_free_event_queue
+  SHARDED     // one sub-queue per group of producer threads, see sharded_event_queue
+};
+
 // this enum sets the counter for number of events behaviour in aysnc_batcher
 enum class events_counter_status
 {
@@ -29,7 +37,21 @@ struct async_batcher_config
   int send_high_water_mark;
   int send_batch_interval_ms;
   int send_queue_max_capacity;
+  // hard cap on the bytes held by the queue and the batch being built, 0 = no cap
+  size_t send_queue_memory_cap;
   queue_mode_enum queue_mode;
+  queue_implementation_enum queue_implementation;
+  int queue_ring_size;    // number of slots of the LOCK_FREE queue
+  int queue_shards;       // number of sub-queues of the SHARDED queue, 0 = number of hardware threads
+  int transform_threads;  // number of threads running event transforms, 0 = run them on the batcher thread
+  // adaptive batching: the interval and high water mark are picked within these bounds, and a flush starts as soon
+  // as the queue holds send_queue_flush_threshold * send_queue_max_capacity bytes
+  bool adaptive_batching;
+  int batch_interval_min_ms;
+  int batch_interval_max_ms;
+  int send_high_water_mark_min;
+  int send_high_water_mark_max;
+  float send_queue_flush_threshold;
   // bool use_compression;
   // bool use_dedup;
   const char* batch_content_encoding{};
@@ -0,0 +1,101 @@
+#include "file_watcher.h"
+
+#ifdef __linux__
+#  include <sys/inotify.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+
+#  include <cerrno>
+#  include <cstring>
+#endif
+
+namespace reinforcement_learning
+{
+namespace utility
+{
+file_watcher::~file_watcher() { close(); }
+
+#ifdef __linux__
+bool file_watcher::watch(const std::string& file_name)
+{
+  close();
+  _file_name = file_name;
+  // the watch would only see the link itself, not the file it points to
+  if (is_symlink()) { return false; }
+  const auto separator = file_name.find_last_of('/');
+  const std::string directory =
+      separator == std::string::npos ? "." : (separator == 0 ? "/" : file_name.substr(0, separator));
+  _name = separator == std::string::npos ? file_name : file_name.substr(separator + 1);
+
+  _fd = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if (_fd < 0) { return false; }
+  const uint32_t mask = IN_CLOSE_WRITE | IN_MODIFY | IN_MOVED_TO | IN_MOVED_FROM | IN_CREATE | IN_DELETE | IN_ATTRIB;
+  if (::inotify_add_watch(_fd, directory.c_str(), mask) < 0)
+  {
+    close();
+    return false;
+  }
+  return true;
+}
+
+bool file_watcher::changed()
+{
+  if (_fd < 0) { return true; }
+  bool res = false;
+  bool watch_removed = false;
+  alignas(inotify_event) char buffer[4096];
+  while (true)
+  {
+    const ssize_t len = ::read(_fd, buffer, sizeof(buffer));
+    if (len < 0)
+    {
+      if (errno == EINTR) { continue; }
+      // EAGAIN: no more events
+      if (errno != EAGAIN) { res = true; }
+      break;
+    }
+    if (len == 0) { break; }
+    for (ssize_t offset = 0; offset < len;)
+    {
+      const auto* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+      // events were lost
+      if ((event->mask & IN_Q_OVERFLOW) != 0) { res = true; }
+      // the directory itself went away
+      else if ((event->mask & IN_IGNORED) != 0) { watch_removed = true; }
+      else if (event->len > 0 && _name == event->name) { res = true; }
+      offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+    }
+  }
+  // nothing left to watch, or the file was replaced by a symlink: poll from now on
+  if (watch_removed || (res && is_symlink())) { close(); }
+  return res || watch_removed;
+}
+
+bool file_watcher::is_symlink() const
+{
+  struct stat result
+  {
+  };
+  return ::lstat(_file_name.c_str(), &result) == 0 && S_ISLNK(result.st_mode);
+}
+
+void file_watcher::close()
+{
+  if (_fd >= 0) { ::close(_fd); }
+  _fd = -1;
+}
+#else
+bool file_watcher::watch(const std::string& file_name)
+{
+  _file_name = file_name;
+  return false;
+}
+
+bool file_watcher::changed() { return true; }
+
+void file_watcher::close() {}
+
+bool file_watcher::is_symlink() const { return false; }
+#endif
+}  // namespace utility
+}  // namespace reinforcement_learning
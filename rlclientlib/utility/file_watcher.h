@@ -0,0 +1,41 @@
+#pragma once
+
+#include <string>
+
+namespace reinforcement_learning
+{
+namespace utility
+{
+// Reports whether a file may have changed since the previous call, without touching the file itself.
+// Uses inotify on Linux, watching the directory of the file so that files replaced by a rename are noticed too.
+// Changes behind a symlink (e.g. a mounted config directory swapping its data directory) are not seen: symlinked files
+// are not watched. Elsewhere, when inotify is not available, or when the file is a symlink, every call reports a
+// possible change and the caller falls back to polling the file.
+// Not thread safe.
+class file_watcher
+{
+public:
+  file_watcher() = default;
+  ~file_watcher();
+
+  file_watcher(const file_watcher&) = delete;
+  file_watcher& operator=(const file_watcher&) = delete;
+
+  // Returns false if the file cannot be watched (or is a symlink), changed() then always returns true.
+  bool watch(const std::string& file_name);
+
+  // True if the file was written, created, replaced, removed or touched since the previous call.
+  bool changed();
+
+  bool is_watching() const { return _fd >= 0; }
+
+private:
+  void close();
+  bool is_symlink() const;
+
+  int _fd = -1;
+  std::string _file_name;
+  std::string _name;
+};
+}  // namespace utility
+}  // namespace reinforcement_learning
@@ -1,8 +1,12 @@
 #include "http_client.h"
 
+#include "constants.h"
 #include "utility/http_helper.h"
 
+#include <atomic>
 #include <chrono>
+#include <memory>
+#include <vector>
 
 namespace reinforcement_learning
 {
@@ -30,12 +34,45 @@ private:
   web::http::client::http_client _impl;
 };
 
+// Spreads the requests to an endpoint over several clients. Each client has its own session and keep-alive
+// connections, so concurrent posts are not serialized behind one another on a single connection pool.
+class pooled_http_client : public i_http_client
+{
+public:
+  pooled_http_client(const char* url, const utility::configuration& cfg, size_t pool_size) : _url(url)
+  {
+    const auto config = utility::get_http_config(cfg);
+    for (size_t i = 0; i < pool_size; ++i)
+    {
+      _clients.emplace_back(new web::http::client::http_client(::utility::conversions::to_string_t(url), config));
+    }
+  }
+
+  pooled_http_client(const pooled_http_client&) = delete;
+  pooled_http_client& operator=(const pooled_http_client&) = delete;
+
+  response_t request(method_t method) override { return next().request(method); }
+
+  response_t request(request_t request) override { return next().request(request); }
+
+  const std::string& get_url() const override { return _url; }
+
+private:
+  web::http::client::http_client& next() { return *_clients[_next.fetch_add(1) % _clients.size()]; }
+
+  const std::string _url;
+  std::vector<std::unique_ptr<web::http::client::http_client>> _clients;
+  std::atomic<size_t> _next{0};
+};
+
 int create_http_client(const char* url, const utility::configuration& cfg, i_http_client** client, api_status* status)
 {
   int result = error_code::success;
   try
   {
-    *client = new http_client(url, cfg);
+    const auto pool_size = cfg.get_int(name::HTTP_CLIENT_POOL_SIZE, 1);
+    if (pool_size > 1) { *client = new pooled_http_client(url, cfg, static_cast<size_t>(pool_size)); }
+    else { *client = new http_client(url, cfg); }
   }
   catch (const std::exception& e)
   {
@@ -13,6 +13,7 @@ class interruptable_sleeper
   std::condition_variable _cv;
   std::mutex _mutex;
   bool _interrupt = false;
+  bool _wake = false;
 
 public:
   // waits until wake is called or the specified time passes
@@ -21,6 +22,8 @@ public:
   bool sleep(const std::chrono::duration<Rep, Period>& timeout_duration);
   // unblock sleeping thread
   void interrupt();
+  // end the current (or next) sleep early, as if it had timed out
+  void wake();
 };
 
 inline void interruptable_sleeper::interrupt()
@@ -32,6 +35,15 @@ inline void interruptable_sleeper::interrupt()
   _cv.notify_one();
 }
 
+inline void interruptable_sleeper::wake()
+{
+  {
+    std::unique_lock<std::mutex> lock(_mutex);
+    _wake = true;
+  }
+  _cv.notify_one();
+}
+
 /*
  * Sleep returns true if timeout expires and returns false if sleep was interrupted.
  */
@@ -39,7 +51,9 @@ template <class Rep, class Period>
 bool interruptable_sleeper::sleep(const std::chrono::duration<Rep, Period>& timeout_duration)
 {
   std::unique_lock<std::mutex> lock(_mutex);
-  return !(_cv.wait_for(lock, timeout_duration, [this]() { return _interrupt; }));
+  _cv.wait_for(lock, timeout_duration, [this]() { return _interrupt || _wake; });
+  _wake = false;
+  return !_interrupt;
 }
 }  // namespace utility
 }  // namespace reinforcement_learning
\ No newline at end of file
@@ -0,0 +1,111 @@
+#include "mapped_file.h"
+
+#include "api_status.h"
+#include "err_constants.h"
+#include "trace_logger.h"
+
+#include <cerrno>
+#include <cstring>
+
+#ifdef _WIN32
+#  ifndef NOMINMAX
+#    define NOMINMAX
+#  endif
+#  include <windows.h>
+#else
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+
+namespace reinforcement_learning
+{
+namespace utility
+{
+#ifdef _WIN32
+int map_file(const char* file_name, std::shared_ptr<const char>& data, size_t& size, i_trace* trace, api_status* status)
+{
+  data.reset();
+  size = 0;
+  HANDLE file = CreateFileA(file_name, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING,
+      FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file == INVALID_HANDLE_VALUE)
+  {
+    RETURN_ERROR_LS(trace, status, file_open_error) << " file_name = " << file_name << " error = " << GetLastError();
+  }
+  LARGE_INTEGER file_size;
+  if (!GetFileSizeEx(file, &file_size))
+  {
+    const auto error = GetLastError();
+    CloseHandle(file);
+    RETURN_ERROR_LS(trace, status, file_stats_error) << " file_name = " << file_name << " error = " << error;
+  }
+  if (file_size.QuadPart == 0)
+  {
+    CloseHandle(file);
+    return error_code::success;
+  }
+  // the view keeps the mapping alive, the handles can be closed right away
+  HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  CloseHandle(file);
+  if (mapping == nullptr)
+  {
+    RETURN_ERROR_LS(trace, status, file_read_error) << " file_name = " << file_name << " error = " << GetLastError();
+  }
+  const void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+  const auto error = GetLastError();
+  CloseHandle(mapping);
+  if (view == nullptr)
+  {
+    RETURN_ERROR_LS(trace, status, file_read_error) << " file_name = " << file_name << " error = " << error;
+  }
+  size = static_cast<size_t>(file_size.QuadPart);
+  data.reset(static_cast<const char*>(view), [](const char* p) { UnmapViewOfFile(p); });
+  return error_code::success;
+}
+#else
+int map_file(const char* file_name, std::shared_ptr<const char>& data, size_t& size, i_trace* trace, api_status* status)
+{
+  data.reset();
+  size = 0;
+  const int fd = ::open(file_name, O_RDONLY | O_CLOEXEC);
+  if (fd < 0)
+  {
+    RETURN_ERROR_LS(trace, status, file_open_error)
+        << " file_name = " << file_name << " error = " << std::strerror(errno);
+  }
+  struct stat stats
+  {
+  };
+  if (::fstat(fd, &stats) != 0)
+  {
+    const int error = errno;
+    ::close(fd);
+    RETURN_ERROR_LS(trace, status, file_stats_error)
+        << " file_name = " << file_name << " error = " << std::strerror(error);
+  }
+  if (stats.st_size == 0)
+  {
+    ::close(fd);
+    return error_code::success;
+  }
+  const auto length = static_cast<size_t>(stats.st_size);
+  void* addr = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+  const int error = errno;
+  // the mapping keeps the file alive, even if it is replaced or deleted
+  ::close(fd);
+  if (addr == MAP_FAILED)
+  {
+    RETURN_ERROR_LS(trace, status, file_read_error)
+        << " file_name = " << file_name << " error = " << std::strerror(error);
+  }
+  // models are read front to back once, when they are parsed
+  ::madvise(addr, length, MADV_SEQUENTIAL);
+  size = length;
+  data.reset(static_cast<const char*>(addr), [length](const char* p) { ::munmap(const_cast<char*>(p), length); });
+  return error_code::success;
+}
+#endif
+}  // namespace utility
+}  // namespace reinforcement_learning
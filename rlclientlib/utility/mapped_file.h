@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+
+namespace reinforcement_learning
+{
+class api_status;
+class i_trace;
+
+namespace utility
+{
+// Maps a whole file in memory, read-only. Pages are read from the page cache on first access instead of being copied
+// into the heap. The mapping lives as long as a copy of data does.
+// The file must not be modified in place while it is mapped (replace it with a rename instead): on POSIX systems a
+// truncated file makes reading the mapping fail.
+// An empty file yields a null data and a size of 0.
+int map_file(const char* file_name, std::shared_ptr<const char>& data, size_t& size, i_trace* trace,
+    api_status* status = nullptr);
+}  // namespace utility
+}  // namespace reinforcement_learning
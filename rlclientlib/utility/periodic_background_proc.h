@@ -5,6 +5,7 @@
 #include "interruptable_sleeper.h"
 #include "utility/watchdog.h"
 
+#include <atomic>
 #include <string>
 #include <thread>
 
@@ -28,6 +29,13 @@ public:
       error_callback_fn* perror_cb = nullptr);
   int init(BgProc* bgproc, api_status* status = nullptr);
 
+  // The interval can be changed while running, it applies from the next sleep on.
+  // It must not exceed the interval given at construction, which sets the watchdog timeout.
+  void set_interval_ms(int interval_ms);
+  int get_interval_ms() const { return _interval_ms.load(); }
+  // run the next iteration now instead of at the end of the current interval
+  void wake() { _sleeper.wake(); }
+
   // Shutdown and Destructor
   ~periodic_background_proc();
   void stop();
@@ -45,7 +53,8 @@ private:
 private:
   // Internal state
   bool _thread_is_running;
-  int _interval_ms;
+  std::atomic<int> _interval_ms;
+  const int _max_interval_ms;
   std::thread _background_thread;
   interruptable_sleeper _sleeper;
 
@@ -62,6 +71,7 @@ periodic_background_proc<BgProc>::periodic_background_proc(
     const int interval_ms, watchdog& watchdog, std::string const& proc_name, error_callback_fn* perror_cb)
     : _thread_is_running{false}
     , _interval_ms{interval_ms}
+    , _max_interval_ms{interval_ms}
     , _watchdog(watchdog)
     , _proc_name(proc_name)
     , _proc(nullptr)
@@ -92,6 +102,12 @@ int periodic_background_proc<BgProc>::init(BgProc* bgproc, api_status* status)
   return error_code::success;
 }
 
+template <typename BgProc>
+void periodic_background_proc<BgProc>::set_interval_ms(int interval_ms)
+{
+  _interval_ms = interval_ms < _max_interval_ms ? interval_ms : _max_interval_ms;
+}
+
 template <typename BgProc>
 void periodic_background_proc<BgProc>::stop()
 {
@@ -118,7 +134,7 @@ void periodic_background_proc<BGProc>::time_loop()
 {
   // The first action of the thread should be registering itself with the watchdog.
   _watchdog.register_thread(
-      std::this_thread::get_id(), _proc_name, static_cast<long long>(_interval_ms * timeout_grace_multiplier_c));
+      std::this_thread::get_id(), _proc_name, static_cast<long long>(_max_interval_ms * timeout_grace_multiplier_c));
 
   do {
     api_status status;
@@ -129,7 +145,7 @@ void periodic_background_proc<BGProc>::time_loop()
     // Run the background task once
     if (_proc->run_iteration(&status) != error_code::success) { ERROR_CALLBACK(_perror_cb, status); }
     // Cancelable sleep for interval
-  } while (_sleeper.sleep(std::chrono::milliseconds(_interval_ms)));
+  } while (_sleeper.sleep(std::chrono::milliseconds(_interval_ms.load())));
 }
 }  // namespace utility
 }  // namespace reinforcement_learning
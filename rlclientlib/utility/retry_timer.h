@@ -0,0 +1,129 @@
+#pragma once
+
+#include <pplx/pplxtasks.h>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace reinforcement_learning
+{
+namespace utility
+{
+// Exponential backoff between retries of a failed request.
+// The delay doubles on every attempt up to max_delay, and a random half of it is dropped ("equal jitter") so that
+// requests failing together (server restart, throttling) do not all retry at the same time.
+struct retry_backoff
+{
+  std::chrono::milliseconds base_delay{500};
+  std::chrono::milliseconds max_delay{30000};
+
+  // try_count: retries already attempted
+  std::chrono::milliseconds delay(size_t try_count) const
+  {
+    static thread_local std::minstd_rand generator(std::random_device{}());
+    const int64_t base = (std::max)(static_cast<int64_t>(base_delay.count()), int64_t(1));
+    const int64_t cap = (std::max)(static_cast<int64_t>(max_delay.count()), base);
+    // beyond 2^20 the cap has been reached for any sane base delay
+    const int64_t full = (std::min)(base << (std::min)(try_count, size_t(20)), cap);
+    std::uniform_int_distribution<int64_t> jitter(0, full / 2);
+    return std::chrono::milliseconds(full - jitter(generator));
+  }
+};
+
+// Completes tasks after a delay, from a single timer thread.
+// pplx has no timer: continuations that have to wait (such as http retries) chain on delay() instead of sleeping on
+// a thread of the pplx pool, which would hold back every other continuation scheduled on that thread.
+// Delays still pending when the timer is destroyed are completed immediately.
+class retry_timer
+{
+public:
+  retry_timer() : _thread(&retry_timer::timer_loop, this) {}
+
+  retry_timer(const retry_timer&) = delete;
+  retry_timer& operator=(const retry_timer&) = delete;
+
+  ~retry_timer()
+  {
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _stop = true;
+    }
+    _cv.notify_one();
+    _thread.join();
+  }
+
+  pplx::task<void> delay(std::chrono::milliseconds delay)
+  {
+    pplx::task_completion_event<void> completion;
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _entries.push(entry{clock_type::now() + delay, _sequence++, completion});
+    }
+    _cv.notify_one();
+    return pplx::create_task(completion);
+  }
+
+  size_t pending()
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _entries.size();
+  }
+
+private:
+  using clock_type = std::chrono::steady_clock;
+
+  struct entry
+  {
+    clock_type::time_point deadline;
+    uint64_t sequence;  // keeps equal deadlines in scheduling order
+    pplx::task_completion_event<void> completion;
+
+    bool operator>(const entry& other) const
+    {
+      return deadline != other.deadline ? deadline > other.deadline : sequence > other.sequence;
+    }
+  };
+
+  void timer_loop()
+  {
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (!_stop || !_entries.empty())
+    {
+      if (_entries.empty())
+      {
+        _cv.wait(lock);
+        continue;
+      }
+      const auto deadline = _entries.top().deadline;
+      if (!_stop && clock_type::now() < deadline)
+      {
+        _cv.wait_until(lock, deadline);
+        continue;
+      }
+      auto completion = _entries.top().completion;
+      _entries.pop();
+      // continuations are scheduled on the pplx pool, but do not hold the lock while handing them over
+      lock.unlock();
+      completion.set();
+      lock.lock();
+    }
+  }
+
+  std::mutex _mutex;
+  std::condition_variable _cv;
+  std::priority_queue<entry, std::vector<entry>, std::greater<entry>> _entries;
+  uint64_t _sequence = 0;
+  bool _stop = false;
+  // last: started once the members above are initialized
+  std::thread _thread;
+};
+}  // namespace utility
+}  // namespace reinforcement_learning
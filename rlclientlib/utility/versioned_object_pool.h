@@ -2,9 +2,12 @@
 #include "str_util.h"
 #include "trace_logger.h"
 
+#include <algorithm>
+#include <atomic>
 #include <functional>
 #include <memory>
 #include <mutex>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -79,15 +82,99 @@ class versioned_object_pool
   using TFactory = std::function<TObject*(void)>;
   using TObjectDeleter = std::function<void(TObject*)>;
   using impl_type = versioned_object_pool_unsafe<TObject>;
+
+  // Object kept by a thread between two checkout() calls.
+  // The owning thread, update_factory() and the pool destructor take turns on it through `state`.
+  struct thread_slot
+  {
+    enum : int
+    {
+      idle,
+      busy,
+      closed  // the pool or the thread is gone, the slot holds nothing
+    };
+
+    explicit thread_slot(versioned_object_pool* owner) : pool(owner) {}
+
+    std::atomic<int> state{idle};
+    versioned_object_pool* pool;
+    std::unique_ptr<TObject> obj;
+    int version = -1;
+  };
+  using slot_ptr = std::shared_ptr<thread_slot>;
+
+  // Slots of the calling thread, one per pool it used. Objects go back to their pool when the thread exits.
+  struct thread_slots
+  {
+    std::vector<std::pair<const versioned_object_pool*, slot_ptr>> entries;
+
+    ~thread_slots()
+    {
+      for (auto& entry : entries)
+      {
+        auto& slot = *entry.second;
+        if (!close_slot(slot)) { continue; }
+        if (slot.obj != nullptr) { slot.pool->return_to_pool(slot.obj.release(), slot.version); }
+        slot.state.store(thread_slot::closed);
+      }
+    }
+  };
+
   std::mutex _mutex;
+  std::mutex _update_mutex;
   std::unique_ptr<impl_type> _impl;
   i_trace* _trace_logger = nullptr;
+  const bool _thread_cache;
+  std::atomic<int> _version{0};          // _impl->version(), readable without the lock
+  std::vector<slot_ptr> _thread_slots;  // guarded by _mutex
 
 public:
+  // Handle returned by checkout(). Either a thread cached object, or a regular pool object when the thread cache is
+  // disabled or already in use on this thread.
+  class cached_object
+  {
+  public:
+    cached_object(cached_object&& other) noexcept
+        : _pool(other._pool), _slot(other._slot), _shared(std::move(other._shared)), _obj(other._obj)
+    {
+      other._slot = nullptr;
+      other._obj = nullptr;
+    }
+
+    cached_object(const cached_object&) = delete;
+    cached_object& operator=(const cached_object&) = delete;
+    cached_object& operator=(cached_object&&) = delete;
+
+    ~cached_object()
+    {
+      if (_slot != nullptr) { _pool->release_slot(*_slot); }
+    }
+
+    TObject* get() const { return _obj; }
+    TObject* operator->() const { return _obj; }
+    TObject& operator*() const { return *_obj; }
+
+  private:
+    friend class versioned_object_pool;
+
+    cached_object(versioned_object_pool* pool, thread_slot* slot) : _pool(pool), _slot(slot), _obj(slot->obj.get()) {}
+    explicit cached_object(std::unique_ptr<TObject, TObjectDeleter> shared)
+        : _shared(std::move(shared)), _obj(_shared.get())
+    {
+    }
+
+    versioned_object_pool* _pool = nullptr;
+    thread_slot* _slot = nullptr;
+    std::unique_ptr<TObject, TObjectDeleter> _shared;
+    TObject* _obj = nullptr;
+  };
+
   // Construct object pool given a factory function that allocates new objects when called
   // Optionally, pre-populate the pool with a given count of objects
-  versioned_object_pool(TFactory factory, int init_size = 0, i_trace* trace_logger = nullptr)
-      : _impl(new impl_type(std::move(factory), init_size, 0)), _trace_logger(trace_logger)
+  // With thread_cache, checkout() keeps one object per calling thread (see checkout())
+  versioned_object_pool(
+      TFactory factory, int init_size = 0, i_trace* trace_logger = nullptr, bool thread_cache = false)
+      : _impl(new impl_type(std::move(factory), init_size, 0)), _trace_logger(trace_logger), _thread_cache(thread_cache)
   {
   }
 
@@ -97,6 +184,19 @@ public:
 
   ~versioned_object_pool()
   {
+    // Objects cached by live threads are freed here. A thread exiting concurrently returns its object first.
+    std::vector<slot_ptr> slots;
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      slots.swap(_thread_slots);
+    }
+    for (auto& slot : slots)
+    {
+      if (!close_slot(*slot)) { continue; }
+      slot->obj.reset();
+      slot->state.store(thread_slot::closed);
+    }
+
     std::lock_guard<std::mutex> lock(_mutex);
     _impl.reset();
   }
@@ -138,20 +238,82 @@ public:
   }
 
   // Update the pool's factory function and increment version number
+  // The new generation of objects is built by the calling thread (the model refresh thread) without holding the pool
+  // lock, so get_or_create() keeps handing out current version objects in the meantime. The cut-over is a pointer swap
+  // under the lock. The previous generation is destroyed once the lock is released, and the objects still checked out
+  // are freed when they are returned.
   void update_factory(TFactory new_factory)
   {
+    // serializes updates, never taken by get_or_create()
+    std::lock_guard<std::mutex> update_lock(_update_mutex);
+
     int objects_count = 0;
     int new_version = 0;
-
-    std::lock_guard<std::mutex> lock(_mutex);
-    objects_count = _impl->size();
-    new_version = _impl->version() + 1;
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      objects_count = _impl->size();
+      new_version = _impl->version() + 1;
+    }
 
     TRACE_DEBUG(
         _trace_logger, utility::concat("versioned_object_pool::update_factory() called: pool size is ", objects_count));
 
     std::unique_ptr<impl_type> new_impl(new impl_type(std::move(new_factory), objects_count, new_version));
-    _impl.swap(new_impl);
+    std::vector<slot_ptr> slots;
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _impl.swap(new_impl);
+      _version.store(new_version);
+      prune_thread_slots();
+      slots = _thread_slots;
+    }
+    // new_impl holds the previous generation
+
+    // Free the stale objects of idle threads now rather than on their next checkout().
+    // Busy slots drop theirs when released.
+    for (auto& slot : slots)
+    {
+      int expected = thread_slot::idle;
+      if (!slot->state.compare_exchange_strong(expected, thread_slot::busy)) { continue; }
+      if (slot->version != new_version) { slot->obj.reset(); }
+      slot->state.store(thread_slot::idle);
+    }
+  }
+
+  // Retrieve an object for the calling thread. With the thread cache enabled, each thread keeps the object between
+  // calls and only goes to the shared pool (and its lock) on its first call and after a model update, so the steady
+  // state is lock free. Stale objects are freed by update_factory() or when the handle is released, whichever comes
+  // last. Falls back to get_or_create() when the thread cache is disabled or on nested calls from the same thread.
+  cached_object checkout()
+  {
+    if (!_thread_cache) { return cached_object(get_or_create()); }
+
+    thread_slot& slot = local_slot();
+    int expected = thread_slot::idle;
+    // busy: nested call on this thread, or update_factory() is freeing the stale object
+    if (!slot.state.compare_exchange_strong(expected, thread_slot::busy)) { return cached_object(get_or_create()); }
+
+    if (slot.obj == nullptr || slot.version != _version.load())
+    {
+      try
+      {
+        // the stale object goes away before a current one is taken
+        slot.obj.reset();
+        std::lock_guard<std::mutex> lock(_mutex);
+        slot.version = _impl->version();
+        TObject* pool_obj = _impl->get();
+        slot.obj.reset(pool_obj != nullptr ? pool_obj : _impl->create());
+        TRACE_DEBUG(_trace_logger,
+            utility::concat("versioned_object_pool::checkout() called: thread object refreshed, total pool size is ",
+                _impl->size()));
+      }
+      catch (...)
+      {
+        slot.state.store(thread_slot::idle);
+        throw;
+      }
+    }
+    return cached_object(this, &slot);
   }
 
   // Get a reference to the internal factory std::function
@@ -163,6 +325,58 @@ private:
     std::lock_guard<std::mutex> lock(_mutex);
     _impl->return_to_pool(obj, obj_version);
   }
+
+  void release_slot(thread_slot& slot)
+  {
+    // the model was updated while the object was in use
+    if (slot.version != _version.load()) { slot.obj.reset(); }
+    slot.state.store(thread_slot::idle);
+  }
+
+  thread_slot& local_slot()
+  {
+    static thread_local thread_slots slots;
+    for (auto& entry : slots.entries)
+    {
+      // a closed slot under this address belongs to a destroyed pool
+      if (entry.first == this && entry.second->state.load() != thread_slot::closed) { return *entry.second; }
+    }
+
+    auto& entries = slots.entries;
+    entries.erase(std::remove_if(entries.begin(), entries.end(),
+                      [](const std::pair<const versioned_object_pool*, slot_ptr>& entry)
+                      { return entry.second->state.load() == thread_slot::closed; }),
+        entries.end());
+    slot_ptr slot(new thread_slot(this));
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      prune_thread_slots();
+      _thread_slots.push_back(slot);
+    }
+    entries.emplace_back(this, slot);
+    return *slot;
+  }
+
+  // must be called under _mutex
+  void prune_thread_slots()
+  {
+    _thread_slots.erase(std::remove_if(_thread_slots.begin(), _thread_slots.end(),
+                            [](const slot_ptr& slot) { return slot->state.load() == thread_slot::closed; }),
+        _thread_slots.end());
+  }
+
+  // Wait for the slot to be idle and take it for good. Returns false if it was already closed.
+  static bool close_slot(thread_slot& slot)
+  {
+    int expected = thread_slot::idle;
+    while (!slot.state.compare_exchange_weak(expected, thread_slot::busy))
+    {
+      if (expected == thread_slot::closed) { return false; }
+      expected = thread_slot::idle;
+      std::this_thread::yield();
+    }
+    return true;
+  }
 };
 }  // namespace utility
 }  // namespace reinforcement_learning
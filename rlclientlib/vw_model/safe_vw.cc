@@ -9,8 +9,11 @@
 #include "vw/core/v_array.h"
 
 #include <algorithm>
+#include <cstring>
 #include <iostream>
 #include <iterator>
+#include <stdexcept>
+#include <string>
 #include <utility>
 
 namespace mm = reinforcement_learning::model_management;
@@ -25,6 +28,35 @@ safe_vw::safe_vw(std::shared_ptr<safe_vw> master) : _master(std::move(master))
   init();
 }
 
+safe_vw::safe_vw(std::shared_ptr<safe_vw> base, const mm::model_delta& delta)
+    // the instance seeded from base refers to the workspace base was seeded from, which must outlive it. A patched
+    // base is itself seeded from its master, so chained deltas all keep the same master alive instead of each other.
+    : _master(base->_master != nullptr ? base->_master : base)
+{
+  // dense weights wrap indices around the mask: an index past it would silently overwrite another weight
+  const uint64_t mask = base->_vw->weights.mask();
+  for (const auto& w : delta.weights)
+  {
+    if (w.index > mask)
+    {
+      throw std::out_of_range("model delta weight index " + std::to_string(w.index) +
+          " is outside of the weight mask " + std::to_string(mask));
+    }
+  }
+
+  // same configuration as base, then the weights it shares with its master are swapped for a copy of base's weights
+  // the patch can write to
+  _vw = VW::seed_vw_model(_master->_vw, "", nullptr, nullptr);
+  auto& weights = _vw->weights;
+  const auto& base_weights = base->_vw->weights;
+  if (weights.sparse) { weights.sparse_weights = VW::sparse_parameters::deep_copy(base_weights.sparse_weights); }
+  else { weights.dense_weights = VW::dense_parameters::deep_copy(base_weights.dense_weights); }
+
+  for (const auto& w : delta.weights) { weights[w.index] = w.value; }
+  _vw->id = delta.model_id;
+  init();
+}
+
 safe_vw::safe_vw(const char* model_data, size_t len)
 {
   io_buf buf;
@@ -83,6 +115,15 @@ VW::example* safe_vw::get_or_create_example()
 
 VW::example& safe_vw::get_or_create_example_f(void* vw) { return *(((safe_vw*)vw)->get_or_create_example()); }
 
+char* safe_vw::copy_to_parse_buffer(string_view context)
+{
+  // the buffer keeps its capacity, so this is a single memcpy once it has grown to the largest context seen
+  if (_parse_buffer.size() < context.size() + 1) { _parse_buffer.resize(context.size() + 1); }
+  if (!context.empty()) { std::memcpy(_parse_buffer.data(), context.data(), context.size()); }
+  _parse_buffer[context.size()] = '\0';
+  return _parse_buffer.data();
+}
+
 void safe_vw::parse_context_with_pdf(string_view context, std::vector<int>& actions, std::vector<float>& scores)
 {
   VW::parsers::json::decision_service_interaction interaction;
@@ -91,19 +132,17 @@ void safe_vw::parse_context_with_pdf(string_view context, std::vector<int>& acti
   examples.push_back(get_or_create_example());
 
   // copy due to destructive parsing by rapidjson
-  std::string line_vec(context);
+  char* line = copy_to_parse_buffer(context);
   VW::example_factory_t ex_fac = [this]() -> VW::example& { return get_or_create_example_f(this); };
 
   if (_vw->output_config.audit)
   {
     _vw->output_runtime.audit_buffer->clear();
-    VW::read_line_decision_service_json<true>(
-        *_vw, examples, &line_vec[0], line_vec.size(), false, ex_fac, &interaction);
+    VW::read_line_decision_service_json<true>(*_vw, examples, line, context.size(), false, ex_fac, &interaction);
   }
   else
   {
-    VW::read_line_decision_service_json<false>(
-        *_vw, examples, &line_vec[0], line_vec.size(), false, ex_fac, &interaction);
+    VW::read_line_decision_service_json<false>(*_vw, examples, line, context.size(), false, ex_fac, &interaction);
   }
 
   // finalize example
@@ -121,21 +160,57 @@ void safe_vw::parse_context_with_pdf(string_view context, std::vector<int>& acti
   for (auto&& ex : examples) { _example_pool.emplace_back(ex); }
 }
 
-void safe_vw::rank(string_view context, std::vector<int>& actions, std::vector<float>& scores)
+void safe_vw::export_features(const VW::multi_ex& examples, hashed_features& features) const
+{
+  features.hash_seed = _vw->runtime_config.hash_seed;
+  features.parse_mask = _vw->runtime_state.parse_mask;
+  features.num_bits = _vw->initial_weights_config.num_bits;
+  features.parse_options = _parse_options;
+  // the json parser gives the shared example of a multiline context the CB header label
+  const auto& first_costs = examples[0]->l.cb.costs;
+  features.shared = first_costs.size() == 1 && first_costs[0].probability == -1.f;
+
+  features.examples.resize(examples.size());
+  for (size_t i = 0; i < examples.size(); ++i)
+  {
+    const auto* ex = examples[i];
+    auto& namespaces = features.examples[i].namespaces;
+    namespaces.clear();
+    for (const auto index : ex->indices)
+    {
+      const auto& fs = ex->feature_space[index];
+      // a feature group holds every namespace starting with the same character
+      for (const auto& extent : fs.namespace_extents)
+      {
+        namespaces.emplace_back();
+        auto& ns = namespaces.back();
+        ns.index = index;
+        ns.hash = extent.hash;
+        ns.feature_hashes.assign(fs.indices.begin() + extent.begin_index, fs.indices.begin() + extent.end_index);
+        ns.values.assign(fs.values.begin() + extent.begin_index, fs.values.begin() + extent.end_index);
+      }
+    }
+  }
+}
+
+void safe_vw::rank(
+    string_view context, std::vector<int>& actions, std::vector<float>& scores, hashed_features* features)
 {
   VW::multi_ex examples;
   examples.push_back(get_or_create_example());
 
   // copy due to destructive parsing by rapidjson
-  std::string line_vec(context);
+  char* line = copy_to_parse_buffer(context);
   VW::example_factory_t ex_fac = [this]() -> VW::example& { return get_or_create_example_f(this); };
 
   if (_vw->output_config.audit)
   {
     _vw->output_runtime.audit_buffer->clear();
-    VW::parsers::json::read_line_json<true>(*_vw, examples, &line_vec[0], line_vec.size(), ex_fac);
+    VW::parsers::json::read_line_json<true>(*_vw, examples, line, context.size(), ex_fac);
   }
-  else { VW::parsers::json::read_line_json<false>(*_vw, examples, &line_vec[0], line_vec.size(), ex_fac); }
+  else { VW::parsers::json::read_line_json<false>(*_vw, examples, line, context.size(), ex_fac); }
+
+  if (features != nullptr) { export_features(examples, *features); }
 
   // finalize example
   VW::setup_examples(*_vw, examples);
@@ -169,15 +244,15 @@ void safe_vw::choose_continuous_action(string_view context, float& action, float
   examples.push_back(get_or_create_example());
 
   // copy due to destructive parsing by rapidjson
-  std::string line_vec(context);
+  char* line = copy_to_parse_buffer(context);
   VW::example_factory_t ex_fac = [this]() -> VW::example& { return get_or_create_example_f(this); };
 
   if (_vw->output_config.audit)
   {
     _vw->output_runtime.audit_buffer->clear();
-    VW::parsers::json::read_line_json<true>(*_vw, examples, &line_vec[0], line_vec.size(), ex_fac);
+    VW::parsers::json::read_line_json<true>(*_vw, examples, line, context.size(), ex_fac);
   }
-  else { VW::parsers::json::read_line_json<false>(*_vw, examples, &line_vec[0], line_vec.size(), ex_fac); }
+  else { VW::parsers::json::read_line_json<false>(*_vw, examples, line, context.size(), ex_fac); }
 
   // finalize example
   VW::setup_examples(*_vw, examples);
@@ -201,15 +276,15 @@ void safe_vw::rank_decisions(const std::vector<const char*>& event_ids, string_v
   examples.push_back(get_or_create_example());
 
   // copy due to destructive parsing by rapidjson
-  std::string line_vec(context);
+  char* line = copy_to_parse_buffer(context);
   VW::example_factory_t ex_fac = [this]() -> VW::example& { return get_or_create_example_f(this); };
 
   if (_vw->output_config.audit)
   {
     _vw->output_runtime.audit_buffer->clear();
-    VW::parsers::json::read_line_json<true>(*_vw, examples, &line_vec[0], line_vec.size(), ex_fac);
+    VW::parsers::json::read_line_json<true>(*_vw, examples, line, context.size(), ex_fac);
   }
-  else { VW::parsers::json::read_line_json<false>(*_vw, examples, &line_vec[0], line_vec.size(), ex_fac); }
+  else { VW::parsers::json::read_line_json<false>(*_vw, examples, line, context.size(), ex_fac); }
 
   // In order to control the seed for the sampling of each slot the event id + app id is passed in as the seed using the
   // example tag.
@@ -256,15 +331,15 @@ void safe_vw::rank_multi_slot_decisions(const char* event_id, const std::vector<
   examples.push_back(get_or_create_example());
 
   // copy due to destructive parsing by rapidjson
-  std::string line_vec(context);
+  char* line = copy_to_parse_buffer(context);
   VW::example_factory_t ex_fac = [this]() -> VW::example& { return get_or_create_example_f(this); };
 
   if (_vw->output_config.audit)
   {
     _vw->output_runtime.audit_buffer->clear();
-    VW::parsers::json::read_line_json<true>(*_vw, examples, &line_vec[0], line_vec.size(), ex_fac);
+    VW::parsers::json::read_line_json<true>(*_vw, examples, line, context.size(), ex_fac);
   }
-  else { VW::parsers::json::read_line_json<false>(*_vw, examples, &line_vec[0], line_vec.size(), ex_fac); }
+  else { VW::parsers::json::read_line_json<false>(*_vw, examples, line, context.size(), ex_fac); }
 
   // In order to control the seed for the sampling of each slot the event id + app id is passed in as the seed using the
   // example tag.
@@ -340,6 +415,29 @@ mm::model_type_t safe_vw::get_model_type(const VW::config::options_i* args)
   return mm::model_type_t::UNKNOWN;
 }
 
+std::string safe_vw::get_parse_options(VW::config::options_i& options)
+{
+  // see example_joiner::get_parse_options(), which must list the same options in the same order
+  std::string res;
+  for (const char* name : {"hash", "affix"})
+  {
+    if (options.was_supplied(name))
+    {
+      res += std::string(" --") + name + " " + options.get_typed_option<std::string>(name).value();
+    }
+  }
+  for (const char* name : {"ignore", "keep", "redefine", "ngram", "skips", "spelling", "dictionary", "quadratic",
+           "cubic", "interactions", "experimental_full_name_interactions"})
+  {
+    if (!options.was_supplied(name)) { continue; }
+    for (const auto& value : options.get_typed_option<std::vector<std::string>>(name).value())
+    {
+      res += std::string(" --") + name + " " + value;
+    }
+  }
+  return res;
+}
+
 bool safe_vw::is_compatible(const std::string& args) const
 {
   const auto local_model_type = get_model_type(args);
@@ -373,6 +471,7 @@ string_view safe_vw::get_audit_data() const
 
 void safe_vw::init()
 {
+  _parse_options = get_parse_options(*_vw->options);
   if (_vw->output_config.audit)
   {
     _vw->output_runtime.audit_buffer = std::make_shared<std::vector<char>>();
@@ -380,34 +479,69 @@ void safe_vw::init()
   }
 }
 
-safe_vw_factory::safe_vw_factory(std::string command_line) : _command_line(std::move(command_line)) {}
+safe_vw_factory::safe_vw_factory(std::string command_line) : _state(std::make_shared<master_state>())
+{
+  _state->command_line = std::move(command_line);
+}
 
-safe_vw_factory::safe_vw_factory(const model_management::model_data& master_data) : _master_data(master_data) {}
+safe_vw_factory::safe_vw_factory(const model_management::model_data& master_data)
+    : _state(std::make_shared<master_state>())
+{
+  _state->data = master_data;
+}
 
-safe_vw_factory::safe_vw_factory(const model_management::model_data&& master_data) : _master_data(master_data) {}
+safe_vw_factory::safe_vw_factory(const model_management::model_data&& master_data)
+    : _state(std::make_shared<master_state>())
+{
+  _state->data = master_data;
+}
 
 safe_vw_factory::safe_vw_factory(const model_management::model_data& master_data, std::string command_line)
-    : _master_data(master_data), _command_line(std::move(command_line))
+    : _state(std::make_shared<master_state>())
 {
+  _state->data = master_data;
+  _state->command_line = std::move(command_line);
 }
 
 safe_vw_factory::safe_vw_factory(const model_management::model_data&& master_data, std::string command_line)
-    : _master_data(master_data), _command_line(std::move(command_line))
+    : _state(std::make_shared<master_state>())
 {
+  _state->data = master_data;
+  _state->command_line = std::move(command_line);
 }
 
-safe_vw* safe_vw_factory::operator()()
+safe_vw_factory::safe_vw_factory(std::shared_ptr<safe_vw> master) : _state(std::make_shared<master_state>())
+{
+  _state->master = std::move(master);
+}
+
+std::shared_ptr<safe_vw> safe_vw_factory::get_master()
 {
-  if ((_master_data.data() != nullptr) && !_command_line.empty())
+  std::lock_guard<std::mutex> lock(_state->mutex);
+  if (_state->master != nullptr) { return _state->master; }
+
+  const auto& data = _state->data;
+  const auto& command_line = _state->command_line;
+  if ((data.data() != nullptr) && !command_line.empty())
   {
     // Construct new vw object from raw model data and command line argument
-    return new safe_vw(_master_data.data(), _master_data.data_sz(), _command_line);
+    _state->master = std::make_shared<safe_vw>(data.data(), data.data_sz(), command_line);
   }
-  if (_master_data.data() != nullptr)
+  else if (data.data() != nullptr)
   {
     // Construct new vw object from raw model data.
-    return new safe_vw(_master_data.data(), _master_data.data_sz());
+    _state->master = std::make_shared<safe_vw>(data.data(), data.data_sz());
   }
-  return new safe_vw(_command_line);
+  else { _state->master = std::make_shared<safe_vw>(command_line); }
+
+  // the serialized model is not needed anymore, give the memory back
+  _state->data = model_management::model_data();
+  return _state->master;
+}
+
+safe_vw* safe_vw_factory::operator()()
+{
+  // clones share the master's weights and keep it alive
+  return new safe_vw(get_master());
 }
 }  // namespace reinforcement_learning
@@ -1,9 +1,12 @@
 #pragma once
 
+#include "hashed_features.h"
 #include "model_mgmt.h"
+#include "model_mgmt/model_delta.h"
 #include "vw/core/vw.h"
 
 #include <memory>
+#include <mutex>
 #include <vector>
 
 namespace reinforcement_learning
@@ -14,12 +17,23 @@ class safe_vw
   std::shared_ptr<safe_vw> _master;
   VW::workspace* _vw;
   std::vector<VW::example*> _example_pool;
+  // scratch copy of the context for the in-situ json parser, reused across calls
+  std::vector<char> _parse_buffer;
+  // logged with the hashed features, see get_parse_options()
+  std::string _parse_options;
 
   VW::example* get_or_create_example();
   static VW::example& get_or_create_example_f(void* vw);
+  // returns a null terminated, writable copy of context valid until the next call
+  char* copy_to_parse_buffer(string_view context);
+  // the features of freshly parsed examples, before setup_examples() adds the constant feature
+  void export_features(const VW::multi_ex& examples, hashed_features& features) const;
 
 public:
   safe_vw(std::shared_ptr<safe_vw> master);
+  // base patched with delta, in weights of its own: instances sharing base's weights are not affected.
+  // The master base was seeded from is kept alive. Throws std::out_of_range if a weight index is outside of the mask.
+  safe_vw(std::shared_ptr<safe_vw> base, const model_management::model_delta& delta);
   safe_vw(const char* model_data, size_t len, const std::string& vw_commandline);
   safe_vw(const char* model_data, size_t len);
   safe_vw(const std::string& vw_commandline);
@@ -27,7 +41,9 @@ public:
   ~safe_vw();
 
   void parse_context_with_pdf(string_view context, std::vector<int>& actions, std::vector<float>& scores);
-  void rank(string_view context, std::vector<int>& actions, std::vector<float>& scores);
+  // features, if not null, receives the features the context was parsed into
+  void rank(string_view context, std::vector<int>& actions, std::vector<float>& scores,
+      hashed_features* features = nullptr);
   void choose_continuous_action(string_view context, float& action, float& pdf_value);
   // Used for CCB
   void rank_decisions(const std::vector<const char*>& event_ids, string_view context,
@@ -46,6 +62,9 @@ public:
 
   static model_management::model_type_t get_model_type(const std::string& args);
   static model_management::model_type_t get_model_type(const VW::config::options_i* args);
+  // The options changing the features a json context is parsed into, as "--name value" pairs in a fixed order.
+  // The trainer only uses the hashed features of a context if it was given the same ones.
+  static std::string get_parse_options(VW::config::options_i& options);
 
   friend class safe_vw_factory;
 
@@ -53,19 +72,34 @@ private:
   void init();
 };
 
+// Creates the pool's safe_vw instances. The model is deserialized once, into a master instance, on the first call.
+// Every instance returned is a clone of the master sharing its read-only weights.
+// Copies of a factory share the master, so the copy stored by the pool and the one used to validate a model update
+// deserialize the model once between them.
 class safe_vw_factory
 {
-  model_management::model_data _master_data;
-  std::string _command_line;
+  struct master_state
+  {
+    model_management::model_data data;
+    std::string command_line;
+    std::mutex mutex;
+    std::shared_ptr<safe_vw> master;  // created on first use, after which data is released
+  };
+  std::shared_ptr<master_state> _state;
 
 public:
-  // model_data is copied and stored in the factory object.
+  // model_data is copied and stored in the factory object. A memory mapped model is shared, not copied.
   safe_vw_factory(std::string command_line);
   safe_vw_factory(const model_management::model_data& master_data);
   safe_vw_factory(const model_management::model_data&& master_data);
   safe_vw_factory(const model_management::model_data& master_data, std::string command_line);
   safe_vw_factory(const model_management::model_data&& master_data, std::string command_line);
+  // instances are clones of an already constructed master
+  explicit safe_vw_factory(std::shared_ptr<safe_vw> master);
 
   safe_vw* operator()();
+
+  // the instance every instance created is a clone of
+  std::shared_ptr<safe_vw> get_master();
 };
 }  // namespace reinforcement_learning
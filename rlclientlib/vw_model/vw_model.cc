@@ -2,6 +2,7 @@
 
 #include "constants.h"
 #include "err_constants.h"
+#include "hashed_features.h"
 #include "object_factory.h"
 #include "ranking_response.h"
 #include "str_util.h"
@@ -18,8 +19,10 @@ vw_model::vw_model(i_trace* trace_logger, const utility::configuration& config)
     , _initial_command_line(std::string(config.get(name::MODEL_VW_INITIAL_COMMAND_LINE,
                                 "--cb_explore_adf --json --quiet --epsilon 0.0 --first_only --id N/A")) +
           (_audit ? " --audit" : ""))
-    , _vw_pool(safe_vw_factory(_initial_command_line),
-          config.get_int(name::VW_POOL_INIT_SIZE, value::DEFAULT_VW_POOL_INIT_SIZE), trace_logger)
+    , _factory(_initial_command_line)
+    , _vw_pool(_factory,
+          config.get_int(name::VW_POOL_INIT_SIZE, value::DEFAULT_VW_POOL_INIT_SIZE), trace_logger,
+          config.get_bool(name::VW_POOL_THREAD_CACHE, value::DEFAULT_VW_POOL_THREAD_CACHE))
     , _trace_logger(trace_logger)
 {
 }
@@ -30,6 +33,8 @@ int vw_model::update(const model_data& data, bool& model_ready, api_status* stat
   {
     TRACE_INFO(_trace_logger, utility::concat("Received new model data. With size ", data.data_sz()));
 
+    if (is_model_delta(data.data(), data.data_sz())) { return apply_delta(data, model_ready, status); }
+
     if (data.data_sz() > 0)
     {
       std::string cmd_line = add_optional_audit_flag(_quiet_commandline_options);
@@ -45,6 +50,7 @@ int vw_model::update(const model_data& data, bool& model_ready, api_status* stat
       if (test_vw->is_compatible(_initial_command_line))
       {
         // safe_vw_factory will create a copy of the model data to use for vw object construction.
+        _factory = factory;
         _vw_pool.update_factory(factory);
         model_ready = true;
       }
@@ -67,12 +73,49 @@ int vw_model::update(const model_data& data, bool& model_ready, api_status* stat
   return error_code::success;
 }
 
+int vw_model::apply_delta(const model_data& data, bool& model_ready, api_status* status)
+{
+  model_delta delta;
+  RETURN_IF_FAIL(parse_model_delta(data.data(), data.data_sz(), delta, _trace_logger, status));
+
+  const auto base = _factory.get_master();
+  const std::string current_id = base->id();
+  if (current_id == delta.model_id)
+  {
+    TRACE_INFO(_trace_logger, utility::concat("Model delta skipped, model ", current_id, " is already loaded"));
+    return error_code::success;
+  }
+  if (current_id != delta.base_id)
+  {
+    RETURN_ERROR_LS(_trace_logger, status, model_delta_base_mismatch)
+        << "current model " << current_id << ", delta from " << delta.base_id << " to " << delta.model_id;
+  }
+
+  TRACE_INFO(_trace_logger,
+      utility::concat("Applying model delta from ", delta.base_id, " to ", delta.model_id, ", ", delta.weights.size(),
+          " weights"));
+  std::shared_ptr<safe_vw> patched;
+  try
+  {
+    patched = std::make_shared<safe_vw>(base, delta);
+  }
+  catch (const std::exception& e)
+  {
+    RETURN_ERROR_LS(_trace_logger, status, model_delta_invalid) << e.what();
+  }
+  safe_vw_factory factory(std::move(patched));
+  _factory = factory;
+  _vw_pool.update_factory(factory);
+  model_ready = true;
+  return error_code::success;
+}
+
 int vw_model::choose_rank(const char* event_id, uint64_t rnd_seed, string_view features, std::vector<int>& action_ids,
     std::vector<float>& action_pdf, std::string& model_version, api_status* status)
 {
   try
   {
-    auto vw = _vw_pool.get_or_create();
+    auto vw = _vw_pool.checkout();
 
     // Get a ranked list of action_ids and corresponding pdf
     vw->rank(features, action_ids, action_pdf);
@@ -93,6 +136,65 @@ int vw_model::choose_rank(const char* event_id, uint64_t rnd_seed, string_view f
   }
 }
 
+int vw_model::choose_rank_hashed(const char* event_id, uint64_t rnd_seed, string_view features,
+    std::vector<int>& action_ids, std::vector<float>& action_pdf, std::string& model_version, hashed_features& hashed,
+    api_status* status)
+{
+  try
+  {
+    auto vw = _vw_pool.checkout();
+
+    vw->rank(features, action_ids, action_pdf, &hashed);
+
+    if (_audit) { write_audit_log(event_id, vw->get_audit_data()); }
+
+    model_version = vw->id();
+
+    return error_code::success;
+  }
+  catch (const std::exception& e)
+  {
+    RETURN_ERROR_LS(_trace_logger, status, model_rank_error) << e.what();
+  }
+  catch (...)
+  {
+    RETURN_ERROR_LS(_trace_logger, status, model_rank_error) << "Unknown error";
+  }
+}
+
+int vw_model::choose_rank_batch(const std::vector<const char*>& event_ids, const std::vector<uint64_t>& rnd_seeds,
+    const std::vector<string_view>& features, std::vector<std::vector<int>>& action_ids,
+    std::vector<std::vector<float>>& action_pdfs, std::vector<std::string>& model_versions, api_status* status)
+{
+  try
+  {
+    // One checkout for the whole batch: every context is ranked by the same model and the pool is only touched once.
+    auto vw = _vw_pool.checkout();
+
+    action_ids.resize(features.size());
+    action_pdfs.resize(features.size());
+    model_versions.resize(features.size());
+    for (size_t i = 0; i < features.size(); ++i)
+    {
+      vw->rank(features[i], action_ids[i], action_pdfs[i]);
+
+      if (_audit) { write_audit_log(event_ids[i], vw->get_audit_data()); }
+
+      model_versions[i] = vw->id();
+    }
+
+    return error_code::success;
+  }
+  catch (const std::exception& e)
+  {
+    RETURN_ERROR_LS(_trace_logger, status, model_rank_error) << e.what();
+  }
+  catch (...)
+  {
+    RETURN_ERROR_LS(_trace_logger, status, model_rank_error) << "Unknown error";
+  }
+}
+
 int vw_model::choose_rank_multistep(const char* event_id, uint64_t rnd_seed, string_view features,
     const episode_history& history, std::vector<int>& action_ids, std::vector<float>& action_pdf,
     std::string& model_version, api_status* status)
@@ -105,7 +207,7 @@ int vw_model::choose_continuous_action(
 {
   try
   {
-    auto vw = _vw_pool.get_or_create();
+    auto vw = _vw_pool.checkout();
 
     vw->choose_continuous_action(features, action, pdf_value);
 
@@ -129,7 +231,7 @@ int vw_model::request_decision(const std::vector<const char*>& event_ids, string
 {
   try
   {
-    auto vw = _vw_pool.get_or_create();
+    auto vw = _vw_pool.checkout();
 
     // Get a ranked list of action_ids and corresponding pdf
     vw->rank_decisions(event_ids, features, actions_ids, action_pdfs);
@@ -154,7 +256,7 @@ int vw_model::request_multi_slot_decision(const char* event_id, const std::vecto
 {
   try
   {
-    auto vw = _vw_pool.get_or_create();
+    auto vw = _vw_pool.checkout();
 
     // Get a ranked list of action_ids and corresponding pdf
     vw->rank_multi_slot_decisions(event_id, slot_ids, features, actions_ids, action_pdfs);
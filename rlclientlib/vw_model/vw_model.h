@@ -21,6 +21,7 @@ class vw_model : public i_model
 {
   std::string add_optional_audit_flag(const std::string& command_line) const;
   void write_audit_log(const char* event_id, string_view audit_buffer) const;
+  int apply_delta(const model_data& data, bool& model_ready, api_status* status);
 
 public:
   vw_model(i_trace* trace_logger, const utility::configuration& config);
@@ -28,6 +29,13 @@ public:
   int update(const model_data& data, bool& model_ready, api_status* status = nullptr) override;
   int choose_rank(const char* event_id, uint64_t rnd_seed, string_view features, std::vector<int>& action_ids,
       std::vector<float>& action_pdf, std::string& model_version, api_status* status = nullptr) override;
+  int choose_rank_hashed(const char* event_id, uint64_t rnd_seed, string_view features, std::vector<int>& action_ids,
+      std::vector<float>& action_pdf, std::string& model_version, hashed_features& hashed,
+      api_status* status = nullptr) override;
+  int choose_rank_batch(const std::vector<const char*>& event_ids, const std::vector<uint64_t>& rnd_seeds,
+      const std::vector<string_view>& features, std::vector<std::vector<int>>& action_ids,
+      std::vector<std::vector<float>>& action_pdfs, std::vector<std::string>& model_versions,
+      api_status* status = nullptr) override;
   int choose_continuous_action(string_view features, float& action, float& pdf_value, std::string& model_version,
       api_status* status = nullptr) override;
   int request_decision(const std::vector<const char*>& event_ids, string_view features,
@@ -47,6 +55,8 @@ private:
   const std::string _initial_command_line;
   const std::string _quiet_commandline_options{"--json --quiet"};
   const std::string _upgrade_to_CCB_vw_commandline_options{"--ccb_explore_adf --json --quiet"};
+  // factory of the current model, whose master the next delta applies to
+  safe_vw_factory _factory;
   utility::versioned_object_pool<safe_vw> _vw_pool;
   i_trace* _trace_logger;
 };
@@ -10,8 +10,10 @@
 #include "serialization/json_serializer.h"
 #include "vw/core/vw_math.h"
 
+#include <algorithm>
 #include <memory>
 #include <string>
+#include <thread>
 #include <vector>
 
 using namespace reinforcement_learning;
@@ -128,6 +130,28 @@ struct json_event_serializer<config_drop_event>
 }  // namespace logger
 }  // namespace reinforcement_learning
 
+// collection serializer recording the original event count of every batch in the batcher's shared state
+template <typename TEvent>
+struct counting_collection_serializer : logger::json_collection_serializer<TEvent>
+{
+  using base_t = logger::json_collection_serializer<TEvent>;
+  using shared_state_t = std::vector<uint64_t>;
+  using base_t::finalize;
+
+  counting_collection_serializer(utility::data_buffer& buffer, const char* content_encoding, shared_state_t& counts)
+      : base_t(buffer, content_encoding), _counts(counts)
+  {
+  }
+
+  int finalize(api_status* status, uint64_t original_event_count)
+  {
+    _counts.push_back(original_event_count);
+    return finalize(status);
+  }
+
+  shared_state_t& _counts;
+};
+
 void expect_no_error(const api_status& s, void* cntxt)
 {
   BOOST_ASSERT(s.get_error_code() == error_code::success);
@@ -415,3 +439,266 @@ BOOST_AUTO_TEST_CASE(get_batcher_config_counter_status_test)
   batcher_config = utility::get_batcher_config(config, OBSERVATION_SECTION);
   BOOST_ASSERT(batcher_config.event_counter_status == events_counter_status::DISABLE);
 }
+
+BOOST_AUTO_TEST_CASE(get_batcher_config_queue_implementation_test)
+{
+  utility::configuration config;
+  auto batcher_config = utility::get_batcher_config(config, INTERACTION_SECTION);
+  BOOST_ASSERT(batcher_config.queue_implementation == queue_implementation_enum::LOCKED);
+  config.set("queue.implementation", "LOCK_FREE");
+  config.set("interaction.queue.ring.size", "128");
+  batcher_config = utility::get_batcher_config(config, INTERACTION_SECTION);
+  BOOST_ASSERT(batcher_config.queue_implementation == queue_implementation_enum::LOCK_FREE);
+  BOOST_CHECK_EQUAL(batcher_config.queue_ring_size, 128);
+  batcher_config = utility::get_batcher_config(config, OBSERVATION_SECTION);
+  BOOST_CHECK_EQUAL(batcher_config.queue_ring_size, 64 * 1024);
+}
+
+BOOST_AUTO_TEST_CASE(get_batcher_config_transform_threads_test)
+{
+  utility::configuration config;
+  auto batcher_config = utility::get_batcher_config(config, INTERACTION_SECTION);
+  BOOST_CHECK_EQUAL(batcher_config.transform_threads, 0);
+  config.set("interaction.send.transform.threads", "4");
+  batcher_config = utility::get_batcher_config(config, INTERACTION_SECTION);
+  BOOST_CHECK_EQUAL(batcher_config.transform_threads, 4);
+  batcher_config = utility::get_batcher_config(config, OBSERVATION_SECTION);
+  BOOST_CHECK_EQUAL(batcher_config.transform_threads, 0);
+}
+
+// transforms run on the worker pool, but events are still batched in queue order
+BOOST_AUTO_TEST_CASE(flush_with_transform_threads)
+{
+  std::vector<std::string> items;
+  std::unique_ptr<logger::i_message_sender> s(new message_sender(items));
+  error_callback_fn error_fn(expect_no_error, nullptr);
+  utility::watchdog watchdog(nullptr);
+  utility::async_batcher_config config;
+  config.send_batch_interval_ms = static_cast<int>(100000);
+  // the json batches of the test are only read back correctly while they fit in the first 2KB of the buffer
+  config.send_high_water_mark = 1024;
+  config.transform_threads = 4;
+  int dummy = 0;
+
+  std::string expected;
+  float utilization = -1.f;
+  {
+    std::unique_ptr<logger::async_batcher<test_undroppable_event>> batcher(
+        new logger::async_batcher<test_undroppable_event>(std::move(s), watchdog, dummy, &error_fn, config));
+    batcher->init(nullptr);
+
+    for (int i = 0; i < 1000; ++i)
+    {
+      const std::string id = std::to_string(i);
+      auto evt_sp = std::make_shared<test_undroppable_event>(id);
+      auto evt_fn = [evt_sp](test_undroppable_event& out_evt, api_status* status) -> int
+      {
+        out_evt = std::move(*evt_sp);
+        return error_code::success;
+      };
+      batcher->append(std::move(evt_fn), evt_sp.get(), nullptr);
+      expected += id + "\n";
+    }
+    utilization = batcher->get_batching_metrics().transform_utilization;
+  }
+
+  BOOST_CHECK_GE(utilization, 0.f);
+  BOOST_CHECK_LE(utilization, 1.f);
+  std::string received;
+  for (const auto& item : items) { received += item; }
+  BOOST_CHECK_EQUAL(received, expected);
+}
+
+// adaptive batching: a queue past the fill threshold is flushed without waiting for the timer
+BOOST_AUTO_TEST_CASE(adaptive_batching_flushes_early)
+{
+  std::vector<std::string> items;
+  std::unique_ptr<logger::i_message_sender> s(new message_sender(items));
+  error_callback_fn error_fn(expect_no_error, nullptr);
+  utility::watchdog watchdog(nullptr);
+  utility::async_batcher_config config;
+  config.send_batch_interval_ms = 100000;
+  config.adaptive_batching = true;
+  config.batch_interval_min_ms = 100000;
+  config.batch_interval_max_ms = 100000;
+  config.send_queue_max_capacity = 10;  // events are 1 byte each
+  config.send_queue_flush_threshold = 0.5f;
+  int dummy = 0;
+  logger::async_batcher<test_undroppable_event> batcher(std::move(s), watchdog, dummy, &error_fn, config);
+  batcher.init(nullptr);
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+  std::string expected;
+  for (int i = 0; i < 5; ++i)
+  {
+    const std::string id = std::to_string(i);
+    auto evt_sp = std::make_shared<test_undroppable_event>(id);
+    auto evt_fn = [evt_sp](test_undroppable_event& out_evt, api_status* status) -> int
+    {
+      out_evt = std::move(*evt_sp);
+      return error_code::success;
+    };
+    batcher.append(std::move(evt_fn), evt_sp.get(), nullptr);
+    expected += id + "\n";
+  }
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(250));
+  BOOST_REQUIRE_EQUAL(items.size(), 1);
+  BOOST_CHECK_EQUAL(items[0], expected);
+  const auto metrics = batcher.get_batching_metrics();
+  BOOST_CHECK_EQUAL(metrics.early_flushes, 1);
+  BOOST_CHECK_EQUAL(metrics.interval_ms, 100000);
+}
+
+BOOST_AUTO_TEST_CASE(adaptive_batch_controller_tracks_traffic)
+{
+  logger::adaptive_batching_config bounds;
+  bounds.min_interval_ms = 10;
+  bounds.max_interval_ms = 1000;
+  bounds.min_high_water_mark = 1024;
+  bounds.max_high_water_mark = 100 * 1024;
+  logger::adaptive_batch_controller controller(bounds, 500, 10 * 1024);
+
+  // 100 bytes per second: the longest interval and the smallest batches
+  for (int i = 0; i < 20; ++i) { controller.update(100, 1000.f, 1.f, 1, 0, false); }
+  BOOST_CHECK_EQUAL(controller.interval_ms(), 1000);
+  BOOST_CHECK_EQUAL(controller.high_water_mark(), 1024);
+
+  // 10MB per second: short intervals, each flush sending full batches
+  for (int i = 0; i < 20; ++i) { controller.update(100 * 1024, 10.f, 1.f, 1, 0, false); }
+  BOOST_CHECK_LT(controller.interval_ms(), 20);
+  BOOST_CHECK_EQUAL(controller.high_water_mark(), 100 * 1024);
+
+  // a sender taking 50ms per batch, with more and more batches in flight: the interval is stretched past the latency
+  const int interval_ms = controller.interval_ms();
+  for (size_t in_flight = 1; in_flight <= 5; ++in_flight)
+  {
+    controller.update(100 * 1024, 10.f, 50.f, 1, in_flight, false);
+  }
+  BOOST_CHECK_GT(controller.interval_ms(), interval_ms);
+  BOOST_CHECK_GE(controller.interval_ms(), 40);
+  BOOST_CHECK_EQUAL(controller.metrics().flushes, 45);
+  BOOST_CHECK_EQUAL(controller.metrics().in_flight, 5);
+}
+
+// events over send.queue.memory_cap.kb are dropped in DROP mode, and the gauge reports the bytes held
+BOOST_AUTO_TEST_CASE(memory_cap_drops_events)
+{
+  std::vector<std::string> items;
+  std::unique_ptr<logger::i_message_sender> s(new message_sender(items));
+  error_callback_fn error_fn(expect_no_error, nullptr);
+  utility::watchdog watchdog(nullptr);
+  utility::async_batcher_config config;
+  config.send_batch_interval_ms = 100000;
+  config.send_queue_memory_cap = 3;  // events are 1 byte each
+  int dummy = 0;
+  logger::async_batcher<test_droppable_event> batcher(std::move(s), watchdog, dummy, &error_fn, config);
+  batcher.init(nullptr);
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+  for (int i = 0; i < 5; ++i)
+  {
+    auto evt_sp = std::make_shared<test_droppable_event>(std::to_string(i));
+    auto evt_fn = [evt_sp](test_droppable_event& out_evt, api_status* status) -> int
+    {
+      out_evt = std::move(*evt_sp);
+      return error_code::success;
+    };
+    batcher.append(std::move(evt_fn), evt_sp.get(), nullptr);
+  }
+
+  const auto metrics = batcher.get_batching_metrics();
+  BOOST_CHECK_EQUAL(metrics.memory_cap_drops, 2);
+  BOOST_CHECK_EQUAL(metrics.memory_bytes, 3);
+}
+
+// in BLOCK mode a producer over send.queue.memory_cap.kb waits until a sent batch releases its memory
+BOOST_AUTO_TEST_CASE(memory_cap_blocks_until_batch_sent)
+{
+  std::vector<std::string> items;
+  std::unique_ptr<logger::i_message_sender> s(new message_sender(items));
+  error_callback_fn error_fn(expect_no_error, nullptr);
+  utility::watchdog watchdog(nullptr);
+  utility::async_batcher_config config;
+  config.send_batch_interval_ms = 20;
+  config.send_queue_memory_cap = 3;  // events are 1 byte each
+  config.queue_mode = queue_mode_enum::BLOCK;
+  int dummy = 0;
+  int n = 10;
+
+  {
+    logger::async_batcher<test_droppable_event> batcher(std::move(s), watchdog, dummy, &error_fn, config);
+    batcher.init(nullptr);
+    for (int i = 0; i < n; ++i)
+    {
+      auto evt_sp = std::make_shared<test_droppable_event>(std::to_string(i));
+      auto evt_fn = [evt_sp](test_droppable_event& out_evt, api_status* status) -> int
+      {
+        out_evt = std::move(*evt_sp);
+        return error_code::success;
+      };
+      batcher.append(std::move(evt_fn), evt_sp.get(), nullptr);
+    }
+    BOOST_CHECK_EQUAL(batcher.get_batching_metrics().memory_cap_drops, 0);
+  }
+
+  // every event was sent, at most 3 per batch
+  std::string expected_output;
+  for (int i = 0; i < n; ++i) { expected_output += std::to_string(i) + "\n"; }
+  std::string actual_output;
+  for (const auto& item : items) { actual_output.append(item); }
+  BOOST_CHECK_EQUAL(actual_output, expected_output);
+  BOOST_CHECK_GE(items.size(), 4);
+}
+
+// with a sharded queue the batches still count every event once, whichever shards the producers were hashed to
+BOOST_AUTO_TEST_CASE(sharded_queue_original_event_count)
+{
+  std::vector<std::string> items;
+  std::unique_ptr<logger::i_message_sender> s(new message_sender(items));
+  error_callback_fn error_fn(expect_no_error, nullptr);
+  utility::watchdog watchdog(nullptr);
+  utility::async_batcher_config config;
+  config.send_batch_interval_ms = 1;
+  config.send_high_water_mark = 64;
+  config.queue_implementation = queue_implementation_enum::SHARDED;
+  config.queue_shards = 16;
+  config.event_counter_status = events_counter_status::ENABLE;
+  std::vector<uint64_t> counts;
+  const int producers = 2;
+  const int per_producer = 2000;
+
+  {
+    logger::async_batcher<test_undroppable_event, counting_collection_serializer> batcher(
+        std::move(s), watchdog, counts, &error_fn, config);
+    batcher.init(nullptr);
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; ++p)
+    {
+      threads.emplace_back(
+          [&batcher, p]
+          {
+            for (int i = 0; i < per_producer; ++i)
+            {
+              auto evt_sp = std::make_shared<test_undroppable_event>(std::to_string(p));
+              auto evt_fn = [evt_sp](test_undroppable_event& out_evt, api_status* status) -> int
+              {
+                out_evt = std::move(*evt_sp);
+                return error_code::success;
+              };
+              batcher.append(std::move(evt_fn), evt_sp.get(), nullptr);
+            }
+          });
+    }
+    for (auto& t : threads) { t.join(); }
+  }
+
+  BOOST_CHECK_GT(counts.size(), 1);
+  uint64_t total = 0;
+  for (auto count : counts) { total += count; }
+  BOOST_CHECK_EQUAL(total, producers * per_producer);
+
+  size_t sent = 0;
+  for (const auto& item : items) { sent += std::count(item.begin(), item.end(), '\n'); }
+  BOOST_CHECK_EQUAL(sent, producers * per_producer);
+}
@@ -4,12 +4,39 @@
 
 #include <boost/test/unit_test.hpp>
 
+#include "constants.h"
+#include "data_buffer.h"
 #include "dedup_internals.h"
+#include "logger/async_batcher.h"
+#include "logger/message_sender.h"
+#include "logger/message_type.h"
+#include "utility/watchdog.h"
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
 
 namespace r = reinforcement_learning;
 namespace err = reinforcement_learning::error_code;
 namespace fb = flatbuffers;
 
+class counting_sender : public r::logger::i_message_sender
+{
+public:
+  explicit counting_sender(std::vector<uint16_t>& msg_types) : _msg_types(msg_types) {}
+
+  int send(const uint16_t msg_type, const buffer& db, r::api_status* status = nullptr) override
+  {
+    _msg_types.push_back(msg_type);
+    return err::success;
+  }
+  int init(r::api_status* status) override { return err::success; }
+
+private:
+  std::vector<uint16_t>& _msg_types;
+};
+
 fb::DetachedBuffer str_to_buff(const char* str)
 {
   auto len = strlen(str) + 1;
@@ -118,6 +145,91 @@ BOOST_AUTO_TEST_CASE(dedup_simple_json)
   BOOST_CHECK_EQUAL(false, dict.remove_object(178626470));
 }
 
+BOOST_AUTO_TEST_CASE(dedup_extract_objects_single_pass)
+{
+  // small objects grow when replaced, nested arrays and _multi keys below the top level are left alone
+  std::string payload =
+      R"({"_multi":[{},{"a":{"_multi":[{"x":1}]}},{"b":[{"c":1}]}],"s":"\"_multi\"","t":[{"u":1}]})";
+
+  std::string p_out;
+  std::vector<r::dedup_dict::object_ref> objects;
+  BOOST_CHECK_EQUAL(err::success, r::dedup_dict::extract_objects(payload, p_out, objects, nullptr));
+  BOOST_REQUIRE_EQUAL(3, objects.size());
+  BOOST_CHECK_EQUAL("{}", payload.substr(objects[0].offset, objects[0].length));
+  BOOST_CHECK_EQUAL(R"({"a":{"_multi":[{"x":1}]}})", payload.substr(objects[1].offset, objects[1].length));
+  BOOST_CHECK_EQUAL(R"({"b":[{"c":1}]})", payload.substr(objects[2].offset, objects[2].length));
+
+  std::string expected = R"({"_multi":[{"__aid":)" + std::to_string(objects[0].id) + R"(},{"__aid":)" +
+      std::to_string(objects[1].id) + R"(},{"__aid":)" + std::to_string(objects[2].id) +
+      R"(}],"s":"\"_multi\"","t":[{"u":1}]})";
+  BOOST_CHECK_EQUAL(expected, p_out);
+
+  // the dictionary is only updated by add_objects
+  r::dedup_dict dict;
+  BOOST_CHECK_EQUAL(0, dict.size());
+  dict.add_objects(payload, objects);
+  BOOST_CHECK_EQUAL(3, dict.size());
+  BOOST_CHECK_EQUAL("{}", dict.get_object(objects[0].id));
+}
+
+BOOST_AUTO_TEST_CASE(dedup_arena_recycles_chunks)
+{
+  r::dedup_arena arena;
+  std::string content(1000, 'x');
+  std::vector<r::dedup_arena::chunk*> owners;
+  for (int i = 0; i < 200; ++i)
+  {
+    r::dedup_arena::chunk* owner = nullptr;
+    const char* stored = arena.store(content.data(), content.size(), owner);
+    BOOST_CHECK_EQUAL(0, memcmp(stored, content.data(), content.size()));
+    owners.push_back(owner);
+  }
+  // 200 KB of content packed in 64 KB chunks
+  BOOST_CHECK_EQUAL(4, arena.chunks_count());
+
+  for (auto* owner : owners) { arena.release(owner); }
+  // the current chunk and a couple of free ones are kept for reuse
+  BOOST_CHECK_LE(arena.chunks_count(), 3);
+
+  // large contents get a chunk of their own, freed with the content
+  std::string large(r::dedup_arena::CHUNK_SIZE, 'y');
+  r::dedup_arena::chunk* owner = nullptr;
+  const auto before = arena.chunks_count();
+  arena.store(large.data(), large.size(), owner);
+  BOOST_CHECK_EQUAL(before + 1, arena.chunks_count());
+  arena.release(owner);
+  BOOST_CHECK_EQUAL(before, arena.chunks_count());
+}
+
+BOOST_AUTO_TEST_CASE(dedup_dict_concurrent_add_remove)
+{
+  r::dedup_dict dict;
+  std::atomic<int> mismatches{0};
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t)
+  {
+    threads.emplace_back(
+        [&dict, &mismatches, t]
+        {
+          for (int i = 0; i < 1000; ++i)
+          {
+            // objects shared by all threads and objects private to each
+            const auto shared = std::to_string(i % 50);
+            const auto own = std::to_string(t) + "_" + std::to_string(i);
+            const auto shared_id = dict.add_object(shared.data(), shared.size());
+            const auto own_id = dict.add_object(own.data(), own.size());
+            const auto content = dict.get_object(own_id);
+            if (std::string(content.data(), content.size()) != own) { ++mismatches; }
+            dict.remove_object(shared_id);
+            dict.remove_object(own_id);
+          }
+        });
+  }
+  for (auto& t : threads) { t.join(); }
+  BOOST_CHECK_EQUAL(0, mismatches);
+  BOOST_CHECK_EQUAL(0, dict.size());
+}
+
 BOOST_AUTO_TEST_CASE(compression_transformer)
 {
   r::zstd_compressor compressor(1);
@@ -136,6 +248,61 @@ BOOST_AUTO_TEST_CASE(compression_transformer)
   BOOST_CHECK_EQUAL(input, (char*)in.data());
 }
 
+BOOST_AUTO_TEST_CASE(compression_trained_dictionary)
+{
+  r::zstd_compressor compressor(1, 1024, 500);
+  BOOST_CHECK(compressor.uses_dictionaries());
+
+  const auto add_samples = [&compressor](int round) {
+    for (int i = 0; i < 500; ++i)
+    {
+      const auto sample = R"({"GUser":{"id":"user)" + std::to_string(i) + R"(","major":"eng","hobby":"hiking"},)" +
+          R"("_multi":[{"TAction":{"a)" + std::to_string(round) + R"(":"f)" + std::to_string(i % 7) +
+          R"("}},{"TAction":{"a2":"g"}}]})";
+      auto in = str_to_buff(sample.c_str());
+      std::shared_ptr<const r::zstd_dictionary> dictionary;
+      BOOST_CHECK_EQUAL(err::success, compressor.compress(in, nullptr, &dictionary));
+    }
+  };
+
+  // payloads go through the compressor as samples, the dictionary is only trained by train_dictionary()
+  add_samples(0);
+  const char* input = R"({"GUser":{"id":"user42","major":"eng","hobby":"hiking"},"_multi":[]})";
+  auto plain = str_to_buff(input);
+  std::shared_ptr<const r::zstd_dictionary> dictionary;
+  BOOST_CHECK_EQUAL(err::success, compressor.compress(plain, nullptr, &dictionary));
+  BOOST_CHECK(dictionary == nullptr);
+  BOOST_CHECK_EQUAL(0, ZSTD_getDictID_fromFrame(plain.data(), plain.size()));
+
+  compressor.train_dictionary();
+  auto in = str_to_buff(input);
+  BOOST_CHECK_EQUAL(err::success, compressor.compress(in, nullptr, &dictionary));
+  BOOST_REQUIRE(dictionary != nullptr);
+  const auto id = ZSTD_getDictID_fromFrame(in.data(), in.size());
+  BOOST_CHECK_NE(0, id);
+  BOOST_CHECK_EQUAL(id, dictionary->id());
+
+  // the frame can only be read with its dictionary
+  auto copy = str_to_buff(input);
+  BOOST_CHECK_EQUAL(err::success, compressor.compress(copy, nullptr));
+  BOOST_CHECK_EQUAL(err::compression_error, r::zstd_compressor::decompress(copy, nullptr));
+
+  // the payload keeps its dictionary however many were trained since
+  for (int round = 1; round < 6; ++round)
+  {
+    add_samples(round);
+    compressor.train_dictionary();
+  }
+  auto latest = str_to_buff(input);
+  std::shared_ptr<const r::zstd_dictionary> latest_dictionary;
+  BOOST_CHECK_EQUAL(err::success, compressor.compress(latest, nullptr, &latest_dictionary));
+  BOOST_REQUIRE(latest_dictionary != nullptr);
+  BOOST_CHECK(latest_dictionary != dictionary);
+
+  BOOST_CHECK_EQUAL(err::success, r::zstd_compressor::decompress(in, nullptr, dictionary.get()));
+  BOOST_CHECK_EQUAL(input, (char*)in.data());
+}
+
 BOOST_AUTO_TEST_CASE(action_dict_builder)
 {
   r::utility::configuration c;
@@ -331,4 +498,48 @@ BOOST_AUTO_TEST_CASE(dedup_disable_compression)
   BOOST_CHECK_EQUAL((int)r::event_content_type::IDENTITY, (int)content_type);
   BOOST_CHECK_EQUAL(old_len, in.size());
   BOOST_CHECK_EQUAL(ptr1, in.data());
-}
\ No newline at end of file
+}
+BOOST_AUTO_TEST_CASE(dedup_extension_batcher_with_compression_dictionary)
+{
+  r::utility::configuration c;
+  c.set(r::name::PROTOCOL_VERSION, "2");
+  c.set(r::name::INTERACTION_USE_COMPRESSION, "true");
+  c.set(r::name::ZSTD_DICTIONARY_SIZE, "1024");
+  c.set(r::name::ZSTD_DICTIONARY_SAMPLES, "4");
+  c.set(r::name::INTERACTION_SEND_BATCH_INTERVAL_MS, "10");
+  auto ext = r::create_dedup_logger_extension(c, "interaction", nullptr);
+  BOOST_REQUIRE(ext != nullptr);
+
+  std::vector<uint16_t> msg_types;
+  r::utility::watchdog watchdog(nullptr);
+  auto batcher = ext->create_batcher(
+      std::unique_ptr<r::logger::i_message_sender>(new counting_sender(msg_types)), watchdog, nullptr, "interaction");
+  BOOST_REQUIRE_EQUAL(err::success, batcher->init(nullptr));
+
+  auto* extp = ext.get();
+  for (int i = 0; i < 32; ++i)
+  {
+    const std::string context = R"({"a":{"f":)" + std::to_string(i) + R"(},"_multi":[{"b":1},{"b":2}]})";
+    auto evt_sp = std::make_shared<r::generic_event>(
+        "id", r::timestamp(), r::generic_event::payload_type_t::PayloadType_CB, context.c_str(), "app");
+    auto evt_fn = [evt_sp, context, extp](r::generic_event& out_evt, r::api_status* status) -> int
+    {
+      auto payload = str_to_buff(context.c_str());
+      auto content_type = r::event_content_type::IDENTITY;
+      std::shared_ptr<const r::zstd_dictionary> dictionary;
+      RETURN_IF_FAIL(extp->transform_serialized_payload(payload, content_type, dictionary, status));
+      out_evt = r::generic_event("id", r::timestamp(), r::generic_event::payload_type_t::PayloadType_CB,
+          std::move(payload), content_type, "app");
+      out_evt.set_payload_dictionary(std::move(dictionary));
+      return err::success;
+    };
+    BOOST_CHECK_EQUAL(err::success, batcher->append(std::move(evt_fn), evt_sp.get(), nullptr));
+    // leave the batcher time to send the batch and train a dictionary from its samples
+    if (i % 8 == 7) { std::this_thread::sleep_for(std::chrono::milliseconds(50)); }
+  }
+  batcher.reset();
+
+  BOOST_CHECK(!msg_types.empty());
+  const uint16_t collection_type = r::logger::message_type::fb_generic_event_collection;
+  for (auto msg_type : msg_types) { BOOST_CHECK_EQUAL(collection_type, msg_type); }
+}
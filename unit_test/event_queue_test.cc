@@ -3,11 +3,15 @@
 #endif
 
 #include "logger/event_queue.h"
+#include "logger/lock_free_event_queue.h"
+#include "logger/sharded_event_queue.h"
 #include <boost/test/unit_test.hpp>
 
 #include "data_buffer.h"
 #include "err_constants.h"
 
+#include <algorithm>
+#include <atomic>
 #include <functional>
 #include <thread>
 
@@ -300,4 +304,310 @@ BOOST_AUTO_TEST_CASE(queue_capacity_test)
   Func f;
   queue.pop(&f);
   BOOST_CHECK_EQUAL(queue.capacity(), 0);
-}
\ No newline at end of file
+}
+BOOST_AUTO_TEST_CASE(lock_free_queue_push_pop_test)
+{
+  lock_free_event_queue<test_event> queue(30, 4, queue_mode_enum::DROP, events_counter_status::ENABLE);
+
+  // wrap around the ring a few times
+  for (int round = 0; round < 3; ++round)
+  {
+    for (int i = 0; i < 3; ++i)
+    {
+      auto evt_sp = std::make_shared<test_event>(std::to_string(round * 3 + i + 1));
+      BOOST_CHECK(queue.push(std::bind(passthru, _1, _2, evt_sp), 10, evt_sp.get()));
+    }
+    BOOST_CHECK_EQUAL(queue.size(), 3);
+    BOOST_CHECK_EQUAL(queue.capacity(), 30);
+
+    Func f;
+    test_event val;
+    for (int i = 0; i < 3; ++i)
+    {
+      BOOST_REQUIRE(queue.pop(&f));
+      f(val, nullptr);
+      BOOST_CHECK_EQUAL(val.get_event_id(), std::to_string(round * 3 + i + 1));
+      BOOST_CHECK_EQUAL(val.get_event_index(), round * 3 + i + 1);
+    }
+    BOOST_CHECK_EQUAL(queue.size(), 0);
+    BOOST_CHECK_EQUAL(queue.capacity(), 0);
+    BOOST_CHECK(!queue.pop(&f));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(lock_free_queue_full_ring_drop_test)
+{
+  lock_free_event_queue<test_event> queue(1000, 2, queue_mode_enum::DROP);
+  std::vector<std::shared_ptr<test_event>> events;
+  for (int i = 0; i < 3; ++i)
+  {
+    events.push_back(std::make_shared<test_event>(std::to_string(i + 1)));
+    queue.push(std::bind(passthru, _1, _2, events.back()), 1, events.back().get());
+  }
+
+  // the ring has two slots, the third event is dropped
+  BOOST_CHECK_EQUAL(queue.size(), 2);
+  BOOST_CHECK(queue.is_full());
+
+  Func f;
+  test_event val;
+  BOOST_REQUIRE(queue.pop(&f));
+  f(val, nullptr);
+  BOOST_CHECK_EQUAL(val.get_event_id(), "1");
+  BOOST_CHECK(!queue.is_full());
+}
+
+BOOST_AUTO_TEST_CASE(lock_free_queue_prune_test)
+{
+  lock_free_event_queue<test_event> queue(30, 16, queue_mode_enum::DROP, events_counter_status::ENABLE);
+  for (const auto* id : {"no_drop_1", "drop_1"})
+  {
+    auto evt_sp = std::make_shared<test_event>(id);
+    queue.push(std::bind(passthru, _1, _2, evt_sp), 10, evt_sp.get());
+  }
+
+  queue.prune(1.0);  // drop should not work since current capacity is less than limit (20 < 30)
+  BOOST_CHECK_EQUAL(queue.size(), 2);
+  BOOST_CHECK_EQUAL(queue.capacity(), 20);
+
+  for (const auto* id : {"no_drop_2", "drop_2", "no_drop_3"})
+  {
+    auto evt_sp = std::make_shared<test_event>(id);
+    queue.push(std::bind(passthru, _1, _2, evt_sp), 10, evt_sp.get());
+  }
+
+  BOOST_CHECK_EQUAL(queue.size(), 5);
+  BOOST_CHECK_EQUAL(queue.capacity(), 50);
+  queue.prune(1.0);  // drop should work since current capacity is more than limit (50 > 30)
+  BOOST_CHECK_EQUAL(queue.size(), 3);
+  BOOST_CHECK_EQUAL(queue.capacity(), 30);
+
+  Func f;
+  test_event val;
+  const std::vector<std::pair<std::string, uint64_t>> expected = {{"no_drop_1", 1}, {"no_drop_2", 3}, {"no_drop_3", 5}};
+  for (const auto& e : expected)
+  {
+    BOOST_REQUIRE(queue.pop(&f));
+    f(val, nullptr);
+    BOOST_CHECK_EQUAL(val.get_event_id(), e.first);
+    BOOST_CHECK_EQUAL(val.get_event_index(), e.second);
+  }
+  BOOST_CHECK(!queue.pop(&f));
+}
+
+BOOST_AUTO_TEST_CASE(lock_free_queue_push_pop_subsample)
+{
+  lock_free_event_queue<test_event> queue(30, 16, queue_mode_enum::DROP, events_counter_status::ENABLE, 0.5);
+
+  int n = 10;
+  for (int i = 0; i < n; ++i)
+  {
+    std::string id = (i % 2 == 0 ? "drop_" : "no_drop_") + std::to_string(i + 1);
+    auto evt_sp = std::make_shared<test_event>(id);
+    queue.push(std::bind(passthru, _1, _2, evt_sp), 10, evt_sp.get());
+  }
+
+  BOOST_CHECK_EQUAL(queue.size(), n / 2);
+
+  Func f;
+  test_event item;
+  for (int i = 1; i < n; i += 2)
+  {
+    BOOST_REQUIRE(queue.pop(&f));
+    f(item, nullptr);
+    BOOST_CHECK_EQUAL(item.get_event_id(), "no_drop_" + std::to_string(i + 1));
+    BOOST_CHECK_EQUAL(item.get_event_index(), i + 1);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(lock_free_queue_concurrent_producers)
+{
+  const int producers = 8;
+  const int per_producer = 2000;
+  lock_free_event_queue<test_event> queue(1 << 30, 1024, queue_mode_enum::BLOCK, events_counter_status::ENABLE);
+  std::atomic<bool> done{false};
+
+  std::vector<thread> threads;
+  for (int p = 0; p < producers; ++p)
+  {
+    threads.emplace_back(
+        [&queue, p]
+        {
+          for (int i = 0; i < per_producer; ++i)
+          {
+            auto evt_sp = std::make_shared<test_event>(std::to_string(p));
+            queue.push(std::bind(passthru, _1, _2, evt_sp), 1, evt_sp.get());
+          }
+        });
+  }
+
+  size_t popped = 0;
+  std::vector<bool> seen(producers * per_producer + 1, false);
+  bool unique = true;
+  std::vector<int> per_thread(producers, 0);
+  thread consumer(
+      [&]
+      {
+        Func f;
+        test_event item;
+        while (!done || queue.size() > 0)
+        {
+          if (!queue.pop(&f)) { continue; }
+          f(item, nullptr);
+          const auto index = item.get_event_index();
+          unique = unique && index > 0 && index < seen.size() && !seen[index];
+          if (unique) { seen[index] = true; }
+          ++per_thread[std::stoi(item.get_event_id())];
+          ++popped;
+        }
+      });
+
+  for (auto& t : threads) { t.join(); }
+  done = true;
+  consumer.join();
+
+  // every index was handed out exactly once
+  BOOST_CHECK(unique);
+  BOOST_CHECK_EQUAL(popped, producers * per_producer);
+  for (int count : per_thread) { BOOST_CHECK_EQUAL(count, per_producer); }
+  BOOST_CHECK_EQUAL(queue.capacity(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(sharded_queue_push_pop_threads)
+{
+  const int producers = 8;
+  const int per_producer = 500;
+  sharded_event_queue<test_event> queue(1 << 30, 4, events_counter_status::ENABLE);
+  BOOST_CHECK_EQUAL(queue.shards_count(), 4);
+
+  std::vector<thread> threads;
+  for (int p = 0; p < producers; ++p)
+  {
+    threads.emplace_back(
+        [&queue, p]
+        {
+          for (int i = 0; i < per_producer; ++i)
+          {
+            auto evt_sp = std::make_shared<test_event>(std::to_string(p));
+            queue.push(std::bind(passthru, _1, _2, evt_sp), 10, evt_sp.get());
+          }
+        });
+  }
+  for (auto& t : threads) { t.join(); }
+
+  BOOST_CHECK_EQUAL(queue.size(), producers * per_producer);
+  BOOST_CHECK_EQUAL(queue.capacity(), producers * per_producer * 10);
+
+  Func f;
+  test_event item;
+  std::vector<bool> seen(producers * per_producer + 1, false);
+  uint64_t last_index = 0;
+  bool ordered = true;
+  while (queue.pop(&f))
+  {
+    f(item, nullptr);
+    BOOST_REQUIRE_LE(item.get_event_index(), producers * per_producer);
+    seen[item.get_event_index()] = true;
+    // the shards are merged by index
+    ordered = ordered && item.get_event_index() > last_index;
+    last_index = item.get_event_index();
+    // the front events held by the consumer are still accounted
+    if (last_index == 1) { BOOST_CHECK_EQUAL(queue.size(), producers * per_producer - 1); }
+  }
+  // every index was handed out exactly once
+  BOOST_CHECK_EQUAL(std::count(seen.begin() + 1, seen.end(), true), producers * per_producer);
+  BOOST_CHECK(ordered);
+  BOOST_CHECK_EQUAL(queue.size(), 0);
+  BOOST_CHECK_EQUAL(queue.capacity(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(sharded_queue_prune_subsample_test)
+{
+  sharded_event_queue<test_event> queue(30, 2, events_counter_status::ENABLE, 0.5);
+  for (const auto* id : {"no_drop_1", "drop_1", "no_drop_2", "no_drop_3", "no_drop_4"})
+  {
+    auto evt_sp = std::make_shared<test_event>(id);
+    queue.push(std::bind(passthru, _1, _2, evt_sp), 10, evt_sp.get());
+  }
+  // subsampled event is not queued but still counted
+  BOOST_CHECK_EQUAL(queue.size(), 4);
+  BOOST_CHECK_EQUAL(queue.capacity(), 40);
+  BOOST_CHECK(queue.is_full());
+
+  Func f;
+  test_event item;
+  uint64_t max_index = 0;
+  while (queue.pop(&f))
+  {
+    f(item, nullptr);
+    max_index = (std::max)(max_index, item.get_event_index());
+  }
+  BOOST_CHECK_EQUAL(max_index, 5);
+  BOOST_CHECK(!queue.is_full());
+}
+
+BOOST_AUTO_TEST_CASE(queue_push_batch_test)
+{
+  event_queue<test_event> locked(1000, events_counter_status::ENABLE, 0.5);
+  sharded_event_queue<test_event> sharded(1000, 4, events_counter_status::ENABLE);
+  for (i_event_queue<test_event>* queue : std::vector<i_event_queue<test_event>*>{&locked, &sharded})
+  {
+    std::vector<std::shared_ptr<test_event>> events;
+    std::vector<Func> funcs;
+    std::vector<test_event*> event_ptrs;
+    for (const auto* id : {"1", "2", "3", "drop_4", "5"})
+    {
+      events.push_back(std::make_shared<test_event>(id));
+      funcs.push_back(std::bind(passthru, _1, _2, events.back()));
+      event_ptrs.push_back(events.back().get());
+    }
+    const std::vector<size_t> sizes(events.size(), 10);
+
+    // the subsampled event only exists when the queue subsamples
+    const size_t expected = queue == &locked ? 4 : 5;
+    BOOST_CHECK_EQUAL(queue->push_batch(funcs.data(), sizes.data(), event_ptrs.data(), events.size()), expected);
+    BOOST_CHECK_EQUAL(queue->size(), expected);
+    BOOST_CHECK_EQUAL(queue->capacity(), expected * 10);
+
+    // items are popped in order, with consecutive indices
+    Func f;
+    test_event item;
+    uint64_t index = 0;
+    while (queue->pop(&f))
+    {
+      f(item, nullptr);
+      ++index;
+      if (item.get_event_id() == "5" && expected == 4) { ++index; }
+      BOOST_CHECK_EQUAL(item.get_event_index(), index);
+    }
+    BOOST_CHECK_EQUAL(index, 5);
+  }
+}
+
+// an event dropped instead of queued takes an index, the next event is numbered after it
+BOOST_AUTO_TEST_CASE(queue_drop_takes_index_test)
+{
+  event_queue<test_event> locked(1000, events_counter_status::ENABLE);
+  lock_free_event_queue<test_event> lock_free(1000, 16, queue_mode_enum::DROP, events_counter_status::ENABLE);
+  sharded_event_queue<test_event> sharded(1000, 4, events_counter_status::ENABLE);
+  for (i_event_queue<test_event>* queue : std::vector<i_event_queue<test_event>*>{&locked, &lock_free, &sharded})
+  {
+    auto first = std::make_shared<test_event>("1");
+    queue->push(std::bind(passthru, _1, _2, first), 10, first.get());
+    test_event dropped("drop_2");
+    queue->drop(&dropped);
+    auto last = std::make_shared<test_event>("3");
+    queue->push(std::bind(passthru, _1, _2, last), 10, last.get());
+    BOOST_CHECK_EQUAL(queue->size(), 2);
+
+    Func f;
+    test_event item;
+    std::vector<uint64_t> indices;
+    while (queue->pop(&f))
+    {
+      f(item, nullptr);
+      indices.push_back(item.get_event_index());
+    }
+    BOOST_CHECK(indices == (std::vector<uint64_t>{1, 3}));
+  }
+}
@@ -0,0 +1,171 @@
+#ifdef STAND_ALONE
+#  define BOOST_TEST_MODULE Main
+#endif
+
+#include "logger/event_record.h"
+#include <boost/test/unit_test.hpp>
+
+#include "action_flags.h"
+#include "configuration.h"
+#include "generated/v2/CbEvent_generated.h"
+#include "logger/lock_free_event_queue.h"
+#include "logger/logger_extensions.h"
+#include "serialization/fb_serializer.h"
+#include "serialization/payload_serializer.h"
+
+using namespace reinforcement_learning;
+using namespace reinforcement_learning::logger;
+using namespace reinforcement_learning::messages::flatbuff;
+
+namespace
+{
+using cb_record_t = generic_event_record<cb_serializer, unsigned int, v2::LearningModeType, std::vector<uint64_t>,
+    std::vector<float>, std::string>;
+
+void fill(cb_record_t* record, std::vector<uint64_t> action_ids, std::vector<float> probabilities)
+{
+  auto& args = record->get_args();
+  std::get<0>(args) = action_flags::DEFAULT;
+  std::get<1>(args) = v2::LearningModeType_Online;
+  std::get<2>(args) = std::move(action_ids);
+  std::get<3>(args) = std::move(probabilities);
+  std::get<4>(args) = "model_id";
+}
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(event_record_pool_reuse)
+{
+  event_record_pool<cb_record_t> pool;
+  auto* first = pool.acquire();
+  auto* second = pool.acquire();
+  BOOST_CHECK_NE(first, second);
+  BOOST_CHECK_EQUAL(pool.size(), 2);
+
+  first->release();
+  BOOST_CHECK_EQUAL(pool.acquire(), first);
+  BOOST_CHECK_EQUAL(pool.size(), 2);
+}
+
+// released records beyond the free list cap, and records grown too large, are freed
+BOOST_AUTO_TEST_CASE(event_record_pool_trim)
+{
+  event_record_pool<cb_record_t> pool(1);
+  auto* first = pool.acquire();
+  auto* second = pool.acquire();
+  first->release();
+  second->release();
+  BOOST_CHECK_EQUAL(pool.size(), 1);
+
+  auto* large = pool.acquire();
+  BOOST_CHECK_EQUAL(pool.size(), 1);
+  fill(large, std::vector<uint64_t>(event_record_pool<cb_record_t>::MAX_RECORD_BYTES, 1), {1.f});
+  large->release();
+  BOOST_CHECK_EQUAL(pool.size(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(event_record_transform)
+{
+  utility::configuration config;
+  auto ext = i_logger_extensions::get_extensions(config, nullptr);
+  event_record_pool<cb_record_t> pool;
+
+  auto* record = pool.acquire();
+  record->prepare("event_id", timestamp(), cb_serializer().type, "my_context", "app_id", ext.get());
+  fill(record, {2, 1}, {0.8f, 0.2f});
+
+  generic_event out_evt;
+  BOOST_CHECK_EQUAL(record->transform(out_evt, nullptr), error_code::success);
+  BOOST_CHECK_EQUAL(out_evt.get_id(), "event_id");
+  BOOST_CHECK_EQUAL(out_evt.get_app_id(), "app_id");
+  BOOST_CHECK(out_evt.get_context_string().empty());
+
+  const auto* event = v2::GetCbEvent(out_evt.get_payload().data());
+  std::string context(event->context()->begin(), event->context()->end());
+  BOOST_CHECK_EQUAL(context, "my_context");
+  BOOST_CHECK_EQUAL(event->action_ids()->size(), 2);
+  BOOST_CHECK_EQUAL(event->model_id()->str(), "model_id");
+
+  // the record went back to the pool
+  BOOST_CHECK_EQUAL(pool.acquire(), record);
+  BOOST_CHECK_EQUAL(pool.size(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(event_record_released_on_drop)
+{
+  event_record_pool<cb_record_t> pool;
+  auto* record = pool.acquire();
+  record->prepare("event_id", timestamp(), cb_serializer().type, "my_context", "app_id", nullptr);
+
+  // a pass probability of 0 always drops the event
+  BOOST_CHECK(record->get_event().try_drop(0.f, 0));
+  BOOST_CHECK_EQUAL(pool.acquire(), record);
+  BOOST_CHECK_EQUAL(pool.size(), 1);
+}
+
+// events rejected by a full ring in DROP mode go back to the pool, and later indices account for them
+BOOST_AUTO_TEST_CASE(event_record_released_on_full_ring)
+{
+  utility::configuration config;
+  auto ext = i_logger_extensions::get_extensions(config, nullptr);
+  event_record_pool<cb_record_t> pool;
+  lock_free_event_queue<generic_event> queue(1 << 30, 4, queue_mode_enum::DROP, events_counter_status::ENABLE);
+
+  const auto push = [&](const std::string& id)
+  {
+    auto* record = pool.acquire();
+    record->prepare(id.c_str(), timestamp(), cb_serializer().type, "my_context", "app_id", ext.get());
+    fill(record, {1}, {1.f});
+    const auto transform = [record](generic_event& out_evt, api_status* status)
+    { return record->transform(out_evt, status); };
+    return queue.push(transform, 1, &record->get_event());
+  };
+
+  for (int i = 0; i < 4; ++i) { BOOST_CHECK(push("event_" + std::to_string(i))); }
+  for (int i = 4; i < 20; ++i) { BOOST_CHECK(!push("event_" + std::to_string(i))); }
+  BOOST_CHECK_EQUAL(queue.size(), 4);
+  // 4 records in the ring and the one every rejected event reused
+  BOOST_CHECK_EQUAL(pool.size(), 5);
+
+  std::function<int(generic_event&, api_status*)> func;
+  generic_event out_evt;
+  for (int i = 0; i < 4; ++i)
+  {
+    BOOST_REQUIRE(queue.pop(&func));
+    BOOST_CHECK_EQUAL(func(out_evt, nullptr), error_code::success);
+  }
+  BOOST_CHECK(!queue.pop(&func));
+  BOOST_CHECK_EQUAL(pool.size(), 5);
+
+  BOOST_CHECK(push("last"));
+  BOOST_REQUIRE(queue.pop(&func));
+  BOOST_CHECK_EQUAL(func(out_evt, nullptr), error_code::success);
+  // the 16 rejected events are counted before it
+  BOOST_CHECK_EQUAL(out_evt.get_event_index(), 21);
+  BOOST_CHECK_EQUAL(pool.size(), 5);
+}
+
+// the queue accounts the context, the serializer arguments and the payload of a queued event
+BOOST_AUTO_TEST_CASE(event_record_memory_size)
+{
+  utility::configuration config;
+  auto ext = i_logger_extensions::get_extensions(config, nullptr);
+  event_record_pool<cb_record_t> pool;
+
+  const std::string context(10 * 1024, 'x');
+  auto* record = pool.acquire();
+  record->prepare("event_id", timestamp(), cb_serializer().type, context, "app_id", ext.get());
+  fill(record, std::vector<uint64_t>(1000, 1), std::vector<float>(1000, 0.001f));
+  record->get_event().set_captured_size(record->args_size());
+
+  const size_t args_size = record->args_size();
+  BOOST_CHECK_GE(args_size, 1000 * (sizeof(uint64_t) + sizeof(float)));
+  const size_t queued_size = fb_event_serializer<generic_event>::size_estimate(record->get_event());
+  BOOST_CHECK_GE(queued_size, context.size() + args_size);
+
+  generic_event out_evt;
+  BOOST_CHECK_EQUAL(record->transform(out_evt, nullptr), error_code::success);
+  // the context and the arguments are gone, the payload holds both
+  const size_t transformed_size = fb_event_serializer<generic_event>::size_estimate(out_evt);
+  BOOST_CHECK_GE(transformed_size, out_evt.get_payload().size());
+  BOOST_CHECK_GE(out_evt.get_payload().size(), context.size());
+}
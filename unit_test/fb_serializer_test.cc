@@ -229,3 +229,38 @@ BOOST_AUTO_TEST_CASE(fb_serializer_generic_event_metadata)
     BOOST_CHECK_EQUAL(metadata.app_id()->c_str(), "app_id");
   }
 }
+
+BOOST_AUTO_TEST_CASE(flatbuffer_arena_reuses_blocks)
+{
+  auto& arena = flatbuffer_arena::local();
+  const auto cached = arena.cached_bytes();
+
+  auto* block = arena.allocate(3000);
+  arena.deallocate(block, 3000);
+  BOOST_CHECK_EQUAL(cached + 4096, arena.cached_bytes());
+
+  // same size class: the block is handed out again
+  auto* other = arena.allocate(4000);
+  BOOST_CHECK(block == other);
+  BOOST_CHECK_EQUAL(cached, arena.cached_bytes());
+  arena.deallocate(other, 4000);
+}
+
+BOOST_AUTO_TEST_CASE(fb_serializer_generic_event_returns_payload_to_arena)
+{
+  data_buffer db;
+  fb_collection_serializer<generic_event> collection_serializer(db, value::CONTENT_ENCODING_IDENTITY);
+  cb_serializer serializer;
+  const std::vector<uint64_t> action_ids = {1, 2};
+  const std::vector<float> probabilities = {0.8f, 0.2f};
+
+  auto buffer = serializer.event(std::string(10 * 1024, 'x'), action_flags::DEFAULT, v2::LearningModeType_Online,
+      action_ids, probabilities, "model_id");
+  generic_event ge("event_id", timestamp(), v2::PayloadType_CB, std::move(buffer), event_content_type::IDENTITY, "");
+
+  const auto cached = flatbuffer_arena::local().cached_bytes();
+  BOOST_CHECK_EQUAL(error_code::success, collection_serializer.add(ge));
+  BOOST_CHECK_EQUAL(0, ge.get_payload().size());
+  BOOST_CHECK_GT(flatbuffer_arena::local().cached_bytes(), cached);
+  BOOST_CHECK_EQUAL(error_code::success, collection_serializer.finalize(nullptr));
+}
@@ -5,9 +5,23 @@
 #include "logger/file/file_logger.h"
 #include <boost/test/unit_test.hpp>
 
+#include "api_status.h"
+#include "constants.h"
 #include "err_constants.h"
+#include "error_callback_fn.h"
+#include "logger/file/buffered_file_logger.h"
 
 #include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#ifdef _WIN32
+#  include <direct.h>
+#else
+#  include <sys/stat.h>
+#endif
 
 namespace rl = reinforcement_learning;
 namespace rlog = reinforcement_learning::logger;
@@ -37,4 +51,221 @@ BOOST_AUTO_TEST_CASE(file_logger_test)
 
   BOOST_CHECK(file_exists(file));
   remove(file.c_str());
-}
\ No newline at end of file
+}
+
+namespace
+{
+std::string read_file(const std::string& file)
+{
+  std::ifstream f(file, std::ios::binary);
+  std::stringstream ss;
+  ss << f.rdbuf();
+  return ss.str();
+}
+
+rl::i_sender::buffer make_batch(const std::string& body)
+{
+  const auto buff = rl::i_sender::buffer(new rutil::data_buffer());
+  buff->resize_body_region(body.size());
+  std::memcpy(buff->body_begin(), body.data(), body.size());
+  buff->set_body_endoffset(buff->get_body_beginoffset() + body.size());
+  return buff;
+}
+
+std::string batch_bytes(const rl::i_sender::buffer& buff)
+{
+  return std::string(reinterpret_cast<const char*>(buff->preamble_begin()), buff->buffer_filled_size());
+}
+
+void remove_files(const std::string& file)
+{
+  remove(file.c_str());
+  for (int i = 1; i < 100; ++i) { remove((file + "." + std::to_string(i)).c_str()); }
+}
+
+bool make_dir(const std::string& dir)
+{
+#ifdef _WIN32
+  return _mkdir(dir.c_str()) == 0;
+#else
+  return mkdir(dir.c_str(), 0755) == 0;
+#endif
+}
+
+bool remove_dir(const std::string& dir)
+{
+#ifdef _WIN32
+  return _rmdir(dir.c_str()) == 0;
+#else
+  return rmdir(dir.c_str()) == 0;
+#endif
+}
+
+void count_errors(const rl::api_status&, int* errors) { ++*errors; }
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(buffered_file_logger_writes_everything_on_shutdown)
+{
+  const std::string file("buffered_file_logger_test");
+  remove_files(file);
+
+  std::string expected;
+  {
+    rlog::file::buffered_file_logger logger(file, nullptr);
+    rutil::configuration config;
+    // long enough for the batches to still be in memory when the logger is destroyed
+    config.set(rl::name::FILE_FLUSH_INTERVAL_MS, "60000");
+    BOOST_CHECK_EQUAL(logger.init(config, nullptr), rerr::success);
+    for (int i = 0; i < 1000; ++i)
+    {
+      const auto buff = make_batch("batch " + std::to_string(i));
+      expected += batch_bytes(buff);
+      BOOST_CHECK_EQUAL(logger.send(buff), rerr::success);
+    }
+  }
+
+  BOOST_CHECK(read_file(file) == expected);
+  remove_files(file);
+}
+
+BOOST_AUTO_TEST_CASE(buffered_file_logger_flush)
+{
+  const std::string file("buffered_file_logger_flush_test");
+  remove_files(file);
+
+  rlog::file::buffered_file_logger logger(file, nullptr);
+  rutil::configuration config;
+  config.set(rl::name::FILE_FLUSH_INTERVAL_MS, "60000");
+  BOOST_CHECK_EQUAL(logger.init(config, nullptr), rerr::success);
+
+  const auto buff = make_batch("batch");
+  BOOST_CHECK_EQUAL(logger.send(buff), rerr::success);
+  BOOST_CHECK_EQUAL(logger.flush(), rerr::success);
+  BOOST_CHECK_EQUAL(logger.in_flight_count(), 0);
+  BOOST_CHECK_EQUAL(logger.bytes_written(), buff->buffer_filled_size());
+  BOOST_CHECK(read_file(file) == batch_bytes(buff));
+  remove_files(file);
+}
+
+BOOST_AUTO_TEST_CASE(buffered_file_logger_fsync_batch)
+{
+  const std::string file("buffered_file_logger_fsync_test");
+  remove_files(file);
+
+  rlog::file::buffered_file_logger logger(file, nullptr);
+  rutil::configuration config;
+  config.set(rl::name::FILE_FSYNC, rl::value::FILE_FSYNC_BATCH);
+  config.set(rl::name::FILE_FLUSH_INTERVAL_MS, "60000");
+  BOOST_CHECK_EQUAL(logger.init(config, nullptr), rerr::success);
+
+  size_t total = 0;
+  for (int i = 0; i < 10; ++i)
+  {
+    const auto buff = make_batch("batch " + std::to_string(i));
+    BOOST_CHECK_EQUAL(logger.send(buff), rerr::success);
+    // on disk by the time send returns
+    total += buff->buffer_filled_size();
+    BOOST_CHECK_EQUAL(logger.in_flight_count(), 0);
+    BOOST_CHECK_EQUAL(logger.bytes_written(), total);
+  }
+  remove_files(file);
+}
+
+BOOST_AUTO_TEST_CASE(buffered_file_logger_rotates_by_size)
+{
+  const std::string file("buffered_file_logger_rotate_test");
+  remove_files(file);
+
+  std::string expected;
+  size_t rotations = 0;
+  {
+    rlog::file::buffered_file_logger logger(file, nullptr);
+    rutil::configuration config;
+    config.set(rl::name::FILE_ROTATE_KB, "4");
+    config.set(rl::name::FILE_WRITE_BEHIND_BUFFER_KB, "1");
+    BOOST_CHECK_EQUAL(logger.init(config, nullptr), rerr::success);
+    for (int i = 0; i < 100; ++i)
+    {
+      const auto buff = make_batch(std::string(200, static_cast<char>('a' + i % 26)));
+      expected += batch_bytes(buff);
+      BOOST_CHECK_EQUAL(logger.send(buff), rerr::success);
+    }
+    BOOST_CHECK_EQUAL(logger.flush(), rerr::success);
+    rotations = logger.rotations();
+  }
+
+  // ~20KB in files of at most 4KB, batches are not split
+  BOOST_CHECK_GE(rotations, 4);
+  std::string content;
+  for (size_t i = 1; i <= rotations; ++i)
+  {
+    const auto part = read_file(file + "." + std::to_string(i));
+    BOOST_CHECK_LE(part.size(), 4 * 1024);
+    content += part;
+  }
+  content += read_file(file);
+  BOOST_CHECK(content == expected);
+  remove_files(file);
+}
+
+// a file that cannot be rotated keeps receiving the batches, and is rotated once the rename works again
+BOOST_AUTO_TEST_CASE(buffered_file_logger_rotation_failure)
+{
+  const std::string file("buffered_file_logger_rotate_failure_test");
+  const std::string blocker = file + ".1";
+  remove_files(file);
+
+  int errors = 0;
+  rl::error_callback_fn error_fn(count_errors, &errors);
+  std::string expected;
+  {
+    rlog::file::buffered_file_logger logger(file, nullptr, &error_fn);
+    rutil::configuration config;
+    config.set(rl::name::FILE_ROTATE_KB, "1");
+    config.set(rl::name::FILE_FLUSH_INTERVAL_MS, "60000");
+    BOOST_CHECK_EQUAL(logger.init(config, nullptr), rerr::success);
+
+    // a non empty directory named after the rotated file makes the rename fail
+    BOOST_REQUIRE(make_dir(blocker));
+    std::ofstream(blocker + "/file") << "blocker";
+    for (int i = 0; i < 10; ++i)
+    {
+      const auto buff = make_batch(std::string(200, static_cast<char>('a' + i)));
+      expected += batch_bytes(buff);
+      BOOST_CHECK_EQUAL(logger.send(buff), rerr::success);
+      BOOST_CHECK_EQUAL(logger.flush(), rerr::success);
+    }
+    BOOST_CHECK_GT(errors, 0);
+    BOOST_CHECK_EQUAL(logger.rotations(), 0);
+    BOOST_CHECK(read_file(file) == expected);
+
+    remove((blocker + "/file").c_str());
+    BOOST_REQUIRE(remove_dir(blocker));
+    const auto last = make_batch("last");
+    BOOST_CHECK_EQUAL(logger.send(last), rerr::success);
+    BOOST_CHECK_EQUAL(logger.flush(), rerr::success);
+    BOOST_CHECK_EQUAL(logger.rotations(), 1);
+    BOOST_CHECK(read_file(file) == batch_bytes(last));
+  }
+
+  BOOST_CHECK(read_file(blocker) == expected);
+  remove_files(file);
+}
+
+#ifdef __linux__
+// with fsync_policy::BATCH, send() returns the error of a batch that could not be written
+BOOST_AUTO_TEST_CASE(buffered_file_logger_fsync_batch_write_error)
+{
+  // every write to /dev/full fails with ENOSPC
+  rlog::file::buffered_file_logger logger("/dev/full", nullptr);
+  rutil::configuration config;
+  config.set(rl::name::FILE_FSYNC, rl::value::FILE_FSYNC_BATCH);
+  BOOST_REQUIRE_EQUAL(logger.init(config, nullptr), rerr::success);
+
+  rl::api_status status;
+  BOOST_CHECK_EQUAL(logger.send(make_batch("batch"), &status), rerr::file_write_error);
+  BOOST_CHECK_EQUAL(status.get_error_code(), rerr::file_write_error);
+  BOOST_CHECK_EQUAL(logger.in_flight_count(), 0);
+  BOOST_CHECK_EQUAL(logger.bytes_written(), 0);
+}
+#endif
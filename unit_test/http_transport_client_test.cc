@@ -12,8 +12,18 @@
 #include "utility/data_buffer_streambuf.h"
 #include "utility/eventhub_http_authorization.h"
 #include "utility/header_authorization.h"
+#include "utility/http_client.h"
+#include "utility/retry_timer.h"
 
+#include <cpprest/http_listener.h>
+
+#include <atomic>
 #include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <set>
 
 namespace reinforcement_learning
 {
@@ -37,6 +47,43 @@ public:
 void error_counter_func(const r::api_status&, void* counter) { static_cast<error_counter*>(counter)->_error_handler(); }
 
 const std::chrono::milliseconds UNLIMITED_RETRY_TIME(9999999);
+
+u::retry_backoff make_backoff(int base_delay_ms, int max_delay_ms)
+{
+  u::retry_backoff backoff;
+  backoff.base_delay = std::chrono::milliseconds(base_delay_ms);
+  backoff.max_delay = std::chrono::milliseconds(max_delay_ms);
+  return backoff;
+}
+
+using stub_listener = web::http::experimental::listener::http_listener;
+
+// Opens a listener on a free local port and returns its url. cpprest does not report the port picked by the system for
+// port 0, so random ports of the dynamic range are tried until one can be bound.
+std::string open_stub_listener(
+    std::unique_ptr<stub_listener>& listener, const std::function<void(http_request)>& handler)
+{
+  std::mt19937 rng(std::random_device{}());
+  std::uniform_int_distribution<int> ports(49152, 65535);
+  for (int attempt = 0; attempt < 20; ++attempt)
+  {
+    const std::string url = "http://127.0.0.1:" + std::to_string(ports(rng)) + "/stub";
+    listener.reset(new stub_listener(::utility::conversions::to_string_t(url)));
+    listener->support(methods::POST, handler);
+    try
+    {
+      listener->open().wait();
+      return url;
+    }
+    catch (const std::exception&)
+    {
+      // port in use
+    }
+  }
+  BOOST_FAIL("no free port for the stub server");
+  return "";
+}
+
 BOOST_AUTO_TEST_CASE(send_something_apim_authorization)
 {
   mock_http_client* http_client = new mock_http_client("localhost:8080");
@@ -120,6 +167,7 @@ BOOST_AUTO_TEST_CASE(retry_http_send_success)
     // create a client
     r::http_transport_client<r::eventhub_http_authorization> eh(
         http_client, 1, 8 /* retries */, UNLIMITED_RETRY_TIME, nullptr, &error_callback);
+    eh.set_retry_backoff(make_backoff(10, 50));
     reinforcement_learning::api_status ret;
 
     std::shared_ptr<u::data_buffer> db1(new u::data_buffer());
@@ -157,6 +205,7 @@ BOOST_AUTO_TEST_CASE(retry_http_send_fail_retries_exhausted)
     // create a client
     r::http_transport_client<r::eventhub_http_authorization> eh(
         http_client, 1, MAX_RETRIES, UNLIMITED_RETRY_TIME, nullptr, &error_callback);
+    eh.set_retry_backoff(make_backoff(10, 50));
 
     r::api_status ret;
     std::shared_ptr<u::data_buffer> db1(new u::data_buffer());
@@ -196,6 +245,8 @@ BOOST_AUTO_TEST_CASE(retry_http_send_fail_retry_time_exhausted)
     // create a client
     r::http_transport_client<r::eventhub_http_authorization> eh(
         http_client, 1, UNLIMITED_RETRIES, RETRY_TIME_MS, nullptr, &error_callback);
+    // between 0.5 and 1 second between retries
+    eh.set_retry_backoff(make_backoff(1000, 1000));
 
     r::api_status ret;
     std::shared_ptr<u::data_buffer> db1(new u::data_buffer());
@@ -209,7 +260,8 @@ BOOST_AUTO_TEST_CASE(retry_http_send_fail_retry_time_exhausted)
   auto actual_retry_time_ms =
       std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now() - start_time);
 
-  // 1 second between retries, 5.5 second retry budget, should allow at least three attempts (initial + two retries)
+  // at most 1 second between retries, 5.5 second retry budget, should allow at least three attempts (initial + two
+  // retries)
   BOOST_CHECK_GE(tries, 3);
 
   // Should have taken at least RETRY_TIME_MS to give up attempting retries
@@ -252,6 +304,7 @@ BOOST_AUTO_TEST_CASE(http_in_order_after_retry)
     // create a client
     r::http_transport_client<r::eventhub_http_authorization> eh(
         http_client, 1, MAX_RETRIES, UNLIMITED_RETRY_TIME, nullptr, &error_callback);
+    eh.set_retry_backoff(make_backoff(10, 50));
 
     r::api_status ret;
     std::shared_ptr<u::data_buffer> db1(new u::data_buffer());
@@ -302,3 +355,224 @@ BOOST_AUTO_TEST_CASE(http_in_order_after_retry)
   BOOST_CHECK_EQUAL(received_messages[4], "message 5");
   BOOST_CHECK_EQUAL(counter._err_count, 0);
 }
+
+// A request stuck in retries only holds its own slot: later requests keep going through the rest of the window.
+BOOST_AUTO_TEST_CASE(http_slow_request_does_not_block_window)
+{
+  mock_http_client* http_client = new mock_http_client("localhost:8080");
+
+  const int FAST_MESSAGES = 20;
+  std::mutex mutex;
+  int slow_tries = 0;
+  std::vector<std::string> received_messages;
+  http_client->set_responder(methods::POST,
+      [&](const http_request& message, http_response& resp)
+      {
+        std::vector<unsigned char> data = const_cast<http_request&>(message).extract_vector().get();
+        std::string body(data.begin() + reinforcement_learning::logger::preamble::size(), data.end());
+        std::lock_guard<std::mutex> lock(mutex);
+        // the first message fails twice before succeeding
+        if (body == "slow" && ++slow_tries <= 2)
+        {
+          resp.set_status_code(status_codes::InternalError);
+          return;
+        }
+        received_messages.push_back(body);
+        resp.set_status_code(status_codes::Created);
+      });
+
+  error_counter counter;
+  r::error_callback_fn error_callback(&error_counter_func, &counter);
+
+  {
+    r::http_transport_client<r::eventhub_http_authorization> eh(
+        http_client, 4, 8, UNLIMITED_RETRY_TIME, nullptr, &error_callback);
+    // at least 300ms in retry delays for the slow message
+    eh.set_retry_backoff(make_backoff(200, 400));
+
+    r::api_status ret;
+    for (int i = 0; i <= FAST_MESSAGES; ++i)
+    {
+      std::shared_ptr<u::data_buffer> db(new u::data_buffer());
+      u::data_buffer_streambuf sbuff(db.get());
+      std::ostream message(&sbuff);
+      message << (i == 0 ? std::string("slow") : "message " + std::to_string(i));
+      sbuff.finalize();
+      BOOST_CHECK_EQUAL(eh.send(db, &ret), r::error_code::success);
+    }
+    // the fast messages went through while the slow one was still waiting for its retry
+    BOOST_CHECK_GE(eh.in_flight_count(), 1);
+  }
+
+  BOOST_REQUIRE_EQUAL(received_messages.size(), FAST_MESSAGES + 1);
+  BOOST_CHECK_EQUAL(received_messages.back(), "slow");
+  BOOST_CHECK_EQUAL(counter._err_count, 0);
+}
+
+BOOST_AUTO_TEST_CASE(http_sender_metrics_histograms)
+{
+  mock_http_client* http_client = new mock_http_client("localhost:8080");
+
+  std::atomic<int> tries{0};
+  http_client->set_responder(methods::POST,
+      [&tries](const http_request& message, http_response& resp)
+      {
+        // every other request fails, each message is retried once
+        resp.set_status_code(++tries % 2 == 1 ? status_codes::InternalError : status_codes::Created);
+      });
+
+  r::http_transport_client<r::eventhub_http_authorization> eh(
+      http_client, 1, 4, UNLIMITED_RETRY_TIME, nullptr, nullptr);
+  eh.set_retry_backoff(make_backoff(10, 10));
+
+  r::api_status ret;
+  for (int i = 0; i < 5; ++i)
+  {
+    std::shared_ptr<u::data_buffer> db(new u::data_buffer());
+    u::data_buffer_streambuf sbuff(db.get());
+    std::ostream message(&sbuff);
+    message << "message " << i;
+    sbuff.finalize();
+    BOOST_CHECK_EQUAL(eh.send(db, &ret), r::error_code::success);
+  }
+
+  // the window holds a single request: every send waited for the previous one to complete
+  r::http_sender_metrics metrics;
+  BOOST_REQUIRE(eh.get_metrics(metrics));
+  BOOST_CHECK_GE(metrics.completed, 4);
+  BOOST_CHECK_EQUAL(metrics.completed + metrics.in_flight, 5);
+  BOOST_CHECK_EQUAL(metrics.failed, 0);
+  BOOST_CHECK_EQUAL(metrics.retries[1], metrics.completed);
+  uint64_t latencies = 0;
+  for (size_t i = 0; i < r::http_sender_metrics::LATENCY_BUCKETS; ++i)
+  {
+    latencies += metrics.latency_ms[i];
+    // every request waited for at least the 5ms minimum retry delay
+    if (i < r::http_completion_window::latency_bucket(std::chrono::milliseconds(5)))
+    {
+      BOOST_CHECK_EQUAL(metrics.latency_ms[i], 0);
+    }
+  }
+  BOOST_CHECK_EQUAL(latencies, metrics.completed);
+}
+
+BOOST_AUTO_TEST_CASE(retry_backoff_grows_exponentially_with_jitter)
+{
+  const auto backoff = make_backoff(100, 1000);
+  for (int i = 0; i < 100; ++i)
+  {
+    BOOST_CHECK_GE(backoff.delay(0).count(), 50);
+    BOOST_CHECK_LE(backoff.delay(0).count(), 100);
+    BOOST_CHECK_GE(backoff.delay(2).count(), 200);
+    BOOST_CHECK_LE(backoff.delay(2).count(), 400);
+    // capped at max_delay
+    BOOST_CHECK_GE(backoff.delay(10).count(), 500);
+    BOOST_CHECK_LE(backoff.delay(10).count(), 1000);
+    BOOST_CHECK_LE(backoff.delay(1000).count(), 1000);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(retry_timer_completes_in_deadline_order)
+{
+  u::retry_timer timer;
+  std::mutex mutex;
+  std::vector<int> order;
+  auto record = [&](int id)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    order.push_back(id);
+  };
+  auto slow = timer.delay(std::chrono::milliseconds(200)).then([&] { record(2); });
+  auto fast = timer.delay(std::chrono::milliseconds(10)).then([&] { record(1); });
+  fast.wait();
+  slow.wait();
+  BOOST_CHECK_EQUAL(order.size(), 2);
+  BOOST_CHECK_EQUAL(order[0], 1);
+  BOOST_CHECK_EQUAL(order[1], 2);
+  BOOST_CHECK_EQUAL(timer.pending(), 0);
+}
+
+// Local stub server answering one request in 10 with a 500 and delaying one in 25 by 200ms.
+// Every message must go through, and retries must not stall the other requests in flight.
+BOOST_AUTO_TEST_CASE(http_stub_server_throughput_with_failures_and_latency_spikes)
+{
+  const int MESSAGES = 500;
+
+  std::atomic<int> requests{0};
+  std::mutex received_mutex;
+  std::set<std::string> received;
+  // delays the replies without blocking the pplx threads the client also runs on
+  u::retry_timer spike_timer;
+
+  std::unique_ptr<stub_listener> listener;
+  const std::string url = open_stub_listener(listener,
+      [&](http_request request)
+      {
+        const int n = ++requests;
+        if (n % 10 == 0)
+        {
+          request.reply(status_codes::InternalError);
+          return;
+        }
+        request.extract_vector().then(
+            [&, request, n](std::vector<unsigned char> body)
+            {
+              {
+                std::lock_guard<std::mutex> lock(received_mutex);
+                received.insert(std::string(body.begin() + r::logger::preamble::size(), body.end()));
+              }
+              if (n % 25 == 0)
+              {
+                spike_timer.delay(std::chrono::milliseconds(200))
+                    .then([request] { request.reply(status_codes::Created); });
+              }
+              else { request.reply(status_codes::Created); }
+            });
+      });
+
+  u::configuration config;
+  config.set(r::name::HTTP_API_KEY, "apikey1234");
+  config.set(r::name::HTTP_CLIENT_POOL_SIZE, "4");
+  config.set(r::name::HTTP_RETRY_BASE_DELAY_MS, "10");
+  config.set(r::name::HTTP_RETRY_MAX_DELAY_MS, "100");
+
+  error_counter counter;
+  r::error_callback_fn error_callback(&error_counter_func, &counter);
+
+  r::i_http_client* http_client = nullptr;
+  BOOST_REQUIRE_EQUAL(r::create_http_client(url.c_str(), config, &http_client), r::error_code::success);
+
+  r::http_sender_metrics metrics;
+  const auto start_time = std::chrono::steady_clock::now();
+  {
+    r::http_transport_client<r::header_authorization> sender(
+        http_client, 16, 8, UNLIMITED_RETRY_TIME, nullptr, &error_callback);
+    r::api_status ret;
+    BOOST_REQUIRE_EQUAL(sender.init(config, &ret), r::error_code::success);
+
+    for (int i = 0; i < MESSAGES; ++i)
+    {
+      std::shared_ptr<u::data_buffer> db(new u::data_buffer());
+      u::data_buffer_streambuf sbuff(db.get());
+      std::ostream message(&sbuff);
+      message << "message " << i;
+      sbuff.finalize();
+      BOOST_CHECK_EQUAL(sender.send(db, &ret), r::error_code::success);
+    }
+    BOOST_REQUIRE(sender.get_metrics(metrics));
+  }
+  const auto elapsed_ms =
+      std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start_time).count();
+  listener->close().wait();
+
+  BOOST_TEST_MESSAGE(
+      "stub server: " << MESSAGES << " messages, " << requests.load() << " requests in " << elapsed_ms << "ms");
+  BOOST_CHECK_EQUAL(received.size(), MESSAGES);
+  BOOST_CHECK_GE(requests.load(), MESSAGES + MESSAGES / 10);
+  BOOST_CHECK_EQUAL(counter._err_count, 0);
+  // the requests still in flight when the metrics were read were joined by the destructor
+  BOOST_CHECK_EQUAL(metrics.completed + metrics.in_flight, MESSAGES);
+  BOOST_CHECK_GE(metrics.retries[1], 1);
+  // ~50 failed posts waiting one second each used to take most of a minute with 16 requests in flight
+  BOOST_CHECK_LT(elapsed_ms, 20000);
+}
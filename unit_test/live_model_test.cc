@@ -215,6 +215,47 @@ BOOST_AUTO_TEST_CASE(live_model_ranking_request)
   BOOST_CHECK_EQUAL(status.get_error_msg(), "");
 }
 
+BOOST_AUTO_TEST_CASE(live_model_ranking_request_batch)
+{
+  u::configuration config;
+  cfg::create_from_json(JSON_CFG, config);
+  config.set(r::name::EH_TEST, "true");
+
+  r::api_status status;
+
+  r::cb_loop ds = create_mock_live_model<r::cb_loop>(config, nullptr, nullptr, nullptr);
+  BOOST_CHECK_EQUAL(ds.init(&status), err::success);
+
+  std::vector<std::string> event_ids;
+  for (int i = 0; i < 16; ++i) { event_ids.push_back("event_id_" + std::to_string(i)); }
+  std::vector<std::pair<r::str_view, r::str_view>> requests;
+  for (const auto& event_id : event_ids) { requests.emplace_back(event_id.c_str(), JSON_CONTEXT); }
+
+  std::vector<r::ranking_response> responses;
+  BOOST_CHECK_EQUAL(ds.choose_rank_batch(requests, r::action_flags::DEFAULT, responses, &status), err::success);
+  BOOST_REQUIRE_EQUAL(responses.size(), requests.size());
+
+  // a batch decides exactly like one choose_rank() call per request
+  for (size_t i = 0; i < requests.size(); ++i)
+  {
+    BOOST_CHECK_EQUAL(responses[i].get_event_id(), event_ids[i]);
+
+    r::ranking_response single;
+    BOOST_CHECK_EQUAL(ds.choose_rank(event_ids[i].c_str(), JSON_CONTEXT, single, &status), err::success);
+    size_t batch_action;
+    size_t single_action;
+    BOOST_CHECK_EQUAL(responses[i].get_chosen_action_id(batch_action), err::success);
+    BOOST_CHECK_EQUAL(single.get_chosen_action_id(single_action), err::success);
+    BOOST_CHECK_EQUAL(batch_action, single_action);
+    BOOST_CHECK_EQUAL(responses[i].size(), single.size());
+  }
+
+  // a single invalid request fails the batch
+  requests[3] = std::make_pair(r::str_view(""), r::str_view(JSON_CONTEXT));
+  BOOST_CHECK_EQUAL(
+      ds.choose_rank_batch(requests, r::action_flags::DEFAULT, responses, &status), err::invalid_argument);
+}
+
 BOOST_AUTO_TEST_CASE(live_model_ranking_request_online_mode)
 {
   // create a simple ds configuration
@@ -645,6 +686,38 @@ BOOST_AUTO_TEST_CASE(live_model_outcome)
   BOOST_CHECK_EQUAL(status.get_error_msg(), "");
 }
 
+BOOST_AUTO_TEST_CASE(live_model_logger_metrics)
+{
+  u::configuration config;
+  cfg::create_from_json(JSON_CFG, config);
+  config.set(r::name::EH_TEST, "true");
+  // long enough for the interaction to still be queued when the metrics are read
+  config.set(r::name::INTERACTION_SEND_BATCH_INTERVAL_MS, "100000");
+
+  r::cb_loop ds = create_mock_live_model<r::cb_loop>(config, nullptr, nullptr, nullptr);
+  r::logger_metrics interactions;
+  r::logger_metrics observations;
+  // not available before init
+  BOOST_CHECK_EQUAL(ds.get_logger_metrics(interactions, observations), err::not_initialized);
+
+  r::api_status status;
+  BOOST_REQUIRE_EQUAL(ds.init(&status), err::success);
+  // let the batcher run its first flush before the interaction is logged
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  r::ranking_response response;
+  BOOST_REQUIRE_EQUAL(ds.choose_rank("event_id", JSON_CONTEXT, response), err::success);
+
+  BOOST_CHECK_EQUAL(ds.get_logger_metrics(interactions, observations, &status), err::success);
+  BOOST_CHECK_EQUAL(interactions.batching.interval_ms, 100000);
+  // the interaction waits in the queue for the next flush
+  BOOST_CHECK_GT(interactions.batching.memory_bytes, 0);
+  BOOST_CHECK_GT(observations.batching.interval_ms, 0);
+  BOOST_CHECK_GT(observations.batching.high_water_mark, 0);
+  // the mock senders do not track their requests
+  BOOST_CHECK(!interactions.has_sender_metrics);
+  BOOST_CHECK(!observations.has_sender_metrics);
+}
+
 BOOST_AUTO_TEST_CASE(live_model_outcome_with_secondary_id_and_v1)
 {
   // create a simple ds configuration
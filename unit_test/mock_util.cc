@@ -18,6 +18,7 @@ std::unique_ptr<fakeit::Mock<r::i_sender>> get_mock_sender(int send_return_code)
 
   When(Method((*mock), init)).AlwaysReturn(r::error_code::success);
   When(Method((*mock), send)).AlwaysReturn(send_return_code);
+  When(Method((*mock), get_metrics)).AlwaysReturn(false);
   Fake(Dtor((*mock)));
 
   return mock;
@@ -39,6 +40,7 @@ std::unique_ptr<fakeit::Mock<r::i_sender>> get_mock_sender(std::vector<buffer_da
   };
   When(Method((*mock), init)).AlwaysReturn(r::error_code::success);
   When(Method((*mock), send)).AlwaysDo(send_fn);
+  When(Method((*mock), get_metrics)).AlwaysReturn(false);
   Fake(Dtor((*mock)));
 
   return mock;
@@ -82,6 +84,21 @@ std::unique_ptr<fakeit::Mock<m::i_model>> get_mock_model(m::model_type_t model_t
     return r::error_code::success;
   };
 
+  const auto choose_rank_batch_fn = [choose_rank_fn](const std::vector<const char*>& event_ids,
+                                        const std::vector<uint64_t>& seeds, const std::vector<r::string_view>& features,
+                                        std::vector<std::vector<int>>& actions, std::vector<std::vector<float>>& scores,
+                                        std::vector<std::string>& model_versions, r::api_status* status)
+  {
+    actions.resize(features.size());
+    scores.resize(features.size());
+    model_versions.resize(features.size());
+    for (size_t i = 0; i < features.size(); ++i)
+    {
+      choose_rank_fn(event_ids[i], seeds[i], features[i], actions[i], scores[i], model_versions[i], status);
+    }
+    return r::error_code::success;
+  };
+
   const auto choose_continuous_action_fn =
       [](r::string_view, float&, float&, std::string& model_version, r::api_status*)
   {
@@ -117,6 +134,7 @@ std::unique_ptr<fakeit::Mock<m::i_model>> get_mock_model(m::model_type_t model_t
 
   When(Method((*mock), update)).AlwaysReturn(r::error_code::success);
   When(Method((*mock), choose_rank)).AlwaysDo(choose_rank_fn);
+  When(Method((*mock), choose_rank_batch)).AlwaysDo(choose_rank_batch_fn);
   When(Method((*mock), choose_continuous_action)).AlwaysDo(choose_continuous_action_fn);
   When(Method((*mock), request_decision)).AlwaysDo(request_decision_fn);
   When(Method((*mock), request_multi_slot_decision)).AlwaysDo(request_multi_slot_decision_fn);
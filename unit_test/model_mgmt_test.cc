@@ -12,14 +12,24 @@
 #include "err_constants.h"
 #include "factory_resolver.h"
 #include "model_mgmt/data_callback_fn.h"
+#include "model_mgmt/delta_data_transport.h"
+#include "model_mgmt/file_model_loader.h"
+#include "model_mgmt/model_delta.h"
 #include "model_mgmt/model_downloader.h"
 #include "object_factory.h"
 #include "utility/periodic_background_proc.h"
 #include "utility/watchdog.h"
 
+#include <cstdio>
+#include <fstream>
 #include <regex>
 #include <unordered_map>
 
+#ifndef _WIN32
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+
 #ifdef USE_AZURE_FACTORIES
 #  include "mock_http_client.h"
 #  include "model_mgmt/restapi_data_transport.h"
@@ -243,3 +253,223 @@ BOOST_AUTO_TEST_CASE(vw_model_type)
   BOOST_CHECK_EQUAL(r::error_code::success, r::model_factory.create(vw, r::value::VW, model_cc));
   BOOST_CHECK_EQUAL((int)m::model_type_t::SLATES, (int)vw->model_type());
 }
+
+namespace
+{
+void write_model_file(const std::string& file_name, const std::string& content)
+{
+  // models are published by renaming a complete file over the previous one
+  const auto tmp_name = file_name + ".tmp";
+  {
+    std::ofstream out(tmp_name, std::ios::binary | std::ios::trunc);
+    out << content;
+  }
+  BOOST_REQUIRE_EQUAL(0, std::rename(tmp_name.c_str(), file_name.c_str()));
+}
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(file_model_loader_mmap)
+{
+  const std::string file_name = "file_model_loader_mmap.model";
+  write_model_file(file_name, "first model");
+
+  m::file_model_loader loader(file_name, true, nullptr, true);
+  BOOST_REQUIRE_EQUAL(e::success, loader.init(nullptr));
+
+  m::model_data first;
+  BOOST_REQUIRE_EQUAL(e::success, loader.get_data(first));
+  // read through const references, the non-const data() would copy the mapping
+  const m::model_data& mapped = first;
+  BOOST_CHECK_EQUAL(std::string(mapped.data(), mapped.data_sz()), "first model");
+  BOOST_CHECK_EQUAL(first.refresh_count(), 1);
+
+  // copies share the mapping
+  const m::model_data copy = first;
+  BOOST_CHECK_EQUAL(static_cast<const void*>(copy.data()), static_cast<const void*>(mapped.data()));
+
+  // writing goes to a copy of the mapping, which is read-only
+  m::model_data writable = first;
+  writable.data()[0] = 'F';
+  BOOST_CHECK_EQUAL(std::string(writable.data(), writable.data_sz()), "First model");
+  BOOST_CHECK_EQUAL(std::string(copy.data(), copy.data_sz()), "first model");
+
+  // unchanged file: nothing to load
+  m::model_data unchanged;
+  BOOST_REQUIRE_EQUAL(e::success, loader.get_data(unchanged));
+  BOOST_CHECK_EQUAL(unchanged.data_sz(), 0);
+
+  write_model_file(file_name, "second, longer model");
+  m::model_data second;
+  BOOST_REQUIRE_EQUAL(e::success, loader.get_data(second));
+  BOOST_CHECK_EQUAL(std::string(second.data(), second.data_sz()), "second, longer model");
+
+  // the previous model is still mapped after the file was replaced
+  BOOST_CHECK_EQUAL(std::string(mapped.data(), mapped.data_sz()), "first model");
+
+  std::remove(file_name.c_str());
+}
+
+#ifndef _WIN32
+BOOST_AUTO_TEST_CASE(file_model_loader_watch_symlink_swap)
+{
+  // a mounted config directory: model -> ..data/model, ..data -> v1, published by swapping ..data to v2
+  const std::string dir = "file_model_loader_watch";
+  BOOST_REQUIRE_EQUAL(0, ::mkdir(dir.c_str(), 0755));
+  BOOST_REQUIRE_EQUAL(0, ::mkdir((dir + "/v1").c_str(), 0755));
+  BOOST_REQUIRE_EQUAL(0, ::mkdir((dir + "/v2").c_str(), 0755));
+  write_model_file(dir + "/v1/model", "first model");
+  write_model_file(dir + "/v2/model", "second, longer model");
+  BOOST_REQUIRE_EQUAL(0, ::symlink("v1", (dir + "/..data").c_str()));
+  BOOST_REQUIRE_EQUAL(0, ::symlink("..data/model", (dir + "/model").c_str()));
+
+  m::file_model_loader loader(dir + "/model", true, nullptr, false, true);
+  BOOST_REQUIRE_EQUAL(e::success, loader.init(nullptr));
+
+  m::model_data first;
+  BOOST_REQUIRE_EQUAL(e::success, loader.get_data(first));
+  BOOST_CHECK_EQUAL(std::string(first.data(), first.data_sz()), "first model");
+
+  BOOST_REQUIRE_EQUAL(0, ::symlink("v2", (dir + "/..data_tmp").c_str()));
+  BOOST_REQUIRE_EQUAL(0, std::rename((dir + "/..data_tmp").c_str(), (dir + "/..data").c_str()));
+
+  // the symlinked file is polled: the swap is noticed
+  m::model_data second;
+  BOOST_REQUIRE_EQUAL(e::success, loader.get_data(second));
+  BOOST_CHECK_EQUAL(std::string(second.data(), second.data_sz()), "second, longer model");
+
+  for (const auto* name : {"/model", "/..data", "/v1/model", "/v2/model"}) { std::remove((dir + name).c_str()); }
+  for (const auto* name : {"/v1", "/v2", ""}) { ::rmdir((dir + name).c_str()); }
+}
+#endif
+
+BOOST_AUTO_TEST_CASE(file_model_loader_watch)
+{
+  const std::string file_name = "file_model_loader_watch.model";
+  write_model_file(file_name, "first model");
+
+  m::file_model_loader loader(file_name, true, nullptr, false, true);
+  BOOST_REQUIRE_EQUAL(e::success, loader.init(nullptr));
+
+  m::model_data first;
+  BOOST_REQUIRE_EQUAL(e::success, loader.get_data(first));
+  BOOST_CHECK_EQUAL(std::string(first.data(), first.data_sz()), "first model");
+
+  m::model_data unchanged;
+  BOOST_REQUIRE_EQUAL(e::success, loader.get_data(unchanged));
+  BOOST_CHECK_EQUAL(unchanged.data_sz(), 0);
+
+  write_model_file(file_name, "second, longer model");
+  m::model_data second;
+  BOOST_REQUIRE_EQUAL(e::success, loader.get_data(second));
+  BOOST_CHECK_EQUAL(std::string(second.data(), second.data_sz()), "second, longer model");
+
+  std::remove(file_name.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(model_data_set_shared)
+{
+  std::shared_ptr<const char> shared(new char[4]{'a', 'b', 'c', 'd'}, std::default_delete<const char[]>());
+  m::model_data md;
+  md.alloc(16);
+  md.set_shared(shared, 4);
+  BOOST_CHECK_EQUAL(md.data_sz(), 4);
+  BOOST_CHECK_EQUAL(static_cast<const void*>(md.data()), static_cast<const void*>(shared.get()));
+  BOOST_CHECK_EQUAL(shared.use_count(), 2);
+
+  md.free();
+  BOOST_CHECK_EQUAL(shared.use_count(), 1);
+  BOOST_CHECK_EQUAL(md.data_sz(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(model_delta_round_trip)
+{
+  m::model_delta delta;
+  delta.base_id = "model-1";
+  delta.model_id = "model-2";
+  delta.weights.push_back({12, 0.5f});
+  delta.weights.push_back({(uint64_t(1) << 40) + 3, -2.25f});
+
+  std::vector<char> payload;
+  m::write_model_delta(delta, payload);
+  BOOST_CHECK(m::is_model_delta(payload.data(), payload.size()));
+
+  m::model_delta parsed;
+  BOOST_REQUIRE_EQUAL(e::success, m::parse_model_delta(payload.data(), payload.size(), parsed, nullptr));
+  BOOST_CHECK_EQUAL(parsed.base_id, "model-1");
+  BOOST_CHECK_EQUAL(parsed.model_id, "model-2");
+  BOOST_REQUIRE_EQUAL(parsed.weights.size(), 2);
+  BOOST_CHECK_EQUAL(parsed.weights[1].index, (uint64_t(1) << 40) + 3);
+  BOOST_CHECK_EQUAL(parsed.weights[1].value, -2.25f);
+
+  // truncated
+  r::api_status status;
+  BOOST_CHECK_EQUAL(
+      e::model_delta_invalid, m::parse_model_delta(payload.data(), payload.size() - 1, parsed, nullptr, &status));
+
+  // a complete model is not a delta
+  const char vw_model[] = {6, 0, 0, 0, 0, 0, 0, 0, '9', '.', '8', '.', '0', 0};
+  BOOST_CHECK(!m::is_model_delta(vw_model, sizeof(vw_model)));
+}
+
+namespace
+{
+// returns the queued payloads, one per get_data call, and nothing once they are consumed
+class queued_data_transport : public m::i_data_transport
+{
+public:
+  explicit queued_data_transport(std::vector<std::string> payloads) : _payloads(std::move(payloads)) {}
+
+  int get_data(m::model_data& data, r::api_status* status) override
+  {
+    if (_next == _payloads.size()) { return e::success; }
+    data.set_data(_payloads[_next].data(), _payloads[_next].size());
+    data.increment_refresh_count();
+    ++_next;
+    return e::success;
+  }
+
+private:
+  std::vector<std::string> _payloads;
+  size_t _next = 0;
+};
+
+std::string get_payload(m::i_data_transport& transport)
+{
+  m::model_data md;
+  BOOST_REQUIRE_EQUAL(e::success, transport.get_data(md));
+  return md.refresh_count() > 0 ? std::string(md.data(), md.data_sz()) : std::string();
+}
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(delta_data_transport_fallback)
+{
+  std::unique_ptr<m::i_data_transport> full(new queued_data_transport({"full-1", "full-2"}));
+  std::unique_ptr<m::i_data_transport> delta(new queued_data_transport({"delta-1", "delta-2", "delta-3"}));
+  m::delta_data_transport transport(std::move(full), std::move(delta), nullptr);
+
+  // the complete model first, then deltas
+  BOOST_CHECK_EQUAL(get_payload(transport), "full-1");
+  BOOST_CHECK_EQUAL(get_payload(transport), "delta-1");
+
+  // back to the complete model once, then deltas again
+  transport.request_full_model();
+  BOOST_CHECK_EQUAL(get_payload(transport), "full-2");
+  BOOST_CHECK_EQUAL(get_payload(transport), "delta-2");
+
+  // no new complete model: deltas keep coming
+  transport.request_full_model();
+  BOOST_CHECK_EQUAL(get_payload(transport), "delta-3");
+  BOOST_CHECK_EQUAL(get_payload(transport), "");
+}
+
+BOOST_AUTO_TEST_CASE(delta_data_transport_config)
+{
+  u::configuration config;
+  config.set(r::name::MODEL_BLOB_URI, "http://localhost/model");
+  u::configuration delta_config;
+  BOOST_CHECK(!m::get_delta_config(config, delta_config));
+
+  config.set(r::name::MODEL_DELTA_BLOB_URI, "http://localhost/delta");
+  BOOST_REQUIRE(m::get_delta_config(config, delta_config));
+  BOOST_CHECK_EQUAL(delta_config.get(r::name::MODEL_BLOB_URI, nullptr), "http://localhost/delta");
+}
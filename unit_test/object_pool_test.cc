@@ -7,7 +7,10 @@
 #include "trace_logger.h"
 #include "utility/versioned_object_pool.h"
 
+#include <atomic>
 #include <string>
+#include <thread>
+#include <vector>
 
 using namespace reinforcement_learning;
 using namespace reinforcement_learning::utility;
@@ -190,4 +193,129 @@ BOOST_AUTO_TEST_CASE(object_pool_logging)
   pool.update_factory(new_factory);
   BOOST_TEST(logger.get_message().find("2") != std::string::npos);
   logger.reset();
-}
\ No newline at end of file
+}
+
+BOOST_AUTO_TEST_CASE(object_pool_update_factory_does_not_block_get_or_create)
+{
+  my_object_factory factory;
+  versioned_object_pool<my_object> pool(factory, 2);
+
+  // the new generation cannot be built until release is set
+  std::atomic<bool> building{false};
+  std::atomic<bool> release{false};
+  auto slow_factory = [&building, &release]() -> my_object*
+  {
+    building = true;
+    while (!release) { std::this_thread::yield(); }
+    return new my_object(100);
+  };
+
+  std::thread updater([&pool, &slow_factory] { pool.update_factory(slow_factory); });
+  while (!building) { std::this_thread::yield(); }
+
+  // the update is in progress: callers get objects of the current generation without waiting for it
+  {
+    auto obj1 = pool.get_or_create();
+    auto obj2 = pool.get_or_create();
+    auto obj3 = pool.get_or_create();
+    BOOST_CHECK_LT(obj1->_id, 100);
+    BOOST_CHECK_LT(obj2->_id, 100);
+    BOOST_CHECK_LT(obj3->_id, 100);
+  }
+
+  release = true;
+  updater.join();
+
+  auto obj = pool.get_or_create();
+  BOOST_CHECK_EQUAL(obj->_id, 100);
+}
+
+BOOST_AUTO_TEST_CASE(object_pool_checkout_keeps_thread_object)
+{
+  my_object_factory factory;
+  versioned_object_pool<my_object> pool(factory, 0, nullptr, true);
+
+  my_object* first = nullptr;
+  {
+    auto obj = pool.checkout();
+    first = obj.get();
+    // nested checkout on the same thread gets another object
+    auto nested = pool.checkout();
+    BOOST_CHECK_NE(nested.get(), first);
+  }
+  {
+    auto obj = pool.checkout();
+    BOOST_CHECK_EQUAL(obj.get(), first);
+  }
+
+  // other threads get their own object
+  my_object* other = nullptr;
+  std::thread t([&pool, &other] { other = pool.checkout().get(); });
+  t.join();
+  BOOST_CHECK_NE(other, first);
+
+  // the exited thread gave its object back to the pool
+  auto obj1 = pool.get_or_create();
+  BOOST_CHECK_EQUAL(obj1.get(), other);
+}
+
+BOOST_AUTO_TEST_CASE(object_pool_checkout_releases_stale_objects)
+{
+  // counts the live objects of one generation
+  struct counted_object
+  {
+    std::atomic<int>& _alive;
+    int _id;
+    counted_object(std::atomic<int>& alive, int id) : _alive(alive), _id(id) { ++_alive; }
+    ~counted_object() { --_alive; }
+  };
+
+  std::atomic<int> alive0{0}, alive1{0}, alive2{0};
+  versioned_object_pool<counted_object> pool([&alive0] { return new counted_object(alive0, 0); }, 0, nullptr, true);
+
+  // an idle thread cached object is freed by the update itself
+  {
+    auto obj = pool.checkout();
+  }
+  BOOST_CHECK_EQUAL(alive0, 1);
+  pool.update_factory([&alive1] { return new counted_object(alive1, 1); });
+  BOOST_CHECK_EQUAL(alive0, 0);
+
+  // an object in use during the update is freed when released
+  {
+    auto obj = pool.checkout();
+    BOOST_CHECK_EQUAL(obj->_id, 1);
+    pool.update_factory([&alive2] { return new counted_object(alive2, 2); });
+    BOOST_CHECK_EQUAL(obj->_id, 1);
+  }
+  BOOST_CHECK_EQUAL(alive1, 0);
+
+  auto obj = pool.checkout();
+  BOOST_CHECK_EQUAL(obj->_id, 2);
+}
+
+BOOST_AUTO_TEST_CASE(object_pool_checkout_concurrent_updates)
+{
+  my_object_factory factory;
+  versioned_object_pool<my_object> pool(factory, 0, nullptr, true);
+
+  std::atomic<bool> done{false};
+  std::atomic<int> checkouts{0};
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; ++i)
+  {
+    threads.emplace_back(
+        [&pool, &done, &checkouts]
+        {
+          while (!done)
+          {
+            auto obj = pool.checkout();
+            if (obj.get() != nullptr) { ++checkouts; }
+          }
+        });
+  }
+  for (int i = 0; i < 50; ++i) { pool.update_factory(my_object_factory()); }
+  done = true;
+  for (auto& t : threads) { t.join(); }
+  BOOST_CHECK_GT(checkouts, 0);
+}
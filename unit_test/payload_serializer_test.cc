@@ -12,6 +12,9 @@
 #include "generated/v2/OutcomeEvent_generated.h"
 #include "ranking_response.h"
 
+#include <algorithm>
+#include <string>
+
 using namespace reinforcement_learning;
 using namespace reinforcement_learning::logger;
 using namespace std;
@@ -60,6 +63,71 @@ BOOST_AUTO_TEST_CASE(cb_payload_serializer_test)
   BOOST_CHECK_EQUAL(true, event->deferred_action());
 }
 
+// the context is written into the builder as raw bytes: large contexts and embedded nulls must round-trip
+BOOST_AUTO_TEST_CASE(cb_payload_serializer_large_context_test)
+{
+  cb_serializer serializer;
+  std::string context(50 * 1024, 'x');
+  context[100] = '\0';
+  const std::vector<uint64_t> action_ids = {1, 2};
+  const std::vector<float> probs = {0.9f, 0.1f};
+
+  const auto buffer =
+      serializer.event(context, action_flags::DEFAULT, v2::LearningModeType_Online, action_ids, probs, "model_id");
+
+  const auto event = v2::GetCbEvent(buffer.data());
+  BOOST_REQUIRE_EQUAL(context.size(), event->context()->size());
+  BOOST_CHECK(std::equal(context.begin(), context.end(), event->context()->begin()));
+  BOOST_CHECK_EQUAL(2, event->action_ids()->size());
+  BOOST_CHECK_EQUAL("model_id", event->model_id()->c_str());
+}
+
+BOOST_AUTO_TEST_CASE(cb_payload_serializer_hashed_features_test)
+{
+  cb_serializer serializer;
+  const std::vector<uint64_t> action_ids = {1, 2};
+  const std::vector<float> probs = {0.9f, 0.1f};
+
+  hashed_features features;
+  const auto without_features = serializer.event(
+      "my_context", action_flags::DEFAULT, v2::LearningModeType_Online, action_ids, probs, "model_id", features);
+  BOOST_CHECK(v2::GetCbEvent(without_features.data())->hashed_features() == nullptr);
+
+  features.hash_seed = 7;
+  features.parse_mask = 0xffff;
+  features.num_bits = 16;
+  features.parse_options = " --ignore U";
+  features.shared = true;
+  features.examples.resize(2);
+  features.examples[0].namespaces.resize(1);
+  features.examples[0].namespaces[0].index = 'G';
+  features.examples[0].namespaces[0].hash = 42;
+  features.examples[0].namespaces[0].feature_hashes = {10, 11};
+  features.examples[0].namespaces[0].values = {1.f, 2.f};
+
+  const auto buffer = serializer.event(
+      "my_context", action_flags::DEFAULT, v2::LearningModeType_Online, action_ids, probs, "model_id", features);
+
+  const auto event = v2::GetCbEvent(buffer.data());
+  BOOST_CHECK_EQUAL("model_id", event->model_id()->c_str());
+  const auto* hashed = event->hashed_features();
+  BOOST_REQUIRE(hashed != nullptr);
+  BOOST_CHECK_EQUAL(7, hashed->hash_seed());
+  BOOST_CHECK_EQUAL(0xffff, hashed->parse_mask());
+  BOOST_CHECK_EQUAL(16, hashed->num_bits());
+  BOOST_CHECK_EQUAL(" --ignore U", hashed->parse_options()->str());
+  BOOST_CHECK_EQUAL(true, hashed->shared());
+  BOOST_REQUIRE_EQUAL(2, hashed->examples()->size());
+  BOOST_CHECK_EQUAL(0, hashed->examples()->Get(1)->namespaces()->size());
+
+  const auto* ns = hashed->examples()->Get(0)->namespaces()->Get(0);
+  BOOST_CHECK_EQUAL('G', ns->index());
+  BOOST_CHECK_EQUAL(42, ns->hash());
+  BOOST_REQUIRE_EQUAL(2, ns->feature_hashes()->size());
+  BOOST_CHECK_EQUAL(11, ns->feature_hashes()->Get(1));
+  BOOST_CHECK_CLOSE(2.f, ns->values()->Get(1), tolerance);
+}
+
 BOOST_AUTO_TEST_CASE(ca_payload_serializer_test)
 {
   ca_serializer serializer;
@@ -7,6 +7,7 @@
 
 #include "data.h"
 #include "model_mgmt.h"
+#include "model_mgmt/model_delta.h"
 #include "utility/versioned_object_pool.h"
 
 using namespace reinforcement_learning;
@@ -120,6 +121,65 @@ BOOST_AUTO_TEST_CASE(factory_with_initial_model)
   }
 }
 
+BOOST_AUTO_TEST_CASE(factory_clones_share_master)
+{
+  const auto json = R"({"a":{"0":1,"5":2},"_multi":[{"b":{"0":1}},{"b":{"0":2}},{"b":{"0":3}}]})";
+  std::vector<float> ranking_expected = {.8f, .1f, .1f};
+
+  model_management::model_data model_data;
+  get_model_data_from_raw((const char*)cb_data_5_model, cb_data_5_model_len, &model_data);
+
+  std::unique_ptr<versioned_object_pool<safe_vw>> pool;
+  {
+    safe_vw_factory factory(model_data, "--json --quiet");
+    // the master is deserialized here and shared with the pool's copy of the factory
+    std::unique_ptr<safe_vw> test_vw(factory());
+    pool.reset(new versioned_object_pool<safe_vw>(factory, 4));
+  }
+
+  // every clone ranks with the same weights
+  auto vw1 = pool->get_or_create();
+  auto vw2 = pool->get_or_create();
+  auto vw3 = pool->get_or_create();
+  BOOST_CHECK_NE(vw1.get(), vw2.get());
+  for (auto* vw : {vw1.get(), vw2.get(), vw3.get()})
+  {
+    std::vector<int> actions;
+    std::vector<float> ranking;
+    vw->rank(json, actions, ranking);
+    BOOST_CHECK_EQUAL_COLLECTIONS(ranking.begin(), ranking.end(), ranking_expected.begin(), ranking_expected.end());
+  }
+}
+
+BOOST_AUTO_TEST_CASE(safe_vw_chained_deltas)
+{
+  const auto json = R"({"a":{"0":1,"5":2},"_multi":[{"b":{"0":1}},{"b":{"0":2}},{"b":{"0":3}}]})";
+
+  auto master = std::make_shared<safe_vw>((const char*)cb_data_5_model, cb_data_5_model_len);
+  model_management::model_delta delta;
+  delta.base_id = master->id();
+  delta.model_id = "delta-1";
+  delta.weights.push_back({0, 0.f});
+  auto patched = std::make_shared<safe_vw>(master, delta);
+
+  // each patched instance only depends on the instance it was patched from while it is constructed
+  master.reset();
+  delta.base_id = "delta-1";
+  delta.model_id = "delta-2";
+  auto patched_twice = std::make_shared<safe_vw>(patched, delta);
+  patched.reset();
+
+  std::vector<int> actions;
+  std::vector<float> ranking;
+  patched_twice->rank(json, actions, ranking);
+  BOOST_CHECK_EQUAL(patched_twice->id(), "delta-2");
+  BOOST_CHECK_EQUAL(actions.size(), 3);
+
+  // an index past the weight mask would wrap around onto another weight
+  delta.weights.push_back({uint64_t(1) << 40, 1.f});
+  BOOST_CHECK_THROW(std::make_shared<safe_vw>(patched_twice, delta), std::out_of_range);
+}
+
 BOOST_AUTO_TEST_CASE(factory_with_empty_model)
 {
   const auto json = R"({"a":{"0":1,"5":2},"_multi":[{"b":{"0":1}},{"b":{"0":2}},{"b":{"0":3}}]})";